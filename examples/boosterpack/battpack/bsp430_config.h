@@ -7,7 +7,7 @@
 
 /* Support console output with buffered output and input */
 #define configBSP430_CONSOLE 1
-#define BSP430_CONSOLE_TX_BUFFER_SIZE 80
+#define BSP430_CONSOLE_TX_BUFFER_SIZE 64
 #define BSP430_CONSOLE_RX_BUFFER_SIZE 16
 
 /* Monitor uptime with delay support */
@@ -9,7 +9,7 @@
  * compare ISR-based transmission with DMA transmission. */
 #define configBSP430_CONSOLE 1
 #ifndef BSP430_CONSOLE_TX_BUFFER_SIZE
-#define BSP430_CONSOLE_TX_BUFFER_SIZE 80
+#define BSP430_CONSOLE_TX_BUFFER_SIZE 64
 #endif /* BSP430_CONSOLE_TX_BUFFER_SIZE */
 
 /* Monitor uptime and provide generic timer with delay capability.
@@ -40,6 +40,29 @@ cacheQueue_ni (hBSP430timerMuxSharedAlarm sap)
 {
   hBSP430timerMuxAlarm map = sap->alarms;
   sAlarmQueue * qp = queue;
+#if (configBSP430_TIMER_MUX_ALARM_HEAP - 0)
+  /* Walk the heap depth-first.  Only the first entry is guaranteed
+   * to be the next alarm due. */
+  hBSP430timerMuxAlarm stack[NMUXALARMS];
+  unsigned int depth = 0;
+
+  memset(queue, -1, sizeof(queue));
+  if (map) {
+    stack[depth++] = map;
+  }
+  while (0 < depth) {
+    map = stack[--depth];
+    qp->id = (map - alarms);
+    qp->setting_tck = map->setting_tck;
+    if (map->next) {
+      stack[depth++] = map->next;
+    }
+    if (map->child) {
+      stack[depth++] = map->child;
+    }
+    ++qp;
+  }
+#else /* configBSP430_TIMER_MUX_ALARM_HEAP */
   memset(queue, -1, sizeof(queue));
   while (map) {
     qp->id = (map - alarms);
@@ -47,6 +70,7 @@ cacheQueue_ni (hBSP430timerMuxSharedAlarm sap)
     map = map->next;
     ++qp;
   }
+#endif /* configBSP430_TIMER_MUX_ALARM_HEAP */
   return (unsigned int)(qp - queue);
 }
 
@@ -160,7 +184,7 @@ void main ()
   cprintf("muxalarm " __DATE__ " " __TIME__ "\n");
 
   for (map = alarms; map < alarms_end; ++map) {
-    memset(map, 0, sizeof(&map));
+    memset(map, 0, sizeof(*map));
     map->callback_ni = handle_mux_alarm;
     map->setting_tck = rand();
   }
@@ -173,7 +197,7 @@ void main ()
   vBSP430timerResetCounter_ni(sap->dedicated.timer);
 
   for (map = alarms; map < alarms_end; ++map) {
-    memset(map, 0, sizeof(&map));
+    memset(map, 0, sizeof(*map));
     map->callback_ni = handle_mux_alarm;
     map->setting_tck = (unsigned int)rand();
     rc = iBSP430timerMuxAlarmAdd_ni(sap, map);
@@ -0,0 +1,61 @@
+/** This file is in the public domain.
+ *
+ * @homepage http://github.com/pabigot/bsp430
+ *
+ * Compares the time taken by the table-driven decimal conversion in
+ * utility/format against conversion by division.  The conversions
+ * and formatting are checked against the C library on the host by
+ * maintainer/timerhost/formattest.c.
+ */
+
+#include <bsp430/platform.h>
+#include <bsp430/utility/uptime.h>
+#include <bsp430/utility/console.h>
+#include <bsp430/utility/format.h>
+#include <bsp430/utility/unittest.h>
+
+/* Division-based conversion, for comparison */
+static int
+divide_ul (char * dp,
+           unsigned long v)
+{
+  char tmp[12];
+  char * tp = tmp + sizeof(tmp);
+  int len;
+
+  do {
+    *--tp = '0' + (v % 10);
+    v /= 10;
+  } while (v);
+  len = (tmp + sizeof(tmp)) - tp;
+  memcpy(dp, tp, len);
+  dp[len] = 0;
+  return len;
+}
+
+void main ()
+{
+  unsigned long t0;
+  unsigned long t_table;
+  unsigned long t_divide;
+  unsigned long v;
+  char buf[BSP430_FORMAT_BUFFER_SIZE];
+
+  vBSP430platformInitialize_ni();
+  vBSP430unittestInitialize();
+
+  t0 = ulBSP430uptime();
+  for (v = 0; v < 100000UL; v += 7) {
+    (void)divide_ul(buf, v * 42949UL);
+  }
+  t_divide = ulBSP430uptime() - t0;
+  t0 = ulBSP430uptime();
+  for (v = 0; v < 100000UL; v += 7) {
+    (void)iBSP430formatUnsignedLong(buf, v * 42949UL, 10);
+  }
+  t_table = ulBSP430uptime() - t0;
+  cprintf("32-bit decimal conversion: division %lu ticks, table %lu ticks\n", t_divide, t_table);
+  BSP430_UNITTEST_ASSERT_TRUE(t_table < t_divide);
+
+  vBSP430unittestFinalize();
+}
@@ -11,6 +11,14 @@
 #include <bsp430/utility/unittest.h>
 #include <bsp430/periph/timer.h>
 
+#if (configBSP430_TIMER_MUX_ALARM_HEAP - 0)
+/* Only the earliest alarm is determined by the heap; the links among
+ * the rest depend on the order of operations. */
+#define ASSERT_NEXT(expected_, alarm_) do { } while (0)
+#else /* configBSP430_TIMER_MUX_ALARM_HEAP */
+#define ASSERT_NEXT(expected_, alarm_) BSP430_UNITTEST_ASSERT_EQUAL_FMTp(expected_, (alarm_).next)
+#endif /* configBSP430_TIMER_MUX_ALARM_HEAP */
+
 void
 testOnOff (void)
 {
@@ -55,79 +63,79 @@ testAddRemove (void)
   i = iBSP430timerMuxAlarmAdd_ni(hs, alarms+1);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+1, hs->alarms);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(NULL, alarms[1].next);
+  ASSERT_NEXT(NULL, alarms[1]);
   BSP430_UNITTEST_ASSERT_TRUE(BSP430_TIMER_ALARM_FLAG_SET & hs->dedicated.flags);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTld(hs->alarms->setting_tck, hs->dedicated.setting_tck);
 
   i = iBSP430timerMuxAlarmAdd_ni(hs, alarms+3);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+1, hs->alarms);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+3, alarms[1].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(NULL, alarms[3].next);
+  ASSERT_NEXT(alarms+3, alarms[1]);
+  ASSERT_NEXT(NULL, alarms[3]);
   BSP430_UNITTEST_ASSERT_TRUE(BSP430_TIMER_ALARM_FLAG_SET & hs->dedicated.flags);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTld(hs->alarms->setting_tck, hs->dedicated.setting_tck);
 
   i = iBSP430timerMuxAlarmAdd_ni(hs, alarms+2);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+1, hs->alarms);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+2, alarms[1].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+3, alarms[2].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(NULL, alarms[3].next);
+  ASSERT_NEXT(alarms+2, alarms[1]);
+  ASSERT_NEXT(alarms+3, alarms[2]);
+  ASSERT_NEXT(NULL, alarms[3]);
   BSP430_UNITTEST_ASSERT_TRUE(BSP430_TIMER_ALARM_FLAG_SET & hs->dedicated.flags);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTld(hs->alarms->setting_tck, hs->dedicated.setting_tck);
 
   i = iBSP430timerMuxAlarmAdd_ni(hs, alarms+0);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+0, hs->alarms);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+1, alarms[0].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+2, alarms[1].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+3, alarms[2].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(NULL, alarms[3].next);
+  ASSERT_NEXT(alarms+1, alarms[0]);
+  ASSERT_NEXT(alarms+2, alarms[1]);
+  ASSERT_NEXT(alarms+3, alarms[2]);
+  ASSERT_NEXT(NULL, alarms[3]);
   BSP430_UNITTEST_ASSERT_TRUE(BSP430_TIMER_ALARM_FLAG_SET & hs->dedicated.flags);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTld(hs->alarms->setting_tck, hs->dedicated.setting_tck);
 
   i = iBSP430timerMuxAlarmAdd_ni(hs, alarms+4);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+0, hs->alarms);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+1, alarms[0].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+2, alarms[1].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+3, alarms[2].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+4, alarms[3].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(NULL, alarms[4].next);
+  ASSERT_NEXT(alarms+1, alarms[0]);
+  ASSERT_NEXT(alarms+2, alarms[1]);
+  ASSERT_NEXT(alarms+3, alarms[2]);
+  ASSERT_NEXT(alarms+4, alarms[3]);
+  ASSERT_NEXT(NULL, alarms[4]);
   BSP430_UNITTEST_ASSERT_TRUE(BSP430_TIMER_ALARM_FLAG_SET & hs->dedicated.flags);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTld(hs->alarms->setting_tck, hs->dedicated.setting_tck);
 
   i = iBSP430timerMuxAlarmRemove_ni(hs, alarms+0);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+1, hs->alarms);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+2, alarms[1].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+3, alarms[2].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+4, alarms[3].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(NULL, alarms[4].next);
+  ASSERT_NEXT(alarms+2, alarms[1]);
+  ASSERT_NEXT(alarms+3, alarms[2]);
+  ASSERT_NEXT(alarms+4, alarms[3]);
+  ASSERT_NEXT(NULL, alarms[4]);
   BSP430_UNITTEST_ASSERT_TRUE(BSP430_TIMER_ALARM_FLAG_SET & hs->dedicated.flags);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTld(hs->alarms->setting_tck, hs->dedicated.setting_tck);
 
   i = iBSP430timerMuxAlarmRemove_ni(hs, alarms+2);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+1, hs->alarms);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+3, alarms[1].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+4, alarms[3].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(NULL, alarms[4].next);
+  ASSERT_NEXT(alarms+3, alarms[1]);
+  ASSERT_NEXT(alarms+4, alarms[3]);
+  ASSERT_NEXT(NULL, alarms[4]);
   BSP430_UNITTEST_ASSERT_TRUE(BSP430_TIMER_ALARM_FLAG_SET & hs->dedicated.flags);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTld(hs->alarms->setting_tck, hs->dedicated.setting_tck);
 
   i = iBSP430timerMuxAlarmRemove_ni(hs, alarms+4);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+1, hs->alarms);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+3, alarms[1].next);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(NULL, alarms[3].next);
+  ASSERT_NEXT(alarms+3, alarms[1]);
+  ASSERT_NEXT(NULL, alarms[3]);
   BSP430_UNITTEST_ASSERT_TRUE(BSP430_TIMER_ALARM_FLAG_SET & hs->dedicated.flags);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTld(hs->alarms->setting_tck, hs->dedicated.setting_tck);
 
   i = iBSP430timerMuxAlarmRemove_ni(hs, alarms+3);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTp(alarms+1, hs->alarms);
-  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(NULL, alarms[1].next);
+  ASSERT_NEXT(NULL, alarms[1]);
   BSP430_UNITTEST_ASSERT_TRUE(BSP430_TIMER_ALARM_FLAG_SET & hs->dedicated.flags);
   BSP430_UNITTEST_ASSERT_EQUAL_FMTld(hs->alarms->setting_tck, hs->dedicated.setting_tck);
 
@@ -137,6 +145,138 @@ testAddRemove (void)
   BSP430_UNITTEST_ASSERT_FALSE(BSP430_TIMER_ALARM_FLAG_SET & hs->dedicated.flags);
 }
 
+void
+testRemoveOrder (void)
+{
+  static const unsigned long settings[] = { 500, 100, 400, 100, 300, 200, 600, 250 };
+  sBSP430timerMuxSharedAlarm sd;
+  hBSP430timerMuxSharedAlarm hs;
+  sBSP430timerMuxAlarm alarms[sizeof(settings)/sizeof(*settings)];
+  unsigned long last_tck = 0;
+  int n = 0;
+  int i;
+
+  memset(alarms, 0, sizeof(alarms));
+  hs = hBSP430timerMuxAlarmStartup(&sd, BSP430_TIMER_CCACLK_PERIPH_HANDLE, 1);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(&sd, hs);
+  hs->dedicated.timer->hpl->ctl &= ~(MC0 | MC1);
+  vBSP430timerResetCounter_ni(hs->dedicated.timer);
+
+  for (i = 0; i < sizeof(alarms)/sizeof(*alarms); ++i) {
+    alarms[i].setting_tck = settings[i];
+    (void)iBSP430timerMuxAlarmAdd_ni(hs, alarms+i);
+  }
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTld(100UL, hs->alarms->setting_tck);
+
+  /* Remove alarms that are not the earliest, one of them twice */
+  i = iBSP430timerMuxAlarmRemove_ni(hs, alarms+2);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
+  i = iBSP430timerMuxAlarmRemove_ni(hs, alarms+5);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
+  i = iBSP430timerMuxAlarmRemove_ni(hs, alarms+2);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTld(100UL, hs->alarms->setting_tck);
+
+  /* Draining from the front yields the rest in order */
+  while (NULL != hs->alarms) {
+    hBSP430timerMuxAlarm ap = hs->alarms;
+    BSP430_UNITTEST_ASSERT_TRUE(last_tck <= ap->setting_tck);
+    BSP430_UNITTEST_ASSERT_EQUAL_FMTld(ap->setting_tck, hs->dedicated.setting_tck);
+    last_tck = ap->setting_tck;
+    (void)iBSP430timerMuxAlarmRemove_ni(hs, ap);
+    ++n;
+  }
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(6, n);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTld(600UL, last_tck);
+  BSP430_UNITTEST_ASSERT_FALSE(BSP430_TIMER_ALARM_FLAG_SET & hs->dedicated.flags);
+
+  (void)iBSP430timerMuxAlarmShutdown(hs);
+}
+
+typedef struct sPeriodicAlarm {
+  sBSP430timerMuxAlarm alarm;
+  unsigned int count;
+  unsigned long last_tck;
+  unsigned int overruns;
+  unsigned int stop_after;
+} sPeriodicAlarm;
+
+static int
+periodic_cb (hBSP430timerMuxSharedAlarm shared,
+             hBSP430timerMuxAlarm alarm)
+{
+  sPeriodicAlarm * pap = (sPeriodicAlarm *)alarm;
+
+  ++pap->count;
+  pap->last_tck = alarm->setting_tck;
+  pap->overruns += alarm->overruns;
+  if (pap->count == pap->stop_after) {
+    (void)iBSP430timerMuxAlarmRemove_ni(shared, alarm);
+  }
+  return 0;
+}
+
+void
+testPeriodic (void)
+{
+  sBSP430timerMuxSharedAlarm sd;
+  hBSP430timerMuxSharedAlarm hs;
+  sPeriodicAlarm pa[2];
+  int i;
+
+  memset(pa, 0, sizeof(pa));
+  hs = hBSP430timerMuxAlarmStartup(&sd, BSP430_TIMER_CCACLK_PERIPH_HANDLE, 1);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(&sd, hs);
+  hs->dedicated.timer->hpl->ctl &= ~(MC0 | MC1);
+  vBSP430timerResetCounter_ni(hs->dedicated.timer);
+
+  pa[0].alarm.callback_ni = periodic_cb;
+  pa[0].alarm.setting_tck = 100;
+  i = iBSP430timerMuxAlarmAddPeriodic_ni(hs, &pa[0].alarm, 100);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
+  pa[1].alarm.callback_ni = periodic_cb;
+  pa[1].alarm.setting_tck = 150;
+  pa[1].stop_after = 3;
+  i = iBSP430timerMuxAlarmAddPeriodic_ni(hs, &pa[1].alarm, 50);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
+
+  /* At 250 the first alarm fires for 100 and skips 200.  The second
+   * fires for 150, skips 200, and fires again for 250 in the same
+   * pass. */
+  hs->dedicated.timer->hpl->r = 250;
+  (void)hs->dedicated.callback_ni(&hs->dedicated);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(1, pa[0].count);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTld(100UL, pa[0].last_tck);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, pa[0].overruns);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(1, pa[0].alarm.overruns);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTld(300UL, pa[0].alarm.setting_tck);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(2, pa[1].count);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTld(250UL, pa[1].last_tck);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(1, pa[1].overruns);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTld(300UL, hs->alarms->setting_tck);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTld(300UL, hs->dedicated.setting_tck);
+
+  /* At 300 both fire; the second stops itself.  The overrun of the
+   * first is reported. */
+  hs->dedicated.timer->hpl->r = 300;
+  (void)hs->dedicated.callback_ni(&hs->dedicated);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(2, pa[0].count);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTld(300UL, pa[0].last_tck);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(1, pa[0].overruns);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(3, pa[1].count);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTld(0UL, pa[1].alarm.period_tck);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(&pa[0].alarm, hs->alarms);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTld(400UL, hs->alarms->setting_tck);
+
+  /* Removing a periodic alarm from outside its callback stops it */
+  i = iBSP430timerMuxAlarmRemove_ni(hs, &pa[0].alarm);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTp(NULL, hs->alarms);
+  BSP430_UNITTEST_ASSERT_FALSE(BSP430_TIMER_ALARM_FLAG_SET & hs->dedicated.flags);
+
+  (void)iBSP430timerMuxAlarmShutdown(hs);
+}
+
 void main ()
 {
   vBSP430platformInitialize_ni();
@@ -144,6 +284,8 @@ void main ()
 
   testOnOff();
   testAddRemove();
+  testRemoveOrder();
+  testPeriodic();
 
   vBSP430unittestFinalize();
 }
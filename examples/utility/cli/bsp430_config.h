@@ -8,8 +8,20 @@
 /* Support console output */
 #define configBSP430_CONSOLE 1
 
-/* Enable an 8-character rx buffer for the console */
-#define BSP430_CONSOLE_RX_BUFFER_SIZE 8
+/* Enable a 128-character rx buffer for the console, large enough to
+ * hold a full command line */
+#define BSP430_CONSOLE_RX_BUFFER_SIZE 128
+
+/* Let the console edit and echo command lines, waking the
+ * application only for complete lines and control characters.  Build
+ * with WITHOUT_RX_COOKED=1 to have the CLI edit and echo input
+ * itself. */
+#ifndef APP_RX_COOKED
+#define APP_RX_COOKED 1
+#endif /* APP_RX_COOKED */
+#if (APP_RX_COOKED - 0)
+#define configBSP430_CONSOLE_RX_COOKED 1
+#endif /* APP_RX_COOKED */
 
 /* Enable an 80-character command buffer */
 #define BSP430_CLI_CONSOLE_BUFFER_SIZE 80
@@ -21,5 +33,12 @@
 /* Monitor uptime and provide generic ACLK-driven timer */
 #define configBSP430_UPTIME 1
 
+/* Build with WITH_ISRSTATS=1 to record the duration of HAL interrupt
+ * handlers, measured in SMCLK ticks on the secondary timer. */
+#if (APP_ISRSTATS - 0)
+#define configBSP430_ISRSTATS 1
+#define configBSP430_TIMER_CCACLK 1
+#endif /* APP_ISRSTATS */
+
 /* Get platform defaults */
 #include <bsp430/platform/bsp430_config.h>
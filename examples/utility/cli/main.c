@@ -8,6 +8,7 @@
 #include <bsp430/utility/uptime.h>
 #include <bsp430/utility/console.h>
 #include <bsp430/utility/cli.h>
+#include <bsp430/utility/isrstats.h>
 #include <bsp430/utility/led.h>
 #include <bsp430/periph/pmm.h>
 #include <string.h>
@@ -204,6 +205,45 @@ static const sBSP430cliCommand dcmd_set = {
 #undef LAST_COMMAND
 #define LAST_COMMAND &dcmd_set
 
+/* A provisioning script.  In a real application this would be placed
+ * in FRAM or information memory so it can be updated independently
+ * of the code. */
+static const char provision_script[] =
+  "# Restore default values\0"
+  "set ival -1\0"
+  "set uival 0xFFFF\0"
+  "set all 1 2 3 4\0"
+  "show\0";
+
+static int
+cmd_script (const char * argstr)
+{
+  unsigned int line;
+  unsigned long t0_utt;
+  unsigned long t1_utt;
+  int rv;
+
+  t0_utt = ulBSP430uptime();
+  rv = iBSP430cliExecuteScript(commandSet, NULL, provision_script, sizeof(provision_script), &line);
+  t1_utt = ulBSP430uptime();
+  if (0 != rv) {
+    cprintf("Script failed at line %u: %d\n", line, rv);
+  } else {
+    cprintf("Script ran %u lines in %lu us\n", line,
+            BSP430_CORE_TICKS_TO_US(t1_utt - t0_utt, ulBSP430uptimeConversionFrequency_Hz()));
+  }
+  return rv;
+}
+static const sBSP430cliCommand dcmd_script = {
+  .key = "script",
+  .help = "# Run the stored provisioning script",
+  .next = LAST_COMMAND,
+  .handler = iBSP430cliHandlerSimple,
+  .param.simple_handler = cmd_script
+};
+#undef LAST_COMMAND
+#define LAST_COMMAND &dcmd_script
+
 static int
 cmd_quote (const char * argstr)
 {
@@ -398,6 +438,56 @@ static const sBSP430cliCommand dcmd_responsive = {
 #undef LAST_COMMAND
 #define LAST_COMMAND &dcmd_responsive
 
+#if (configBSP430_ISRSTATS - 0)
+static int
+cmd_isrstats (const char * argstr)
+{
+  hBSP430isrstatsVector vp;
+  sBSP430isrstatsVector stats;
+  size_t argstr_len = strlen(argstr);
+  const char * tp;
+  size_t len;
+  BSP430_CORE_SAVED_INTERRUPT_STATE(istate);
+
+  tp = xBSP430cliNextToken(&argstr, &argstr_len, &len);
+  BSP430_CORE_DISABLE_INTERRUPT();
+  vp = hBSP430isrstatsFirst_ni();
+  BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
+  if (NULL == vp) {
+    cprintf("No interrupts recorded\n");
+  }
+  while (vp) {
+    unsigned int b;
+
+    BSP430_CORE_DISABLE_INTERRUPT();
+    stats = *vp;
+    BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
+    cprintf("%s: %lu calls, max %u tick\n", stats.name, stats.count_ni, stats.max_tt);
+    for (b = 0; b < BSP430_ISRSTATS_NBUCKETS; ++b) {
+      if (0 != stats.buckets_ni[b]) {
+        cprintf("\t< %lu: %u\n", 1UL << b, stats.buckets_ni[b]);
+      }
+    }
+    vp = stats.next_ni;
+  }
+  if ((5 == len) && (0 == strncmp(tp, "reset", len))) {
+    BSP430_CORE_DISABLE_INTERRUPT();
+    vBSP430isrstatsReset_ni();
+    BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
+  }
+  return 0;
+}
+static const sBSP430cliCommand dcmd_isrstats = {
+  .key = "isrstats",
+  .help = "[reset] # Display (and clear) interrupt handler durations",
+  .next = LAST_COMMAND,
+  .handler = iBSP430cliHandlerSimple,
+  .param.simple_handler = cmd_isrstats
+};
+#undef LAST_COMMAND
+#define LAST_COMMAND &dcmd_isrstats
+#endif /* configBSP430_ISRSTATS */
+
 static int
 cmd_help (sBSP430cliCommandLink * chain,
           void * param,
@@ -424,6 +514,11 @@ void main ()
 
   vBSP430platformInitialize_ni();
   (void)iBSP430consoleInitialize();
+#if (configBSP430_CONSOLE_RX_COOKED - 0) && (APP_RX_COOKED - 0)
+  BSP430_CORE_DISABLE_INTERRUPT();
+  (void)iBSP430consoleSetRxCooked_ni(1);
+  BSP430_CORE_ENABLE_INTERRUPT();
+#endif /* configBSP430_CONSOLE_RX_COOKED */
   vBSP430cliSetDiagnosticFunction(iBSP430cliConsoleDiagnostic);
   cprintf("\ncli example " __DATE__ " " __TIME__ "\n");
 #if (configBSP430_CLI_COMMAND_COMPLETION - 0)
@@ -456,6 +551,21 @@ void main ()
     }
   }
 
+#if (configBSP430_ISRSTATS - 0)
+  {
+    volatile sBSP430hplTIMER * const hrt = xBSP430hplLookupTIMER(BSP430_TIMER_CCACLK_PERIPH_HANDLE);
+
+    if (NULL == hrt) {
+      cprintf("No timer available for interrupt statistics\n");
+    } else {
+      hrt->ctl = TASSEL_2 | MC_2 | TACLR;
+      BSP430_CORE_DISABLE_INTERRUPT();
+      vBSP430isrstatsInitialize_ni(&hrt->r);
+      BSP430_CORE_ENABLE_INTERRUPT();
+    }
+  }
+#endif /* configBSP430_ISRSTATS */
+
   vBSP430ledSet(0, 1);
   cprintf("\nLED lit when not awaiting input\n");
 
@@ -18,5 +18,8 @@
 #define configBSP430_CLI_COMMAND_COMPLETION 1
 #define configBSP430_CLI_COMMAND_COMPLETION_HELPER 1
 
+/* Support sorted command tables */
+#define configBSP430_CLI_COMMAND_INDEX 1
+
 /* Get platform defaults */
 #include <bsp430/platform/bsp430_config.h>
@@ -0,0 +1,31 @@
+/* Generated by maintainer/clitable.py from commands.cli.  Do not edit. */
+
+static const sBSP430cliCommand indexed_commands_complete[] = {
+  { .key = "common",
+    .next = indexed_commands_complete + 1,
+    .handler = iBSP430cliHandlerSimple,
+    .param.simple_handler = cmd_dummy,
+    BSP430_CLI_COMMAND_INDEXED_COUNT(2)
+  },
+  { .key = "component",
+    .handler = iBSP430cliHandlerSimple,
+    .param.simple_handler = cmd_dummy
+  },
+};
+
+static const sBSP430cliCommand indexed_commands[] = {
+  { .key = "complete",
+    .child = indexed_commands_complete,
+    .next = indexed_commands + 1,
+    BSP430_CLI_COMMAND_INDEXED_COUNT(3)
+  },
+  { .key = "other",
+    .next = indexed_commands + 2,
+    .handler = iBSP430cliHandlerSimple,
+    .param.simple_handler = cmd_dummy
+  },
+  { .key = "say",
+    .handler = iBSP430cliHandlerSimple,
+    .param.simple_handler = cmd_dummy, .completion_helper = &completion_helper_say.completion_helper
+  },
+};
@@ -96,6 +96,262 @@ testNextQToken (void)
 #undef SET_INPUT
 }
 
+void
+testTokenize (void)
+{
+  static const char * const inputs[] = {
+    "", "   ", "one", "  one two ", "'one two'", "'one two", "''",
+    "'one'x two", "a \"b c\" 'd' e'f' \"g",
+  };
+  sBSP430cliToken tokens[BSP430_CLI_ARGV_MAX];
+  const char * command;
+  int ntokens;
+  size_t ii;
+
+  /* Tokens must match what xBSP430cliNextQToken() finds */
+  for (ii = 0; ii < sizeof(inputs)/sizeof(*inputs); ++ii) {
+    const char * mcommand = inputs[ii];
+    size_t remaining = strlen(mcommand);
+    int ti;
+
+    ntokens = iBSP430cliTokenize(mcommand, remaining, tokens, sizeof(tokens)/sizeof(*tokens));
+    BSP430_UNITTEST_ASSERT_TRUE(0 <= ntokens);
+    for (ti = 0; ti <= ntokens; ++ti) {
+      const char * tp;
+      size_t len;
+
+      tp = xBSP430cliNextQToken(&mcommand, &remaining, &len);
+      if (ti == ntokens) {
+        BSP430_UNITTEST_ASSERT_EQUAL_FMTu(0, len);
+        break;
+      }
+      BSP430_UNITTEST_ASSERT_EQUAL_FMTp(tp, tokens[ti].text);
+      BSP430_UNITTEST_ASSERT_EQUAL_FMTu(len, tokens[ti].len);
+      BSP430_UNITTEST_ASSERT_EQUAL_FMTd(tp != mcommand - len, tokens[ti].quoted);
+    }
+  }
+
+  command = "a \"b c\" 'd' e'f' \"g";
+  ntokens = iBSP430cliTokenize(command, strlen(command), tokens, sizeof(tokens)/sizeof(*tokens));
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(5, ntokens);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTu(3, tokens[1].len);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(1, tokens[1].quoted);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(1, tokens[2].quoted);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, tokens[3].quoted);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTu(4, tokens[3].len);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, tokens[4].quoted);
+
+  /* Too many tokens is an error */
+  ntokens = iBSP430cliTokenize(command, strlen(command), tokens, 4);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, ntokens);
+
+  /* A NUL ends the input */
+  ntokens = iBSP430cliTokenize("a b", 4, tokens, sizeof(tokens)/sizeof(*tokens));
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(2, ntokens);
+}
+
+void
+testTokenAs (void)
+{
+  sBSP430cliToken token;
+  int i;
+  unsigned int ui;
+  long l;
+  unsigned long ul;
+  int rv;
+
+#define SET_TOKEN(str_) do {                    \
+    token.text = str_;                          \
+    token.len = strlen(str_);                   \
+    token.quoted = 0;                           \
+  } while (0)
+
+  SET_TOKEN("");
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Missing, iBSP430cliTokenAsI(&token, &i));
+  SET_TOKEN("-");
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, iBSP430cliTokenAsI(&token, &i));
+  SET_TOKEN("0x");
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, iBSP430cliTokenAsI(&token, &i));
+  SET_TOKEN("12a");
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, iBSP430cliTokenAsI(&token, &i));
+  SET_TOKEN("08");
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, iBSP430cliTokenAsI(&token, &i));
+
+  SET_TOKEN("0");
+  rv = iBSP430cliTokenAsI(&token, &i);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, i);
+  SET_TOKEN("-32768");
+  rv = iBSP430cliTokenAsI(&token, &i);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-32768, i);
+  SET_TOKEN("32768");
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, iBSP430cliTokenAsI(&token, &i));
+  SET_TOKEN("-0x10");
+  rv = iBSP430cliTokenAsI(&token, &i);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-16, i);
+
+  SET_TOKEN("0177777");
+  rv = iBSP430cliTokenAsUI(&token, &ui);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTu(0xFFFF, ui);
+  SET_TOKEN("0x10000");
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, iBSP430cliTokenAsUI(&token, &ui));
+  SET_TOKEN("-1");
+  rv = iBSP430cliTokenAsUI(&token, &ui);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTu(0xFFFF, ui);
+
+  SET_TOKEN("-2147483648");
+  rv = iBSP430cliTokenAsL(&token, &l);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTld(-2147483647L - 1, l);
+  SET_TOKEN("2147483648");
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, iBSP430cliTokenAsL(&token, &l));
+
+  SET_TOKEN("0xFfFfFfFf");
+  rv = iBSP430cliTokenAsUL(&token, &ul);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTlx(0xFFFFFFFFUL, ul);
+  SET_TOKEN("4294967296");
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, iBSP430cliTokenAsUL(&token, &ul));
+
+  /* Conversion stops at the end of the span, not at a NUL */
+  token.text = "1234";
+  token.len = 2;
+  rv = iBSP430cliTokenAsI(&token, &i);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(12, i);
+
+#undef SET_TOKEN
+}
+
+static int argv_argc;
+static unsigned long argv_sum;
+
+static int
+argv_sum_handler (sBSP430cliCommandLink * chain,
+                  int argc,
+                  const sBSP430cliToken * argv)
+{
+  int i;
+
+  argv_argc = argc;
+  argv_sum = 0;
+  for (i = 0; i < argc; ++i) {
+    unsigned long v;
+    int rv = iBSP430cliTokenAsUL(argv + i, &v);
+
+    if (0 != rv) {
+      return rv;
+    }
+    argv_sum += v;
+  }
+  return 0;
+}
+
+static const sBSP430cliCommand dcmd_sum = {
+  .key = "sum",
+  .handler = iBSP430cliHandlerArgv,
+  .param.argv_handler = argv_sum_handler,
+};
+
+void
+testHandlerArgv (void)
+{
+  int rv;
+
+  rv = iBSP430cliExecuteCommand(&dcmd_sum, 0, "sum 1 0x10 010");
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(3, argv_argc);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTlu(25UL, argv_sum);
+  rv = iBSP430cliExecuteCommand(&dcmd_sum, 0, "sum");
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, argv_argc);
+  rv = iBSP430cliExecuteCommand(&dcmd_sum, 0, "sum 1 x");
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, rv);
+  rv = iBSP430cliExecuteCommand(&dcmd_sum, 0, "sum 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17");
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, rv);
+}
+
+typedef struct sScriptSource {
+  const char * text;
+  size_t remaining;
+} sScriptSource;
+
+static int
+script_read (void * context,
+             char * dst,
+             size_t len)
+{
+  sScriptSource * sp = (sScriptSource *)context;
+
+  /* Deliver in small pieces to exercise refill */
+  if (3 < len) {
+    len = 3;
+  }
+  if (sp->remaining < len) {
+    len = sp->remaining;
+  }
+  memcpy(dst, sp->text, len);
+  sp->text += len;
+  sp->remaining -= len;
+  return len;
+}
+
+void
+testExecuteScript (void)
+{
+  static const char script[] = "sum 1 2\0  \0# sum 9\0sum 3\0\0sum 99\0";
+  static const char bad_script[] = "sum 1\0sum x\0sum 2\0";
+  static const char erased_script[] = "sum 5\0\xffsum 6\0";
+  sScriptSource source;
+  char buffer[8];
+  unsigned int line;
+  int rv;
+
+  rv = iBSP430cliExecuteScript(&dcmd_sum, 0, script, sizeof(script), &line);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTu(4, line);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTlu(3UL, argv_sum);
+
+  rv = iBSP430cliExecuteScript(&dcmd_sum, 0, bad_script, sizeof(bad_script), &line);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTu(2, line);
+
+  /* Final command must be terminated */
+  rv = iBSP430cliExecuteScript(&dcmd_sum, 0, bad_script, 8, &line);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTu(2, line);
+
+  rv = iBSP430cliExecuteScript(&dcmd_sum, 0, erased_script, sizeof(erased_script), &line);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTu(1, line);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTlu(5UL, argv_sum);
+
+  source.text = script;
+  source.remaining = sizeof(script);
+  rv = iBSP430cliExecuteScriptStream(&dcmd_sum, 0, script_read, &source, buffer, sizeof(buffer), &line);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTu(4, line);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTlu(3UL, argv_sum);
+
+  source.text = bad_script;
+  source.remaining = sizeof(bad_script);
+  rv = iBSP430cliExecuteScriptStream(&dcmd_sum, 0, script_read, &source, buffer, sizeof(buffer), &line);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTu(2, line);
+
+  /* Command too long for the buffer */
+  source.text = "sum 1\0sum 1 2 3\0";
+  source.remaining = 18;
+  rv = iBSP430cliExecuteScriptStream(&dcmd_sum, 0, script_read, &source, buffer, sizeof(buffer), &line);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTd(-eBSP430_CLI_ERR_Invalid, rv);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTu(2, line);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTlu(1UL, argv_sum);
+}
+
 void
 testConsoleBufferExtend (void)
 {
@@ -180,6 +436,9 @@ static const sBSP430cliCommand dcmd_say = {
 #undef LAST_COMMAND
 #define LAST_COMMAND (&dcmd_say)
 
+/* The same command set as a sorted table */
+#include "commands.h"
+
 void
 testCommandCompletion (void)
 {
@@ -269,6 +528,75 @@ testCommandCompletion (void)
   BSP430_UNITTEST_ASSERT_EQUAL_FMTu(3, ccd.append_len);
 }
 
+static int
+candidateIn (const char * candidate,
+             const sBSP430cliCompletionData * cdp)
+{
+  size_t ci;
+
+  for (ci = 0; ci < cdp->ncandidates; ++ci) {
+    if (0 == strcmp(candidate, cdp->returned_candidates[ci])) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+void
+testIndexedCommands (void)
+{
+  static const char * const inputs[] = {
+    "", "c", "co", "complete", "complete ", "complete com", "complete comp",
+    "complete x", "o", "other", "other ", "s", "say ", "say t", "say th",
+    "x", "completely",
+  };
+  const char * lcands[5];
+  const char * icands[5];
+  sBSP430cliCompletionData lccd;
+  sBSP430cliCompletionData iccd;
+  size_t ii;
+
+#if (configBSP430_CLI_COMMAND_INDEX - 0)
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTu(3, indexed_commands[0].indexed_count);
+  BSP430_UNITTEST_ASSERT_EQUAL_FMTu(2, indexed_commands_complete[0].indexed_count);
+#endif /* configBSP430_CLI_COMMAND_INDEX */
+  for (ii = 0; ii < sizeof(inputs)/sizeof(*inputs); ++ii) {
+    const char * input = inputs[ii];
+    const sBSP430cliCommand * lmatch;
+    const sBSP430cliCommand * imatch;
+    int lflags;
+    int iflags;
+    size_t ci;
+
+    lmatch = imatch = NULL;
+    BSP430_UNITTEST_ASSERT_EQUAL_FMTd(iBSP430cliMatchCommand(LAST_COMMAND, input, strlen(input), &lmatch, 0, 0, 0),
+                                      iBSP430cliMatchCommand(indexed_commands, input, strlen(input), &imatch, 0, 0, 0));
+    BSP430_UNITTEST_ASSERT_EQUAL_FMTd(NULL == lmatch, NULL == imatch);
+    if ((NULL != lmatch) && (NULL != imatch)) {
+      BSP430_UNITTEST_ASSERT_EQUAL_ASCIIZ(lmatch->key, imatch->key);
+    }
+
+    lccd.command_set = LAST_COMMAND;
+    iccd.command_set = indexed_commands;
+    lccd.command = iccd.command = input;
+    lccd.returned_candidates = lcands;
+    iccd.returned_candidates = icands;
+    lccd.max_returned_candidates = iccd.max_returned_candidates = sizeof(lcands)/sizeof(*lcands);
+    lflags = iBSP430cliCommandCompletion(&lccd);
+    iflags = iBSP430cliCommandCompletion(&iccd);
+    BSP430_UNITTEST_ASSERT_EQUAL_FMTd(lflags, iflags);
+    BSP430_UNITTEST_ASSERT_EQUAL_FMTu(lccd.ncandidates, iccd.ncandidates);
+    BSP430_UNITTEST_ASSERT_EQUAL_FMTu(lccd.append_len, iccd.append_len);
+    BSP430_UNITTEST_ASSERT_EQUAL_FMTd(NULL == lccd.append, NULL == iccd.append);
+    if (NULL != lccd.append) {
+      BSP430_UNITTEST_ASSERT_EQUAL_FMTd(0, strncmp(lccd.append, iccd.append, lccd.append_len));
+    }
+    for (ci = 0; ci < lccd.ncandidates; ++ci) {
+      BSP430_UNITTEST_ASSERT_TRUE(candidateIn(lcands[ci], &iccd));
+    }
+  }
+}
+
 void
 testHelperStringsExtract (void)
 {
@@ -309,8 +637,13 @@ void main (void)
 
   testNextToken();
   testNextQToken();
+  testTokenize();
+  testTokenAs();
+  testHandlerArgv();
+  testExecuteScript();
   testConsoleBufferExtend();
   testCommandCompletion();
+  testIndexedCommands();
   testHelperStringsExtract();
 
   vBSP430unittestFinalize();
@@ -0,0 +1,93 @@
+/** This file is in the public domain.
+ *
+ * Demonstrate the event loop.  A periodic timed event blinks an LED,
+ * another reports status every five seconds, and console input is
+ * handled by a work item posted from the receive interrupt.  Between
+ * events the MCU sleeps; the status line shows how many times it
+ * slept and how many alarm periods were missed.
+ *
+ * @homepage http://github.com/pabigot/bsp430
+ *
+ */
+
+#include <bsp430/platform.h>
+#include <bsp430/utility/uptime.h>
+#include <bsp430/utility/console.h>
+#include <bsp430/utility/led.h>
+#include <bsp430/utility/evloop.h>
+
+static sBSP430evloopTimer blink;
+static sBSP430evloopTimer status;
+static sBSP430evloopWork input;
+static unsigned long sleeps;
+static unsigned long overruns;
+
+static void
+blink_handler (hBSP430evloopWork work)
+{
+  hBSP430evloopTimer tp = (hBSP430evloopTimer)work;
+
+  overruns += tp->alarm.overruns;
+  vBSP430ledSet(0, -1);
+}
+
+static void
+status_handler (hBSP430evloopWork work)
+{
+  char as_text[BSP430_UPTIME_AS_TEXT_LENGTH];
+
+  cprintf("%s: %lu sleeps, %lu missed blinks\n",
+          xBSP430uptimeAsText(ulBSP430uptime(), as_text), sleeps, overruns);
+}
+
+static void
+input_handler (hBSP430evloopWork work)
+{
+  int c;
+
+  cprintf("input '");
+  while (0 <= ((c = cgetchar()))) {
+    cputchar(c);
+  }
+  cprintf("'\n");
+}
+
+static int
+console_rx_ni (void)
+{
+  return iBSP430evloopPost(&input);
+}
+
+static unsigned int
+idle_hook_ni (unsigned int lpm_bits)
+{
+  ++sleeps;
+  return lpm_bits;
+}
+
+void main ()
+{
+  unsigned long now_utt;
+
+  vBSP430platformInitialize_ni();
+  (void)iBSP430consoleInitialize();
+  cprintf("\nevloop " __DATE__ " " __TIME__ "\n");
+  if (0 != iBSP430evloopInitialize()) {
+    cprintf("Event loop initialization failed\n");
+    return;
+  }
+
+  (void)hBSP430evloopTimerInitialize(&blink, blink_handler);
+  (void)hBSP430evloopTimerInitialize(&status, status_handler);
+  (void)hBSP430evloopWorkInitialize(&input, input_handler);
+
+  BSP430_CORE_DISABLE_INTERRUPT();
+  (void)xBSP430evloopSetIdleHook_ni(idle_hook_ni);
+  vBSP430consoleSetRxCallback_ni(console_rx_ni);
+  now_utt = ulBSP430uptime_ni();
+  (void)iBSP430evloopTimerSchedule_ni(&blink, now_utt, BSP430_UPTIME_MS_TO_UTT(500));
+  (void)iBSP430evloopTimerSchedule_ni(&status, now_utt, BSP430_UPTIME_MS_TO_UTT(5000));
+  BSP430_CORE_ENABLE_INTERRUPT();
+
+  vBSP430evloopRun();
+}
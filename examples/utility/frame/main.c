@@ -0,0 +1,80 @@
+/** This file is in the public domain.
+ *
+ * Demonstrate framed channels over the console UART.  Once a second
+ * the application emits a line of text, and sends the uptime counter
+ * as a binary frame on channel 2.  Frames received on channel 1 are
+ * returned on channel 1.  Run maintainer/framedemux.py against the
+ * UART to see the text and channels on separate pseudo-terminals.
+ *
+ * @homepage http://github.com/pabigot/bsp430
+ *
+ */
+
+#include <bsp430/platform.h>
+#include <bsp430/utility/uptime.h>
+#include <bsp430/utility/console.h>
+#include <bsp430/utility/frame.h>
+#include <string.h>
+
+#define CHANNEL_ECHO 1
+#define CHANNEL_UPTIME 2
+
+static uint8_t echo_data[BSP430_FRAME_RX_PAYLOAD_MAX];
+static volatile size_t echo_len;
+static volatile int echo_ready;
+
+static int
+echo_rx_ni (unsigned int channel,
+            const uint8_t * data,
+            size_t len)
+{
+  /* Keep the first frame until the main loop has returned it */
+  if (echo_ready) {
+    return 0;
+  }
+  memcpy(echo_data, data, len);
+  echo_len = len;
+  echo_ready = 1;
+  return BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
+}
+
+void main ()
+{
+  unsigned long wake_utt;
+  unsigned int iters = 0;
+
+  vBSP430platformInitialize_ni();
+  (void)iBSP430consoleInitialize();
+  (void)iBSP430frameInitialize();
+  BSP430_CORE_DISABLE_INTERRUPT();
+  (void)iBSP430frameSetRxCallback_ni(CHANNEL_ECHO, echo_rx_ni);
+  BSP430_CORE_ENABLE_INTERRUPT();
+
+  cprintf("\nframe " __DATE__ " " __TIME__ "\n");
+  wake_utt = ulBSP430uptime_ni();
+  while (1) {
+    long rem;
+    int rc;
+
+    rem = lBSP430uptimeSleepUntil(wake_utt, LPM1_bits);
+    if (echo_ready) {
+      (void)iBSP430frameTransmit(CHANNEL_ECHO, echo_data, echo_len);
+      echo_ready = 0;
+    }
+    rc = cgetchar();
+    if (0 <= rc) {
+      cprintf("input '");
+      do {
+        cputchar(rc);
+      } while (0 <= ((rc = cgetchar())));
+      cprintf("'\n");
+    }
+    if (0 >= rem) {
+      unsigned long now_utt = ulBSP430uptime();
+
+      cprintf("%u: %s, %lu frame errors\n", iters++, xBSP430uptimeAsText_ni(now_utt), ulBSP430frameRxErrors_ni(0));
+      (void)iBSP430frameTransmit(CHANNEL_UPTIME, (const uint8_t *)&now_utt, sizeof(now_utt));
+      wake_utt += BSP430_UPTIME_MS_TO_UTT(1000);
+    }
+  }
+}
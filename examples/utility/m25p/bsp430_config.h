@@ -14,6 +14,10 @@
 /* Request the SPI flash */
 #define configBSP430_PLATFORM_M25P 1
 
+/* Use the secondary timer on SMCLK to count cycles spent in SPI
+ * transfers */
+#define configBSP430_TIMER_CCACLK 1
+
 /* For external M25P-compatible chips */
 #if (BSP430_PLATFORM_EXP430F5529LP - 0)
 /* SPI on USCI_A0, CSn on P6.6, PWR and RSTn hard-wired */
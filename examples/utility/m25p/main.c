@@ -9,6 +9,7 @@
 
 #include <bsp430/platform.h>
 #include <bsp430/clock.h>
+#include <bsp430/periph/timer.h>
 #include <bsp430/utility/uptime.h>
 #include <bsp430/utility/console.h>
 #include <bsp430/utility/m25p.h>
@@ -87,6 +88,51 @@ int writeToAddress (hBSP430m25p m25p,
   return rc;
 }
 
+/* Count SMCLK cycles to transmit a page of data with the responses
+ * kept, which waits for each octet to complete before sending the
+ * next, and discarded, which keeps the transmit buffer full.  CSn is
+ * not asserted, so the flash ignores the traffic.  The timer is
+ * returned to its previous configuration afterwards. */
+void benchmarkPageTransmit (hBSP430m25p m25p)
+{
+  volatile sBSP430hplTIMER * const hrt = xBSP430hplLookupTIMER(BSP430_TIMER_CCACLK_PERIPH_HANDLE);
+  BSP430_CORE_INTERRUPT_STATE_T istate;
+  unsigned long smclk_hz;
+  unsigned int ctl;
+  unsigned int overhead;
+  unsigned int t0;
+  unsigned int t1;
+  unsigned int t2;
+  int rc0;
+  int rc1;
+
+  if (NULL == hrt) {
+    cprintf("High-resolution timer not available\n");
+    return;
+  }
+  BSP430_CORE_SAVE_INTERRUPT_STATE(istate);
+  BSP430_CORE_DISABLE_INTERRUPT();
+  ctl = hrt->ctl;
+  hrt->ctl = 0;
+  hrt->ctl = TASSEL_2 | MC_2;
+  smclk_hz = ulBSP430timerFrequency_Hz_ni(BSP430_TIMER_CCACLK_PERIPH_HANDLE);
+  t0 = uiBSP430timerSyncCounterRead_ni(hrt);
+  t1 = uiBSP430timerSyncCounterRead_ni(hrt);
+  overhead = t1 - t0;
+  t0 = uiBSP430timerSyncCounterRead_ni(hrt);
+  rc0 = iBSP430spiTxRx_rh(m25p->spi, buffer, sizeof(buffer), 0, buffer);
+  t1 = uiBSP430timerSyncCounterRead_ni(hrt);
+  rc1 = iBSP430spiTxRx_rh(m25p->spi, buffer, sizeof(buffer), 0, NULL);
+  t2 = uiBSP430timerSyncCounterRead_ni(hrt);
+  hrt->ctl = 0;
+  hrt->ctl = ctl;
+  BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
+  cprintf("SMCLK at %lu Hz, SPI prescaler 1, timing overhead %u cycles\n",
+          smclk_hz, overhead);
+  cprintf("Transmit %d octets keeping responses: %u cycles\n", rc0, t1 - t0 - overhead);
+  cprintf("Transmit %d octets discarding responses: %u cycles\n", rc1, t2 - t1 - overhead);
+}
+
 void main ()
 {
   int rc;
@@ -208,6 +254,8 @@ void main ()
 #endif /* BSP430_PLATFORM_M25P_SUBSECTOR_SIZE */
   cprintf("RDID identified %lu bytes total capacity\n", 0x1UL << buffer[2]);
 
+  benchmarkPageTransmit(m25p);
+
   addr = 0;
 
   rc = readFromAddress(m25p, addr, sizeof(flashContents));
@@ -10,7 +10,7 @@
 
 /* Support buffered console output and input */
 #define configBSP430_CONSOLE 1
-#define BSP430_CONSOLE_TX_BUFFER_SIZE 80
+#define BSP430_CONSOLE_TX_BUFFER_SIZE 64
 #define BSP430_CONSOLE_RX_BUFFER_SIZE 16
 
 /* Enable the uptime infrastructure, including its delay capabilities on CCIDX 1. */
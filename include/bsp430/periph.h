@@ -84,6 +84,7 @@
 
 #include <bsp430/core.h>
 #include <msp430.h>
+#include <bsp430/utility/isrstats.h>
 
 /** An integral type used to uniquely identify a raw MCU peripheral.
  *
@@ -234,9 +234,12 @@
  * alarm cancellation failed, e.g. due to it having already gone off.
  *
  * When the alarm fires, the callback registered in
- * sBSP430timerAlarm::callback_ni is invoked.  The callback may invoke
- * iBSP430timerAlarmSet_ni() to reschedule a periodic alarm, but
- * complex processing should not be done.  The callback should instead
+ * sBSP430timerAlarm::callback_ni is invoked.  Periodic alarms should
+ * be set with iBSP430timerAlarmSetPeriodic_ni(), which re-arms the
+ * alarm from its previous scheduled time so that the period does not
+ * drift with interrupt latency.  The callback may instead invoke
+ * iBSP430timerAlarmSet_ni() to reschedule the alarm, but complex
+ * processing should not be done.  The callback should instead
  * set a volatile global variable and return a value such as
  * #BSP430_HAL_ISR_CALLBACK_EXIT_LPM.  See
  * #iBSP430timerAlarmCallback_ni.
@@ -1145,8 +1148,9 @@ typedef struct sBSP430halTIMER {
    *
    * @note This field is not marked volatile because doing so costs
    * several extra instructions due to it being a multi-word value.
-   * It should be read and written only when interrupts are
-   * disabled. */
+   * It should be read and written only when interrupts are disabled,
+   * except by ullBSP430timerCounter() which validates what it
+   * reads. */
   unsigned long overflow_count;
 
   /** The callback chain to invoke when an overflow interrupt is
@@ -1288,6 +1292,30 @@ ulBSP430timerCounter (hBSP430halTIMER timer,
   return rv;
 }
 
+/** Read the timer counter without disabling interrupts.
+ *
+ * The overflow counter and the hardware counter are read, then the
+ * overflow counter is read again; if it changed an overflow
+ * interrupt intervened and the read is retried.  The result is
+ * therefore consistent regardless of when the overflow interrupt is
+ * taken, and successive reads never decrease.  This may be invoked
+ * from any context, including interrupt handlers and code running
+ * with interrupts enabled, and does not affect the interrupt state.
+ * As with ulBSP430timerCounter_ni() a pending overflow that has not
+ * yet been handled is taken into account.
+ *
+ * @warning The overflow interrupt handler must not be interrupted
+ * between reading the timer's IV register and incrementing
+ * sBSP430halTIMER::overflow_count, as is the case for the BSP430
+ * timer ISRs.  See also the warnings at ulBSP430timerCounter_ni().
+ *
+ * @param timer The timer for which the count is desired.
+ *
+ * @return The number of clock ticks observed since the timer was
+ * last reset.  Only the low 48 bits are significant, since
+ * sBSP430halTIMER::overflow_count holds 32 bits. */
+unsigned long long ullBSP430timerCounter (hBSP430halTIMER timer);
+
 /** Read a timer capture register.
  *
  * Capture/compare registers may be set to record the time of an
@@ -1414,6 +1442,25 @@ typedef struct sBSP430timerAlarm {
    * must not be manipulated by user code. */
   unsigned long setting_tck;
 
+  /** The interval between events of a periodic alarm, or zero for an
+   * alarm that fires once.  When the callback of a periodic alarm
+   * returns, the alarm is set again @a period_tck ticks after @a
+   * setting_tck unless the callback cancelled or set the alarm
+   * itself.
+   *
+   * @note This field is maintained by iBSP430timerAlarmSetPeriodic_ni()
+   * and must not be manipulated by user code. */
+  unsigned long period_tck;
+
+  /** The number of events of a periodic alarm that were skipped
+   * immediately before the one being delivered, because the time at
+   * which they were due had already passed when the alarm was re-armed.
+   * This may be inspected by the callback.
+   *
+   * @note This field is maintained by the infrastructure and must not
+   * be manipulated by user code. */
+  unsigned int overruns;
+
   /** The function invoked by the infrastructure when the alarm goes
    * off.  If this is a null pointer, the infrastructure will act as
    * though it was a function that did nothing but return
@@ -1644,6 +1691,43 @@ int iBSP430timerAlarmSet_ni (hBSP430timerAlarm alarm,
 int iBSP430timerAlarmSetForced_ni (hBSP430timerAlarm alarm,
                                    unsigned long setting_tck);
 
+/** Set the alarm to go off periodically.
+ *
+ * The alarm goes off first at @p setting_tck, and thereafter every @p
+ * period_tck ticks.  Each subsequent event is scheduled from the time
+ * at which the previous event was due, not from the time at which its
+ * callback ran, so latency does not accumulate.  If an event cannot
+ * be delivered before the next one is due (e.g. because interrupts
+ * were disabled for more than a period) the missed events are skipped
+ * and their number is recorded in sBSP430timerAlarm::overruns for the
+ * callback of the next delivered event.
+ *
+ * The alarm continues until it is cancelled with
+ * iBSP430timerAlarmCancel_ni() or disabled, either of which may be
+ * done from within the callback.  A callback that invokes
+ * iBSP430timerAlarmSet_ni() converts the alarm to a one-shot alarm at
+ * the new time.
+ *
+ * As with iBSP430timerAlarmSetForced_ni() the first event is
+ * delivered as soon as possible if @p setting_tck is too near or has
+ * already passed.
+ *
+ * @param alarm a pointer to an alarm structure initialized using
+ * iBSP430timerAlarmInitialize().
+ *
+ * @param setting_tck the time at which the alarm should first go off.
+ *
+ * @param period_tck the interval between alarm events.  This should
+ * be larger than the time required to process the event.  A value of
+ * zero produces a one-shot alarm.
+ *
+ * @return as with iBSP430timerAlarmSetForced_ni().
+ *
+ * @ingroup grp_timer_alarm */
+int iBSP430timerAlarmSetPeriodic_ni (hBSP430timerAlarm alarm,
+                                     unsigned long setting_tck,
+                                     unsigned long period_tck);
+
 /** Wrapper to invoke iBSP430timerAlarmSet_ni() when interrupts are
  * enabled.
  *
@@ -1661,11 +1745,31 @@ int iBSP430timerAlarmSet (hBSP430timerAlarm alarm,
   return rv;
 }
 
+/** Wrapper to invoke iBSP430timerAlarmSetPeriodic_ni() when
+ * interrupts are enabled.
+ *
+ * @ingroup grp_timer_alarm */
+static BSP430_CORE_INLINE
+int iBSP430timerAlarmSetPeriodic (hBSP430timerAlarm alarm,
+                                  unsigned long setting_tck,
+                                  unsigned long period_tck)
+{
+  BSP430_CORE_SAVED_INTERRUPT_STATE(istate);
+  int rv;
+
+  BSP430_CORE_DISABLE_INTERRUPT();
+  rv = iBSP430timerAlarmSetPeriodic_ni(alarm, setting_tck, period_tck);
+  BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
+  return rv;
+}
+
 /** Cancel a scheduled alarm event.
  *
  * This disconnects the scheduled alarm and inhibits any pending alarm
  * from being executed.  It may be executed from user code or from
- * within an alarm callback or other interrupt handler.
+ * within an alarm callback or other interrupt handler.  A periodic
+ * alarm is stopped, including when this is invoked from its own
+ * callback.
  *
  * @param alarm a pointer to an alarm structure initialized using
  * iBSP430timerAlarmInitialize().
@@ -1695,6 +1799,31 @@ int iBSP430timerAlarmCancel (hBSP430timerAlarm alarm)
   return rv;
 }
 
+/** Select the data structure holding multiplexed alarms.
+ *
+ * By default the alarms associated with a sBSP430timerMuxSharedAlarm
+ * are kept in a singly-linked list sorted by due time.  Adding an
+ * alarm walks the list with interrupts disabled, so with many active
+ * alarms iBSP430timerMuxAlarmAdd_ni() becomes a significant source of
+ * interrupt latency.
+ *
+ * Define this to a true value to hold the alarms in a pairing heap
+ * instead.  Adding an alarm is then constant time; removing the
+ * earliest alarm (when it fires) or an arbitrary alarm takes
+ * amortized logarithmic time.  The cost is two additional pointers in
+ * each sBSP430timerMuxAlarm, and alarms with identical due times are
+ * no longer guaranteed to fire in the order they were added.
+ *
+ * In either case sBSP430timerMuxSharedAlarm::alarms refers to the
+ * earliest pending alarm.
+ *
+ * @cppflag
+ * @ingroup grp_timer_alarm
+ * @defaulted */
+#ifndef configBSP430_TIMER_MUX_ALARM_HEAP
+#define configBSP430_TIMER_MUX_ALARM_HEAP 0
+#endif /* configBSP430_TIMER_MUX_ALARM_HEAP */
+
 /* Forward declaration */
 struct sBSP430timerMuxAlarm;
 
@@ -1708,10 +1837,24 @@ struct sBSP430timerMuxSharedAlarm;
  * has been reached.  When this is invoked @p alarm has been removed
  * from the list of alarms associated with @p shared.
  *
- * It is permitted to invoke iBSP430timerMuxAlarmSet_ni() from this
+ * It is permitted to invoke iBSP430timerMuxAlarmAdd_ni() from this
  * callback to re-associate @p alarm with @p shared.  Prior to doing
  * this the @p alarm->setting_tck value should be updated.
  *
+ * If @p alarm was added with iBSP430timerMuxAlarmAddPeriodic_ni() it
+ * is re-associated with @p shared automatically when the callback
+ * returns, and the callback must not add it again.  The callback may
+ * change @link sBSP430timerMuxAlarm::period_tck alarm->period_tck@endlink,
+ * or stop the alarm by setting that field to zero or by invoking
+ * iBSP430timerMuxAlarmRemove_ni().
+ *
+ * All alarms that are due when the shared alarm fires, and those
+ * that become due while their callbacks run (including periodic
+ * alarms due again), are processed in a single interrupt.  Alarms
+ * that come due while that second group is processed are left to a
+ * further interrupt, so that callbacks taking longer than their
+ * period cannot hold the interrupt handler indefinitely.
+ *
  * @ingroup grp_timer_alarm
  */
 typedef int (* iBSP430timerMuxAlarmCallback_ni) (struct sBSP430timerMuxSharedAlarm * shared,
@@ -1729,8 +1872,11 @@ typedef struct sBSP430timerMuxSharedAlarm {
    * code.  */
   sBSP430timerAlarm dedicated;
 
-  /** The active multiplexed alarms, sorted by time with earliest
-   * wakeup first. */
+  /** The active multiplexed alarms.  This is the alarm with the
+   * earliest wakeup.  Normally it heads a list sorted by time; when
+   * #configBSP430_TIMER_MUX_ALARM_HEAP is enabled it is the root of
+   * a heap and the remaining alarms are reached through
+   * sBSP430timerMuxAlarm::child. */
   struct sBSP430timerMuxAlarm * alarms;
 } sBSP430timerMuxSharedAlarm;
 
@@ -1756,11 +1902,41 @@ typedef struct sBSP430timerMuxAlarm {
   /** The callback to be invoked when the alarm goes off. */
   iBSP430timerMuxAlarmCallback_ni callback_ni;
 
-  /** A link to the next alarm in a chain.
+  /** The interval between events of a periodic alarm, or zero for an
+   * alarm that fires once.
+   *
+   * The value is set by iBSP430timerMuxAlarmAdd_ni() and
+   * iBSP430timerMuxAlarmAddPeriodic_ni().  It may be changed by the
+   * alarm callback; see #iBSP430timerMuxAlarmCallback_ni. */
+  unsigned long period_tck;
+
+  /** The number of events of a periodic alarm that were skipped
+   * immediately before the one being delivered, because the time at
+   * which they were due had already passed when the alarm was
+   * re-armed.  This may be inspected by the callback. */
+  unsigned int overruns;
+
+  /** A link to the next alarm in a chain.  When
+   * #configBSP430_TIMER_MUX_ALARM_HEAP is enabled this links to the
+   * next sibling within the heap.
    *
    * User code is only permitted to use this field when the structure
    * is not owned by a shared multiplex alarm. */
   struct sBSP430timerMuxAlarm * next;
+
+#if defined(BSP430_DOXYGEN) || (configBSP430_TIMER_MUX_ALARM_HEAP - 0)
+  /** The first of the alarms that are due no earlier than this one.
+   *
+   * @dependency #configBSP430_TIMER_MUX_ALARM_HEAP */
+  struct sBSP430timerMuxAlarm * child;
+
+  /** The parent of this alarm if it is the first child, otherwise
+   * its preceding sibling.  This is a null pointer when the alarm is
+   * not owned by a shared multiplex alarm, or is the earliest alarm.
+   *
+   * @dependency #configBSP430_TIMER_MUX_ALARM_HEAP */
+  struct sBSP430timerMuxAlarm * prev;
+#endif /* configBSP430_TIMER_MUX_ALARM_HEAP */
 } sBSP430timerMuxAlarm;
 
 /** Handle for an individual multiplixed alarm.
@@ -1808,7 +1984,8 @@ int iBSP430timerMuxAlarmShutdown (sBSP430timerMuxSharedAlarm * shared);
  * The user must have already initialized the @p alarm structure
  * including its callback and setting.  @p alarm is linked into the
  * list of alarms managed by @p shared, and the underlying timer is
- * configured to wake when the first alarm is due.
+ * configured to wake when the first alarm is due.  The alarm fires
+ * once; see iBSP430timerMuxAlarmAddPeriodic_ni().
  *
  * The underlying dedicated alarm sets its wakeup using
  * iBSP430timerAlarmSetForced_ni() so that delays resulting from slow
@@ -1831,16 +2008,47 @@ int iBSP430timerMuxAlarmShutdown (sBSP430timerMuxSharedAlarm * shared);
 int iBSP430timerMuxAlarmAdd_ni (hBSP430timerMuxSharedAlarm shared,
                                 hBSP430timerMuxAlarm alarm);
 
+/** Link a new periodic alarm into the list managed by @p shared
+ *
+ * As with iBSP430timerMuxAlarmAdd_ni(), except that after its
+ * callback returns the alarm is added again to go off @p period_tck
+ * ticks after the time at which it was due.  Events that would
+ * already have passed when the alarm is re-added are skipped, and
+ * their number is recorded in sBSP430timerMuxAlarm::overruns for the
+ * callback of the next delivered event.
+ *
+ * @param shared the shared alarm that manages multiplexed alarms.
+ *
+ * @param alarm information on the alarm to be set.
+ * sBSP430timerMuxAlarm::setting_tck holds the time of the first
+ * event.
+ *
+ * @param period_tck the interval between alarm events.  This should
+ * be larger than the time required to process the event.  A value of
+ * zero produces a one-shot alarm.
+ *
+ * @return as with iBSP430timerMuxAlarmAdd_ni().
+ *
+ * @ingroup grp_timer_alarm */
+int iBSP430timerMuxAlarmAddPeriodic_ni (hBSP430timerMuxSharedAlarm shared,
+                                        hBSP430timerMuxAlarm alarm,
+                                        unsigned long period_tck);
+
 /** Remove an alarm from a shared list.
  *
  * The alarm is removed from the list.  If any alarms remain, @p
  * shared is updated to fire when the next alarm is due.  It is
  * guaranteed that the removed alarm will not fire after this function
- * has been invoked.
+ * has been invoked.  A periodic alarm is stopped, including when this
+ * is invoked from its own callback.
  *
  * @param shared the shared alarm that manages multiplexed alarms.
  *
- * @param alarm the alarm to be removed.
+ * @param alarm the alarm to be removed.  Removing an alarm that is
+ * not owned by @p shared has no effect.  When
+ * #configBSP430_TIMER_MUX_ALARM_HEAP is enabled this is only
+ * detectable if the alarm was zero-initialized or has previously
+ * fired or been removed.
  *
  * @return Normally the return value from
  * iBSP430timerAlarmSetForced_ni() when setting for the next scheduled
@@ -1907,6 +2115,112 @@ int iBSP430timerMuxAlarmRemove_ni (hBSP430timerMuxSharedAlarm shared,
  * infrastructure is active (i.e., the interrupt is enabled). */
 #define BSP430_TIMER_PULSECAP_ACTIVE 0x2000
 
+/** Define to a true value to support batched pulse capture through
+ * #sBSP430timerPulseCaptureRing.
+ *
+ * This adds a pointer to each sBSP430timerPulseCapture and the code
+ * to fill and analyze a ring from the capture interrupt.
+ *
+ * @cppflag
+ * @defaulted */
+#ifndef configBSP430_TIMER_PULSECAP_RING
+#define configBSP430_TIMER_PULSECAP_RING 0
+#endif /* configBSP430_TIMER_PULSECAP_RING */
+
+/** Bit set in sBSP430timerPulseCaptureRing::flags_ni if the capture
+ * records both edges, so entries alternate between the start and end
+ * of pulses.  Determined from the capture mode when the ring is
+ * attached. */
+#define BSP430_TIMER_PULSECAP_RING_BOTH_EDGES 0x01
+
+/** Bit set in sBSP430timerPulseCaptureRing::flags_ni while the ring
+ * is waiting for the start of a pulse before storing captures.  Set
+ * when the ring is attached and after captures are lost. */
+#define BSP430_TIMER_PULSECAP_RING_RESYNC 0x02
+
+/** Storage for batched pulse captures.
+ *
+ * When a ring is attached to a pulse capture with
+ * iBSP430timerPulseCaptureSetRing_ni() the interrupt does nothing but
+ * store the overflow-adjusted capture time in the ring.  The pulse
+ * capture callback is invoked only when a batch of captures has been
+ * stored.  The application then examines the oldest batch, normally
+ * with iBSP430timerPulseCaptureRingStats_ni(), which also releases it.
+ *
+ * Each batch is an unbroken sequence of captures beginning with the
+ * start of a pulse (a low-to-high transition when both edges are
+ * captured).  When a capture is lost, either because the hardware
+ * overwrote it (#COV) or because the ring was full, the partial batch
+ * is discarded, sBSP430timerPulseCaptureRing::lost_ni is incremented,
+ * and storage resumes at the start of the next pulse.
+ *
+ * Fields other than those marked as maintained by the infrastructure
+ * are set by hBSP430timerPulseCaptureRingInitialize(). */
+typedef struct sBSP430timerPulseCaptureRing {
+  /** Storage for capture times.  Entry @c i of the ring is at index
+   * <tt>i & (size - 1)</tt>. */
+  unsigned long * captures_tt;
+
+  /** The number of entries in @a captures_tt.  This must be a power
+   * of two. */
+  unsigned int size;
+
+  /** The number of captures that make up a batch. */
+  unsigned int batch;
+
+  /** Free-running index of the next entry to be stored.  Maintained
+   * by the infrastructure. */
+  volatile unsigned int head_ni;
+
+  /** Free-running index of the oldest entry not yet released.
+   * Advanced by the application, normally through
+   * iBSP430timerPulseCaptureRingStats_ni(). */
+  volatile unsigned int tail_ni;
+
+  /** The number of captures stored in the batch being filled.
+   * Maintained by the infrastructure. */
+  volatile unsigned int fill_ni;
+
+  /** The number of times captures were lost, causing a partial batch
+   * to be discarded.  Maintained by the infrastructure; the
+   * application may clear it. */
+  volatile unsigned int lost_ni;
+
+  /** Flags such as #BSP430_TIMER_PULSECAP_RING_BOTH_EDGES.
+   * Maintained by the infrastructure. */
+  volatile unsigned int flags_ni;
+} sBSP430timerPulseCaptureRing;
+
+/** Handle for a pulse capture ring */
+typedef struct sBSP430timerPulseCaptureRing * hBSP430timerPulseCaptureRing;
+
+/** Statistics over a batch of captures, produced by
+ * iBSP430timerPulseCaptureRingStats_ni().  All durations are in ticks
+ * of the capturing timer. */
+typedef struct sBSP430timerPulseCaptureStats {
+  /** The number of complete periods (start to start of successive
+   * pulses) in the batch. */
+  unsigned int periods;
+
+  /** The mean period */
+  unsigned long mean_period_tt;
+
+  /** The shortest period */
+  unsigned long min_period_tt;
+
+  /** The longest period */
+  unsigned long max_period_tt;
+
+  /** The mean time from the start to the end of a pulse.  Zero unless
+   * both edges are captured. */
+  unsigned long mean_width_tt;
+
+  /** The duty cycle in tenths of a percent: the mean width as a
+   * fraction of the mean period.  Zero unless both edges are
+   * captured. */
+  unsigned int duty_ppt;
+} sBSP430timerPulseCaptureStats;
+
 /* Forward declaration */
 struct sBSP430timerPulseCapture;
 
@@ -1957,6 +2271,15 @@ typedef struct sBSP430timerPulseCapture {
    * valid only if #BSP430_TIMER_PULSECAP_END_VALID is set in @a
    * flags. */
   volatile unsigned long end_tt_ni;
+
+#if defined(BSP430_DOXYGEN) || (configBSP430_TIMER_PULSECAP_RING - 0)
+  /** The ring into which captures are batched, or a null pointer to
+   * process captures individually.  Set with
+   * iBSP430timerPulseCaptureSetRing_ni().
+   *
+   * @dependency #configBSP430_TIMER_PULSECAP_RING */
+  hBSP430timerPulseCaptureRing ring;
+#endif /* configBSP430_TIMER_PULSECAP_RING */
 } sBSP430timerPulseCapture;
 
 /** Handle for a structure used to capture the width of a pulse */
@@ -2199,6 +2522,106 @@ void vBSP430timerPulseCaptureInvertSense_ni (hBSP430timerPulseCapture pulsecap)
   pulsecap->flags_ni = flags;
 }
 
+#if defined(BSP430_DOXYGEN) || (configBSP430_TIMER_PULSECAP_RING - 0)
+/** Configure a ring for batched pulse captures.
+ *
+ * @param ring the structure to be initialized.
+ *
+ * @param captures_tt storage for @p size capture times.
+ *
+ * @param size the number of entries in @p captures_tt.  It must be a
+ * power of two, and should be at least twice @p batch so that one
+ * batch can be filled while the previous one is examined.
+ *
+ * @param batch the number of captures that make up a batch, which
+ * must not exceed @p size.  It must be at least two; when both edges
+ * are captured it must be even and at least four, so each batch
+ * includes whole pulses and at least one complete period.
+ *
+ * @return @p ring, or a null pointer if the parameters are invalid.
+ *
+ * @dependency #configBSP430_TIMER_PULSECAP_RING */
+hBSP430timerPulseCaptureRing
+hBSP430timerPulseCaptureRingInitialize (hBSP430timerPulseCaptureRing ring,
+                                        unsigned long * captures_tt,
+                                        unsigned int size,
+                                        unsigned int batch);
+
+/** Attach a ring to, or detach it from, a pulse capture.
+ *
+ * While a ring is attached, each capture is stored in it and the
+ * capture callback is invoked only when a batch is complete.
+ * #BSP430_TIMER_PULSECAP_START_CALLBACK and
+ * #BSP430_TIMER_PULSECAP_END_CALLBACK are ignored, and
+ * sBSP430timerPulseCapture::start_tt_ni and
+ * sBSP430timerPulseCapture::end_tt_ni are not updated.
+ *
+ * Attaching a ring discards its contents and determines from the
+ * capture mode of the timer whether it holds both edges.  The capture
+ * mode should not be changed while the ring is attached.
+ *
+ * @param pulsecap a pulse capture structure initialized using
+ * hBSP430timerPulseCaptureInitialize().
+ *
+ * @param ring a ring initialized with
+ * hBSP430timerPulseCaptureRingInitialize(), or a null pointer to
+ * return to processing captures individually.
+ *
+ * @return 0 on success, or a negative error code if @p ring has a
+ * batch size that is invalid for the capture mode.
+ *
+ * @dependency #configBSP430_TIMER_PULSECAP_RING */
+int iBSP430timerPulseCaptureSetRing_ni (hBSP430timerPulseCapture pulsecap,
+                                        hBSP430timerPulseCaptureRing ring);
+
+/** Return the number of complete batches in @p ring that have not
+ * been released.
+ *
+ * @dependency #configBSP430_TIMER_PULSECAP_RING */
+static BSP430_CORE_INLINE
+unsigned int
+uiBSP430timerPulseCaptureRingBatches_ni (hBSP430timerPulseCaptureRing ring)
+{
+  return ((ring->head_ni - ring->fill_ni) - ring->tail_ni) / ring->batch;
+}
+
+/** Return capture @p idx of the oldest unreleased batch in @p ring.
+ *
+ * @param ring the ring, which must hold a complete batch.
+ *
+ * @param idx the position within the batch, less than
+ * sBSP430timerPulseCaptureRing::batch.
+ *
+ * @dependency #configBSP430_TIMER_PULSECAP_RING */
+static BSP430_CORE_INLINE
+unsigned long
+ulBSP430timerPulseCaptureRingCapture_ni (hBSP430timerPulseCaptureRing ring,
+                                         unsigned int idx)
+{
+  return ring->captures_tt[(ring->tail_ni + idx) & (ring->size - 1)];
+}
+
+/** Compute statistics over the oldest batch in @p ring and release it.
+ *
+ * The computation is done with interrupts disabled; for large batches
+ * an application may prefer to copy the captures out with
+ * ulBSP430timerPulseCaptureRingCapture_ni() and release the batch by
+ * advancing sBSP430timerPulseCaptureRing::tail_ni by
+ * sBSP430timerPulseCaptureRing::batch.
+ *
+ * @param ring the ring holding captures.
+ *
+ * @param stats where the statistics are stored.  This may be a null
+ * pointer to simply release the batch.
+ *
+ * @return 0 on success, or a negative value if @p ring holds no
+ * complete batch.
+ *
+ * @dependency #configBSP430_TIMER_PULSECAP_RING */
+int iBSP430timerPulseCaptureRingStats_ni (hBSP430timerPulseCaptureRing ring,
+                                          sBSP430timerPulseCaptureStats * stats);
+#endif /* configBSP430_TIMER_PULSECAP_RING */
+
 /* !BSP430! insert=hal_decl */
 /* BEGIN AUTOMATICALLY GENERATED CODE---DO NOT MODIFY [hal_decl] */
 /** Control inclusion of the @HAL interface to #BSP430_PERIPH_TA0
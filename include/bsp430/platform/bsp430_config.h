@@ -325,6 +325,13 @@
 #undef BSP430_WANT_CONFIG_HAL
 #undef BSP430_WANT_CONFIG_HPL
 #undef BSP430_WANT_PERIPH_CPPID
+
+/* DMA-driven transmission needs the DMA HAL and its ISR */
+#if (configBSP430_CONSOLE_TX_DMA - 0)
+#ifndef configBSP430_HAL_DMA
+#define configBSP430_HAL_DMA 1
+#endif /* configBSP430_HAL_DMA */
+#endif /* configBSP430_CONSOLE_TX_DMA */
 #endif /* configBSP430_CONSOLE */
 
 #if (configBSP430_TIMER_CCACLK - 0)
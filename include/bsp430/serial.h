@@ -420,6 +420,14 @@ hBSP430halSERIAL hBSP430serialOpenSPI (hBSP430halSERIAL hal,
  * be used to provide data for transmission and to process received
  * data.
  *
+ * When @p rx_data is null the octets are transmitted back-to-back,
+ * each written as soon as the transmit buffer empties rather than
+ * after the response to its predecessor arrives.  The routine returns
+ * once the last octet has left the shift register, with any received
+ * data discarded.  On fast SPI clocks this can nearly double the write
+ * throughput, which is what display updates and flash programming
+ * need.
+ *
  * @param hal the serial device over which the data is transmitted and
  * received
  *
@@ -454,6 +462,145 @@ int iBSP430spiTxRx_rh (hBSP430halSERIAL hal,
   return hal->dispatch->spiTxRx_rh(hal, tx_data, tx_len, rx_len, rx_data);
 }
 
+struct sBSP430spiTransaction;
+
+/** Callback invoked when an asynchronous SPI transaction completes.
+ *
+ * The callback is invoked from the serial device receive interrupt
+ * once the last octet of the transaction has been received.  It may
+ * start another transaction using the same @p xfer structure.
+ *
+ * @param xfer the transaction that has completed
+ *
+ * @return As with #iBSP430halISRCallbackVoid_ni.  Use
+ * #BSP430_HAL_ISR_CALLBACK_EXIT_LPM to wake the main loop. */
+typedef int (* iBSP430spiTransactionCallback_ni) (struct sBSP430spiTransaction * xfer);
+
+/** Bit set in sBSP430spiTransaction::flags_ni while a transaction is
+ * in progress. */
+#define BSP430_SPI_TRANSACTION_FLAG_ACTIVE 0x01
+
+/** State for an interrupt-driven SPI transaction.
+ *
+ * The transaction is carried out by callbacks installed on the
+ * device's sBSP430halSERIAL::tx_cbchain_ni and
+ * sBSP430halSERIAL::rx_cbchain_ni, so the peripheral interrupt
+ * handlers move each octet and the CPU may sleep between them.  All
+ * fields are maintained by iBSP430spiTxRxAsync_ni() and the
+ * callbacks; the application should only read them.  The structure
+ * must be zero-initialized before its first use.
+ *
+ * @note Only one octet is outstanding at a time: the next is
+ * transmitted once the response to the previous one has been
+ * received.  The receive buffer therefore cannot be overrun however
+ * long the interrupt is delayed, at the cost of idle bus time between
+ * octets. */
+typedef struct sBSP430spiTransaction {
+  /** @cond DOXYGEN_EXCLUDE */
+  sBSP430halISRVoidChainNode tx_cb_node;
+  sBSP430halISRVoidChainNode rx_cb_node;
+  /** @endcond */
+
+  /** The device on which the transaction runs */
+  hBSP430halSERIAL hal;
+
+  /** Octets to be transmitted as the command, as for
+   * iBSP430spiTxRx_rh() */
+  const uint8_t * tx_data;
+
+  /** Number of octets in #tx_data */
+  size_t tx_len;
+
+  /** Number of additional octets to receive after the command */
+  size_t rx_len;
+
+  /** Where received octets are stored, or a null pointer */
+  uint8_t * rx_data;
+
+  /** Function invoked when the transaction completes, or a null
+   * pointer */
+  iBSP430spiTransactionCallback_ni callback_ni;
+
+  /** Number of octets transmitted so far */
+  volatile size_t tx_count_ni;
+
+  /** Number of octets received so far */
+  volatile size_t rx_count_ni;
+
+  /** Transaction state, including #BSP430_SPI_TRANSACTION_FLAG_ACTIVE */
+  volatile unsigned int flags_ni;
+} sBSP430spiTransaction;
+
+/** Handle for an asynchronous SPI transaction */
+typedef struct sBSP430spiTransaction * hBSP430spiTransaction;
+
+/** Begin an interrupt-driven SPI transaction.
+ *
+ * The transaction has the same form as iBSP430spiTxRx_rh(): the @p
+ * tx_len octets of @p tx_data are transmitted, followed by @p rx_len
+ * dummy octets per #BSP430_SERIAL_SPI_READ_TX_BYTE, and every octet
+ * received is stored in @p rx_data.  This function returns as soon as
+ * the first octet has been queued; the remainder are moved by the
+ * device interrupt handlers.  When the last response has been
+ * received @p callback_ni is invoked, and
+ * #BSP430_SPI_TRANSACTION_FLAG_ACTIVE is cleared in @p xfer.
+ *
+ * On first use the transaction callbacks are linked into the device
+ * callback chains, which must then be empty.  They remain linked when
+ * the transaction completes, so the completion callback or the
+ * application can start another transaction with the same @p xfer
+ * without further setup.  While they are linked iBSP430spiTxRx_rh()
+ * is unavailable; use iBSP430spiTxRxAsyncRelease_ni() to restore it.
+ *
+ * The HAL interrupt handlers for the device must be enabled (e.g.,
+ * #configBSP430_HAL_EUSCI_B0_ISR).  Chip select is the caller's
+ * responsibility, and must remain asserted until the transaction
+ * completes.
+ *
+ * @param hal the SPI-configured serial device
+ *
+ * @param xfer the structure holding transaction state.  It must
+ * remain valid until the transaction completes.
+ *
+ * @param tx_data as with iBSP430spiTxRx_rh().  The data must remain
+ * valid until the transaction completes.
+ *
+ * @param tx_len as with iBSP430spiTxRx_rh()
+ *
+ * @param rx_len as with iBSP430spiTxRx_rh()
+ *
+ * @param rx_data as with iBSP430spiTxRx_rh()
+ *
+ * @param callback_ni the function to invoke on completion, or a null
+ * pointer.  With a null pointer the completing interrupt returns
+ * #BSP430_HAL_ISR_CALLBACK_EXIT_LPM.
+ *
+ * @return 0 if the transaction was started.  -1 if the device lacks
+ * interrupt handlers, its callback chains are in use by something
+ * other than @p xfer, @p xfer is already active, or there is nothing
+ * to transfer.
+ *
+ * @dependency #configBSP430_SERIAL_ENABLE_SPI */
+int iBSP430spiTxRxAsync_ni (hBSP430halSERIAL hal,
+                            hBSP430spiTransaction xfer,
+                            const uint8_t * tx_data,
+                            size_t tx_len,
+                            size_t rx_len,
+                            uint8_t * rx_data,
+                            iBSP430spiTransactionCallback_ni callback_ni);
+
+/** Remove the callbacks of an asynchronous SPI transaction from its
+ * device.
+ *
+ * @param xfer a transaction previously started with
+ * iBSP430spiTxRxAsync_ni()
+ *
+ * @return 0 if the callbacks were removed or had not been linked; -1
+ * if the transaction is still active.
+ *
+ * @dependency #configBSP430_SERIAL_ENABLE_SPI */
+int iBSP430spiTxRxAsyncRelease_ni (hBSP430spiTransaction xfer);
+
 #endif /* configBSP430_SERIAL_ENABLE_SPI */
 
 /** Control the duration of I2C loops waiting for bus conditions.
@@ -649,6 +796,169 @@ int iBSP430i2cRxData_rh (hBSP430halSERIAL hal,
 {
   return hal->dispatch->i2cRxData_rh(hal, rx_data, rx_len);
 }
+
+struct sBSP430i2cTransaction;
+
+/** Callback invoked when a queued I2C transaction completes.
+ *
+ * The callback is invoked from the serial device interrupt once the
+ * stop condition that ends the transaction has been generated, or the
+ * transaction has failed.  The next queued transaction has already
+ * been started.  The callback may submit further transactions,
+ * including @p xfer itself.
+ *
+ * @param xfer the transaction that has completed.  Its
+ * sBSP430i2cTransaction::result_ni field holds the outcome.
+ *
+ * @return As with #iBSP430halISRCallbackVoid_ni.  Use
+ * #BSP430_HAL_ISR_CALLBACK_EXIT_LPM to wake the main loop. */
+typedef int (* iBSP430i2cTransactionCallback_ni) (struct sBSP430i2cTransaction * xfer);
+
+/** Value of sBSP430i2cTransaction::result_ni while a transaction is
+ * queued or in progress. */
+#define BSP430_I2C_TRANSACTION_PENDING 1
+
+/** An I2C master transaction for an #sBSP430i2cQueue.
+ *
+ * The transaction addresses a slave and writes @a tx_len octets from
+ * @a tx_data, then reads @a rx_len octets into @a rx_data, then
+ * generates a stop condition.  When both segments are present the
+ * read follows a repeated start, as needed to read a register from
+ * most sensors.  Either segment may be empty, but not both.
+ *
+ * The application sets the fields through #callback_ni, which must
+ * not change until the transaction completes.  The remaining fields
+ * are maintained by the queue.  The structure must be
+ * zero-initialized before its first use. */
+typedef struct sBSP430i2cTransaction {
+  /** @cond DOXYGEN_EXCLUDE */
+  struct sBSP430i2cTransaction * volatile next_ni;
+  /** @endcond */
+
+  /** The 7-bit address of the slave */
+  unsigned int address;
+
+  /** Octets written after the address */
+  const uint8_t * tx_data;
+
+  /** Number of octets in #tx_data */
+  size_t tx_len;
+
+  /** Where octets read from the slave are stored */
+  uint8_t * rx_data;
+
+  /** Number of octets to read into #rx_data */
+  size_t rx_len;
+
+  /** Function invoked when the transaction completes, or a null
+   * pointer */
+  iBSP430i2cTransactionCallback_ni callback_ni;
+
+  /** #BSP430_I2C_TRANSACTION_PENDING from submission until
+   * completion.  Then zero if every octet was transferred, or a
+   * negative error code.  @c -(#BSP430_I2C_ERRFLAG_PROTOCOL | @c
+   * UCNACKIFG) indicates the slave did not acknowledge its address or
+   * a written octet.  @c -(#BSP430_I2C_ERRFLAG_PROTOCOL | @c UCALIFG)
+   * indicates another master won arbitration for the bus; the
+   * transaction may be submitted again.
+   * #BSP430_I2C_ERRFLAG_SPINLIMIT indicates the peripheral failed to
+   * complete a start or stop condition. */
+  volatile int result_ni;
+} sBSP430i2cTransaction;
+
+/** Handle for a queued I2C transaction */
+typedef struct sBSP430i2cTransaction * hBSP430i2cTransaction;
+
+/** A queue of I2C transactions carried out, one after another, by
+ * the interrupt handler of a serial device in I2C master mode.
+ *
+ * Several drivers may submit transactions to the same queue and
+ * sleep while the bus works.  All fields are maintained by the queue
+ * and the peripheral implementation; the application should only
+ * read them. */
+typedef struct sBSP430i2cQueue {
+  /** @cond DOXYGEN_EXCLUDE */
+  sBSP430halISRIndexedChainNode cb_node;
+  /** @endcond */
+
+  /** The device on which transactions run */
+  hBSP430halSERIAL hal;
+
+  /** The transaction in progress, followed by those waiting */
+  struct sBSP430i2cTransaction * volatile head_ni;
+
+  /** The last transaction waiting */
+  struct sBSP430i2cTransaction * volatile tail_ni;
+
+  /** Octets transferred in the current segment of #head_ni */
+  volatile size_t index_ni;
+
+  /** Peripheral-specific state of #head_ni */
+  volatile unsigned int state_ni;
+} sBSP430i2cQueue;
+
+/** Handle for an I2C transaction queue */
+typedef struct sBSP430i2cQueue * hBSP430i2cQueue;
+
+/** Attach a transaction queue to a serial device.
+ *
+ * The device must already be open in I2C master mode (see
+ * hBSP430serialOpenI2C()), and its HAL interrupt handler must be
+ * enabled (e.g., #configBSP430_HAL_EUSCI_B0_ISR).  While the queue is
+ * attached the interrupt handler passes every I2C event to it, and
+ * the polled functions iBSP430i2cTxData_rh() and
+ * iBSP430i2cRxData_rh() must not be used.
+ *
+ * The eUSCI_B and 5xx USCI_B peripherals support queues.
+ *
+ * @param queue the structure holding queue state
+ *
+ * @param hal the I2C-configured serial device
+ *
+ * @return @p queue, or a null pointer if the device does not support
+ * queues, lacks an interrupt handler, or already has a queue.
+ *
+ * @dependency #configBSP430_SERIAL_ENABLE_I2C */
+hBSP430i2cQueue hBSP430i2cQueueInitialize_ni (hBSP430i2cQueue queue,
+                                              hBSP430halSERIAL hal);
+
+/** Submit a transaction to a queue.
+ *
+ * The transaction starts immediately if the queue is idle, and
+ * otherwise when those submitted before it have completed.
+ *
+ * @param queue the queue on which the transaction runs
+ *
+ * @param xfer the transaction, with its address, data, and callback
+ * set.  It must remain valid until it completes.
+ *
+ * @return 0 if the transaction was queued.  -1 if @p queue is not
+ * attached to a device, @p xfer is already pending, or there is
+ * nothing to transfer.
+ *
+ * @dependency #configBSP430_SERIAL_ENABLE_I2C */
+int iBSP430i2cQueueSubmit_ni (hBSP430i2cQueue queue,
+                              hBSP430i2cTransaction xfer);
+
+/** Detach a queue from its serial device.
+ *
+ * @param queue a queue previously attached with
+ * hBSP430i2cQueueInitialize_ni()
+ *
+ * @return 0 if the queue was detached or was not attached; -1 if
+ * transactions remain in it.
+ *
+ * @dependency #configBSP430_SERIAL_ENABLE_I2C */
+int iBSP430i2cQueueRelease_ni (hBSP430i2cQueue queue);
+
+/** @cond DOXYGEN_EXCLUDE */
+/* Used by peripheral implementations to end the transaction at the
+ * head of the queue with @p result, start the next, and invoke the
+ * completion callback.  Returns the callback's flags. */
+int iBSP430i2cQueueComplete_ni (hBSP430i2cQueue queue,
+                                int result);
+/** @endcond */
+
 #endif /* configBSP430_SERIAL_ENABLE_I2C */
 
 /** Control serial device reset mode.
@@ -187,6 +187,7 @@ struct sBSP430hplUSCI5;
 struct sBSP430hplEUSCIA;
 struct sBSP430hplEUSCIB;
 struct sBSP430serialDispatch;
+struct sBSP430i2cQueue;
 
 /** Structure holding hardware abstraction layer state for serial
  * devices. */
@@ -288,6 +289,23 @@ typedef struct sBSP430halSERIAL {
    * even if interrupts are enabled. */
   const struct sBSP430halISRVoidChainNode * volatile tx_cbchain_ni;
 
+#if defined(BSP430_DOXYGEN) || (configBSP430_SERIAL_ENABLE_I2C - 0)
+  /** The callback chain to invoke on any I2C event.
+   *
+   * A non-null value causes the interrupt handler to read the
+   * peripheral interrupt vector and pass it as the index to this
+   * chain, instead of performing the transmit and receive processing
+   * associated with #rx_cbchain_ni and #tx_cbchain_ni.  It is
+   * normally installed by hBSP430i2cQueueInitialize_ni().
+   *
+   * @note This field has an @link enh_interrupts_ni _ni@endlink
+   * suffix and must not be traversed or manipulated unless interrupts
+   * are disabled.
+   *
+   * @dependency #configBSP430_SERIAL_ENABLE_I2C */
+  const struct sBSP430halISRIndexedChainNode * volatile i2c_cbchain_ni;
+#endif /* configBSP430_SERIAL_ENABLE_I2C */
+
   /** Total number of received octets */
   unsigned long num_rx;
 
@@ -334,6 +352,9 @@ struct sBSP430serialDispatch {
   int (* i2cSetAddresses_rh) (hBSP430halSERIAL hal, int own_address, int slave_address);
   int (* i2cRxData_rh) (hBSP430halSERIAL hal, uint8_t * rx_data, size_t rx_len);
   int (* i2cTxData_rh) (hBSP430halSERIAL hal, const uint8_t * tx_data, size_t tx_len);
+  /* Null if the peripheral does not support sBSP430i2cQueue */
+  void (* i2cQueueStart_ni) (struct sBSP430i2cQueue * queue);
+  iBSP430halISRCallbackIndexed_ni i2cQueueISR_ni;
 #endif /* configBSP430_SERIAL_ENABLE_I2C */
   int (* setReset_rh) (hBSP430halSERIAL hal, int resetp);
   int (* setHold_rh) (hBSP430halSERIAL hal, int holdp);
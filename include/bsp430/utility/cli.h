@@ -131,6 +131,7 @@
 #define BSP430_UTILITY_CLI_H
 
 #include <bsp430/core.h>
+#include <bsp430/utility/eui64.h>
 
 /** Define to a true value to request that command completion be enabled.
  *
@@ -171,6 +172,44 @@
 #define configBSP430_CLI_COMMAND_COMPLETION_HELPER 0
 #endif /* configBSP430_CLI_COMMAND_COMPLETION_HELPER */
 
+/** Define to a true value to support command sets held as sorted
+ * arrays.
+ *
+ * Normally the commands at each level are found by walking the
+ * sBSP430cliCommand::next chain and comparing every key.  When this
+ * is enabled, a set of sibling commands may instead be a constant
+ * array sorted by key, with the number of commands recorded in
+ * sBSP430cliCommand::indexed_count of the first element.
+ * iBSP430cliMatchCommand(), and hence command execution and
+ * completion, locate matches in such a set by binary search.  Sets
+ * that are not indexed are processed as before, so the two
+ * representations may be mixed.
+ *
+ * Such tables are most easily produced from a text description by
+ * @c maintainer/clitable.py, which also fills in the
+ * sBSP430cliCommand::next chain so the generated tables remain
+ * usable when this option is disabled.
+ *
+ * @cppflag
+ * @defaulted
+ * @ingroup grp_utility_cli_cli
+ */
+#ifndef configBSP430_CLI_COMMAND_INDEX
+#define configBSP430_CLI_COMMAND_INDEX 0
+#endif /* configBSP430_CLI_COMMAND_INDEX */
+
+/** Expand to the initializer for sBSP430cliCommand::indexed_count
+ * when #configBSP430_CLI_COMMAND_INDEX is enabled, and to nothing
+ * otherwise.  Use this in the first element of an indexed command
+ * set.
+ *
+ * @param count_ the number of commands in the set */
+#if defined(BSP430_DOXYGEN) || (configBSP430_CLI_COMMAND_INDEX - 0)
+#define BSP430_CLI_COMMAND_INDEXED_COUNT(count_) .indexed_count = (count_),
+#else /* configBSP430_CLI_COMMAND_INDEX */
+#define BSP430_CLI_COMMAND_INDEXED_COUNT(count_)
+#endif /* configBSP430_CLI_COMMAND_INDEX */
+
 /** Get the next token in the command string.
  *
  * @param commandp pointer to a pointer into an immutable buffer
@@ -227,6 +266,109 @@ const char * xBSP430cliNextQToken (const char ** commandp,
                                    size_t * remainingp,
                                    size_t * lenp);
 
+/** A token located within a command string.
+ *
+ * Tokens refer to the text of the command string in place; nothing
+ * is copied and the text is not NUL-terminated.  The command string
+ * must remain unchanged while the token is in use.
+ *
+ * @ingroup grp_utility_cli_hci */
+typedef struct sBSP430cliToken {
+  /** The first character of the token.  For a quoted token this is
+   * the character following the opening quote. */
+  const char * text;
+
+  /** The number of characters in the token, excluding any quotes. */
+  size_t len;
+
+  /** Nonzero if the token was delimited by quotes, as recognized by
+   * xBSP430cliNextQToken(). */
+  unsigned char quoted;
+} sBSP430cliToken;
+
+/** The maximum number of argument tokens made available to an
+ * #iBSP430cliArgvHandler.
+ *
+ * The token array is allocated on the stack of
+ * iBSP430cliHandlerArgv(), so this should be no larger than the
+ * application needs.
+ *
+ * @defaulted */
+#ifndef BSP430_CLI_ARGV_MAX
+#define BSP430_CLI_ARGV_MAX 8
+#endif /* BSP430_CLI_ARGV_MAX */
+
+/** Split a command string into tokens in a single pass.
+ *
+ * Tokens are identified exactly as by repeated calls to
+ * xBSP430cliNextQToken(), but the command string is scanned only
+ * once and the results are stored in @p tokens for random access.
+ *
+ * @param command pointer to an immutable buffer containing a sequence
+ * of whitespace-separated tokens
+ *
+ * @param command_len the length of the sequence beginning at @p
+ * command
+ *
+ * @param tokens where the tokens should be stored
+ *
+ * @param max_tokens the number of entries available in @p tokens
+ *
+ * @return the number of tokens stored in @p tokens, or
+ * <c>-#eBSP430_CLI_ERR_Invalid</c> if the command has more than @p
+ * max_tokens tokens.
+ *
+ * @ingroup grp_utility_cli_hci */
+int iBSP430cliTokenize (const char * command,
+                        size_t command_len,
+                        sBSP430cliToken * tokens,
+                        unsigned int max_tokens);
+
+/** Convert a token to a signed 16-bit integer.
+ *
+ * The token is parsed in place.  The text is normally decimal but
+ * optionally hexadecimal (with leading @c 0x) or octal (with leading
+ * @c 0), and may have a leading sign.
+ *
+ * @param tp the token to be converted
+ *
+ * @param destp where the converted value should be stored.  The
+ * destination is unchanged if the conversion fails.
+ *
+ * @return 0 if the whole token was converted to a value in range;
+ * <c>-#eBSP430_CLI_ERR_Missing</c> if the token is empty;
+ * <c>-#eBSP430_CLI_ERR_Invalid</c> otherwise.
+ *
+ * @ingroup grp_utility_cli_hci */
+int iBSP430cliTokenAsI (const sBSP430cliToken * tp,
+                        int * destp);
+
+/** Convert a token to an unsigned 16-bit integer.
+ *
+ * As with iBSP430cliTokenAsI().  As with strtoul() a leading minus
+ * sign negates the value in the unsigned type.
+ *
+ * @ingroup grp_utility_cli_hci */
+int iBSP430cliTokenAsUI (const sBSP430cliToken * tp,
+                         unsigned int * destp);
+
+/** Convert a token to a signed 32-bit integer.
+ *
+ * As with iBSP430cliTokenAsI().
+ *
+ * @ingroup grp_utility_cli_hci */
+int iBSP430cliTokenAsL (const sBSP430cliToken * tp,
+                        long * destp);
+
+/** Convert a token to an unsigned 32-bit integer.
+ *
+ * As with iBSP430cliTokenAsUI().
+ *
+ * @ingroup grp_utility_cli_hci */
+int iBSP430cliTokenAsUL (const sBSP430cliToken * tp,
+                         unsigned long * destp);
+
+
 /* Forward declarations */
 struct sBSP430cliCommand;
 struct sBSP430cliCommandLink;
@@ -417,6 +559,24 @@ typedef int (* iBSP430cliHandlerFunction) (struct sBSP430cliCommandLink * chain,
  */
 typedef int (* iBSP430cliSimpleHandler) (const char * argstr);
 
+/** Type for a command handler that takes its arguments as tokens.
+ *
+ * When the sBSP430cliCommand::handler field is set to
+ * iBSP430cliHandlerArgv(), the corresponding
+ * sBSP430cliCommand::uParam::argv_handler field should be the address
+ * of a conforming function which will be invoked with the remainder
+ * of the command string already split by iBSP430cliTokenize().
+ *
+ * @param chain the chain of commands leading to the handler
+ *
+ * @param argc the number of tokens in @p argv
+ *
+ * @param argv the tokens, which refer to text in the command string
+ */
+typedef int (* iBSP430cliArgvHandler) (struct sBSP430cliCommandLink * chain,
+                                       int argc,
+                                       const sBSP430cliToken * argv);
+
 /** The definition of a command, including the token that identifies
  * it, optional help, subordinate and sibling command structures, and
  * the handler that implements the operation given user input. */
@@ -482,8 +642,21 @@ typedef struct sBSP430cliCommand {
      * is a pointer-to-function which is not type-compatible with @p
      * ptr. */
     iBSP430cliSimpleHandler const simple_handler;
+
+    /** The parameter field used for iBSP430cliHandlerArgv(). */
+    iBSP430cliArgvHandler const argv_handler;
   } param;
 
+#if defined(BSP430_DOXYGEN) || (configBSP430_CLI_COMMAND_INDEX - 0)
+  /** Nonzero only in the first command of a set held as an array
+   * sorted by key (as with strcmp()), where it is the number of
+   * commands in the array.  Such a set is searched by binary search
+   * rather than by walking @a next.
+   *
+   * @dependency #configBSP430_CLI_COMMAND_INDEX */
+  unsigned int indexed_count;
+#endif /* configBSP430_CLI_COMMAND_INDEX */
+
 } sBSP430cliCommand;
 
 /** Callback support for iBSP430cliMatchCommand().  In addition to
@@ -510,7 +683,9 @@ typedef struct sBSP430cliMatchCallback {
  *
  * @param cmds the first in a sequence of sibling commands that may
  * appear at the beginning of the remainder of the command string.
- * This must not be a null pointer.
+ * This must not be a null pointer.  If it is an indexed set (see
+ * #configBSP430_CLI_COMMAND_INDEX) candidates are located by binary
+ * search, and @p match_cb is invoked on them in key order.
  *
  * @param command the unprocessed remainder of the command string.  If
  * there is no non-empty token in what remains, @p match_cb (if
@@ -606,6 +781,93 @@ iBSP430cliParseCommand (const sBSP430cliCommand * cmds,
                         iBSP430cliHandlerFunction chain_handler,
                         iBSP430cliHandlerFunction handler);
 
+/** Execute a stored sequence of commands.
+ *
+ * A script is a sequence of commands, each followed by a NUL
+ * character, held in directly addressable memory such as FRAM,
+ * information memory, or flash.  The commands are executed in order
+ * as with iBSP430cliExecuteCommand(), without the console buffer, echo,
+ * or prompt.  Commands consisting only of whitespace, and those whose
+ * first token begins with @c #, are skipped.
+ *
+ * The script ends at @p script_len, at an empty command (i.e. two
+ * consecutive NUL characters), or at a command beginning with the
+ * octet 0xFF as found in erased flash.
+ *
+ * @param cmds as with iBSP430cliExecuteCommand()
+ *
+ * @param param as with iBSP430cliExecuteCommand()
+ *
+ * @param script the first character of the script
+ *
+ * @param script_len the maximum length of the script, in octets
+ *
+ * @param linep optional pointer to where the number of the last
+ * command processed, counting from 1, should be stored.  If the
+ * script fails this identifies the failing command.
+ *
+ * @return 0 if all commands succeeded.  Otherwise the nonzero value
+ * returned by the first command that failed, or
+ * <c>-#eBSP430_CLI_ERR_Invalid</c> if the script ends with a command
+ * that is not followed by a NUL.
+ *
+ * @ingroup grp_utility_cli_cli */
+int iBSP430cliExecuteScript (const sBSP430cliCommand * cmds,
+                             void * param,
+                             const char * script,
+                             size_t script_len,
+                             unsigned int * linep);
+
+/** Type for a function that supplies script text to
+ * iBSP430cliExecuteScriptStream().
+ *
+ * @param context the value passed to iBSP430cliExecuteScriptStream()
+ *
+ * @param dst where the next octets of the script should be stored
+ *
+ * @param len the maximum number of octets to store in @p dst
+ *
+ * @return the number of octets stored in @p dst; zero at the end of
+ * the script; a negative value if the script could not be read. */
+typedef int (* iBSP430cliScriptReadFunction) (void * context,
+                                              char * dst,
+                                              size_t len);
+
+/** Execute a sequence of commands that is not directly addressable.
+ *
+ * This is iBSP430cliExecuteScript() for scripts held in external
+ * storage such as a region of an M25P serial flash.  The script is
+ * read sequentially through @p read_fn into @p buffer, and each
+ * command is executed in place within that buffer.
+ *
+ * @param cmds as with iBSP430cliExecuteCommand()
+ *
+ * @param param as with iBSP430cliExecuteCommand()
+ *
+ * @param read_fn the function that supplies the script text
+ *
+ * @param context passed to @p read_fn
+ *
+ * @param buffer scratch space used to hold commands.  The longest
+ * command, including its NUL terminator, must fit.
+ *
+ * @param buffer_len the number of octets available at @p buffer
+ *
+ * @param linep as with iBSP430cliExecuteScript()
+ *
+ * @return as with iBSP430cliExecuteScript().  A command too long for
+ * @p buffer yields <c>-#eBSP430_CLI_ERR_Invalid</c>, and a negative
+ * value from @p read_fn is returned as the result.
+ *
+ * @ingroup grp_utility_cli_cli */
+int iBSP430cliExecuteScriptStream (const sBSP430cliCommand * cmds,
+                                   void * param,
+                                   iBSP430cliScriptReadFunction read_fn,
+                                   void * context,
+                                   char * buffer,
+                                   size_t buffer_len,
+                                   unsigned int * linep);
+
 /** Utility to extract and store a signed 16-bit integer expressed in
  * text.
  *
@@ -724,6 +986,26 @@ int iBSP430cliHandlerSimple (sBSP430cliCommandLink * chain,
                              const char * argstr,
                              size_t argstr_len);
 
+/** Handler to invoke a command that takes pre-split arguments.
+ *
+ * The remainder of the command string is split with
+ * iBSP430cliTokenize() into at most #BSP430_CLI_ARGV_MAX tokens, and
+ * the @link sBSP430cliCommand::uParam::argv_handler @a
+ * chain->cmd->param.argv_handler @endlink is invoked with the result.
+ *
+ * See iBSP430cliHandlerFunction().
+ *
+ * @param chain passed to #iBSP430cliArgvHandler
+ * @param param ignored
+ * @param argstr the text to be split
+ * @param argstr_len the length of @p argstr
+ * @return value returned by the argv handler, or a diagnostic if the
+ * handler is missing or there are too many tokens. */
+int iBSP430cliHandlerArgv (sBSP430cliCommandLink * chain,
+                           void * param,
+                           const char * argstr,
+                           size_t argstr_len);
+
 /** Handler to store a signed 16-bit integer expressed in text.
  *
  * See iBSP430cliHandlerFunction() and iBSP430cliStoreI().
@@ -847,6 +1129,35 @@ enum eBSP430cliErrorType {
   eBSP430_CLIERRORTYPES,
 };
 
+/** Convert a token to an EUI-64.
+ *
+ * The token is parsed in place using iBSP430eui64Parse().
+ *
+ * @param tp the token to be converted
+ *
+ * @param eui64 where the extracted value should be stored
+ *
+ * @return 0 if the conversion succeeded;
+ * <c>-#eBSP430_CLI_ERR_Missing</c> if the token is empty;
+ * <c>-#eBSP430_CLI_ERR_Invalid</c> otherwise.
+ *
+ * @dependency #BSP430_EUI64
+ * @ingroup grp_utility_cli_hci */
+#if defined(BSP430_DOXYGEN) || (BSP430_EUI64 - 0)
+static BSP430_CORE_INLINE
+int iBSP430cliTokenAsEUI64 (const sBSP430cliToken * tp,
+                            hBSP430eui64 eui64)
+{
+  if (0 == tp->len) {
+    return -eBSP430_CLI_ERR_Missing;
+  }
+  if (0 != iBSP430eui64Parse(tp->text, tp->len, eui64)) {
+    return -eBSP430_CLI_ERR_Invalid;
+  }
+  return 0;
+}
+#endif /* BSP430_EUI64 */
+
 /** Type for a function that reports errors processing commands.
  *
  * The command processing infrastructure can be customized to diagnose
@@ -64,17 +64,18 @@
  * cgetchar().  Extensions include cputchars(), cputtext(), and
  * cpeekchar().
  *
- * With library support through #BSP430_CONSOLE_USE_EMBTEXTF or <a
- * href="https://sourceforge.net/projects/mspgcc/files/msp430-libc/">msp430-libc</a>
- * in the MSPGCC toolchain full support for formatted output via
- * cprintf() and vcprintf() is possible.
- *
- * In addition optimized routines are provided to convert integers in
- * standard bases with minimal space overhead (cputi(), cputu(),
- * cputl(), cputul()).  The integer routines are more cumbersome but
- * necessary when the platform cannot accommodate the stack overhead
- * of cprintf() (on the order of 100 bytes if 64-bit integer support
- * is included).
+ * Formatted output via cprintf() and vcprintf() is supported on all
+ * toolchains by the engine in <bsp430/utility/format.h>, which
+ * converts integers without division.
+ *
+ * In addition routines are provided to convert integers with minimal
+ * space overhead (cputi(), cputu(), cputl(), cputul()).  The integer
+ * routines are more cumbersome but useful when the platform cannot
+ * accommodate the stack overhead of cprintf(), which holds its
+ * formatting state alongside a conversion buffer large enough for a
+ * 64-bit octal value.  The integer routines need only a buffer of
+ * #BSP430_FORMAT_LONG_BUFFER_SIZE octets, and convert @c int values
+ * with 16-bit arithmetic.
  *
  * Compile-time options #BSP430_CONSOLE_RX_BUFFER_SIZE and
  * #BSP430_CONSOLE_TX_BUFFER_SIZE enable interrupt-driven input and
@@ -155,8 +156,8 @@
 #endif /* BSP430_CONSOLE_BAUD_RATE */
 
 /** Define this to the size of a buffer to be used for interrupt-driven
- * console input.  The value must not exceed 254, and buffer
- * management is most efficient if the value is a power of 2.
+ * console input.  The value must be a power of 2 not exceeding
+ * 16384.
  *
  * If this has a value of zero, character input is not interrupt
  * driven.  cgetchar() will return the most recently received
@@ -168,8 +169,8 @@
 #endif /* BSP430_CONSOLE_RX_BUFFER_SIZE */
 
 /** Define this to the size of a buffer to be used for interrupt-driven
- * console output.  The value must not exceed 254, and buffer
- * management is most efficient if the value is a power of 2.
+ * console output.  The value must be a power of 2 not exceeding
+ * 16384.  All octets of the buffer are usable.
  *
  * If this has a value of zero, character output is not interrupt
  * driven.  cputchar() will block until the UART is ready to accept
@@ -184,18 +185,76 @@
 #define BSP430_CONSOLE_TX_BUFFER_SIZE 0
 #endif /* BSP430_CONSOLE_TX_BUFFER_SIZE */
 
+/** Text emitted in place of console output that was discarded.
+ *
+ * When the transmit policy set by iBSP430consoleSetTxPolicy_ni()
+ * causes output to be discarded, this string is queued immediately
+ * before the next output that is accepted, so that the loss is
+ * visible in the console stream.  Define to an empty string to
+ * suppress the marker.
+ *
+ * @defaulted
+ * @dependency #BSP430_CONSOLE_TX_BUFFER_SIZE */
+#ifndef BSP430_CONSOLE_TX_OVERFLOW_MARKER
+#define BSP430_CONSOLE_TX_OVERFLOW_MARKER "<!>"
+#endif /* BSP430_CONSOLE_TX_OVERFLOW_MARKER */
+
+/** Define to a true value to drain the console transmit buffer
+ * through a DMA channel rather than the UART transmit interrupt.
+ *
+ * In the default interrupt-driven mode each transmitted character
+ * costs one UART interrupt.  When this option is enabled the
+ * contiguous data between the tail of the transmit buffer and its
+ * head (or the end of the buffer, if the data wraps) is handed to
+ * DMA channel #BSP430_CONSOLE_TX_DMA_CHANNEL as a single block,
+ * triggered by the UART transmit flag.  Only one interrupt, on block
+ * completion, is required per block.
+ *
+ * This requires a non-zero #BSP430_CONSOLE_TX_BUFFER_SIZE, a DMAX
+ * peripheral on a 5xx-family MCU, and that the application provide
+ * #BSP430_CONSOLE_TX_DMA_TRIGGER.  Enabling it implicitly enables
+ * #configBSP430_HAL_DMA.  If the console peripheral is not an eUSCI_A
+ * or USCI5 instance the console falls back to interrupt-driven
+ * transmission.
+ *
+ * @cppflag
+ * @defaulted
+ * @dependency #BSP430_CONSOLE_TX_BUFFER_SIZE */
+#ifndef configBSP430_CONSOLE_TX_DMA
+#define configBSP430_CONSOLE_TX_DMA 0
+#endif /* configBSP430_CONSOLE_TX_DMA */
+
+/** The DMA channel used when #configBSP430_CONSOLE_TX_DMA is enabled.
+ *
+ * The console takes exclusive ownership of this channel.
+ *
+ * @defaulted
+ * @dependency #configBSP430_CONSOLE_TX_DMA */
+#ifndef BSP430_CONSOLE_TX_DMA_CHANNEL
+#define BSP430_CONSOLE_TX_DMA_CHANNEL 0
+#endif /* BSP430_CONSOLE_TX_DMA_CHANNEL */
+
+/** The DMA trigger select value corresponding to the transmit flag of
+ * the console UART, e.g. the numeric value of @c DMA0TSEL__UCA0TXIFG
+ * on an MSP430FR5969 with console on eUSCI_A0.
+ *
+ * This value is MCU-specific and there is no default: it must be
+ * provided when #configBSP430_CONSOLE_TX_DMA is enabled.
+ *
+ * @dependency #configBSP430_CONSOLE_TX_DMA */
+#if defined(BSP430_DOXYGEN)
+#define BSP430_CONSOLE_TX_DMA_TRIGGER include <bsp430_config.h>
+#endif /* BSP430_DOXYGEN */
+
 /** Define to indicate build infrastructure support for embtextf
  *
- * This flag should be defined to a true value by the build
- * infrastructure when the external @ref mp_external_embtextf library
- * is to supply enhanced formatting functions.  This enables:
- * @li cprintf(), vcprintf()
- * @li cputi(), cputu(), cputl(), cputul()
+ * This flag is defined to a true value by the build infrastructure
+ * when the external @ref mp_external_embtextf library is linked into
+ * the application.
  *
- * @note When using the MSPGCC toolchain this capability is available
- * implicitly through msp430-libc.  #BSP430_CONSOLE_USE_EMBTEXTF
- * should be defined only when the external version of these functions
- * is to be used instead.
+ * @note The console no longer uses embtextf: cprintf(), vcprintf(),
+ * and the cputi() family are implemented using
+ * <bsp430/utility/format.h> regardless of this setting.
  */
 #ifndef BSP430_CONSOLE_USE_EMBTEXTF
 #define BSP430_CONSOLE_USE_EMBTEXTF 0
@@ -266,6 +325,71 @@ void vBSP430consoleSetRxCallback_ni (iBSP430consoleRxCallback_ni cb);
 
 #endif /* BSP430_CONSOLE_RX_BUFFER_SIZE */
 
+/** Define to a true value to support a cooked (line discipline) mode
+ * for console input.
+ *
+ * When enabled at runtime by iBSP430consoleSetRxCooked_ni(), the
+ * receive interrupt handler edits the line being entered, so the
+ * application need not wake for each character:
+ *
+ * @li Printable characters are buffered and echoed, without waking
+ * the application;
+ * @li Backspace (@c BS or @c DEL) erases the previous character;
+ * @li Control-U erases the line and control-W the previous word;
+ * @li Any other character, including carriage return, tab, and
+ * escape, is buffered without echo and wakes the application, as do
+ * the characters of an escape sequence.  As with the CLI, a sequence
+ * runs through its final character (@c 0x40 to @c 0x7E), so the
+ * parameters of a control sequence such as @c ESC @c [ @c 3 @c ~ are
+ * neither echoed nor edited.
+ *
+ * Editing applies only to characters the application has not yet
+ * read.  Edits that reach further back are buffered and passed to the
+ * application, as is done with the CLI after command completion.
+ * While the receive buffer is full, further input is refused and
+ * echoed as a bell.  #BSP430_CONSOLE_RX_BUFFER_SIZE should therefore
+ * be large enough to hold a line.
+ *
+ * The registered receive callback (vBSP430consoleSetRxCallback_ni())
+ * is invoked only when the application would be woken.
+ *
+ * With interrupt-driven transmission echo is queued only if all of it
+ * fits in the transmit buffer, and is otherwise discarded.  Discarded
+ * echo does not count as a transmit drop or produce an overflow
+ * marker, whatever the policy set by iBSP430consoleSetTxPolicy_ni().
+ * When interrupt-driven transmission is not enabled echo is written
+ * directly to the UART from the interrupt handler.
+ *
+ * @cppflag
+ * @defaulted
+ * @dependency #BSP430_CONSOLE_RX_BUFFER_SIZE */
+#ifndef configBSP430_CONSOLE_RX_COOKED
+#define configBSP430_CONSOLE_RX_COOKED 0
+#endif /* configBSP430_CONSOLE_RX_COOKED */
+
+#if defined(BSP430_DOXYGEN) || ((0 < BSP430_CONSOLE_RX_BUFFER_SIZE) && (configBSP430_CONSOLE_RX_COOKED - 0))
+
+/** Enable or disable cooked console input.
+ *
+ * @param enablep nonzero to apply the line discipline described at
+ * #configBSP430_CONSOLE_RX_COOKED to subsequent input; zero to return
+ * to delivering each character as received.
+ *
+ * @return the previous setting
+ *
+ * @dependency #configBSP430_CONSOLE_RX_COOKED */
+int iBSP430consoleSetRxCooked_ni (int enablep);
+
+/** Return nonzero if cooked console input is active.
+ *
+ * In this case characters returned by cgetchar() have already been
+ * echoed.
+ *
+ * @dependency #configBSP430_CONSOLE_RX_COOKED */
+int iBSP430consoleRxCooked (void);
+
+#endif /* configBSP430_CONSOLE_RX_COOKED */
+
 /** If defined to a true value, the individual character display
  * function used internally to the console module will be made public
  * with the name @c putchar so that it will be used by @c printf(3)
@@ -344,7 +468,22 @@ int cputtext (const char * s);
  * @consoleoutput */
 int cputchars (const char * cp, size_t len);
 
-#if defined(BSP430_DOXYGEN) || (BSP430_CONSOLE_USE_EMBTEXTF - 0) || (__MSPGCC__ - 0)
+/** Transmit binary data to the console UART.
+ *
+ * Unlike cputchars(), the octets are passed through unchanged: no
+ * carriage return is inserted ahead of a newline even when
+ * #configBSP430_CONSOLE_USE_ONLCR is set.  The data is queued as a
+ * single block, subject to the policy set by
+ * iBSP430consoleSetTxPolicy_ni().
+ *
+ * @param dp the first octet to transmit
+ *
+ * @param len the number of octets to transmit
+ *
+ * @return the number of octets queued or transmitted
+ *
+ * @consoleoutput */
+int iBSP430consoleTransmitOctets (const uint8_t * dp, size_t len);
 
 /** Like printf(3), but to the console UART.
  *
@@ -355,13 +494,14 @@ int cputchars (const char * cp, size_t len);
  * If xBSP430consoleInitialize() has not assigned a UART device, the
  * call is a no-op.
  *
- * @param format A printf(3) format string
+ * @param format A printf(3) format string, restricted to the
+ * conversions supported by iBSP430formatVprintf()
  *
  * @return Number of characters printed if the console is enabled; 0
  * if it is disabled; a negative error code if an error is
  * encountered
  *
- * @dependency #BSP430_CONSOLE, #BSP430_CONSOLE_USE_EMBTEXTF
+ * @dependency #BSP430_CONSOLE
  *
  * @consoleoutput */
 int cprintf (const char * format, ...)
@@ -376,72 +516,160 @@ __attribute__((__format__(printf, 1, 2)))
  * @param ap A stdarg reference to variable arguments to a calling function.
  * @return as with cprintf().
  *
- * @dependency #BSP430_CONSOLE, #BSP430_CONSOLE_USE_EMBTEXTF
+ * @dependency #BSP430_CONSOLE
  *
  * @consoleoutput */
 int vcprintf (const char * format, va_list ap);
 
-/** Format an int using itoa and emit it to the console.
+/** Format an int and emit it to the console.
  *
- * @param n the integer value to be formatted
- * @param radix the radix to use when formatting
+ * The value is treated as signed only when @p radix is 10.
  *
- * @warning The implementation assumes that @p radix is at least 10.
- * Passing a smaller radix will likely result in stack corruption.
+ * @param n the integer value to be formatted
+ * @param radix the radix to use when formatting, from 2 to 36
  *
  * @return the number of characters emitted
  *
- * @dependency #BSP430_CONSOLE, #BSP430_CONSOLE_USE_EMBTEXTF */
+ * @dependency #BSP430_CONSOLE */
 int cputi (int n, int radix);
 
-/** Format an int using utoa and emit it to the console.
- *
- * @consoleoutput
+/** Format an unsigned int and emit it to the console.
  *
  * @param n the integer value to be formatted
- * @param radix the radix to use when formatting
- *
- * @warning The implementation assumes that the radix is at least 10.
- * Passing a smaller radix will likely result in stack corruption.
+ * @param radix the radix to use when formatting, from 2 to 36
  *
  * @return the number of characters emitted
  *
- * @dependency #BSP430_CONSOLE, #BSP430_CONSOLE_USE_EMBTEXTF
+ * @dependency #BSP430_CONSOLE
  *
  * @consoleoutput */
 int cputu (unsigned int n, int radix);
 
-/** Format an int using ltoa and emit it to the console.
+/** Format a long and emit it to the console.
  *
- * @param n the integer value to be formatted
- * @param radix the radix to use when formatting
+ * The value is treated as signed only when @p radix is 10.
  *
- * @warning The implementation assumes that the radix is at least 10.
- * Passing a smaller radix will likely result in stack corruption.
+ * @param n the integer value to be formatted
+ * @param radix the radix to use when formatting, from 2 to 36
  *
  * @return the number of characters emitted
  *
- * @dependency #BSP430_CONSOLE, #BSP430_CONSOLE_USE_EMBTEXTF
+ * @dependency #BSP430_CONSOLE
  *
  * @consoleoutput */
 int cputl (long n, int radix);
 
-/** Format an int using itoa and emit it to the console.
+/** Format an unsigned long and emit it to the console.
  *
  * @param n the integer value to be formatted
- * @param radix the radix to use when formatting
- *
- * @warning The implementation assumes that the radix is at least 10.
- * Passing a smaller radix will likely result in stack corruption.
+ * @param radix the radix to use when formatting, from 2 to 36
  *
  * @return the number of characters emitted
  *
- * @dependency #BSP430_CONSOLE, #BSP430_CONSOLE_USE_EMBTEXTF
+ * @dependency #BSP430_CONSOLE
  *
  * @consoleoutput */
 int cputul (unsigned long n, int radix);
 
-#endif /* BSP430_CONSOLE_USE_EMBTEXTF */
+/** Define to a true value to have BSP430_CONSOLE_LOG() emit compact
+ * binary records instead of formatted text.
+ *
+ * When enabled, each format string passed to BSP430_CONSOLE_LOG() is
+ * placed in a dedicated @c bsp430_logfmt section of the image and is
+ * never transmitted.  At runtime only a short record identifying the
+ * format and carrying the raw argument values is queued to the
+ * console, avoiding the cost of number formatting on the MCU and
+ * reducing the volume of data transmitted.  The record stream is
+ * converted back to text on the host by @c maintainer/logdecode.py,
+ * which reads the format strings from the ELF image.
+ *
+ * Each record comprises #BSP430_CONSOLE_LOG_RECORD_START, the 16-bit
+ * little-endian offset of the format string within the @c
+ * bsp430_logfmt section, a one-octet payload length, and the payload.
+ * The payload holds the arguments in order, encoded in native
+ * representation at their promoted size; strings are copied inline
+ * with a terminating NUL.  Floating-point conversions are not
+ * supported.
+ *
+ * Binary records are emitted without newline translation and may be
+ * freely interleaved with text output; the decoder passes text
+ * through unchanged.  A record is queued whole or not at all: where
+ * the transmit policy would drop or truncate part of it, the entire
+ * record is discarded and counted by ulBSP430consoleTxDrops_ni().
+ *
+ * This is supported only with GCC toolchains.  Otherwise, or when
+ * this flag is false, BSP430_CONSOLE_LOG() is equivalent to
+ * cprintf().
+ *
+ * @cppflag
+ * @defaulted
+ * @dependency #BSP430_CONSOLE */
+#ifndef configBSP430_CONSOLE_LOG_BINARY
+#define configBSP430_CONSOLE_LOG_BINARY 0
+#endif /* configBSP430_CONSOLE_LOG_BINARY */
+
+/** The octet that introduces a binary log record.
+ *
+ * This is the ASCII record separator, which does not normally appear
+ * in console text.
+ *
+ * @dependency #configBSP430_CONSOLE_LOG_BINARY */
+#define BSP430_CONSOLE_LOG_RECORD_START 0x1E
+
+/** The maximum length of a binary log record, including the four
+ * octet header.
+ *
+ * The record is assembled on the stack of the caller of
+ * BSP430_CONSOLE_LOG().  Arguments that do not fit are omitted, and
+ * inline strings are truncated; the decoder marks missing values.
+ * The value may not exceed 259.
+ *
+ * @defaulted
+ * @dependency #configBSP430_CONSOLE_LOG_BINARY */
+#ifndef BSP430_CONSOLE_LOG_RECORD_MAX
+#define BSP430_CONSOLE_LOG_RECORD_MAX 32
+#endif /* BSP430_CONSOLE_LOG_RECORD_MAX */
+
+#if defined(BSP430_DOXYGEN) || ((configBSP430_CONSOLE_LOG_BINARY - 0) && (BSP430_CORE_TOOLCHAIN_GCC - 0))
+
+/** Emit a binary log record.
+ *
+ * This is the implementation underlying BSP430_CONSOLE_LOG() when
+ * #configBSP430_CONSOLE_LOG_BINARY is enabled.  It should not be
+ * invoked directly: @p format must be located in the @c
+ * bsp430_logfmt section.
+ *
+ * @param format the format string, as stored in the @c bsp430_logfmt
+ * section
+ *
+ * @return the number of octets queued to the console, or a negative
+ * error code if the record was discarded
+ *
+ * @consoleoutput */
+int iBSP430consoleLogRecord_ (const char * format, ...)
+#if (__GNUC__ - 0)
+__attribute__((__format__(printf, 1, 2)))
+#endif /* __GNUC__ */
+;
+
+/** Log a message to the console.
+ *
+ * The arguments are as for cprintf(), except that @p fmt_ must be a
+ * string literal.  When #configBSP430_CONSOLE_LOG_BINARY is enabled
+ * the message is emitted as a binary record to be decoded on the
+ * host; otherwise this is cprintf().
+ *
+ * @dependency #configBSP430_CONSOLE_LOG_BINARY
+ *
+ * @consoleoutput */
+#define BSP430_CONSOLE_LOG(fmt_, ...) do {                              \
+    static const char bsp430_console_log_fmt_[] __attribute__((__section__("bsp430_logfmt"))) = fmt_; \
+    (void)iBSP430consoleLogRecord_(bsp430_console_log_fmt_, ## __VA_ARGS__); \
+  } while (0)
+
+#else /* configBSP430_CONSOLE_LOG_BINARY */
+#define BSP430_CONSOLE_LOG cprintf
+#endif /* configBSP430_CONSOLE_LOG_BINARY */
 
 /** Initialize and return the console serial HAL instance.
  *
@@ -538,7 +766,7 @@ int iBSP430consoleTransmitUseInterrupts_ni (int enablep);
  * function had to suspend (enabling interrupts) in order to obtain
  * that space;
  * @li -1 if @p want_available is larger than
- * #BSP430_CONSOLE_TX_BUFFER_SIZE-1, which is the maximum number of
+ * #BSP430_CONSOLE_TX_BUFFER_SIZE, which is the maximum number of
  * bytes that can be made available.
  *
  * @consoleoutput */
@@ -562,6 +790,139 @@ int iBSP430consoleWaitForTxSpace_ni (int want_available);
  * @consoleoutput */
 int iBSP430consoleFlush (void);
 
+/** Policies for console output when the transmit buffer is full.
+ *
+ * @see iBSP430consoleSetTxPolicy_ni() */
+typedef enum eBSP430consoleTxPolicy {
+  /** Suspend until space is available.  This is the default, and
+   * never loses output, but the time required to emit output is
+   * unbounded. */
+  eBSP430consoleTxPolicy_BLOCK,
+
+  /** Discard output that does not fit.  Each block of output (e.g.,
+   * the text passed to cputtext()) is either queued completely or
+   * discarded completely. */
+  eBSP430consoleTxPolicy_DROP_NEWEST,
+
+  /** Discard the oldest untransmitted output to make room for new
+   * output.  When transmission uses DMA, data already handed to the
+   * DMA channel cannot be discarded; if that does not leave enough
+   * space, the new output is truncated.  While a transfer is in
+   * flight the newest queued output is discarded instead, so that
+   * making room takes the same time however much is kept. */
+  eBSP430consoleTxPolicy_DROP_OLDEST,
+
+  /** Queue as much of each block of output as fits, and discard the
+   * rest. */
+  eBSP430consoleTxPolicy_TRUNCATE,
+} eBSP430consoleTxPolicy;
+
+/** Select how console output behaves when the transmit buffer is full.
+ *
+ * Under any policy other than #eBSP430consoleTxPolicy_BLOCK, console
+ * output functions never suspend, so the time required to emit
+ * output is bounded.  Discarded octets are counted (see
+ * ulBSP430consoleTxDrops_ni()), and #BSP430_CONSOLE_TX_OVERFLOW_MARKER
+ * is queued ahead of the next output accepted after a loss.  The
+ * counts returned by the output functions, such as cputtext() and
+ * cprintf(), include only the characters the policy accepted.
+ *
+ * Formatted output from cprintf() is queued in pieces, so a policy
+ * may discard part of a formatted message.
+ *
+ * The policy only affects interrupt-driven transmission.  Direct
+ * transmission (see iBSP430consoleTransmitUseInterrupts_ni()) always
+ * waits for the UART.  The policy is retained across
+ * iBSP430consoleInitialize().
+ *
+ * @param policy the policy to be used
+ *
+ * @return the previous policy, or -1 if @p policy is not recognized
+ * or #BSP430_CONSOLE_TX_BUFFER_SIZE is zero and @p policy is not
+ * #eBSP430consoleTxPolicy_BLOCK.
+ *
+ * @dependency #BSP430_CONSOLE_TX_BUFFER_SIZE */
+int iBSP430consoleSetTxPolicy_ni (eBSP430consoleTxPolicy policy);
+
+/** Return the number of console output octets that have been
+ * discarded due to the policy set by iBSP430consoleSetTxPolicy_ni().
+ *
+ * @param reset if nonzero, the count is cleared after being read
+ *
+ * @return the number of octets discarded since the count was last
+ * cleared */
+unsigned long ulBSP430consoleTxDrops_ni (int reset);
+
+/** Make room to queue a group of output without suspending.
+ *
+ * Use this when several pieces of output must reach the UART
+ * contiguously, such as the parts of a frame.  On a non-negative
+ * return the caller may queue up to @p len octets, provided
+ * interrupts remain disabled until it has done so, and they will be
+ * accepted in full with nothing else interleaved.
+ *
+ * Under #eBSP430consoleTxPolicy_BLOCK this suspends until the space
+ * is available; if @p len exceeds the buffer it waits for half the
+ * buffer to be free, and the output will suspend while being queued.
+ * Under #eBSP430consoleTxPolicy_DROP_OLDEST queued data is discarded
+ * to make room.  Where the space cannot be made the @p len octets are counted
+ * as dropped, and the caller should discard its output.
+ *
+ * @param len the number of octets the caller intends to queue
+ *
+ * @return 0 if the space was available without suspending, a
+ * positive value if the caller suspended to obtain it, or -1 if the
+ * output should be discarded.  When output is not interrupt-driven
+ * this returns 0.
+ *
+ * @dependency #BSP430_CONSOLE_TX_BUFFER_SIZE */
+int iBSP430consoleReserveTxSpace_ni (size_t len);
+
+/** Flag for vBSP430consoleDump() selecting the number of hexadecimal
+ * digits, up to eight, used to display the address at the start of
+ * each line.  Zero suppresses the address. */
+#define BSP430_CONSOLE_DUMP_ADDRESS(digits_) ((digits_) & 0x0F)
+
+/** Flag for vBSP430consoleDump() requesting an extra space between
+ * each group of @p octets_ octets within a line.  Zero, or a value of
+ * 16 or more, suppresses grouping. */
+#define BSP430_CONSOLE_DUMP_GROUP(octets_) (((octets_) & 0x1F) << 4)
+
+/** Flag for vBSP430consoleDump() requesting that each line end with
+ * the octets displayed as printable characters. */
+#define BSP430_CONSOLE_DUMP_ASCII 0x0200
+
+/** Flag for vBSP430consoleDump() requesting that the octets be
+ * transmitted unaltered, for capture by a host tool, rather than
+ * displayed.  All other flags are ignored. */
+#define BSP430_CONSOLE_DUMP_RAW 0x0400
+
+/** The vBSP430consoleDump() flags used by
+ * vBSP430consoleDisplayMemory(). */
+#define BSP430_CONSOLE_DUMP_DEFAULT (BSP430_CONSOLE_DUMP_ADDRESS(8) | BSP430_CONSOLE_DUMP_GROUP(8) | BSP430_CONSOLE_DUMP_ASCII)
+
+/** Display the contents of a block of memory in a selected layout.
+ *
+ * Each line covers the 16-octet block of addresses containing its
+ * octets, with positions outside the displayed region left blank.
+ * Lines are formatted directly from a table of hexadecimal digits and
+ * each is passed to the console as a single block of output, so
+ * large regions are displayed at close to the UART rate.  Every line
+ * is preceded by a newline, and a final newline follows the last.
+ *
+ * @param dp pointer to start of memory region
+ * @param len number of octets to display
+ * @param base base displayed address for first octet
+ * @param flags a combination of #BSP430_CONSOLE_DUMP_ADDRESS(),
+ * #BSP430_CONSOLE_DUMP_GROUP(), #BSP430_CONSOLE_DUMP_ASCII, and
+ * #BSP430_CONSOLE_DUMP_RAW
+ *
+ * @consoleoutput */
+void vBSP430consoleDump (const uint8_t * dp,
+                         size_t len,
+                         unsigned long base,
+                         unsigned int flags);
+
 /** Display the contents of a block of memory.
  *
  * This function displays on the console the contents of a memory
@@ -571,6 +932,8 @@ int iBSP430consoleFlush (void);
  * followed by up to 16 octet values, followed by the values as
  * printable characters.
  *
+ * This is vBSP430consoleDump() with #BSP430_CONSOLE_DUMP_DEFAULT.
+ *
  * @param dp pointer to start of memory region
  * @param len number of octets to display
  * @param base base displayed address for first octet
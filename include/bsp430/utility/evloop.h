@@ -0,0 +1,295 @@
+/* Copyright 2014, Peter A. Bigot
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the software nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ *
+ * @brief Tickless cooperative event loop
+ *
+ * This module provides the main loop that most applications write by
+ * hand: run whatever work interrupts have requested, then sleep in a
+ * low power mode until another interrupt requests more.
+ *
+ * Work is described by #sBSP430evloopWork structures, each holding a
+ * handler that runs in the main context with interrupts enabled.  An
+ * interrupt callback requests that the handler run by invoking
+ * iBSP430evloopPost() and returning its result, which wakes the
+ * processor.  Posting only stores flags, so it is safe in any context
+ * including nested interrupts, and never disables interrupts.
+ * Posting work that is already pending has no further effect: the
+ * handler runs once and must process everything that accumulated
+ * since it last ran.  This keeps the time spent in interrupt context
+ * to the minimum needed to capture the data, and moves parsing and
+ * protocol processing (e.g. NMEA sentences or CC3000 events) into
+ * the main loop.
+ *
+ * Timed events are #sBSP430evloopTimer structures, which are work
+ * items that are posted by a multiplexed alarm (see @ref
+ * grp_timer_alarm) on the uptime timer.  They may be one-shot or
+ * periodic.  There is no periodic tick: the processor sleeps until
+ * the next timed event or other interrupt.
+ *
+ * When no work is pending vBSP430evloopRun() enters the deepest low
+ * power mode that is safe.  Code that needs a clock to remain active
+ * (e.g. SMCLK for a UART transfer in progress) places a hold on the
+ * corresponding mode using vBSP430evloopLPMHold_ni(), and releases it
+ * when done.  An application idle hook may inspect or override the
+ * choice.
+ *
+ * A host program in @c maintainer/timerhost exercises the loop
+ * against a simulated uptime timer.
+ *
+ * @homepage http://github.com/pabigot/bsp430
+ * @copyright Copyright 2014, Peter A. Bigot.  Licensed under <a href="http://www.opensource.org/licenses/BSD-3-Clause">BSD-3-Clause</a>
+ */
+
+#ifndef BSP430_UTILITY_EVLOOP_H
+#define BSP430_UTILITY_EVLOOP_H
+
+#include <bsp430/core.h>
+#include <bsp430/periph/timer.h>
+#include <bsp430/utility/uptime.h>
+
+/** The capture/compare index on the uptime timer used by the
+ * multiplexed alarm that posts timed events.
+ *
+ * @warning This defaults to the same index as
+ * #BSP430_UPTIME_DELAY_CCIDX.  Applications that use both
+ * #configBSP430_UPTIME_DELAY and this module must assign one of them
+ * a different index.
+ *
+ * @defaulted */
+#ifndef BSP430_EVLOOP_ALARM_CCIDX
+#define BSP430_EVLOOP_ALARM_CCIDX 1
+#endif /* BSP430_EVLOOP_ALARM_CCIDX */
+
+/** The deepest low power mode the event loop will enter, as a level
+ * from 0 (#LPM0_bits) to 4 (#LPM4_bits).
+ *
+ * The default keeps the uptime timer running: LPM3 when it is clocked
+ * from ACLK, otherwise LPM0.
+ *
+ * @defaulted */
+#ifndef BSP430_EVLOOP_LPM_DEEPEST
+#if (TASSEL_1 == (BSP430_UPTIME_TASSEL))
+#define BSP430_EVLOOP_LPM_DEEPEST 3
+#else /* BSP430_UPTIME_TASSEL */
+#define BSP430_EVLOOP_LPM_DEEPEST 0
+#endif /* BSP430_UPTIME_TASSEL */
+#endif /* BSP430_EVLOOP_LPM_DEEPEST */
+
+/* Forward declaration */
+struct sBSP430evloopWork;
+
+/** Function invoked from vBSP430evloopRun() to process posted work.
+ *
+ * It runs in the main context with interrupts enabled.
+ *
+ * @param work the work item that was posted.  The techniques of @ref
+ * callback_appinfo may be used to reach application data. */
+typedef void (* vBSP430evloopHandler) (struct sBSP430evloopWork * work);
+
+/** A unit of deferred work.
+ *
+ * Instances are registered with hBSP430evloopWorkInitialize() and
+ * must remain valid for the life of the application; there is no way
+ * to unregister them. */
+typedef struct sBSP430evloopWork {
+  /** The next registered work item.  Maintained by the
+   * infrastructure. */
+  struct sBSP430evloopWork * next;
+
+  /** The function that processes the work. */
+  vBSP430evloopHandler handler;
+
+  /** Nonzero while the work has been posted and its handler has not
+   * yet been invoked.  Set by iBSP430evloopPost(), cleared by the
+   * event loop immediately before invoking the handler. */
+  volatile unsigned char pending;
+} sBSP430evloopWork;
+
+/** Handle for a work item. */
+typedef sBSP430evloopWork * hBSP430evloopWork;
+
+/** A timed event: a work item posted by a multiplexed alarm. */
+typedef struct sBSP430evloopTimer {
+  /** The work posted when the timer expires.  This is the first
+   * field, so the handler may convert its argument to a pointer to
+   * the timer. */
+  sBSP430evloopWork work;
+
+  /** The alarm that posts the work.  For a periodic timer the alarm
+   * has already been re-armed when the handler runs, so
+   * sBSP430timerMuxAlarm::setting_tck is the uptime at which the
+   * event is next due.  Expirations that occur while the work is
+   * still pending are merged with it. */
+  sBSP430timerMuxAlarm alarm;
+} sBSP430evloopTimer;
+
+/** Handle for a timed event. */
+typedef sBSP430evloopTimer * hBSP430evloopTimer;
+
+/** Function invoked by vBSP430evloopRun() with interrupts disabled
+ * immediately before it sleeps.
+ *
+ * @param lpm_bits the deepest mode that is safe considering the
+ * current holds.
+ *
+ * @return the status register bits for the mode to enter, which
+ * should be no deeper than @p lpm_bits, or zero to return to the
+ * loop without sleeping. */
+typedef unsigned int (* uiBSP430evloopIdleHook_ni) (unsigned int lpm_bits);
+
+/** Prepare the event loop for use.
+ *
+ * This starts the multiplexed alarm on the uptime timer that supports
+ * timed events.  It must be invoked after vBSP430platformInitialize_ni()
+ * and before any other function in this module.
+ *
+ * @return zero on success, or a negative value if the alarm could not
+ * be configured. */
+int iBSP430evloopInitialize (void);
+
+/** Register a work item.
+ *
+ * @param work the structure to be registered.  Its contents are
+ * overwritten.  Registering a structure that is already registered
+ * only updates its handler.
+ *
+ * @param handler the function that processes the work.
+ *
+ * @return the handle for the work item. */
+hBSP430evloopWork hBSP430evloopWorkInitialize (sBSP430evloopWork * work,
+                                               vBSP430evloopHandler handler);
+
+/** Request that a work item be processed.
+ *
+ * This may be invoked from any context, with interrupts enabled or
+ * disabled.  It does not disable interrupts.
+ *
+ * @param work the work to be processed.
+ *
+ * @return #BSP430_HAL_ISR_CALLBACK_EXIT_LPM, so an interrupt callback
+ * can return the value to wake the event loop. */
+int iBSP430evloopPost (hBSP430evloopWork work);
+
+/** Register a timed event.
+ *
+ * @param timer the structure to be registered.  Its contents are
+ * overwritten.
+ *
+ * @param handler the function that processes the event.
+ *
+ * @return the handle for the timed event. */
+hBSP430evloopTimer hBSP430evloopTimerInitialize (sBSP430evloopTimer * timer,
+                                                 vBSP430evloopHandler handler);
+
+/** Schedule a timed event.
+ *
+ * Any previous schedule for @p timer is cancelled.
+ *
+ * @param timer the timed event.
+ *
+ * @param when_utt the uptime at which the event should first be
+ * posted.  If it has already passed the event is posted as soon as
+ * possible.
+ *
+ * @param period_utt the interval at which the event is posted after
+ * the first time, or zero for an event that is posted once.  Periodic
+ * events are scheduled from the time at which the previous event was
+ * due, so they do not drift.
+ *
+ * @return as with iBSP430timerMuxAlarmAddPeriodic_ni(). */
+int iBSP430evloopTimerSchedule_ni (hBSP430evloopTimer timer,
+                                   unsigned long when_utt,
+                                   unsigned long period_utt);
+
+/** Cancel a timed event.
+ *
+ * The event will not be posted again, and if it has been posted but
+ * its handler has not yet run the posting is withdrawn.
+ *
+ * @param timer the timed event.
+ *
+ * @return as with iBSP430timerMuxAlarmRemove_ni(). */
+int iBSP430evloopTimerCancel_ni (hBSP430evloopTimer timer);
+
+/** Prevent the event loop from entering modes deeper than @p level.
+ *
+ * Holds are counted; each must be matched by a call to
+ * vBSP430evloopLPMRelease_ni() with the same level.
+ *
+ * @param level a low power mode level from 0 (#LPM0_bits) to 4
+ * (#LPM4_bits).  Other values are ignored. */
+void vBSP430evloopLPMHold_ni (unsigned int level);
+
+/** Release a hold placed by vBSP430evloopLPMHold_ni().
+ *
+ * @param level the level that was held. */
+void vBSP430evloopLPMRelease_ni (unsigned int level);
+
+/** Return the status register bits for the deepest low power mode
+ * that is permitted by #BSP430_EVLOOP_LPM_DEEPEST and the current
+ * holds. */
+unsigned int uiBSP430evloopLPMBits_ni (void);
+
+/** Install a hook invoked before the event loop sleeps.
+ *
+ * @param hook the hook, or a null pointer to sleep in the mode
+ * selected by uiBSP430evloopLPMBits_ni().
+ *
+ * @return the previous hook. */
+uiBSP430evloopIdleHook_ni xBSP430evloopSetIdleHook_ni (uiBSP430evloopIdleHook_ni hook);
+
+/** Invoke the handlers of all pending work.
+ *
+ * Handlers run in registration order.  Work that is posted while the
+ * handlers run is processed before this returns.  Interrupts are
+ * enabled while the handlers run and the interrupt state is restored
+ * on return.
+ *
+ * @return the number of handlers invoked. */
+int iBSP430evloopRunPending (void);
+
+/** Run the event loop.
+ *
+ * Alternately processes pending work and sleeps until there is more,
+ * until a handler invokes vBSP430evloopStop().  Interrupts are
+ * enabled while the loop runs; the interrupt state is restored on
+ * return.
+ *
+ * @blocking */
+void vBSP430evloopRun (void);
+
+/** Cause vBSP430evloopRun() to return once the handlers of the work
+ * that is currently pending have completed. */
+void vBSP430evloopStop (void);
+
+#endif /* BSP430_UTILITY_EVLOOP_H */
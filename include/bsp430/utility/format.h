@@ -0,0 +1,139 @@
+/* Copyright 2014, Peter A. Bigot
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the software nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ *
+ * @brief Integer conversion and printf-style formatting
+ *
+ * The MSP430 has no divide instruction, and a hardware multiplier is
+ * not present on every device, so the conventional approach of
+ * producing decimal digits by repeated division by ten is slow: each
+ * digit of a 32-bit value costs a library call taking hundreds of
+ * cycles.  The routines here convert decimal values by subtracting
+ * powers of ten from a table, using 16-bit arithmetic once the value
+ * is small enough, and convert power-of-two radixes by shifting.
+ * Division is used only for other radixes.
+ *
+ * iBSP430formatVprintf() uses these routines to implement a compact
+ * subset of printf(3) sufficient for console output, emitting runs of
+ * text rather than individual characters.  It supports the flags @c
+ * -+ #0, field width and precision (including @c *), the length
+ * modifiers @c hh, @c h, @c l, @c ll, and @c z, and the conversions
+ * @c d, @c i, @c u, @c o, @c x, @c X, @c c, @c s, @c p, and @c %.
+ * Floating point conversions consume their argument and emit @c ?.
+ *
+ * @homepage http://github.com/pabigot/bsp430
+ * @copyright Copyright 2014, Peter A. Bigot.  Licensed under <a href="http://www.opensource.org/licenses/BSD-3-Clause">BSD-3-Clause</a>
+ */
+
+#ifndef BSP430_UTILITY_FORMAT_H
+#define BSP430_UTILITY_FORMAT_H
+
+#include <bsp430/core.h>
+#include <stdarg.h>
+
+/** Bit to be combined with the radix passed to
+ * iBSP430formatUnsignedLong() and iBSP430formatUnsignedLongLong() to
+ * request upper-case letters for digits above nine. */
+#define BSP430_FORMAT_RADIX_UPPER 0x0100
+
+/** The size of a buffer sufficient to hold any value converted by
+ * iBSP430formatUnsignedLongLong(), including the terminating NUL. */
+#define BSP430_FORMAT_BUFFER_SIZE (1 + 8 * sizeof(unsigned long long))
+
+/** The size of a buffer sufficient to hold any value converted by
+ * iBSP430formatUnsignedLong(), including the terminating NUL. */
+#define BSP430_FORMAT_LONG_BUFFER_SIZE (1 + 8 * sizeof(unsigned long))
+
+/** Convert an unsigned value to text.
+ *
+ * @param dp where the digits are to be stored, followed by a
+ * terminating NUL.  The buffer must be large enough to hold them;
+ * #BSP430_FORMAT_LONG_BUFFER_SIZE is always sufficient.
+ *
+ * @param value the value to be converted
+ *
+ * @param radix the radix for conversion, between 2 and 36 inclusive,
+ * optionally combined with #BSP430_FORMAT_RADIX_UPPER.  Radix 10 and
+ * powers of two are converted without division.  Other radixes take
+ * a division per digit, 16-bit where the value fits and otherwise
+ * 32-bit; none uses 64-bit arithmetic.
+ *
+ * @return the number of digits stored, or -1 if @p radix is not
+ * valid. */
+int iBSP430formatUnsignedLong (char * dp,
+                               unsigned long value,
+                               int radix);
+
+/** Convert an unsigned long long value to text.
+ *
+ * As with iBSP430formatUnsignedLong(), but with
+ * #BSP430_FORMAT_BUFFER_SIZE always sufficient for @p dp.  Values
+ * that fit in 32 bits are converted at that width.  Larger values in
+ * radixes other than 10 and powers of two are divided as 16-bit
+ * limbs, so there is still no 64-bit division. */
+int iBSP430formatUnsignedLongLong (char * dp,
+                                   unsigned long long value,
+                                   int radix);
+
+/** The type of a function that receives text from
+ * iBSP430formatVprintf().
+ *
+ * @param context the value passed to iBSP430formatVprintf()
+ * @param cp the start of the text to be emitted
+ * @param len the number of characters to be emitted
+ *
+ * @return a negative value to indicate an error; any other value is
+ * ignored. */
+typedef int (* iBSP430formatEmit) (void * context,
+                                   const char * cp,
+                                   size_t len);
+
+/** Format text in the style of vprintf(3).
+ *
+ * Text is passed to @p emit in runs; consecutive literal characters
+ * of @p format, each converted value, and any padding are each
+ * emitted with a single call where possible.
+ *
+ * @param emit the function that receives formatted text
+ * @param context a value passed through to @p emit
+ * @param format a printf(3) format string, restricted as described in
+ * <bsp430/utility/format.h>
+ * @param ap the arguments to be formatted
+ *
+ * @return the number of characters emitted, or the first negative
+ * value returned by @p emit */
+int iBSP430formatVprintf (iBSP430formatEmit emit,
+                          void * context,
+                          const char * format,
+                          va_list ap);
+
+#endif /* BSP430_UTILITY_FORMAT_H */
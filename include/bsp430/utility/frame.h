@@ -0,0 +1,182 @@
+/* Copyright 2014, Peter A. Bigot
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the software nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ *
+ * @brief Multiplexed binary channels framed over the console UART
+ *
+ * This module carries several logical binary channels over the
+ * console UART alongside ordinary console text.  Each message is
+ * prefixed with its channel number, followed by a CRC-16 (polynomial
+ * 0x1021, initial value 0xFFFF, transmitted low octet first), and the
+ * whole is encoded with Consistent Overhead Byte Stuffing (COBS).  The
+ * encoded frame contains no zero octets and is transmitted between
+ * two zero octets, so a receiver can separate frames from text (which
+ * never contains NUL) and resynchronize after any loss.  COBS costs at
+ * most one octet in 254 regardless of content, so binary data is
+ * carried at nearly the line rate.
+ *
+ * Frames are transmitted with iBSP430frameTransmit().  The payload is
+ * copied directly from the caller's buffer into the console transmit
+ * buffer, with the COBS code octets inserted as it goes; no
+ * intermediate encoding buffer is used.  The frame is queued
+ * atomically, so console text emitted from other contexts cannot
+ * corrupt it.
+ *
+ * Received frames are recognized by a callback that iBSP430frameInitialize()
+ * places ahead of the console in the UART receive chain.  Octets
+ * outside a frame continue to the console receive buffer, so a
+ * command-line interface works as before.  Each valid frame is passed,
+ * from the receive interrupt, to the callback registered for its
+ * channel with iBSP430frameSetRxCallback_ni().
+ *
+ * @c maintainer/framedemux.py is a host program that connects to the
+ * target UART and presents the console text and each channel on its
+ * own pseudo-terminal.
+ *
+ * Echo from the cooked line discipline of
+ * #configBSP430_CONSOLE_RX_COOKED is emitted by the receive interrupt,
+ * which cannot run while a frame is queued, so it appears between
+ * frames and never inside one.
+ *
+ * @homepage http://github.com/pabigot/bsp430
+ * @copyright Copyright 2014, Peter A. Bigot.  Licensed under <a href="http://www.opensource.org/licenses/BSD-3-Clause">BSD-3-Clause</a>
+ */
+
+#ifndef BSP430_UTILITY_FRAME_H
+#define BSP430_UTILITY_FRAME_H
+
+#include <bsp430/core.h>
+
+/** The number of channels supported.  Channel numbers range from
+ * zero to one less than this value, which may not exceed 256.
+ *
+ * @defaulted */
+#ifndef BSP430_FRAME_CHANNEL_COUNT
+#define BSP430_FRAME_CHANNEL_COUNT 4
+#endif /* BSP430_FRAME_CHANNEL_COUNT */
+
+/** The maximum payload length of a received frame.  A buffer of
+ * this size plus three octets (for the channel and the CRC) holds the
+ * frame being decoded.  Longer frames are discarded.
+ *
+ * @defaulted */
+#ifndef BSP430_FRAME_RX_PAYLOAD_MAX
+#define BSP430_FRAME_RX_PAYLOAD_MAX 64
+#endif /* BSP430_FRAME_RX_PAYLOAD_MAX */
+
+/** The octet that precedes and follows each encoded frame. */
+#define BSP430_FRAME_DELIMITER 0x00
+
+/** Callback for received frames.
+ *
+ * This is invoked from the console UART receive interrupt for each
+ * frame that arrives intact on the channel for which it is registered.
+ *
+ * @param channel the channel on which the frame arrived
+ *
+ * @param data the payload of the frame.  This is valid only for the
+ * duration of the call.
+ *
+ * @param len the number of octets in the payload
+ *
+ * @return As with iBSP430halISRCallbackVoid_ni(). */
+typedef int (* iBSP430frameRxCallback_ni) (unsigned int channel,
+                                          const uint8_t * data,
+                                          size_t len);
+
+/** Attach the framing layer to the console.
+ *
+ * This must be invoked after iBSP430consoleInitialize().  Until it is
+ * invoked frames may be transmitted, but none are received.
+ *
+ * @return 0 if the framing layer is active, or -1 if there is no
+ * console. */
+int iBSP430frameInitialize (void);
+
+/** Detach the framing layer from the console.
+ *
+ * This must be invoked before iBSP430consoleDeconfigure().
+ *
+ * @return 0 */
+int iBSP430frameDeconfigure (void);
+
+/** Register the callback for frames received on a channel.
+ *
+ * Frames that arrive on a channel with no callback are discarded.
+ *
+ * @param channel the channel of interest
+ *
+ * @param cb the callback to be invoked, or a null pointer to discard
+ * frames received on @p channel
+ *
+ * @return 0 if the callback was registered, or -1 if @p channel is
+ * not valid */
+int iBSP430frameSetRxCallback_ni (unsigned int channel,
+                                  iBSP430frameRxCallback_ni cb);
+
+/** Transmit a frame on a channel.
+ *
+ * Space for the whole encoded frame is obtained with
+ * iBSP430consoleReserveTxSpace_ni(), so the frame is either queued in
+ * full or not at all, according to the console transmit policy.  The
+ * encoded frame occupies at most @p len + 6 + (@p len + 3) / 254
+ * octets.
+ *
+ * As with other console output, this should not be invoked from an
+ * interrupt handler unless the console transmit policy does not
+ * block.
+ *
+ * @param channel the channel on which the frame is sent
+ *
+ * @param data the payload of the frame
+ *
+ * @param len the number of octets in the payload
+ *
+ * @return @p len if the frame was queued, or -1 if it was discarded
+ * or @p channel is not valid
+ *
+ * @consoleoutput */
+int iBSP430frameTransmit (unsigned int channel,
+                          const uint8_t * data,
+                          size_t len);
+
+/** Return the number of received frames that were discarded because
+ * they were malformed, too long, failed the CRC check, or named an
+ * invalid channel.
+ *
+ * @param reset if nonzero, the count is cleared after being read
+ *
+ * @return the number of frames discarded since the count was last
+ * cleared */
+unsigned long ulBSP430frameRxErrors_ni (int reset);
+
+#endif /* BSP430_UTILITY_FRAME_H */
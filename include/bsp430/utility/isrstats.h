@@ -0,0 +1,224 @@
+/* Copyright 2014, Peter A. Bigot
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the software nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ *
+ * @brief Duration histograms for HAL interrupt handlers
+ *
+ * When #configBSP430_ISRSTATS is enabled each HAL interrupt handler
+ * (timer, port, eUSCI, USCI, USCI5, and DMA) reads a free-running
+ * counter after its declarations and again just before it returns.
+ * The difference, which covers the entire callback chain invoked by
+ * iBSP430callbackInvokeISRVoid_ni() or
+ * iBSP430callbackInvokeISRIndexed_ni(), is recorded in a
+ * #sBSP430isrstatsVector belonging to that handler: the number of
+ * invocations, the longest duration, and a histogram with one bucket
+ * for each power of two.  This identifies the vector, and by
+ * disabling callbacks one at a time the chain member, responsible for
+ * exceeding a timing budget.
+ *
+ * The counter is supplied by the application through
+ * vBSP430isrstatsInitialize_ni().  Normally it is the counter
+ * register of a timer in continuous mode clocked from SMCLK, so that
+ * it can be read reliably at any time and durations are in SMCLK
+ * ticks.  Durations are computed modulo 2^16; a handler that runs
+ * longer than a counter period is recorded with the remainder.
+ * Nothing is recorded until a counter has been supplied.
+ *
+ * Only the time spent within the handler is measured.  The delay
+ * between the event and the start of the handler includes the time
+ * interrupts were disabled elsewhere and cannot be determined without
+ * knowing when the event occurred; an application that does know (for
+ * example the capture time of a timer event) can compare it with the
+ * counter at the start of its callback.
+ *
+ * The vectors that have run at least once may be walked from
+ * hBSP430isrstatsFirst_ni().  Their contents may be displayed as text,
+ * or converted to a compact binary form with
+ * iBSP430isrstatsEncode_ni() for transmission with
+ * iBSP430frameTransmit().
+ *
+ * Instrumentation adds a few dozen cycles to every HAL interrupt, so
+ * the feature is disabled by default.  Enabling it requires that the
+ * application link with this module (@c MODULES += utility/isrstats).
+ *
+ * @homepage http://github.com/pabigot/bsp430
+ * @copyright Copyright 2014, Peter A. Bigot.  Licensed under <a href="http://www.opensource.org/licenses/BSD-3-Clause">BSD-3-Clause</a>
+ */
+
+#ifndef BSP430_UTILITY_ISRSTATS_H
+#define BSP430_UTILITY_ISRSTATS_H
+
+#include <bsp430/core.h>
+
+/** Define to a true value to record the duration of each HAL
+ * interrupt handler.  See @ref bsp430/utility/isrstats.h.
+ *
+ * @cppflag
+ * @defaulted */
+#ifndef configBSP430_ISRSTATS
+#define configBSP430_ISRSTATS 0
+#endif /* configBSP430_ISRSTATS */
+
+/** The number of histogram buckets in a #sBSP430isrstatsVector.
+ *
+ * Bucket zero counts durations of zero ticks; bucket @c b for @c b
+ * greater than zero counts durations from 2^(b-1) through 2^b-1
+ * ticks.  Seventeen buckets cover every 16-bit duration. */
+#define BSP430_ISRSTATS_NBUCKETS 17
+
+/** The number of octets in the binary form of a vector produced by
+ * iBSP430isrstatsEncode_ni(), excluding the name.
+ *
+ * The encoding is the invocation count as four octets, the maximum
+ * duration as two octets, and each histogram bucket as two octets,
+ * all least significant octet first; followed by the characters of
+ * the vector name without a terminating NUL. */
+#define BSP430_ISRSTATS_ENCODED_FIXED_LENGTH (4 + 2 + 2 * (BSP430_ISRSTATS_NBUCKETS))
+
+/** Duration statistics for one interrupt handler.
+ *
+ * Instances are created by #BSP430_ISRSTATS_DEFINE_VECTOR() and are
+ * updated only from within the corresponding handler, so they should
+ * be read with interrupts disabled. */
+typedef struct sBSP430isrstatsVector {
+  /** The next vector that has been recorded, in reverse order of
+   * first invocation */
+  struct sBSP430isrstatsVector * next_ni;
+
+  /** The name of the handler, e.g. "TA0" or "PORT1" */
+  const char * name;
+
+  /** Nonzero once the vector has been linked into the list of
+   * recorded vectors */
+  unsigned char linked_ni;
+
+  /** The counter value when the current invocation began */
+  unsigned int start_tt;
+
+  /** The number of invocations recorded */
+  unsigned long count_ni;
+
+  /** The longest duration recorded */
+  unsigned int max_tt;
+
+  /** The number of durations recorded in each bucket.  The counts
+   * saturate rather than wrapping. */
+  unsigned int buckets_ni[BSP430_ISRSTATS_NBUCKETS];
+} sBSP430isrstatsVector;
+
+/** Handle for duration statistics of an interrupt handler. */
+typedef sBSP430isrstatsVector * hBSP430isrstatsVector;
+
+#if (configBSP430_ISRSTATS - 0)
+
+/** Pointer to the counter used for timestamps.
+ *
+ * Do not assign this directly; use vBSP430isrstatsInitialize_ni(). */
+extern volatile unsigned int * xBSP430isrstatsCounter_ni;
+
+/** Define the statistics for an interrupt handler.
+ *
+ * This appears at file scope immediately before the handler.
+ *
+ * @param isr_ the suffix of the handler name, which is also used as
+ * the name of the vector */
+#define BSP430_ISRSTATS_DEFINE_VECTOR(isr_) \
+  static sBSP430isrstatsVector isrstats_##isr_ = { .name = #isr_ };
+
+/** Mark the start of a handler invocation.
+ *
+ * This is the first statement following the declarations of the
+ * handler.
+ *
+ * @param isr_ as passed to #BSP430_ISRSTATS_DEFINE_VECTOR() */
+#define BSP430_ISRSTATS_ENTER_NI(isr_) do {             \
+    isrstats_##isr_.start_tt = *xBSP430isrstatsCounter_ni; \
+  } while (0)
+
+/** Record the duration of a handler invocation.
+ *
+ * This immediately precedes #BSP430_HAL_ISR_CALLBACK_TAIL_NI().  A
+ * handler that returns without reaching it is not recorded.
+ *
+ * @param isr_ as passed to #BSP430_ISRSTATS_DEFINE_VECTOR() */
+#define BSP430_ISRSTATS_EXIT_NI(isr_) vBSP430isrstatsRecord_ni(&isrstats_##isr_)
+
+/** Select the counter used for timestamps and begin recording.
+ *
+ * @param counterp pointer to a 16-bit counter that increments at a
+ * constant rate and can be read without synchronization, such as @c
+ * &BSP430_HPL_TA1->r for a timer in continuous mode clocked from
+ * SMCLK.  Passing a null pointer stops recording. */
+void vBSP430isrstatsInitialize_ni (volatile unsigned int * counterp);
+
+/** Record the end of an invocation of a handler.
+ *
+ * This is invoked through #BSP430_ISRSTATS_EXIT_NI().  It links @p
+ * vector into the list of recorded vectors on its first call.
+ *
+ * @param vector the statistics for the handler */
+void vBSP430isrstatsRecord_ni (hBSP430isrstatsVector vector);
+
+/** Return the most recently linked vector that has been recorded, or
+ * a null pointer if none has.  The remainder are reached through
+ * sBSP430isrstatsVector::next_ni. */
+hBSP430isrstatsVector hBSP430isrstatsFirst_ni (void);
+
+/** Clear the counts, maxima, and histograms of every recorded
+ * vector.  The vectors remain linked. */
+void vBSP430isrstatsReset_ni (void);
+
+/** Store the binary form of a vector.
+ *
+ * See #BSP430_ISRSTATS_ENCODED_FIXED_LENGTH for the format.
+ *
+ * @param vector the statistics to be encoded
+ *
+ * @param buf where the encoding is stored
+ *
+ * @param len the number of octets available at @p buf
+ *
+ * @return the number of octets stored, or -1 if @p len was too
+ * small */
+int iBSP430isrstatsEncode_ni (hBSP430isrstatsVector vector,
+                              uint8_t * buf,
+                              size_t len);
+
+#else /* configBSP430_ISRSTATS */
+
+#define BSP430_ISRSTATS_DEFINE_VECTOR(isr_)
+#define BSP430_ISRSTATS_ENTER_NI(isr_) do { } while (0)
+#define BSP430_ISRSTATS_EXIT_NI(isr_) do { } while (0)
+
+#endif /* configBSP430_ISRSTATS */
+
+#endif /* BSP430_UTILITY_ISRSTATS_H */
@@ -0,0 +1,314 @@
+/* Copyright 2014, Peter A. Bigot
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the software nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ *
+ * @brief Scheduler for transactions on a shared SPI or I2C bus
+ *
+ * Several drivers commonly share one serial peripheral: an M25P flash
+ * and a CC110x radio on one SPI bus, or a humidity sensor, a pressure
+ * sensor, and a real-time clock on one I2C bus.  Each device has its
+ * own requirements for clock divider, SPI clock phase and polarity,
+ * or slave address.  This module owns the @link
+ * sBSP430halSERIAL::resource resource@endlink of the peripheral on
+ * behalf of all of them and serves their transactions one at a time.
+ *
+ * A driver describes the peripheral configuration it needs in a
+ * #sBSP430serialBusConfig, and each unit of work it wishes to do in a
+ * #sBSP430serialBusRequest that names that configuration, a priority,
+ * and a function that starts the work.  Requests are queued with
+ * iBSP430serialBusSubmit_ni().  When the bus is free the scheduler
+ * selects the next request, reconfigures the peripheral if (and only
+ * if) the request needs different settings from those in effect, and
+ * invokes the request's start function.  The driver performs its
+ * transaction by whatever means suits it (programmed I/O,
+ * iBSP430spiTxRxAsync_ni(), or an I2C queue) and invokes
+ * iBSP430serialBusComplete_ni() when it no longer needs the bus,
+ * possibly from an interrupt.  The next request is then started
+ * immediately, so the bus does not sit idle waiting for the
+ * application to notice the completion.
+ *
+ * Requests are served in decreasing order of priority, and in the
+ * order submitted among requests of equal priority, with one
+ * exception: if the request at the head of the queue needs a
+ * different peripheral configuration, a later request of the same
+ * priority that can use the current configuration is served first.
+ * At most #BSP430_SERIALBUS_MAX_BYPASS requests may pass the head of
+ * the queue this way before it is served.  Changing only the slave
+ * address of an I2C bus does not require resetting the peripheral,
+ * and is not treated as a change of configuration.
+ *
+ * The scheduler claims the peripheral resource when there is work
+ * and releases it when the queue empties.  If another subsystem (such
+ * as the console) is waiting for the resource when a request
+ * completes, the resource is released and the remaining requests
+ * wait for it to be returned.  Another holder may change the
+ * peripheral configuration, so the first request started after the
+ * scheduler reclaims the resource always reopens the peripheral.
+ *
+ * @note This module requires #BSP430_SERIAL_ENABLE_RESOURCE.  Drivers
+ * that use the scheduler should not claim the peripheral resource
+ * themselves.
+ *
+ * @homepage http://github.com/pabigot/bsp430
+ * @copyright Copyright 2014, Peter A. Bigot.  Licensed under <a href="http://www.opensource.org/licenses/BSD-3-Clause">BSD-3-Clause</a>
+ */
+
+#ifndef BSP430_UTILITY_SERIALBUS_H
+#define BSP430_UTILITY_SERIALBUS_H
+
+#include <bsp430/core.h>
+#include <bsp430/serial.h>
+#include <bsp430/resource.h>
+
+/** The number of consecutive times the request at the head of the
+ * queue may be passed over in favor of a request of equal priority
+ * that does not require reconfiguring the peripheral.  Zero disables
+ * such reordering.
+ *
+ * @defaulted */
+#ifndef BSP430_SERIALBUS_MAX_BYPASS
+#define BSP430_SERIALBUS_MAX_BYPASS 4
+#endif /* BSP430_SERIALBUS_MAX_BYPASS */
+
+/** Value of sBSP430serialBusConfig::mode for a SPI bus */
+#define BSP430_SERIALBUS_MODE_SPI 1
+
+/** Value of sBSP430serialBusConfig::mode for an I2C bus */
+#define BSP430_SERIALBUS_MODE_I2C 2
+
+/** Value of sBSP430serialBusRequest::state_ni for a request that is
+ * neither queued nor being served. */
+#define BSP430_SERIALBUS_STATE_IDLE 0
+
+/** Value of sBSP430serialBusRequest::state_ni for a request that is
+ * waiting for the bus. */
+#define BSP430_SERIALBUS_STATE_QUEUED 1
+
+/** Value of sBSP430serialBusRequest::state_ni for a request that
+ * holds the bus. */
+#define BSP430_SERIALBUS_STATE_ACTIVE 2
+
+/** The peripheral configuration required by a device on the bus.
+ *
+ * Instances are normally constant and shared by all requests for the
+ * same device.  Two configurations with identical field values are
+ * equivalent; they need not be the same object. */
+typedef struct sBSP430serialBusConfig {
+  /** #BSP430_SERIALBUS_MODE_SPI or #BSP430_SERIALBUS_MODE_I2C,
+   * selecting hBSP430serialOpenSPI() or hBSP430serialOpenI2C() */
+  unsigned char mode;
+
+  /** The @p ctl0_byte parameter to the open function, e.g. produced
+   * by #BSP430_SERIAL_ADJUST_CTL0_INITIALIZER() */
+  unsigned char ctl0_byte;
+
+  /** The @p ctl1_byte parameter to the open function, e.g. selecting
+   * the clock source */
+  unsigned char ctl1_byte;
+
+  /** The @p prescaler parameter to the open function */
+  unsigned int prescaler;
+
+  /** For I2C, the slave address set with
+   * iBSP430i2cSetAddresses_rh().  A negative value leaves the slave
+   * address unchanged.  Ignored for SPI. */
+  int slave_address;
+} sBSP430serialBusConfig;
+
+struct sBSP430serialBus;
+struct sBSP430serialBusRequest;
+
+/** Function invoked when a request is given the bus.
+ *
+ * This is invoked with interrupts disabled, possibly from within
+ * iBSP430serialBusSubmit_ni(), iBSP430serialBusComplete_ni(), or an
+ * interrupt that released the peripheral resource.  It should start
+ * the work of the request and return; it must not block waiting for
+ * an interrupt.  When the request no longer needs the bus the driver
+ * must invoke iBSP430serialBusComplete_ni(), either from within this
+ * function or later.  This is required even if @p hal is null.
+ *
+ * @param bus the bus on which the request is served
+ *
+ * @param request the request that now holds the bus
+ *
+ * @param hal the peripheral, configured as described by
+ * sBSP430serialBusRequest::config, or a null pointer if the
+ * peripheral could not be configured
+ *
+ * @return As with iBSP430halISRCallbackVoid_ni().  The value is
+ * incorporated into the return value of the function that started
+ * the request. */
+typedef int (* iBSP430serialBusStart_ni) (struct sBSP430serialBus * bus,
+                                          struct sBSP430serialBusRequest * request,
+                                          hBSP430halSERIAL hal);
+
+/** A unit of work that requires exclusive use of the bus.
+ *
+ * Drivers generally embed this structure in their own state and
+ * recover that from @p request in the start function.  The same
+ * request may be resubmitted once it has completed. */
+typedef struct sBSP430serialBusRequest {
+  /** The configuration the request requires.  This must remain valid
+   * while the request is queued or active. */
+  const sBSP430serialBusConfig * config;
+
+  /** The function that starts the request when it is given the bus */
+  iBSP430serialBusStart_ni start_ni;
+
+  /** Scheduling priority; larger values are served first */
+  unsigned char priority;
+
+  /** One of #BSP430_SERIALBUS_STATE_IDLE,
+   * #BSP430_SERIALBUS_STATE_QUEUED, or
+   * #BSP430_SERIALBUS_STATE_ACTIVE.  Maintained by the scheduler. */
+  volatile unsigned char state_ni;
+
+  /** The next request in the queue.  Maintained by the scheduler. */
+  struct sBSP430serialBusRequest * volatile next_ni;
+} sBSP430serialBusRequest;
+
+/** Handle for a bus request */
+typedef sBSP430serialBusRequest * hBSP430serialBusRequest;
+
+/** State of a scheduler for a shared serial peripheral.
+ *
+ * Initialize with hBSP430serialBusInitialize_ni().  The fields are
+ * maintained by the scheduler and should not be modified by the
+ * application. */
+typedef struct sBSP430serialBus {
+  /** The shared peripheral */
+  hBSP430halSERIAL hal;
+
+  /** Registered on the peripheral resource while the scheduler has
+   * queued work but the resource is held by another subsystem */
+  sBSP430resourceWaiter waiter;
+
+  /** The configuration currently in effect on the peripheral, if @a
+   * configured_ni is nonzero */
+  sBSP430serialBusConfig config_ni;
+
+  /** Nonzero if the scheduler has configured the peripheral and it
+   * has not since been released to another subsystem */
+  unsigned char configured_ni;
+
+  /** Nonzero while the scheduler holds the peripheral resource */
+  unsigned char held_ni;
+
+  /** Nonzero while requests are being started, to avoid recursion
+   * when a request completes within its start function */
+  unsigned char dispatching_ni;
+
+  /** The number of times the current head of the queue has been
+   * passed over */
+  unsigned char bypass_ni;
+
+  /** The request that holds the bus, if any */
+  hBSP430serialBusRequest active_ni;
+
+  /** Queued requests in the order they will be considered */
+  volatile hBSP430serialBusRequest head_ni;
+
+  /** The number of times the peripheral has been opened with a new
+   * configuration */
+  unsigned long reconfigurations;
+
+  /** The number of requests that have been started */
+  unsigned long requests;
+} sBSP430serialBus;
+
+/** Handle for a bus scheduler */
+typedef sBSP430serialBus * hBSP430serialBus;
+
+/** Prepare a scheduler for the given peripheral.
+ *
+ * The peripheral is not opened until the first request is started.
+ *
+ * @param bus the scheduler state
+ *
+ * @param hal the shared peripheral
+ *
+ * @return @p bus, or a null pointer if either parameter is null */
+hBSP430serialBus hBSP430serialBusInitialize_ni (hBSP430serialBus bus,
+                                                hBSP430halSERIAL hal);
+
+/** Queue a request for the bus.
+ *
+ * The request is placed after all queued requests of equal or higher
+ * priority.  If the bus is free the request is started before this
+ * returns.
+ *
+ * @param bus the scheduler for the bus
+ *
+ * @param request the request to be served.  sBSP430serialBusRequest::config,
+ * sBSP430serialBusRequest::start_ni, and
+ * sBSP430serialBusRequest::priority must be set.
+ *
+ * @return -1 if @p request is already queued or active, or lacks a
+ * configuration or start function; otherwise the (non-negative)
+ * value returned by any start functions invoked, as with
+ * iBSP430halISRCallbackVoid_ni(). */
+int iBSP430serialBusSubmit_ni (hBSP430serialBus bus,
+                               hBSP430serialBusRequest request);
+
+/** Indicate that the active request no longer needs the bus.
+ *
+ * The next queued request, if any, is started before this returns.
+ * This may be invoked from within the start function of @p request,
+ * or from an interrupt.
+ *
+ * @param bus the scheduler for the bus
+ *
+ * @param request the request that holds the bus
+ *
+ * @return -1 if @p request is not the active request on @p bus;
+ * otherwise the value returned by any start functions invoked, or by
+ * the waiter notified on release of the peripheral resource, as with
+ * iBSP430halISRCallbackVoid_ni(). */
+int iBSP430serialBusComplete_ni (hBSP430serialBus bus,
+                                 hBSP430serialBusRequest request);
+
+/** Remove a request from the queue.
+ *
+ * @param bus the scheduler for the bus
+ *
+ * @param request a request that was submitted to @p bus
+ *
+ * @return -1 if @p request is active; an active request must be
+ * completed with iBSP430serialBusComplete_ni().  Otherwise 0, or if
+ * removing @p request left the queue empty while the scheduler was
+ * waiting for the peripheral resource, the value returned by
+ * iBSP430resourceCancelWait_ni(). */
+int iBSP430serialBusCancel_ni (hBSP430serialBus bus,
+                               hBSP430serialBusRequest request);
+
+#endif /* BSP430_UTILITY_SERIALBUS_H */
@@ -0,0 +1,263 @@
+/* Copyright 2014, Peter A. Bigot
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the software nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ *
+ * @brief UART reception through a double-buffered DMA channel
+ *
+ * At 115200 baud a UART receiving continuously interrupts the CPU
+ * more than eleven thousand times a second, once per octet.  This
+ * module instead has a DMA channel move each received octet from the
+ * UART receive buffer into memory, and interrupts the CPU only when
+ * a block of octets is ready.
+ *
+ * The application provides a buffer of twice
+ * sBSP430uartRxDMA::half_len octets.  The channel fills the first
+ * half, then the second, then the first again, indefinitely.  The
+ * MSP430 DMA controller has no half-transfer interrupt, so each half
+ * is a complete transfer of its own: the channel runs in repeated
+ * single transfer mode, and when it completes a half the service
+ * routine points the destination address register back at that half
+ * while the controller fills the other.  The newly completed half is
+ * then passed to sBSP430uartRxDMA::callback_ni with
+ * #BSP430_UARTRXDMA_EVENT_HALF (first half) or
+ * #BSP430_UARTRXDMA_EVENT_FULL (second half).
+ *
+ * Data rarely arrives in multiples of the half length.  A GPS
+ * receiver emits a burst of sentences once a second and then falls
+ * silent.  To avoid holding the tail of a burst until the next one
+ * arrives, a timer alarm on sBSP430uartRxDMA::idle_timer inspects the
+ * channel every sBSP430uartRxDMA::idle_tck ticks.  When no octet has
+ * arrived since the previous inspection, the octets received but not
+ * yet delivered are passed to the callback with
+ * #BSP430_UARTRXDMA_EVENT_IDLE.  Data is therefore delivered after
+ * the line has been idle for between one and two alarm periods.
+ * Three or four character times is a reasonable period.  The UART
+ * has no idle-line interrupt in asynchronous mode, so the alarm runs
+ * for as long as the receiver does; its cost is one short interrupt
+ * per period regardless of traffic, instead of one per octet.
+ *
+ * Each octet is delivered exactly once, in order.  A delivery never
+ * spans the two halves of the buffer.  The data passed to the
+ * callback remains valid only until the channel refills that half,
+ * so consumers must finish with it (or copy it) within
+ * sBSP430uartRxDMA::half_len character times.  The same limit
+ * applies to the latency of the DMA interrupt: if the channel
+ * completes a half before the service routine has handled the
+ * completion of the previous one, received data is overwritten.
+ *
+ * Existing consumers that process one octet at a time from the
+ * UART's @link sBSP430halSERIAL::rx_cbchain_ni receive callback
+ * chain@endlink, such as the console and the SkyTraq NMEA parser,
+ * need not change: use iBSP430uartRxDMAReplay_ni() as the callback,
+ * and it feeds each delivered octet through that chain as the UART
+ * interrupt would have.
+ *
+ * While the receiver runs the UART receive interrupt is disabled, as
+ * it and the DMA channel would otherwise compete for octets.  The
+ * UART must not be reset, nor its hold released, until
+ * iBSP430uartRxDMAStop_ni() has been invoked, because that
+ * re-enables the receive interrupt when a receive callback chain is
+ * installed.
+ *
+ * @note This module requires #configBSP430_HAL_DMA and is supported
+ * only on 5xx/FR5xx MCUs with a DMAX controller.  The UART must be
+ * an eUSCI_A or a 5xx USCI_A.
+ *
+ * @homepage http://github.com/pabigot/bsp430
+ * @copyright Copyright 2014, Peter A. Bigot.  Licensed under <a href="http://www.opensource.org/licenses/BSD-3-Clause">BSD-3-Clause</a>
+ */
+
+#ifndef BSP430_UTILITY_UARTRXDMA_H
+#define BSP430_UTILITY_UARTRXDMA_H
+
+#include <bsp430/core.h>
+#include <bsp430/serial.h>
+#include <bsp430/periph/dma.h>
+#include <bsp430/periph/timer.h>
+
+/** Event passed to sBSP430uartRxDMA::callback_ni when the channel
+ * has filled the first half of the buffer. */
+#define BSP430_UARTRXDMA_EVENT_HALF 1
+
+/** Event passed to sBSP430uartRxDMA::callback_ni when the channel
+ * has filled the second half of the buffer. */
+#define BSP430_UARTRXDMA_EVENT_FULL 2
+
+/** Event passed to sBSP430uartRxDMA::callback_ni when the line has
+ * been idle for at least sBSP430uartRxDMA::idle_tck ticks. */
+#define BSP430_UARTRXDMA_EVENT_IDLE 3
+
+/** Event passed to sBSP430uartRxDMA::callback_ni for data delivered
+ * by iBSP430uartRxDMAFlush_ni() or iBSP430uartRxDMAStop_ni(). */
+#define BSP430_UARTRXDMA_EVENT_FLUSH 4
+
+struct sBSP430uartRxDMA;
+
+/** Function that consumes received data.
+ *
+ * Invoked from interrupt context with interrupts disabled.
+ *
+ * @param rxd the receiver that received the data
+ *
+ * @param data the first octet not previously delivered
+ *
+ * @param len the number of octets at @p data; always positive
+ *
+ * @param event one of #BSP430_UARTRXDMA_EVENT_HALF,
+ * #BSP430_UARTRXDMA_EVENT_FULL, #BSP430_UARTRXDMA_EVENT_IDLE, or
+ * #BSP430_UARTRXDMA_EVENT_FLUSH, indicating why the data is being
+ * delivered
+ *
+ * @return As with #iBSP430halISRCallbackVoid_ni.
+ * #BSP430_HAL_ISR_CALLBACK_DISABLE_INTERRUPT is ignored. */
+typedef int (* iBSP430uartRxDMACallback_ni) (struct sBSP430uartRxDMA * rxd,
+                                             const uint8_t * data,
+                                             unsigned int len,
+                                             int event);
+
+/** State for UART reception through DMA.
+ *
+ * The application initializes the fields up to and including
+ * #idle_tck before invoking iBSP430uartRxDMAStart_ni(), and must not
+ * change them while the receiver runs.  The remaining fields are
+ * maintained by the module. */
+typedef struct sBSP430uartRxDMA {
+  /** The UART from which data is received.  It must already be
+   * configured and out of reset. */
+  hBSP430halSERIAL uart;
+
+  /** The DMA channel used to move octets from the UART */
+  unsigned char dma_channel;
+
+  /** The DMA trigger select value for the receive flag of #uart,
+   * e.g. @c DMA0TSEL__UCA0RXIFG. */
+  unsigned char dma_trigger;
+
+  /** Index of the capture/compare register of #idle_timer used for
+   * the idle alarm */
+  unsigned char idle_ccidx;
+
+  /** Buffer of at least twice #half_len octets */
+  uint8_t * buffer;
+
+  /** The number of octets in each half of #buffer */
+  unsigned int half_len;
+
+  /** Function invoked to consume received data */
+  iBSP430uartRxDMACallback_ni callback_ni;
+
+  /** The timer used to detect an idle line, or #BSP430_PERIPH_NONE
+   * to deliver data only when a half of the buffer fills.  The timer
+   * must be running and have its HAL and interrupt support enabled. */
+  tBSP430periphHandle idle_timer;
+
+  /** The interval, in ticks of #idle_timer, at which the channel is
+   * inspected for an idle line */
+  unsigned int idle_tck;
+
+  /** Number of octets delivered to #callback_ni */
+  unsigned long octets;
+
+  /** Number of invocations of #callback_ni */
+  unsigned long deliveries;
+
+  /** @cond DOXYGEN_EXCLUDE */
+  sBSP430halISRIndexedChainNode dma_cb;
+  sBSP430timerAlarm idle_alarm;
+  hBSP430timerAlarm idle_alarmh;
+  volatile unsigned char * iep;
+  volatile unsigned char * ifgp;
+  /* The half of the buffer the channel is filling */
+  unsigned char fill_ni;
+  /* Octets of the filling half that have been delivered */
+  unsigned int delivered_ni;
+  /* Octets of the filling half received as of the previous idle
+   * inspection */
+  unsigned int idle_seen_ni;
+  /** @endcond */
+} sBSP430uartRxDMA;
+
+/** Begin receiving from a UART through DMA.
+ *
+ * Configures the DMA channel, disables the UART receive interrupt,
+ * and starts the idle alarm.  Any octet already waiting in the UART
+ * receive buffer is the first one received.
+ *
+ * @param rxd the receiver, with its configuration fields set
+ *
+ * @return 0 if reception began, or -1 if the configuration is
+ * invalid: the UART is not a supported variant, the channel does not
+ * exist, a required field is missing, or the idle alarm could not be
+ * set. */
+int iBSP430uartRxDMAStart_ni (sBSP430uartRxDMA * rxd);
+
+/** Stop receiving through DMA.
+ *
+ * Disables the DMA channel and the idle alarm, and delivers all
+ * received data not previously delivered.  If a receive callback
+ * chain is installed on the UART its receive interrupt is
+ * re-enabled, returning it to octet-at-a-time reception.
+ *
+ * @param rxd a receiver started with iBSP430uartRxDMAStart_ni()
+ *
+ * @return the bits returned by the callback, excluding
+ * #BSP430_HAL_ISR_CALLBACK_DISABLE_INTERRUPT. */
+int iBSP430uartRxDMAStop_ni (sBSP430uartRxDMA * rxd);
+
+/** Deliver received data without waiting for a half to fill or the
+ * line to go idle.
+ *
+ * Data in a half the channel has just completed is left to the DMA
+ * interrupt, which is pending and delivers it.
+ *
+ * @param rxd a running receiver
+ *
+ * @return the bits returned by the callback, excluding
+ * #BSP430_HAL_ISR_CALLBACK_DISABLE_INTERRUPT, or zero if there was
+ * nothing to deliver. */
+int iBSP430uartRxDMAFlush_ni (sBSP430uartRxDMA * rxd);
+
+/** A #iBSP430uartRxDMACallback_ni that passes each octet through the
+ * @link sBSP430halSERIAL::rx_cbchain_ni receive callback
+ * chain@endlink of sBSP430uartRxDMA::uart, as the UART receive
+ * interrupt would have.
+ *
+ * Each octet is stored in @link sBSP430halSERIAL::rx_byte
+ * rx_byte@endlink before the chain is invoked.  Return values of the
+ * chain are combined; #BSP430_HAL_ISR_CALLBACK_BREAK_CHAIN applies
+ * only to the octet for which it was returned. */
+int iBSP430uartRxDMAReplay_ni (sBSP430uartRxDMA * rxd,
+                               const uint8_t * data,
+                               unsigned int len,
+                               int event);
+
+#endif /* BSP430_UTILITY_UARTRXDMA_H */
@@ -363,12 +363,27 @@ ulBSP430uptime_ni (void)
   return ulBSP430timerCounter_ni(hBSP430uptimeTimer(), 0);
 }
 
-/** Return the system uptime in clock ticks. */
+/** Return the system uptime in clock ticks as a value that does not
+ * wrap in the life of the application.
+ *
+ * This may be invoked in any context and does not disable
+ * interrupts.  See ullBSP430timerCounter(). */
+static BSP430_CORE_INLINE
+unsigned long long
+ullBSP430uptime (void)
+{
+  return ullBSP430timerCounter(hBSP430uptimeTimer());
+}
+
+/** Return the system uptime in clock ticks.
+ *
+ * This may be invoked in any context and does not disable
+ * interrupts.  See ullBSP430timerCounter(). */
 static BSP430_CORE_INLINE
 unsigned long
 ulBSP430uptime (void)
 {
-  return ulBSP430timerCounter(hBSP430uptimeTimer(), 0);
+  return (unsigned long)ullBSP430timerCounter(hBSP430uptimeTimer());
 }
 
 /** Return the low word of the system uptime counter.
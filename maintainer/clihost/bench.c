@@ -0,0 +1,263 @@
+/* Throughput benchmark for the BSP430 CLI matcher.
+ *
+ * Synthetic command trees of configurable fan-out and depth are built
+ * both as linked lists (in arbitrary key order) and as arrays sorted
+ * for #configBSP430_CLI_COMMAND_INDEX.  For each form the benchmark
+ * reports how many complete commands iBSP430cliExecuteCommand()
+ * dispatches per second, the mean, 99th percentile, and worst-case
+ * latency of
+ * iBSP430cliCommandCompletion() on partial commands, and the rate at
+ * which keystrokes pass through iBSP430cliConsoleBufferProcessInput().
+ *
+ * Usage: clibench [fanout [depth [commands]]] */
+
+#include <bsp430/platform.h>
+#include <bsp430/utility/console.h>
+#include <bsp430/utility/cli.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define KEY_LEN 5
+
+static unsigned long executed;
+
+static int
+cmd_leaf (sBSP430cliCommandLink * chain,
+          void * param,
+          const char * argstr,
+          size_t argstr_len)
+{
+  ++executed;
+  return 0;
+}
+
+static unsigned long rng_state = 1;
+
+static unsigned long
+rng (void)
+{
+  rng_state = rng_state * 1103515245UL + 12345UL;
+  return (rng_state >> 16) & 0x7FFF;
+}
+
+static double
+now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (1e9 * ts.tv_sec) + ts.tv_nsec;
+}
+
+/* Keys for one sibling set: distinct, equal length (so none is a
+ * prefix of another), sharing leading characters so that partial
+ * keys match several candidates. */
+static char *
+makeKeys (unsigned int fanout)
+{
+  char * keys = malloc(fanout * (KEY_LEN + 1));
+  unsigned int i;
+
+  for (i = 0; i < fanout; ++i) {
+    /* A scrambled index so link order differs from sorted order */
+    unsigned int v = (i * 7919U) % fanout;
+    char * kp = keys + i * (KEY_LEN + 1);
+    int ci;
+
+    kp[0] = 'c';
+    for (ci = KEY_LEN - 1; 0 < ci; --ci) {
+      kp[ci] = 'a' + (v % 26);
+      v /= 26;
+    }
+    kp[KEY_LEN] = 0;
+  }
+  return keys;
+}
+
+static int
+compareDouble (const void * a,
+               const void * b)
+{
+  double da = *(const double *)a;
+  double db = *(const double *)b;
+
+  return (da > db) - (da < db);
+}
+
+static int
+compareKeys (const void * a,
+             const void * b)
+{
+  return strcmp(a, b);
+}
+
+/* Build one level of the tree.  Members of the sBSP430cliCommand
+ * structure are const, so each is composed and then copied into
+ * place. */
+static const sBSP430cliCommand *
+buildSet (const char * keys,
+          unsigned int fanout,
+          unsigned int depth,
+          int indexed)
+{
+  sBSP430cliCommand * set = malloc(fanout * sizeof(*set));
+  char * sorted = NULL;
+  unsigned int i;
+
+  if (indexed) {
+    sorted = malloc(fanout * (KEY_LEN + 1));
+    memcpy(sorted, keys, fanout * (KEY_LEN + 1));
+    qsort(sorted, fanout, KEY_LEN + 1, compareKeys);
+    keys = sorted;
+  }
+  for (i = 0; i < fanout; ++i) {
+    sBSP430cliCommand cmd = {
+      .key = keys + i * (KEY_LEN + 1),
+      .child = (1 < depth) ? buildSet(keys, fanout, depth - 1, indexed) : NULL,
+      .next = ((i + 1) < fanout) ? (set + i + 1) : NULL,
+      .handler = (1 < depth) ? NULL : cmd_leaf,
+#if (configBSP430_CLI_COMMAND_INDEX - 0)
+      .indexed_count = (indexed && (0 == i)) ? fanout : 0,
+#endif /* configBSP430_CLI_COMMAND_INDEX */
+    };
+    memcpy(set + i, &cmd, sizeof(cmd));
+  }
+  return set;
+}
+
+/* A random full command, or a random partial command when partial is
+ * nonzero. */
+static void
+makeCommand (char * buffer,
+             const char * keys,
+             unsigned int fanout,
+             unsigned int depth,
+             int partial)
+{
+  unsigned int level;
+  char * bp = buffer;
+
+  for (level = 0; level < depth; ++level) {
+    const char * kp = keys + (rng() % fanout) * (KEY_LEN + 1);
+    size_t len = KEY_LEN;
+
+    if (partial && ((level + 1) == depth)) {
+      len = 1 + rng() % KEY_LEN;
+    }
+    memcpy(bp, kp, len);
+    bp += len;
+    if ((level + 1) < depth) {
+      *bp++ = ' ';
+    }
+  }
+  if (! partial) {
+    strcpy(bp, " 1 2 3");
+  } else {
+    *bp = 0;
+  }
+}
+
+static void
+runBench (const char * label,
+          const sBSP430cliCommand * set,
+          char * const * commands,
+          char * const * partials,
+          unsigned int ncommands)
+{
+  const char * candidates[BSP430_CLI_CONSOLE_BUFFER_MAX_COMPLETIONS];
+  double * latency = malloc(ncommands * sizeof(*latency));
+  double t0;
+  double elapsed;
+  unsigned int i;
+  int pass;
+  unsigned long keystrokes = 0;
+
+  executed = 0;
+  t0 = now_ns();
+  for (i = 0; i < ncommands; ++i) {
+    (void)iBSP430cliExecuteCommand(set, NULL, commands[i]);
+  }
+  elapsed = now_ns() - t0;
+  if (executed != ncommands) {
+    fprintf(stderr, "%s: executed %lu of %u commands\n", label, executed, ncommands);
+    exit(EXIT_FAILURE);
+  }
+  printf("%-8s execute    %10.0f commands/s  %8.1f ns/command\n",
+         label, ncommands / (elapsed * 1e-9), elapsed / ncommands);
+
+  /* The first pass warms caches and is not timed */
+  for (pass = 0; pass < 2; ++pass) {
+    elapsed = 0;
+    for (i = 0; i < ncommands; ++i) {
+      sBSP430cliCompletionData ccd;
+
+      memset(&ccd, 0, sizeof(ccd));
+      ccd.command = partials[i];
+      ccd.command_set = set;
+      ccd.returned_candidates = candidates;
+      ccd.max_returned_candidates = sizeof(candidates)/sizeof(*candidates);
+      t0 = now_ns();
+      (void)iBSP430cliCommandCompletion(&ccd);
+      latency[i] = now_ns() - t0;
+      elapsed += latency[i];
+    }
+  }
+  qsort(latency, ncommands, sizeof(*latency), compareDouble);
+  printf("%-8s complete   %10.1f ns mean  %8.1f ns p99  %8.1f ns worst\n",
+         label, elapsed / ncommands, latency[(99UL * ncommands) / 100], latency[ncommands - 1]);
+
+  t0 = now_ns();
+  for (i = 0; i < ncommands; ++i) {
+    const char * cp = commands[i];
+
+    vBSP430cliConsoleBufferClear();
+    while (*cp) {
+      vClihostSetInput((const uint8_t *)cp++, 1);
+      (void)iBSP430cliConsoleBufferProcessInput();
+      ++keystrokes;
+    }
+  }
+  elapsed = now_ns() - t0;
+  vBSP430cliConsoleBufferClear();
+  printf("%-8s keystroke  %10.0f keys/s      %8.1f ns/key\n",
+         label, keystrokes / (elapsed * 1e-9), elapsed / keystrokes);
+  free(latency);
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  unsigned int fanout = (1 < argc) ? strtoul(argv[1], NULL, 0) : 64;
+  unsigned int depth = (2 < argc) ? strtoul(argv[2], NULL, 0) : 3;
+  unsigned int ncommands = (3 < argc) ? strtoul(argv[3], NULL, 0) : 100000;
+  size_t command_size = depth * (KEY_LEN + 1) + 8;
+  char ** commands;
+  char ** partials;
+  char * keys;
+  unsigned int i;
+
+  if ((0 == fanout) || (0 == depth) || (BSP430_CLI_CONSOLE_BUFFER_SIZE < command_size)) {
+    fprintf(stderr, "usage: %s [fanout [depth [commands]]]\n"
+            "depth limited by BSP430_CLI_CONSOLE_BUFFER_SIZE (%u)\n",
+            argv[0], (unsigned int)BSP430_CLI_CONSOLE_BUFFER_SIZE);
+    return EXIT_FAILURE;
+  }
+  keys = makeKeys(fanout);
+  commands = malloc(ncommands * sizeof(*commands));
+  partials = malloc(ncommands * sizeof(*partials));
+  for (i = 0; i < ncommands; ++i) {
+    commands[i] = malloc(command_size);
+    makeCommand(commands[i], keys, fanout, depth, 0);
+    partials[i] = malloc(command_size);
+    makeCommand(partials[i], keys, fanout, depth, 1);
+  }
+  printf("fanout %u depth %u: %u commands\n", fanout, depth, ncommands);
+  runBench("linked", buildSet(keys, fanout, depth, 0), commands, partials, ncommands);
+#if (configBSP430_CLI_COMMAND_INDEX - 0)
+  runBench("indexed", buildSet(keys, fanout, depth, 1), commands, partials, ncommands);
+#endif /* configBSP430_CLI_COMMAND_INDEX */
+  return EXIT_SUCCESS;
+}
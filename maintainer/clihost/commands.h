@@ -0,0 +1,105 @@
+/* Generated by maintainer/clitable.py from commands.cli.  Do not edit. */
+
+static const sBSP430cliCommand clihost_commands_complete[] = {
+  { .key = "common",
+    .next = clihost_commands_complete + 1,
+    .handler = iBSP430cliHandlerSimple,
+    .param.simple_handler = cmd_dummy,
+    BSP430_CLI_COMMAND_INDEXED_COUNT(2)
+  },
+  { .key = "component",
+    .handler = iBSP430cliHandlerSimple,
+    .param.simple_handler = cmd_dummy
+  },
+};
+
+static const sBSP430cliCommand clihost_commands_hup_two_three[] = {
+  { .key = "four",
+    .handler = iBSP430cliHandlerSimple,
+    .param.simple_handler = cmd_dummy,
+    BSP430_CLI_COMMAND_INDEXED_COUNT(1)
+  },
+};
+
+static const sBSP430cliCommand clihost_commands_hup_two[] = {
+  { .key = "three",
+    .child = clihost_commands_hup_two_three,
+    BSP430_CLI_COMMAND_INDEXED_COUNT(1)
+  },
+};
+
+static const sBSP430cliCommand clihost_commands_hup[] = {
+  { .key = "two",
+    .child = clihost_commands_hup_two,
+    .handler = iBSP430cliHandlerSimple,
+    .param.simple_handler = cmd_dummy,
+    BSP430_CLI_COMMAND_INDEXED_COUNT(1)
+  },
+};
+
+static const sBSP430cliCommand clihost_commands_set[] = {
+  { .key = "all",
+    .next = clihost_commands_set + 1,
+    .handler = iBSP430cliHandlerSimple,
+    .param.simple_handler = cmd_set_all,
+    BSP430_CLI_COMMAND_INDEXED_COUNT(5)
+  },
+  { .key = "ival",
+    .next = clihost_commands_set + 2,
+    .handler = iBSP430cliHandlerStoreI,
+    .param.ptr = &data.ival
+  },
+  { .key = "lval",
+    .next = clihost_commands_set + 3,
+    .handler = iBSP430cliHandlerStoreL,
+    .param.ptr = &data.lval
+  },
+  { .key = "uival",
+    .next = clihost_commands_set + 4,
+    .handler = iBSP430cliHandlerStoreUI,
+    .param.ptr = &data.uival
+  },
+  { .key = "ulval",
+    .handler = iBSP430cliHandlerStoreUL,
+    .param.ptr = &data.ulval
+  },
+};
+
+static const sBSP430cliCommand clihost_commands[] = {
+  { .key = "complete",
+    .child = clihost_commands_complete,
+    .next = clihost_commands + 1,
+    BSP430_CLI_COMMAND_INDEXED_COUNT(8)
+  },
+  { .key = "expand",
+    .next = clihost_commands + 2,
+    .handler = iBSP430cliHandlerSimple,
+    .param.simple_handler = cmd_expand
+  },
+  { .key = "help",
+    .next = clihost_commands + 3,
+    .handler = cmd_help
+  },
+  { .key = "hup",
+    .child = clihost_commands_hup,
+    .next = clihost_commands + 4
+  },
+  { .key = "quote",
+    .next = clihost_commands + 5,
+    .handler = iBSP430cliHandlerSimple,
+    .param.simple_handler = cmd_quote
+  },
+  { .key = "say",
+    .next = clihost_commands + 6,
+    .handler = cmd_say,
+    .completion_helper = &completion_helper_say.completion_helper
+  },
+  { .key = "set",
+    .child = clihost_commands_set,
+    .next = clihost_commands + 7
+  },
+  { .key = "sum",
+    .handler = iBSP430cliHandlerArgv,
+    .param.argv_handler = cmd_sum
+  },
+};
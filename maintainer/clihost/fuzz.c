@@ -0,0 +1,270 @@
+/* Fuzz entry point for the BSP430 CLI.
+ *
+ * Each input is treated three ways: as keystrokes processed the way
+ * examples/utility/cli does (editing, completion, escapes, and
+ * execution of completed lines); as a stored script run by
+ * iBSP430cliExecuteScript(); and as a command line split by
+ * iBSP430cliTokenize() with every token converted as an integer.
+ *
+ * Built with -fsanitize=fuzzer this provides LLVMFuzzerTestOneInput()
+ * for libFuzzer.  Otherwise a main() runs each file named on the
+ * command line (or standard input) through the same function, which
+ * is what AFL and corpus replay expect. */
+
+#include <bsp430/platform.h>
+#include <bsp430/utility/console.h>
+#include <bsp430/utility/cli.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct data_t {
+  int ival;
+  unsigned int uival;
+  long lval;
+  unsigned long ulval;
+} data;
+
+static const char * const numbers[] = {
+  "zero", "one", "two", "three", "four", "five", "six", "seven",
+  "eight", "nine", "ten"
+};
+
+static const sBSP430cliCompletionHelperStrings completion_helper_say = {
+  .completion_helper = { .helper = vBSP430cliCompletionHelperStrings },
+  .strings = numbers,
+  .len = sizeof(numbers)/sizeof(*numbers)
+};
+
+static int
+cmd_dummy (const char * argstr)
+{
+  return 0;
+}
+
+static int
+cmd_set_all (const char * argstr)
+{
+  size_t argstr_len = strlen(argstr);
+  int rv;
+
+  rv = iBSP430cliStoreExtractedI(&argstr, &argstr_len, &data.ival);
+  if (0 == rv) {
+    rv = iBSP430cliStoreExtractedUI(&argstr, &argstr_len, &data.uival);
+  }
+  if (0 == rv) {
+    rv = iBSP430cliStoreExtractedL(&argstr, &argstr_len, &data.lval);
+  }
+  if (0 == rv) {
+    rv = iBSP430cliStoreExtractedUL(&argstr, &argstr_len, &data.ulval);
+  }
+  return rv;
+}
+
+static int
+cmd_say (sBSP430cliCommandLink * chain,
+         void * param,
+         const char * command,
+         size_t command_len)
+{
+  const char * const * np;
+  int nmatches = 0;
+
+  do {
+    np = xBSP430cliHelperStringsExtract(&completion_helper_say, &command, &command_len);
+    if (NULL != np) {
+      ++nmatches;
+    }
+  } while (NULL != np);
+  cprintf("%u matches found\n", nmatches);
+  return 0;
+}
+
+static int
+cmd_sum (sBSP430cliCommandLink * chain,
+         int argc,
+         const sBSP430cliToken * argv)
+{
+  unsigned long sum = 0;
+  int i;
+
+  for (i = 0; i < argc; ++i) {
+    unsigned long v;
+    int rv = iBSP430cliTokenAsUL(argv + i, &v);
+
+    if (0 != rv) {
+      return rv;
+    }
+    sum += v;
+  }
+  cprintf("%lu\n", sum);
+  return 0;
+}
+
+static int
+cmd_quote (const char * argstr)
+{
+  size_t argstr_len = strlen(argstr);
+
+  while (0 < argstr_len) {
+    size_t len;
+    const char * tp = xBSP430cliNextQToken(&argstr, &argstr_len, &len);
+
+    cprintf("'%.*s'\n", (int)len, tp);
+  }
+  return 0;
+}
+
+static int
+cmd_help (sBSP430cliCommandLink * chain,
+          void * param,
+          const char * command,
+          size_t command_len)
+{
+  vBSP430cliConsoleDisplayHelp(chain->cmd);
+  return 0;
+}
+
+static int cmd_expand (const char * argstr);
+
+#include "commands.h"
+
+static int
+cmd_expand_ (sBSP430cliCommandLink * chain,
+             void * param,
+             const char * argstr,
+             size_t argstr_len)
+{
+  vBSP430cliConsoleDisplayChain(chain, argstr);
+  return 0;
+}
+
+static int
+cmd_expand (const char * argstr)
+{
+  return iBSP430cliParseCommand(clihost_commands, NULL, argstr, NULL, cmd_expand_);
+}
+
+/* Process keystrokes as the cli example's main loop does. */
+static void
+runConsole (const uint8_t * data,
+            size_t size)
+{
+  const char * command;
+  int flags = 0;
+
+  vClihostSetInput(data, size);
+  vBSP430cliConsoleBufferClear();
+  do {
+    flags |= iBSP430cliConsoleBufferProcessInput();
+    if (flags & eBSP430cliConsole_ANY_ESCAPE) {
+      flags = iBSP430cliConsoleBufferConsumeEscape(flags);
+    }
+    if (flags & eBSP430cliConsole_DO_COMPLETION) {
+      command = NULL;
+      flags &= ~eBSP430cliConsole_DO_COMPLETION;
+      flags |= iBSP430cliConsoleBufferCompletion(clihost_commands, &command);
+    }
+    if (flags & eBSP430cliConsole_READY) {
+      (void)iBSP430cliExecuteCommand(clihost_commands, 0, xBSP430cliConsoleBuffer());
+      vBSP430cliConsoleBufferClear();
+    }
+    flags = 0;
+  } while (0 < xClihostInputRemaining());
+}
+
+/* Split the input as a command line and convert every token. */
+static void
+runTokens (const char * text,
+           size_t len)
+{
+  sBSP430cliToken tokens[BSP430_CLI_ARGV_MAX];
+  int ntokens;
+  int i;
+
+  ntokens = iBSP430cliTokenize(text, len, tokens, sizeof(tokens)/sizeof(*tokens));
+  for (i = 0; i < ntokens; ++i) {
+    int iv;
+    unsigned int uiv;
+    long lv;
+    unsigned long ulv;
+
+    (void)iBSP430cliTokenAsI(tokens + i, &iv);
+    (void)iBSP430cliTokenAsUI(tokens + i, &uiv);
+    (void)iBSP430cliTokenAsL(tokens + i, &lv);
+    (void)iBSP430cliTokenAsUL(tokens + i, &ulv);
+  }
+}
+
+int
+LLVMFuzzerTestOneInput (const uint8_t * data,
+                        size_t size)
+{
+  /* An exact-size copy so the sanitizers catch reads past the end */
+  char * text = malloc(size ? size : 1);
+  unsigned int line;
+
+  if (NULL == text) {
+    return 0;
+  }
+  memcpy(text, data, size);
+  runConsole(data, size);
+  (void)iBSP430cliExecuteScript(clihost_commands, 0, text, size, &line);
+  runTokens(text, size);
+  free(text);
+  return 0;
+}
+
+#ifndef CLIHOST_LIBFUZZER
+static int
+runStream (FILE * fp)
+{
+  uint8_t * buffer = NULL;
+  size_t len = 0;
+  size_t size = 0;
+  size_t nr;
+
+  do {
+    if (len == size) {
+      size = size ? (2 * size) : 4096;
+      buffer = realloc(buffer, size);
+      if (NULL == buffer) {
+        return -1;
+      }
+    }
+    nr = fread(buffer + len, 1, size - len, fp);
+    len += nr;
+  } while (0 < nr);
+  (void)LLVMFuzzerTestOneInput(buffer, len);
+  free(buffer);
+  return 0;
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  int ai;
+
+  if (getenv("CLIHOST_ECHO")) {
+    vClihostSetEcho(1);
+  }
+  if (1 >= argc) {
+    return runStream(stdin) ? EXIT_FAILURE : EXIT_SUCCESS;
+  }
+  for (ai = 1; ai < argc; ++ai) {
+    FILE * fp = fopen(argv[ai], "rb");
+
+    if (NULL == fp) {
+      perror(argv[ai]);
+      return EXIT_FAILURE;
+    }
+    if (0 != runStream(fp)) {
+      fclose(fp);
+      return EXIT_FAILURE;
+    }
+    fclose(fp);
+  }
+  return EXIT_SUCCESS;
+}
+#endif /* CLIHOST_LIBFUZZER */
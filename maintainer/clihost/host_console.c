@@ -0,0 +1,105 @@
+/* Stub console for the host build of the BSP430 CLI.
+ *
+ * Input comes from a caller-supplied buffer.  Output is formatted (so
+ * the formatting cost and any invalid arguments are exercised) and
+ * then discarded unless echo is enabled. */
+
+#include <bsp430/utility/console.h>
+#include <stdio.h>
+#include <string.h>
+
+static const uint8_t * input_;
+static size_t input_len_;
+static int echo_;
+
+/* Terminates an escape sequence when iBSP430cliConsoleBufferConsumeEscape()
+ * waits for input that will never arrive. */
+static const uint8_t idle_input_[] = "~";
+
+void
+vClihostSetInput (const uint8_t * data,
+                  size_t len)
+{
+  input_ = data;
+  input_len_ = len;
+}
+
+size_t
+xClihostInputRemaining (void)
+{
+  return input_len_;
+}
+
+void
+vClihostSetEcho (int echo)
+{
+  echo_ = echo;
+}
+
+void
+vClihostIdle (void)
+{
+  if (0 == input_len_) {
+    vClihostSetInput(idle_input_, sizeof(idle_input_) - 1);
+  }
+}
+
+int
+cgetchar (void)
+{
+  if (0 == input_len_) {
+    return -1;
+  }
+  --input_len_;
+  return *input_++;
+}
+
+int
+cputchar (int c)
+{
+  if (echo_) {
+    putchar(c);
+  }
+  return c;
+}
+
+int
+cputchars (const char * cp,
+           size_t len)
+{
+  if (echo_) {
+    fwrite(cp, 1, len, stdout);
+  }
+  return len;
+}
+
+int
+cputtext (const char * s)
+{
+  return cputchars(s, strlen(s));
+}
+
+int
+vcprintf (const char * format,
+          va_list ap)
+{
+  char buffer[256];
+  int rv = vsnprintf(buffer, sizeof(buffer), format, ap);
+
+  if (0 < rv) {
+    (void)cputchars(buffer, (rv < sizeof(buffer)) ? rv : (sizeof(buffer) - 1));
+  }
+  return rv;
+}
+
+int
+cprintf (const char * format, ...)
+{
+  va_list ap;
+  int rv;
+
+  va_start(ap, format);
+  rv = vcprintf(format, ap);
+  va_end(ap);
+  return rv;
+}
@@ -0,0 +1,27 @@
+/* Host stand-in for <bsp430/core.h> used by maintainer/clihost.
+ *
+ * Only what src/utility/cli.c and the headers it includes require is
+ * provided.  Interrupt control is a no-op; entering a low power mode
+ * gives the stub console a chance to supply more input. */
+
+#ifndef BSP430_CORE_H
+#define BSP430_CORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BSP430_CORE_INLINE inline
+#define BSP430_CORE_INLINE_FORCED BSP430_CORE_INLINE __attribute__((__always_inline__))
+
+#define GIE 0x0008
+#define LPM0_bits 0x0010
+
+#define BSP430_CORE_SAVED_INTERRUPT_STATE(var_) int var_ = 0
+#define BSP430_CORE_RESTORE_INTERRUPT_STATE(var_) do { (void)(var_); } while (0)
+#define BSP430_CORE_DISABLE_INTERRUPT() do { } while (0)
+#define BSP430_CORE_ENABLE_INTERRUPT() do { } while (0)
+
+void vClihostIdle (void);
+#define BSP430_CORE_LPM_ENTER(bits_) vClihostIdle()
+
+#endif /* BSP430_CORE_H */
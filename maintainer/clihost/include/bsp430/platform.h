@@ -0,0 +1,31 @@
+/* Host stand-in for <bsp430/platform.h> used by maintainer/clihost.
+ *
+ * This plays the role of an application's bsp430_config.h: every CLI
+ * feature is enabled unless overridden on the command line. */
+
+#ifndef BSP430_PLATFORM_H
+#define BSP430_PLATFORM_H
+
+#ifndef configBSP430_CONSOLE
+#define configBSP430_CONSOLE 1
+#endif /* configBSP430_CONSOLE */
+
+#ifndef BSP430_CLI_CONSOLE_BUFFER_SIZE
+#define BSP430_CLI_CONSOLE_BUFFER_SIZE 64
+#endif /* BSP430_CLI_CONSOLE_BUFFER_SIZE */
+
+#ifndef configBSP430_CLI_COMMAND_COMPLETION
+#define configBSP430_CLI_COMMAND_COMPLETION 1
+#endif /* configBSP430_CLI_COMMAND_COMPLETION */
+
+#ifndef configBSP430_CLI_COMMAND_COMPLETION_HELPER
+#define configBSP430_CLI_COMMAND_COMPLETION_HELPER 1
+#endif /* configBSP430_CLI_COMMAND_COMPLETION_HELPER */
+
+#ifndef configBSP430_CLI_COMMAND_INDEX
+#define configBSP430_CLI_COMMAND_INDEX 1
+#endif /* configBSP430_CLI_COMMAND_INDEX */
+
+#include <bsp430/core.h>
+
+#endif /* BSP430_PLATFORM_H */
@@ -0,0 +1,28 @@
+/* Host stand-in for <bsp430/utility/console.h> used by
+ * maintainer/clihost.
+ *
+ * Input is taken from a buffer supplied with vClihostSetInput();
+ * output is discarded unless vClihostSetEcho() enables it. */
+
+#ifndef BSP430_UTILITY_CONSOLE_H
+#define BSP430_UTILITY_CONSOLE_H
+
+#include <bsp430/core.h>
+#include <stdarg.h>
+
+#define BSP430_CONSOLE (configBSP430_CONSOLE - 0)
+#define BSP430_CONSOLE_RX_BUFFER_SIZE 0
+
+int cgetchar (void);
+int cputchar (int c);
+int cputtext (const char * s);
+int cputchars (const char * cp, size_t len);
+int cprintf (const char * format, ...);
+int vcprintf (const char * format, va_list ap);
+
+/* Host-specific controls */
+void vClihostSetInput (const uint8_t * data, size_t len);
+size_t xClihostInputRemaining (void);
+void vClihostSetEcho (int echo);
+
+#endif /* BSP430_UTILITY_CONSOLE_H */
@@ -0,0 +1,123 @@
+# Generate constant, sorted CLI command tables for <bsp430/utility/cli.h>.
+#
+# The input describes a command tree, one command per line:
+#
+#   key | handler | initializers | help
+#
+# Children are indented beneath their parent by two spaces per level.
+# handler is the sBSP430cliCommand::handler value (empty for none);
+# initializers is any additional C designated initializers, such as
+# ".param.simple_handler = cmd_x"; help is plain text (empty for
+# none).  Trailing empty fields may be omitted.  Blank lines and lines
+# beginning with '#' are ignored.
+#
+# The output is C source defining one array per set of sibling
+# commands, sorted by key and marked with BSP430_CLI_COMMAND_INDEXED_COUNT
+# so that configBSP430_CLI_COMMAND_INDEX can search it, and linked
+# through the next field so it also works without that option.  The
+# top-level set is named by --name; the result is suitable for
+# inclusion after the handlers it references have been declared.
+#
+# Example:
+#   python maintainer/clitable.py --name app_commands commands.cli > commands.h
+
+from __future__ import print_function
+import sys
+import argparse
+
+class Command (object):
+    def __init__ (self, key, handler, init, help_text, lineno):
+        self.key = key
+        self.handler = handler
+        self.init = init
+        self.help = help_text
+        self.lineno = lineno
+        self.children = []
+
+def c_string (text):
+    out = []
+    for c in text:
+        if c in '\\"':
+            out.append('\\' + c)
+        elif (' ' <= c) and (c < '\x7f'):
+            out.append(c)
+        else:
+            out.append('\\%03o' % (ord(c),))
+    return '"' + ''.join(out) + '"'
+
+def parse (lines, source):
+    root = Command(None, None, None, None, 0)
+    stack = [(-1, root)]
+    for (lineno, line) in enumerate(lines, 1):
+        text = line.rstrip('\n').rstrip()
+        stripped = text.lstrip(' ')
+        if (not stripped) or stripped.startswith('#'):
+            continue
+        indent = len(text) - len(stripped)
+        fields = [ _f.strip() for _f in stripped.split('|', 3) ]
+        fields += [''] * (4 - len(fields))
+        (key, handler, init, help_text) = fields
+        if (not key) or (0 <= key.find(' ')):
+            raise ValueError('%s:%d: invalid key %r' % (source, lineno, key))
+        while stack[-1][0] >= indent:
+            stack.pop()
+        cmd = Command(key, handler, init, help_text, lineno)
+        stack[-1][1].children.append(cmd)
+        stack.append((indent, cmd))
+    return root
+
+def validate (cmd, source):
+    keys = sorted(_c.key for _c in cmd.children)
+    for (a, b) in zip(keys, keys[1:]):
+        # In sorted order a key that is a prefix of a sibling
+        # immediately precedes some sibling it prefixes.
+        if b.startswith(a):
+            raise ValueError('%s: key %r is a prefix of sibling %r' % (source, a, b))
+    for c in cmd.children:
+        validate(c, source)
+
+def emit (cmd, name, out):
+    """Emit the arrays for the children of cmd, deepest first, naming
+    the array for cmd's children name."""
+    children = sorted(cmd.children, key=lambda _c: _c.key.encode('utf-8'))
+    child_names = []
+    for c in children:
+        cname = None
+        if c.children:
+            cname = '%s_%s' % (name, ''.join(_ch if _ch.isalnum() else '_' for _ch in c.key))
+            emit(c, cname, out)
+        child_names.append(cname)
+    out.append('static const sBSP430cliCommand %s[] = {' % (name,))
+    for (i, c) in enumerate(children):
+        fields = [ '.key = %s' % (c_string(c.key),) ]
+        if c.help:
+            fields.append('.help = %s' % (c_string(c.help),))
+        if child_names[i] is not None:
+            fields.append('.child = %s' % (child_names[i],))
+        if (i + 1) < len(children):
+            fields.append('.next = %s + %d' % (name, i + 1))
+        if c.handler:
+            fields.append('.handler = %s' % (c.handler,))
+        if c.init:
+            fields.append(c.init)
+        text = ',\n    '.join(fields)
+        if 0 == i:
+            text += ',\n    BSP430_CLI_COMMAND_INDEXED_COUNT(%d)' % (len(children),)
+        out.append('  { %s\n  },' % (text,))
+    out.append('};')
+    out.append('')
+
+def main ():
+    parser = argparse.ArgumentParser(description='Generate sorted BSP430 CLI command tables')
+    parser.add_argument('--name', default='cli_commands', help='name of the top-level command array')
+    parser.add_argument('input', help='command description')
+    args = parser.parse_args()
+    with open(args.input) as f:
+        root = parse(f.readlines(), args.input)
+    validate(root, args.input)
+    out = [ '/* Generated by maintainer/clitable.py from %s.  Do not edit. */' % (args.input,), '' ]
+    emit(root, args.name, out)
+    print('\n'.join(out), end='')
+
+if __name__ == '__main__':
+    main()
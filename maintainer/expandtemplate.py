@@ -334,35 +334,48 @@ sBSP430hal%(PERIPH)s xBSP430hal_%(INSTANCE)s_ = {
 ''',
 
     'hal_isr_defn' : '''#if (configBSP430_HAL_%(INSTANCE)s_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(%(INSTANCE)s)
 BSP430_CORE_DECLARE_INTERRUPT(%(BASEINSTANCE)s_VECTOR)
 isr_%(INSTANCE)s (void)
 {
-  int rv = %(periph)s_isr(BSP430_HAL_%(INSTANCE)s);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(%(INSTANCE)s);
+  rv = %(periph)s_isr(BSP430_HAL_%(INSTANCE)s);
+  BSP430_ISRSTATS_EXIT_NI(%(INSTANCE)s);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_%(INSTANCE)s_ISR */
 ''',
 
     'hal_timer_isr_defn' : '''#if (configBSP430_HAL_T%(TYPE)s%(INSTANCE)s_CC0_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(cc0_T%(TYPE)s%(INSTANCE)s)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER%(INSTANCE)s_%(TYPE)s0_VECTOR)
 isr_cc0_T%(TYPE)s%(INSTANCE)s (void)
 {
   hBSP430hal%(PERIPH)s timer = BSP430_HAL_T%(TYPE)s%(INSTANCE)s;
-  int rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(cc0_T%(TYPE)s%(INSTANCE)s);
+  rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
   if (rv & BSP430_HAL_ISR_CALLBACK_DISABLE_INTERRUPT) {
     timer->hpl->cctl[0] &= ~CCIE;
   }
+  BSP430_ISRSTATS_EXIT_NI(cc0_T%(TYPE)s%(INSTANCE)s);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_T%(TYPE)s%(INSTANCE)s_CC0_ISR */
 
 #if (configBSP430_HAL_T%(TYPE)s%(INSTANCE)s_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(T%(TYPE)s%(INSTANCE)s)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER%(INSTANCE)s_%(TYPE)s1_VECTOR)
 isr_T%(TYPE)s%(INSTANCE)s (void)
 {
   hBSP430hal%(PERIPH)s timer = BSP430_HAL_T%(TYPE)s%(INSTANCE)s;
   unsigned int iv = T%(TYPE)s%(INSTANCE)sIV;
   int rv = 0;
+
+  BSP430_ISRSTATS_ENTER_NI(T%(TYPE)s%(INSTANCE)s);
   if (0 != iv) {
     if (T%(TYPE)s_OVERFLOW == iv) {
       ++timer->overflow_count;
@@ -378,6 +391,7 @@ isr_T%(TYPE)s%(INSTANCE)s (void)
       }
     }
   }
+  BSP430_ISRSTATS_EXIT_NI(T%(TYPE)s%(INSTANCE)s);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_T%(TYPE)s%(INSTANCE)s_ISR */
@@ -444,16 +458,20 @@ struct sBSP430halSERIAL xBSP430hal_%(INSTANCE)s_ = {
 ''',
 
     'hal_port_isr_defn' : '''#if (configBSP430_HAL_%(INSTANCE)s_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(%(INSTANCE)s)
 BSP430_CORE_DECLARE_INTERRUPT(%(INSTANCE)s_VECTOR)
 isr_%(INSTANCE)s (void)
 {
   int idx = 0;
   int rv;
   unsigned char bit = 1;
-
 #if (BSP430_CORE_FAMILY_IS_5XX - 0)
-  unsigned int iv = P%(#)sIV;
+  unsigned int iv;
+#endif /* CPUX */
 
+  BSP430_ISRSTATS_ENTER_NI(%(INSTANCE)s);
+#if (BSP430_CORE_FAMILY_IS_5XX - 0)
+  iv = P%(#)sIV;
   if (0 == iv) {
     return;
   }
@@ -475,6 +493,7 @@ isr_%(INSTANCE)s (void)
 #endif /* CPUX */
     P%(#)sIE &= ~bit;
   }
+  BSP430_ISRSTATS_EXIT_NI(%(INSTANCE)s);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_%(INSTANCE)s_ISR */
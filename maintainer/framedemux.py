@@ -0,0 +1,163 @@
+# Demultiplex framed channels carried over a BSP430 console UART.
+#
+# The target uses <bsp430/utility/frame.h> to send binary frames
+# between zero octets, COBS-encoded with a channel number and CRC-16.
+# Everything outside a frame is console text.  This program opens the
+# UART and creates a pseudo-terminal for the console text and one for
+# each requested channel.  Whatever arrives on a channel is written
+# to its pseudo-terminal, and whatever is written to that
+# pseudo-terminal is framed and sent to the target on that channel.
+# Connect a terminal program to the console pseudo-terminal, and
+# applications to the channel pseudo-terminals.
+#
+# Example:
+#   python maintainer/framedemux.py -b 115200 /dev/ttyACM0 1 2
+
+from __future__ import print_function
+import os
+import sys
+import tty
+import termios
+import select
+import argparse
+
+DELIMITER = 0
+COBS_RUN_MAX = 254
+
+def crc16 (data, crc=0xFFFF):
+    for b in bytearray(data):
+        x = ((crc >> 8) ^ b) & 0xFF
+        x ^= x >> 4
+        crc = ((crc << 8) ^ (x << 12) ^ (x << 5) ^ x) & 0xFFFF
+    return crc
+
+def cobs_encode (data):
+    data = bytearray(data)
+    out = bytearray()
+    pos = 0
+    while True:
+        run = 0
+        while (run < COBS_RUN_MAX) and (pos + run < len(data)) and (0 != data[pos + run]):
+            run += 1
+        out.append(run + 1)
+        out.extend(data[pos:pos + run])
+        pos += run
+        if (pos < len(data)) and (0 == data[pos]):
+            pos += 1
+        elif pos >= len(data):
+            break
+    return bytes(out)
+
+def cobs_decode (data):
+    data = bytearray(data)
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        code = data[pos]
+        if (0 == code) or (pos + code > len(data)):
+            return None
+        out.extend(data[pos + 1:pos + code])
+        pos += code
+        if (code <= COBS_RUN_MAX) and (pos < len(data)):
+            out.append(0)
+    return bytes(out)
+
+def encode_frame (channel, payload):
+    body = bytearray([channel]) + bytearray(payload)
+    crc = crc16(body)
+    body += bytearray([crc & 0xFF, crc >> 8])
+    return bytes(bytearray([DELIMITER]) + bytearray(cobs_encode(body)) + bytearray([DELIMITER]))
+
+def decode_frame (encoded):
+    """Return (channel, payload) for the octets between two
+    delimiters, or None if they are not a valid frame."""
+    body = cobs_decode(encoded)
+    if (body is None) or (3 > len(body)):
+        return None
+    body = bytearray(body)
+    crc = crc16(body[:-2])
+    if (body[-2] != (crc & 0xFF)) or (body[-1] != (crc >> 8)):
+        return None
+    return (body[0], bytes(body[1:-2]))
+
+class Demultiplexer (object):
+    """Split a received octet stream into console text and frames."""
+
+    def __init__ (self, on_text, on_frame):
+        self.on_text = on_text
+        self.on_frame = on_frame
+        self.in_frame = False
+        self.pending = bytearray()
+        self.errors = 0
+
+    def feed (self, data):
+        for b in bytearray(data):
+            if DELIMITER == b:
+                if self.in_frame and self.pending:
+                    frame = decode_frame(self.pending)
+                    if frame is None:
+                        # Perhaps the start of this frame was lost;
+                        # treat the delimiter as a new start.
+                        self.errors += 1
+                    else:
+                        self.in_frame = False
+                        self.on_frame(*frame)
+                else:
+                    self.in_frame = True
+                self.pending = bytearray()
+            elif self.in_frame:
+                self.pending.append(b)
+            else:
+                self.on_text(bytes(bytearray([b])))
+
+def open_pty (label):
+    (master, slave) = os.openpty()
+    tty.setraw(slave)
+    print('%s: %s' % (label, os.ttyname(slave)))
+    return (master, slave)
+
+def main ():
+    parser = argparse.ArgumentParser(description='Demultiplex BSP430 framed console channels')
+    parser.add_argument('-b', '--baud', type=int, default=115200, help='UART baud rate')
+    parser.add_argument('device', help='target UART device')
+    parser.add_argument('channels', type=int, nargs='*', help='channels to expose')
+    args = parser.parse_args()
+
+    uart = os.open(args.device, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(uart)
+    attrs = termios.tcgetattr(uart)
+    speed = getattr(termios, 'B%d' % (args.baud,))
+    attrs[4] = attrs[5] = speed
+    termios.tcsetattr(uart, termios.TCSANOW, attrs)
+
+    (text_fd, _) = open_pty('console')
+    channel_fds = {}
+    for ch in args.channels:
+        (fd, _) = open_pty('channel %d' % (ch,))
+        channel_fds[ch] = fd
+    fd_channels = dict((fd, ch) for (ch, fd) in channel_fds.items())
+
+    def on_frame (channel, payload):
+        fd = channel_fds.get(channel)
+        if fd is not None:
+            os.write(fd, payload)
+
+    demux = Demultiplexer(lambda text: os.write(text_fd, text), on_frame)
+    readers = [uart, text_fd] + list(fd_channels.keys())
+    while True:
+        (ready, _, _) = select.select(readers, [], [])
+        for fd in ready:
+            try:
+                data = os.read(fd, 256)
+            except OSError:
+                # Nobody has the pseudo-terminal open
+                continue
+            if uart == fd:
+                demux.feed(data)
+            elif text_fd == fd:
+                os.write(uart, data.replace(b'\0', b''))
+            else:
+                os.write(uart, encode_frame(fd_channels[fd], data))
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,182 @@
+# Decode binary console log records produced by BSP430_CONSOLE_LOG()
+# when configBSP430_CONSOLE_LOG_BINARY is enabled.
+#
+# The format strings are read from the bsp430_logfmt section of the
+# application ELF image.  The console stream is read from a file or
+# serial device (or stdin); text passes through unchanged and each
+# binary record is replaced by its formatted message.
+#
+# Example:
+#   python maintainer/logdecode.py app.elf /dev/ttyACM0
+
+from __future__ import print_function
+import sys
+import re
+import struct
+import argparse
+
+RECORD_START = 0x1E
+SECTION_NAME = b'bsp430_logfmt'
+
+# e_machine: (sizeof(int), sizeof(long))
+MachineSizes = { 105: (2, 4),    # MSP430
+                 3: (4, 4),      # i386
+                 40: (4, 4),     # ARM
+                 62: (4, 8),     # x86_64
+                 183: (4, 8) }   # AArch64
+
+conversion_re = re.compile(r'%(?P<flags>[-+ #0]*)(?P<width>\*|\d*)(?:\.(?P<prec>\*|\d*))?(?P<lmod>hh|h|ll|l)?(?P<conv>[%diuoxXcsp])')
+
+class FormatTable (object):
+    def __init__ (self, elf_path):
+        with open(elf_path, 'rb') as f:
+            image = f.read()
+        if image[:4] != b'\x7fELF':
+            raise ValueError('%s: not an ELF file' % (elf_path,))
+        is64 = (2 == bytearray(image[4:5])[0])
+        if 1 != bytearray(image[5:6])[0]:
+            raise ValueError('%s: big-endian images not supported' % (elf_path,))
+        if is64:
+            (e_machine,) = struct.unpack_from('<H', image, 18)
+            (e_shoff,) = struct.unpack_from('<Q', image, 40)
+            (e_shentsize, e_shnum, e_shstrndx) = struct.unpack_from('<HHH', image, 58)
+            shfmt = '<IIQQQQIIQQ'
+        else:
+            (e_machine,) = struct.unpack_from('<H', image, 18)
+            (e_shoff,) = struct.unpack_from('<I', image, 32)
+            (e_shentsize, e_shnum, e_shstrndx) = struct.unpack_from('<HHH', image, 46)
+            shfmt = '<IIIIIIIIII'
+        if e_machine not in MachineSizes:
+            raise ValueError('%s: unsupported machine %d' % (elf_path, e_machine))
+        (self.int_size, self.long_size) = MachineSizes[e_machine]
+        sections = []
+        for i in range(e_shnum):
+            sections.append(struct.unpack_from(shfmt, image, e_shoff + i * e_shentsize))
+        strtab = sections[e_shstrndx]
+        self.data = None
+        for sh in sections:
+            nmoff = strtab[4] + sh[0]
+            name = image[nmoff:image.index(b'\0', nmoff)]
+            if SECTION_NAME == name:
+                self.data = image[sh[4]:sh[4] + sh[5]]
+                break
+        if self.data is None:
+            raise ValueError('%s: no %s section' % (elf_path, SECTION_NAME.decode()))
+
+    def format (self, offset):
+        if offset >= len(self.data):
+            return None
+        end = self.data.index(b'\0', offset)
+        return self.data[offset:end].decode('latin-1')
+
+class Payload (object):
+    def __init__ (self, data):
+        self.data = data
+        self.pos = 0
+        self.truncated = False
+
+    def integer (self, size, signed):
+        if self.pos + size > len(self.data):
+            self.truncated = True
+            return None
+        code = { 1: 'b', 2: 'h', 4: 'i', 8: 'q' }[size]
+        if not signed:
+            code = code.upper()
+        (v,) = struct.unpack_from('<' + code, self.data, self.pos)
+        self.pos += size
+        return v
+
+    def string (self):
+        if self.pos >= len(self.data):
+            self.truncated = True
+            return None
+        end = self.data.find(b'\0', self.pos)
+        if 0 > end:
+            end = len(self.data)
+        v = self.data[self.pos:end].decode('latin-1')
+        self.pos = end + 1
+        return v
+
+def render (table, fmt, payload):
+    def convert (m):
+        if '%' == m.group('conv'):
+            return '%'
+        if payload.truncated:
+            return '<?>'
+        spec = '%' + m.group('flags')
+        for (key, sep) in (('width', ''), ('prec', '.')):
+            v = m.group(key)
+            if v is None:
+                continue
+            if '*' == v:
+                v = payload.integer(table.int_size, True)
+                if v is None:
+                    return '<?>'
+            spec += sep + str(v)
+        conv = m.group('conv')
+        lmod = m.group('lmod') or ''
+        if 's' == conv:
+            v = payload.string()
+        elif 'p' == conv:
+            v = payload.integer(table.long_size, False)
+            conv = 'x'
+            spec += '#'
+        else:
+            size = { 'l': table.long_size, 'll': 8 }.get(lmod, table.int_size)
+            v = payload.integer(size, conv in 'di')
+            if v is not None:
+                if 'hh' == lmod:
+                    v = struct.unpack('<' + (conv in 'di' and 'b' or 'B'), struct.pack('<B', v & 0xFF))[0]
+                elif 'h' == lmod:
+                    v = struct.unpack('<' + (conv in 'di' and 'h' or 'H'), struct.pack('<H', v & 0xFFFF))[0]
+                if 'c' == conv:
+                    v = chr(v & 0xFF)
+        if v is None:
+            return '<?>'
+        return (spec + conv) % (v,)
+    return conversion_re.sub(convert, fmt)
+
+def decode (table, stream, out):
+    pending = bytearray()
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            break
+        pending.extend(bytearray(chunk))
+        while pending:
+            if RECORD_START != pending[0]:
+                idx = pending.find(bytearray([RECORD_START]))
+                if 0 > idx:
+                    idx = len(pending)
+                out.write(bytes(pending[:idx]).decode('latin-1'))
+                del pending[:idx]
+                continue
+            if 4 > len(pending):
+                break
+            length = pending[3]
+            if 4 + length > len(pending):
+                break
+            offset = pending[1] | (pending[2] << 8)
+            payload = Payload(bytes(pending[4:4 + length]))
+            del pending[:4 + length]
+            fmt = table.format(offset)
+            if fmt is None:
+                out.write('<bad log record %#x>' % (offset,))
+            else:
+                out.write(render(table, fmt, payload))
+        out.flush()
+
+def main ():
+    parser = argparse.ArgumentParser(description='Decode BSP430 binary console log records')
+    parser.add_argument('elf', help='application ELF image')
+    parser.add_argument('input', nargs='?', help='captured stream or serial device (default stdin)')
+    args = parser.parse_args()
+    table = FormatTable(args.elf)
+    if args.input is None:
+        stream = getattr(sys.stdin, 'buffer', sys.stdin)
+    else:
+        stream = open(args.input, 'rb', 0)
+    decode(table, stream, sys.stdout)
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,502 @@
+/* Randomized test of timer alarms on the simulated Timer_A and
+ * Timer_B.
+ *
+ * Dedicated alarms use every capture/compare register of TA0 and all
+ * but the last of TB0; the last register of TB0 carries a shared
+ * alarm for a set of multiplexed alarms.  Each iteration does one of:
+ *
+ * @li set an idle dedicated alarm, ordinary or forced, or add an idle
+ * multiplexed alarm.  The due time is drawn from distributions that
+ * concentrate on the cases timer.c treats specially: the recent past,
+ * the future limit, the counter wrap in this and the next two cycles,
+ * and times more than one cycle ahead.  Half the time the counter is
+ * first moved to just short of a wrap;
+ * @li cancel a scheduled alarm;
+ * @li let time pass with interrupts enabled, or with them disabled
+ * so that events accumulate.
+ *
+ * Setting, adding, cancelling and removing are done with interrupts
+ * disabled as the API requires; on hosts that support it half of
+ * those calls are single-stepped so the counter advances, and may
+ * wrap, between any pair of instructions.
+ *
+ * The test checks that:
+ *
+ * @li iBSP430timerAlarmSet_ni() classifies the due time correctly;
+ * @li every scheduled alarm fires exactly once, unless cancelled;
+ * @li no alarm fires before it is due, except a forced alarm set less
+ * than #BSP430_TIMER_ALARM_FUTURE_LIMIT ticks ahead;
+ * @li no alarm fires later than the interrupt service time of the
+ * others after it was due, or after interrupts were last enabled if
+ * they were disabled when it became due.
+ *
+ * Afterwards, where stepping is supported, a periodic multiplexed
+ * alarm whose callback runs for two periods checks that the shared
+ * alarm handler delivers it at most twice per interrupt and returns,
+ * with the skipped events counted as overruns.
+ *
+ * Reported: the number of alarms set and fired, how many fired
+ * because interrupts had been disabled, the worst lateness, the
+ * number of interrupts, and the instructions stepped.
+ *
+ * Usage: alarmtest [iterations]   (default 200000) */
+
+#include <bsp430/platform.h>
+#include <bsp430/periph/timer.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timerhost.h"
+
+#define ISR_TCK 5
+
+/* A timer clocked from ACLK advances once for many CPU instructions.
+ * The ratio must leave the set path inside the future limit, which
+ * takes a larger one when the build is instrumented. */
+#if defined(__SANITIZE_ADDRESS__)
+#define STEPS_PER_TICK 512
+#else /* __SANITIZE_ADDRESS__ */
+#define STEPS_PER_TICK 64
+#endif /* __SANITIZE_ADDRESS__ */
+#define NTA0 5
+#define NTB0 6
+#define NDEDICATED (NTA0 + NTB0)
+#define NMUX 8
+#define SLOW_PERIOD_TCK 10
+#define SLOW_CALLS 12
+/* Calls within one interrupt after which the slow alarm is stopped,
+ * so a handler that does not return fails rather than hangs */
+#define SLOW_CALLS_ABANDON 8
+
+/* Longest a due alarm may wait once interrupts are enabled: every
+ * other handler, including two overflows, may run first. */
+#define SLACK_TCK ((NDEDICATED + 3) * ISR_TCK)
+
+typedef struct sExpected {
+  int scheduled;
+  int forced;
+  unsigned long setting_tck;
+  unsigned long fired;
+} sExpected;
+
+typedef struct sDedicated {
+  sBSP430timerAlarm alarm;
+  sExpected ex;
+} sDedicated;
+
+typedef struct sMux {
+  sBSP430timerMuxAlarm alarm;
+  sExpected ex;
+} sMux;
+
+static sDedicated dedicated[NDEDICATED];
+static sMux muxes[NMUX];
+static sBSP430timerMuxSharedAlarm shared;
+static int can_step;
+static unsigned long long enabled_since_tck;
+static unsigned long sets;
+static unsigned long rc_counts[3];
+static unsigned long scheduled;
+static unsigned long cancels;
+static unsigned long fires;
+static unsigned long blocked_fires;
+static unsigned long long max_late_tck;
+
+static unsigned long rng_state = 1;
+
+static unsigned long
+rng (void)
+{
+  rng_state = rng_state * 1103515245UL + 12345UL;
+  return (rng_state >> 16) & 0x7FFF;
+}
+
+static unsigned long
+rngRange (unsigned long lo,
+          unsigned long hi)
+{
+  return lo + (((rng() << 15) | rng()) % (hi - lo + 1));
+}
+
+/* Both timers start together and run from the same clock, so the
+ * extended counter of either is the virtual time. */
+static unsigned long
+now (void)
+{
+  return (unsigned long)ullTimerhostNow();
+}
+
+static void
+enableInterrupts (void)
+{
+  enabled_since_tck = ullTimerhostNow();
+  BSP430_CORE_ENABLE_INTERRUPT();
+}
+
+/* Record a firing and check it was neither early nor late. */
+static void
+fired (sExpected * ep)
+{
+  unsigned long long now_tck = ullTimerhostNow();
+  unsigned long long due_tck = ep->setting_tck;
+  long early = (long)(ep->setting_tck - now());
+
+  ++fires;
+  CHECK(ep->scheduled);
+  if (! ep->scheduled) {
+    return;
+  }
+  ep->scheduled = 0;
+  ++ep->fired;
+  if (ep->forced) {
+    CHECK(early < (long)BSP430_TIMER_ALARM_FUTURE_LIMIT);
+  } else {
+    CHECK(0 >= early);
+  }
+  if (0 >= early) {
+    if (due_tck < enabled_since_tck) {
+      ++blocked_fires;
+      due_tck = enabled_since_tck;
+    } else if ((now_tck - due_tck) > max_late_tck) {
+      max_late_tck = now_tck - due_tck;
+    }
+    CHECK(now_tck - due_tck <= SLACK_TCK);
+  }
+}
+
+static int
+dedicated_cb (hBSP430timerAlarm alarm)
+{
+  fired(&((sDedicated *)alarm)->ex);
+  return 0;
+}
+
+static int
+mux_cb (hBSP430timerMuxSharedAlarm sp,
+        hBSP430timerMuxAlarm alarm)
+{
+  CHECK(&shared == sp);
+  fired(&((sMux *)alarm)->ex);
+  return 0;
+}
+
+static sBSP430timerMuxAlarm slow;
+static volatile unsigned int slow_calls;
+static unsigned long slow_isr;
+static unsigned int slow_calls_isr;
+static unsigned int slow_max_calls_isr;
+static unsigned int slow_max_overruns;
+
+/* Run for two periods, so the alarm is due again before it returns */
+static int
+slow_cb (hBSP430timerMuxSharedAlarm sp,
+         hBSP430timerMuxAlarm alarm)
+{
+  unsigned long entry_tck = ulBSP430timerCounter_ni(sp->dedicated.timer, NULL);
+
+  if (slow_isr != ulTimerhostISRCount) {
+    slow_isr = ulTimerhostISRCount;
+    slow_calls_isr = 0;
+  }
+  if (++slow_calls_isr > slow_max_calls_isr) {
+    slow_max_calls_isr = slow_calls_isr;
+  }
+  if (alarm->overruns > slow_max_overruns) {
+    slow_max_overruns = alarm->overruns;
+  }
+  while ((ulBSP430timerCounter_ni(sp->dedicated.timer, NULL) - entry_tck) < (2 * SLOW_PERIOD_TCK)) {
+  }
+  if ((SLOW_CALLS <= ++slow_calls) || (SLOW_CALLS_ABANDON <= slow_calls_isr)) {
+    slow_calls = SLOW_CALLS;
+    alarm->period_tck = 0;
+  }
+  return 0;
+}
+
+/* A periodic multiplexed alarm whose callback takes longer than its
+ * period.  Service routines are stepped so time passes while it
+ * runs. */
+static void
+checkSlowPeriodic (void)
+{
+  int rc;
+
+  iTimerhostStepISRs = 1;
+  BSP430_CORE_DISABLE_INTERRUPT();
+  slow.callback_ni = slow_cb;
+  slow.setting_tck = now() + SLOW_PERIOD_TCK;
+  rc = iBSP430timerMuxAlarmAddPeriodic_ni(&shared, &slow, SLOW_PERIOD_TCK);
+  CHECK(0 <= rc);
+  enableInterrupts();
+  if (0 == iTimerhostStepBegin()) {
+    while (SLOW_CALLS > slow_calls) {
+    }
+    vTimerhostStepEnd();
+  }
+  iTimerhostStepISRs = 0;
+  CHECK(SLOW_CALLS == slow_calls);
+  CHECK(2 == slow_max_calls_isr);
+  CHECK(0 < slow_max_overruns);
+  CHECK(NULL == shared.alarms);
+}
+
+/* A due time relative to the current time, emphasizing the cases
+ * that timer.c handles specially. */
+static unsigned long
+dueTime (void)
+{
+  unsigned long now_tck = now();
+
+  switch (rng() % 5) {
+    case 0:
+      return now_tck - 8 + rngRange(0, 16);
+    case 1:
+      return ((now_tck >> 16) + rngRange(0, 2)) * 0x10000UL - 8 + rngRange(0, 16);
+    case 2:
+      return now_tck + rngRange(0, 2000);
+    case 3:
+      return now_tck + rngRange(0x10000UL - 100, 0x10000UL + 100);
+  }
+  return now_tck + rngRange(0, 0x30000UL);
+}
+
+/* Let the counter run until it is within a few ticks of a wrap.
+ * Interrupts are taken as usual, since holding them off for most of
+ * a counter cycle could lose an overflow. */
+static void
+approachWrap (void)
+{
+  unsigned long to_wrap = 0x10000UL - (0xFFFF & now());
+  unsigned long margin = rngRange(0, 40);
+
+  if (to_wrap > margin) {
+    vTimerhostAdvance(to_wrap - margin);
+  }
+}
+
+/* Start single-stepping half the time, where supported. */
+static int
+maybeStep (void)
+{
+  if (can_step && (rng() & 1)) {
+    return 0 == iTimerhostStepBegin();
+  }
+  return 0;
+}
+
+static void
+setDedicated (sDedicated * dp)
+{
+  unsigned long setting_tck;
+  unsigned long start_tck;
+  unsigned long end_tck;
+  int forced = (0 == (rng() % 3));
+  int stepped;
+  int rc;
+
+  setting_tck = dueTime();
+  start_tck = now();
+  stepped = maybeStep();
+  if (forced) {
+    rc = iBSP430timerAlarmSetForced_ni(&dp->alarm, setting_tck);
+  } else {
+    rc = iBSP430timerAlarmSet_ni(&dp->alarm, setting_tck);
+  }
+  if (stepped) {
+    vTimerhostStepEnd();
+  }
+  end_tck = now();
+
+  ++sets;
+  CHECK((0 <= rc) && (BSP430_TIMER_ALARM_SET_PAST >= rc));
+  if ((0 > rc) || (BSP430_TIMER_ALARM_SET_PAST < rc)) {
+    return;
+  }
+  ++rc_counts[rc];
+  /* The counter was read somewhere between start and end */
+  if (0 == rc) {
+    CHECK((long)(setting_tck - start_tck) >= (long)BSP430_TIMER_ALARM_FUTURE_LIMIT);
+  } else if (BSP430_TIMER_ALARM_SET_NOW == rc) {
+    CHECK((long)(setting_tck - start_tck) >= 0);
+    CHECK((long)(setting_tck - end_tck) < (long)BSP430_TIMER_ALARM_FUTURE_LIMIT);
+  } else {
+    CHECK((long)(setting_tck - end_tck) < 0);
+  }
+  if ((0 == rc) || forced) {
+    ++scheduled;
+    dp->ex.scheduled = 1;
+    dp->ex.forced = (0 != rc);
+    dp->ex.setting_tck = setting_tck;
+  }
+}
+
+static void
+addMux (sMux * mp)
+{
+  int stepped;
+  int rc;
+
+  mp->alarm.setting_tck = dueTime();
+  mp->ex.setting_tck = mp->alarm.setting_tck;
+  /* Multiplexed alarms already due are forced */
+  mp->ex.forced = 1;
+  mp->ex.scheduled = 1;
+  ++scheduled;
+  stepped = maybeStep();
+  rc = iBSP430timerMuxAlarmAdd_ni(&shared, &mp->alarm);
+  if (stepped) {
+    vTimerhostStepEnd();
+  }
+  ++sets;
+  CHECK(0 <= rc);
+}
+
+static void
+cancel (sExpected * ep,
+        hBSP430timerAlarm alarm,
+        hBSP430timerMuxAlarm malarm)
+{
+  int stepped = maybeStep();
+  int rc;
+
+  if (alarm) {
+    rc = iBSP430timerAlarmCancel_ni(alarm);
+  } else {
+    rc = iBSP430timerMuxAlarmRemove_ni(&shared, malarm);
+  }
+  if (stepped) {
+    vTimerhostStepEnd();
+  }
+  CHECK(0 <= rc);
+  ++cancels;
+  ep->scheduled = 0;
+}
+
+/* Check that nothing is overdue: every scheduled alarm is either
+ * still in the future, or became due too recently to have been
+ * serviced. */
+static void
+checkOverdue (void)
+{
+  unsigned long long now_tck = ullTimerhostNow();
+  unsigned int i;
+
+  for (i = 0; i < NDEDICATED + NMUX; ++i) {
+    sExpected * ep = (i < NDEDICATED) ? &dedicated[i].ex : &muxes[i - NDEDICATED].ex;
+    unsigned long long due_tck = ep->setting_tck;
+
+    if (! ep->scheduled) {
+      continue;
+    }
+    if (due_tck < enabled_since_tck) {
+      due_tck = enabled_since_tck;
+    }
+    CHECK((due_tck > now_tck) || (now_tck - due_tck <= SLACK_TCK));
+  }
+}
+
+static hBSP430halTIMER
+startTimer (tBSP430periphHandle periph)
+{
+  hBSP430halTIMER timer = hBSP430timerLookup(periph);
+
+  timer->hpl->ctl = TASSEL_2 | MC_2 | TAIE;
+  return timer;
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  unsigned long iterations = (1 < argc) ? strtoul(argv[1], NULL, 0) : 200000;
+  unsigned long n;
+  unsigned long scheduled_fired = 0;
+  unsigned int i;
+
+  /* The probe's own steps pass time with the timers stopped, so
+   * start again afterwards */
+  vTimerhostInitialize();
+  can_step = (0 == iTimerhostStepBegin());
+  vTimerhostStepEnd();
+  vTimerhostInitialize();
+  uiTimerhostISRTicks = ISR_TCK;
+  uiTimerhostStepsPerTick = STEPS_PER_TICK;
+  (void)startTimer(BSP430_PERIPH_TA0);
+  (void)startTimer(BSP430_PERIPH_TB0);
+
+  for (i = 0; i < NDEDICATED; ++i) {
+    int ta0 = (i < NTA0);
+    hBSP430timerAlarm ap = hBSP430timerAlarmInitialize(&dedicated[i].alarm,
+                                                       ta0 ? BSP430_PERIPH_TA0 : BSP430_PERIPH_TB0,
+                                                       ta0 ? i : (i - NTA0),
+                                                       dedicated_cb);
+    CHECK(&dedicated[i].alarm == ap);
+    CHECK(0 == iBSP430timerAlarmSetEnabled_ni(ap, 1));
+  }
+  CHECK(&shared == hBSP430timerMuxAlarmStartup(&shared, BSP430_PERIPH_TB0, NTB0));
+  for (i = 0; i < NMUX; ++i) {
+    muxes[i].alarm.callback_ni = mux_cb;
+  }
+  enableInterrupts();
+
+  for (n = 0; n < iterations; ++n) {
+    unsigned int op = rng() % 8;
+    unsigned int idx = rng() % (NDEDICATED + NMUX);
+    int is_mux = (idx >= NDEDICATED);
+    sExpected * ep = is_mux ? &muxes[idx - NDEDICATED].ex : &dedicated[idx].ex;
+
+    if (op < 4) {
+      if ((! ep->scheduled) && (rng() & 1)) {
+        approachWrap();
+      }
+      BSP430_CORE_DISABLE_INTERRUPT();
+      if (! ep->scheduled) {
+        if (is_mux) {
+          addMux(muxes + idx - NDEDICATED);
+        } else {
+          setDedicated(dedicated + idx);
+        }
+      } else if (0 == op) {
+        cancel(ep,
+               is_mux ? NULL : &dedicated[idx].alarm,
+               is_mux ? &muxes[idx - NDEDICATED].alarm : NULL);
+      }
+      enableInterrupts();
+    } else if (op < 7) {
+      vTimerhostAdvance((0 == (rng() % 16)) ? rngRange(0, 0x20000UL) : rngRange(0, 300));
+    } else {
+      BSP430_CORE_DISABLE_INTERRUPT();
+      vTimerhostAdvance(rngRange(0, 200));
+      enableInterrupts();
+    }
+    checkOverdue();
+  }
+
+  /* Everything still scheduled fires, within the window */
+  vTimerhostAdvance(0x40000UL);
+  checkOverdue();
+  for (i = 0; i < NDEDICATED + NMUX; ++i) {
+    sExpected * ep = (i < NDEDICATED) ? &dedicated[i].ex : &muxes[i - NDEDICATED].ex;
+
+    CHECK(! ep->scheduled);
+    scheduled_fired += ep->fired;
+  }
+  CHECK(scheduled_fired == fires);
+  CHECK(fires + cancels == scheduled);
+  if (can_step) {
+    checkSlowPeriodic();
+  }
+
+  printf("%lu sets (%lu now, %lu past), %lu cancelled, %lu fired (%lu after interrupts were disabled); "
+         "max late %llu tck\n",
+         sets, rc_counts[BSP430_TIMER_ALARM_SET_NOW], rc_counts[BSP430_TIMER_ALARM_SET_PAST],
+         cancels, fires, blocked_fires, max_late_tck);
+  if (can_step) {
+    printf("slow periodic alarm: %u calls, at most %u per interrupt, up to %u overruns\n",
+           slow_calls, slow_max_calls_isr, slow_max_overruns);
+  }
+  printf("%lu ISRs over %llu ticks, %lu instructions stepped%s\n",
+         ulTimerhostISRCount, ullTimerhostNow(), ulTimerhostSteps,
+         can_step ? "" : " (stepping not supported on this host)");
+  return iTimerhostCheckResult();
+}
@@ -0,0 +1,228 @@
+/* Benchmark for multiplexed alarms on the simulated Timer_A.
+ *
+ * For each requested population a shared alarm on TA0 CC1 manages
+ * that many multiplexed alarms.  Every alarm re-adds itself from its
+ * callback with a randomized period, and occasionally cancels and
+ * re-adds some other alarm, so the structure stays fully populated
+ * while alarms are continuously inserted, expired, and removed.  The
+ * periods scale with the population so that the virtual time between
+ * expirations is roughly constant.
+ *
+ * Reported per population: the mean and worst-case host time of
+ * iBSP430timerMuxAlarmAdd_ni() and iBSP430timerMuxAlarmRemove_ni(),
+ * both of which run with interrupts disabled on the target, and the
+ * mean, 99th percentile, and worst-case host time spent delivering
+ * the interrupts for one timer event.  Every alarm must fire no
+ * earlier than its due time; the worst lateness in timer ticks is
+ * also shown.  Build with and without
+ * #configBSP430_TIMER_MUX_ALARM_HEAP to compare the sorted list
+ * against the heap.
+ *
+ * Usage: timerbench [alarms ...]   (default 10 100 1000) */
+
+#include <bsp430/platform.h>
+#include <bsp430/periph/timer.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "timerhost.h"
+
+#define EXPIRATIONS 200000UL
+#define TICKS_PER_EXPIRATION 64
+
+typedef struct sStat {
+  double sum_ns;
+  double max_ns;
+  unsigned long count;
+} sStat;
+
+static sBSP430timerMuxSharedAlarm shared;
+static sBSP430timerMuxAlarm * alarms;
+static unsigned int nalarms;
+static unsigned long period_tck;
+static unsigned long fired;
+static unsigned long early;
+static unsigned long late_max_tck;
+static sStat add_stat;
+static sStat remove_stat;
+
+static unsigned long rng_state = 1;
+
+static unsigned long
+rng (void)
+{
+  rng_state = rng_state * 1103515245UL + 12345UL;
+  return (rng_state >> 16) & 0x7FFF;
+}
+
+static double
+now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (1e9 * ts.tv_sec) + ts.tv_nsec;
+}
+
+static void
+record (sStat * sp,
+        double ns)
+{
+  sp->sum_ns += ns;
+  if (ns > sp->max_ns) {
+    sp->max_ns = ns;
+  }
+  ++sp->count;
+}
+
+/* A delay uniformly distributed over half to one and a half times the
+ * mean period. */
+static unsigned long
+randomPeriod (void)
+{
+  return (period_tck / 2) + ((rng() * period_tck) >> 15) + 1;
+}
+
+static void
+addAlarm (hBSP430timerMuxAlarm alarm,
+          unsigned long setting_tck)
+{
+  double t0;
+
+  alarm->setting_tck = setting_tck;
+  t0 = now_ns();
+  (void)iBSP430timerMuxAlarmAdd_ni(&shared, alarm);
+  record(&add_stat, now_ns() - t0);
+}
+
+static int
+alarm_cb (hBSP430timerMuxSharedAlarm sap,
+          hBSP430timerMuxAlarm alarm)
+{
+  unsigned long now_tck = ulBSP430timerCounter_ni(sap->dedicated.timer, NULL);
+
+  ++fired;
+  if (0 > (long)(now_tck - alarm->setting_tck)) {
+    ++early;
+  } else if ((now_tck - alarm->setting_tck) > late_max_tck) {
+    late_max_tck = now_tck - alarm->setting_tck;
+  }
+  if (0 == (rng() & 7)) {
+    hBSP430timerMuxAlarm victim = alarms + (rng() % nalarms);
+
+    /* Only reschedule an alarm that is still in the future: one that
+     * is already due may be waiting for its callback in this same
+     * pass, and must not be re-added until that has run. */
+    if (0 < (long)(victim->setting_tck - now_tck)) {
+      double t0 = now_ns();
+
+      (void)iBSP430timerMuxAlarmRemove_ni(sap, victim);
+      record(&remove_stat, now_ns() - t0);
+      addAlarm(victim, now_tck + randomPeriod());
+    }
+  }
+  addAlarm(alarm, alarm->setting_tck + randomPeriod());
+  return 0;
+}
+
+static int
+compareDouble (const void * a,
+               const void * b)
+{
+  double da = *(const double *)a;
+  double db = *(const double *)b;
+
+  return (da > db) - (da < db);
+}
+
+static int
+runPopulation (unsigned int population)
+{
+  static double * event_ns;
+  hBSP430timerMuxSharedAlarm sap;
+  unsigned long nevents = 0;
+  unsigned long max_events = 4 * EXPIRATIONS;
+  double event_sum = 0;
+  unsigned int i;
+
+  if (NULL == event_ns) {
+    event_ns = malloc(max_events * sizeof(*event_ns));
+  }
+  vTimerhostInitialize();
+  alarms = calloc(population, sizeof(*alarms));
+  nalarms = population;
+  period_tck = (unsigned long)population * TICKS_PER_EXPIRATION;
+  fired = 0;
+  early = 0;
+  late_max_tck = 0;
+  memset(&add_stat, 0, sizeof(add_stat));
+  memset(&remove_stat, 0, sizeof(remove_stat));
+
+  sap = hBSP430timerMuxAlarmStartup(&shared, BSP430_PERIPH_TA0, 1);
+  if (NULL == sap) {
+    fprintf(stderr, "mux alarm startup failed\n");
+    return 1;
+  }
+  BSP430_HPL_TA0->ctl = TASSEL_2 | MC_2 | TAIE;
+  vBSP430timerResetCounter_ni(sap->dedicated.timer);
+  for (i = 0; i < population; ++i) {
+    alarms[i].callback_ni = alarm_cb;
+    addAlarm(alarms + i, randomPeriod());
+  }
+  BSP430_CORE_ENABLE_INTERRUPT();
+  while ((fired < EXPIRATIONS) && (nevents < max_events)) {
+    double t0 = now_ns();
+    double dt;
+
+    (void)ulTimerhostAdvanceToEvent();
+    dt = now_ns() - t0;
+    event_ns[nevents++] = dt;
+    event_sum += dt;
+  }
+  BSP430_CORE_DISABLE_INTERRUPT();
+
+  /* Everything must still be scheduled: removing each alarm once must
+   * leave the shared alarm empty. */
+  for (i = 0; i < population; ++i) {
+    (void)iBSP430timerMuxAlarmRemove_ni(sap, alarms + (i * 7919U) % population);
+  }
+  (void)iBSP430timerMuxAlarmShutdown(sap);
+  qsort(event_ns, nevents, sizeof(*event_ns), compareDouble);
+  printf("%6u alarms: add %7.1f ns (max %8.0f)  remove %7.1f ns (max %8.0f)\n"
+         "              event %7.1f ns (p99 %8.0f, max %8.0f)  %lu fired, %lu events, %lu ISRs, late <= %lu tck\n",
+         population,
+         add_stat.sum_ns / add_stat.count, add_stat.max_ns,
+         remove_stat.count ? (remove_stat.sum_ns / remove_stat.count) : 0.0, remove_stat.max_ns,
+         event_sum / nevents, event_ns[(nevents * 99) / 100], event_ns[nevents - 1],
+         fired, nevents, ulTimerhostISRCount, late_max_tck);
+  free(alarms);
+  if (early || (NULL != shared.alarms) || (fired < EXPIRATIONS)) {
+    fprintf(stderr, "FAILED: %lu early, %s, %lu fired\n",
+            early, shared.alarms ? "alarms remain" : "empty", fired);
+    return 1;
+  }
+  return 0;
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  static const unsigned int default_populations[] = { 10, 100, 1000 };
+  int rc = 0;
+  int i;
+
+  printf("Multiplexed alarms held in a %s\n",
+         (configBSP430_TIMER_MUX_ALARM_HEAP - 0) ? "pairing heap" : "sorted list");
+  if (1 < argc) {
+    for (i = 1; i < argc; ++i) {
+      rc |= runPopulation(strtoul(argv[i], NULL, 0));
+    }
+  } else {
+    for (i = 0; i < sizeof(default_populations) / sizeof(*default_populations); ++i) {
+      rc |= runPopulation(default_populations[i]);
+    }
+  }
+  return rc;
+}
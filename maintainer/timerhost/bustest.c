@@ -0,0 +1,344 @@
+/* Test of the shared serial bus scheduler (utility/serialbus) on the
+ * simulated eUSCI_B0 SPI master.
+ *
+ * Four simulated devices share the bus.  Two need the same settings
+ * (declared separately), the others differ in clock phase or
+ * prescaler.  Each round queues a batch of requests with random
+ * devices, priorities, and lengths, some from the main loop and some
+ * from the completion callbacks of earlier requests; each request
+ * runs one interrupt-driven transaction (all sharing one
+ * sBSP430spiTransaction) and completes from its callback.  The test
+ * checks that:
+ *
+ * @li every request started and completed exactly once, in an order
+ * that never served a request while one of higher priority waited,
+ * and that passed over an earlier request of equal priority only to
+ * avoid reconfiguring the device, at most
+ * #BSP430_SERIALBUS_MAX_BYPASS times in a row;
+ * @li the device was configured as the request required for every
+ * octet of its transaction, and was reopened exactly when the
+ * configuration changed or the scheduler had released the peripheral
+ * resource;
+ * @li while another subsystem holds the peripheral resource no
+ * request starts; cancelled requests never start; and the scheduler
+ * releases the resource to a subsystem that starts waiting for it
+ * while requests remain queued.
+ *
+ * Usage: bustest [rounds]   (default 1000) */
+
+#include <bsp430/platform.h>
+#include <bsp430/serial.h>
+#include <bsp430/utility/serialbus.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timerhost.h"
+
+#define MAX_BATCH 16
+#define MAX_LEN 12
+#define NUM_DEVICES 4
+
+#define CTL0_MODE0 BSP430_SERIAL_ADJUST_CTL0_INITIALIZER(UCCKPL | UCMSB | UCMST)
+#define CTL0_MODE1 BSP430_SERIAL_ADJUST_CTL0_INITIALIZER(UCCKPH | UCMSB | UCMST)
+
+static const sBSP430serialBusConfig configs[NUM_DEVICES] = {
+  { .mode = BSP430_SERIALBUS_MODE_SPI, .ctl0_byte = CTL0_MODE0, .ctl1_byte = UCSSEL__SMCLK, .prescaler = 2, .slave_address = -1 },
+  { .mode = BSP430_SERIALBUS_MODE_SPI, .ctl0_byte = CTL0_MODE0, .ctl1_byte = UCSSEL__SMCLK, .prescaler = 2, .slave_address = -1 },
+  { .mode = BSP430_SERIALBUS_MODE_SPI, .ctl0_byte = CTL0_MODE1, .ctl1_byte = UCSSEL__SMCLK, .prescaler = 2, .slave_address = -1 },
+  { .mode = BSP430_SERIALBUS_MODE_SPI, .ctl0_byte = CTL0_MODE0, .ctl1_byte = UCSSEL__SMCLK, .prescaler = 5, .slave_address = -1 },
+};
+
+typedef struct sRequest {
+  sBSP430serialBusRequest bus_req;
+  unsigned int seq;
+  unsigned int device;
+  uint8_t tx[MAX_LEN];
+  size_t tx_len;
+  size_t rx_len;
+  /* Index of the request submitted when this one completes, or -1 */
+  int chain;
+  unsigned int starts;
+  unsigned int completions;
+  /* Position of the first octet in the slave log */
+  unsigned int log_start;
+} sRequest;
+
+static hBSP430halSERIAL spi;
+static sBSP430serialBus bus;
+static sBSP430spiTransaction xfer;
+static sRequest requests[MAX_BATCH];
+static unsigned int nrequests;
+static unsigned int ncompleted;
+static sRequest * active;
+static const sBSP430serialBusConfig * prev_config;
+static unsigned long expected_reconfigurations;
+static unsigned long bypasses;
+
+/* What the slave saw, and the device settings in effect */
+static uint8_t mosi_log[MAX_BATCH * 2 * MAX_LEN];
+static unsigned int ctlw0_log[MAX_BATCH * 2 * MAX_LEN];
+static unsigned int brw_log[MAX_BATCH * 2 * MAX_LEN];
+static unsigned int nlog;
+
+/* Another subsystem contending for the peripheral resource */
+static sBSP430resourceWaiter other_waiter;
+static int other;
+static volatile int other_holds;
+
+static unsigned long rng_state = 1;
+
+static unsigned long
+rng (void)
+{
+  rng_state = rng_state * 1103515245UL + 12345UL;
+  return (rng_state >> 16) & 0x7FFF;
+}
+
+static int
+slave (uint8_t mosi)
+{
+  uiTimerhostISRTicks = 1 + (rng() % 8);
+  CHECK(nlog < sizeof(mosi_log));
+  if (nlog < sizeof(mosi_log)) {
+    mosi_log[nlog] = mosi;
+    ctlw0_log[nlog] = BSP430_HPL_EUSCI_B0->ctlw0;
+    brw_log[nlog] = BSP430_HPL_EUSCI_B0->brw;
+    ++nlog;
+  }
+  return 0xFF & rng();
+}
+
+static int
+sameSettings (const sBSP430serialBusConfig * a,
+              const sBSP430serialBusConfig * b)
+{
+  return (a->ctl0_byte == b->ctl0_byte) && (a->prescaler == b->prescaler);
+}
+
+static int
+otherReleased (hBSP430resource resource,
+               hBSP430resourceWaiter waiter)
+{
+  CHECK(NULL == bus.active_ni);
+  CHECK(0 == iBSP430resourceClaim_ni(resource, &other, eBSP430resourceWait_FIFO, waiter));
+  other_holds = 1;
+  return BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
+}
+
+static int
+transactionDone (hBSP430spiTransaction xp)
+{
+  sRequest * rp = active;
+  int rv = 0;
+
+  CHECK(&xfer == xp);
+  CHECK(NULL != rp);
+  if (NULL == rp) {
+    return BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
+  }
+  ++rp->completions;
+  ++ncompleted;
+  active = NULL;
+  if (0 <= rp->chain) {
+    rv |= iBSP430serialBusSubmit_ni(&bus, &requests[rp->chain].bus_req);
+  }
+  /* Occasionally another subsystem wants the peripheral while there
+   * is still work queued */
+  if ((NULL != bus.head_ni) && (0 == (rng() % 16))) {
+    CHECK(-1 == iBSP430resourceClaim_ni(&spi->resource, &other, eBSP430resourceWait_FIFO, &other_waiter));
+  }
+  rv |= iBSP430serialBusComplete_ni(&bus, &rp->bus_req);
+  CHECK(-1 == iBSP430serialBusComplete_ni(&bus, &rp->bus_req));
+  /* Once the resource is released the configuration is forgotten */
+  if (! bus.held_ni) {
+    prev_config = NULL;
+  }
+  if (ncompleted == nrequests) {
+    rv |= BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
+  }
+  return rv;
+}
+
+static int
+startRequest (hBSP430serialBus bp,
+              hBSP430serialBusRequest brp,
+              hBSP430halSERIAL hal)
+{
+  sRequest * rp = (sRequest *)brp;
+  const sBSP430serialBusConfig * cp = brp->config;
+  hBSP430serialBusRequest qp;
+  int passed_over = 0;
+
+  CHECK(&bus == bp);
+  CHECK(spi == hal);
+  CHECK(NULL == active);
+  CHECK(0 == other_holds);
+  CHECK(BSP430_SERIALBUS_STATE_ACTIVE == brp->state_ni);
+  ++rp->starts;
+  for (qp = bus.head_ni; NULL != qp; qp = qp->next_ni) {
+    const sRequest * qrp = (const sRequest *)qp;
+
+    CHECK(qp->priority <= brp->priority);
+    if ((qp->priority == brp->priority) && (qrp->seq < rp->seq)) {
+      passed_over = 1;
+    }
+  }
+  if (passed_over) {
+    ++bypasses;
+    CHECK(NULL != prev_config);
+    CHECK((NULL != prev_config) && sameSettings(prev_config, cp));
+  }
+  CHECK(bus.bypass_ni <= BSP430_SERIALBUS_MAX_BYPASS);
+  if ((NULL == prev_config) || (! sameSettings(prev_config, cp))) {
+    ++expected_reconfigurations;
+  }
+  prev_config = cp;
+  CHECK(expected_reconfigurations == bus.reconfigurations);
+  active = rp;
+  rp->log_start = nlog;
+  CHECK(0 == iBSP430spiTxRxAsync_ni(hal, &xfer, rp->tx, rp->tx_len, rp->rx_len, NULL, transactionDone));
+  return 0;
+}
+
+static void
+checkRequest (const sRequest * rp)
+{
+  const sBSP430serialBusConfig * cp = rp->bus_req.config;
+  size_t total = rp->tx_len + rp->rx_len;
+  size_t j;
+
+  CHECK(1 == rp->starts);
+  CHECK(1 == rp->completions);
+  CHECK(BSP430_SERIALBUS_STATE_IDLE == rp->bus_req.state_ni);
+  CHECK(rp->log_start + total <= nlog);
+  if (rp->log_start + total > nlog) {
+    return;
+  }
+  for (j = 0; j < total; ++j) {
+    unsigned int li = rp->log_start + j;
+    uint8_t expected = (j < rp->tx_len) ? rp->tx[j] : (0xFF & BSP430_SERIAL_SPI_READ_TX_BYTE(j - rp->tx_len));
+
+    CHECK(mosi_log[li] == expected);
+    CHECK((cp->ctl0_byte << 8) == (ctlw0_log[li] & (UCCKPH | UCCKPL | UCMSB | UCMST)));
+    CHECK(cp->prescaler == (brw_log[li] & 0xFFFF));
+  }
+}
+
+static void
+runRound (void)
+{
+  unsigned int nimmediate;
+  unsigned int cancelled = MAX_BATCH;
+  unsigned int contended = (0 == (rng() % 4));
+  unsigned int i;
+
+  nrequests = 2 + (rng() % (MAX_BATCH - 1));
+  nimmediate = 1 + (rng() % nrequests);
+  for (i = 0; i < nrequests; ++i) {
+    sRequest * rp = requests + i;
+    size_t j;
+
+    memset(rp, 0, sizeof(*rp));
+    rp->seq = i;
+    rp->device = rng() % NUM_DEVICES;
+    rp->bus_req.config = configs + rp->device;
+    rp->bus_req.start_ni = startRequest;
+    rp->bus_req.priority = rng() % 3;
+    rp->tx_len = 1 + (rng() % MAX_LEN);
+    rp->rx_len = rng() % MAX_LEN;
+    for (j = 0; j < rp->tx_len; ++j) {
+      rp->tx[j] = rng();
+    }
+    /* Requests beyond the immediate ones are submitted in turn as
+     * the last immediate one and its successors complete */
+    rp->chain = ((i + 1 >= nimmediate) && (i + 1 < nrequests)) ? (int)(i + 1) : -1;
+  }
+  nlog = 0;
+  ncompleted = 0;
+  active = NULL;
+
+  BSP430_CORE_DISABLE_INTERRUPT();
+  if (contended) {
+    /* Nothing starts while another subsystem holds the resource */
+    CHECK(0 == iBSP430resourceClaim_ni(&spi->resource, &other, eBSP430resourceWait_NONE, NULL));
+    other_holds = 1;
+    if (1 < nimmediate) {
+      /* A cancelled request does not start, and cancelling the whole
+       * queue stops the scheduler waiting for the resource */
+      cancelled = 0;
+      CHECK(0 == iBSP430serialBusSubmit_ni(&bus, &requests[cancelled].bus_req));
+      CHECK(&bus.waiter == spi->resource.waiter);
+      CHECK(-1 == iBSP430serialBusSubmit_ni(&bus, &requests[cancelled].bus_req));
+      CHECK(0 == iBSP430serialBusCancel_ni(&bus, &requests[cancelled].bus_req));
+      CHECK(BSP430_SERIALBUS_STATE_IDLE == requests[cancelled].bus_req.state_ni);
+      CHECK(NULL == spi->resource.waiter);
+    }
+  }
+  for (i = 0; i < nimmediate; ++i) {
+    if (i != cancelled) {
+      CHECK(0 <= iBSP430serialBusSubmit_ni(&bus, &requests[i].bus_req));
+    }
+  }
+  if (contended) {
+    CHECK(NULL == bus.active_ni);
+    CHECK(&bus.waiter == spi->resource.waiter);
+    /* The other subsystem reconfigured the peripheral */
+    prev_config = NULL;
+    other_holds = 0;
+    (void)iBSP430resourceRelease_ni(&spi->resource, &other);
+  }
+  if (cancelled < nrequests) {
+    ++ncompleted;
+  }
+  while (ncompleted < nrequests) {
+    BSP430_CORE_LPM_ENTER_NI(LPM0_bits);
+    BSP430_CORE_DISABLE_INTERRUPT();
+    if (other_holds) {
+      /* The scheduler released the resource with requests queued */
+      CHECK(NULL != bus.head_ni);
+      CHECK(NULL == bus.active_ni);
+      CHECK(0 == bus.held_ni);
+      CHECK(&bus.waiter == spi->resource.waiter);
+      prev_config = NULL;
+      other_holds = 0;
+      (void)iBSP430resourceRelease_ni(&spi->resource, &other);
+    }
+  }
+  CHECK(NULL == bus.head_ni);
+  CHECK(NULL == bus.active_ni);
+  CHECK(0 == bus.held_ni);
+  CHECK(0 == spi->resource.count);
+  CHECK(NULL == spi->resource.waiter);
+  for (i = 0; i < nrequests; ++i) {
+    if (i == cancelled) {
+      CHECK(0 == requests[i].starts);
+    } else {
+      checkRequest(requests + i);
+    }
+  }
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  unsigned long rounds = (1 < argc) ? strtoul(argv[1], NULL, 0) : 1000;
+  unsigned long n;
+
+  vTimerhostInitialize();
+  vTimerhostSPIInitialize(slave);
+  spi = hBSP430serialLookup(BSP430_PERIPH_EUSCI_B0);
+  CHECK(NULL != spi);
+  CHECK(NULL == hBSP430serialBusInitialize_ni(NULL, spi));
+  CHECK(&bus == hBSP430serialBusInitialize_ni(&bus, spi));
+  other_waiter.callback_ni = otherReleased;
+
+  for (n = 0; n < rounds; ++n) {
+    runRound();
+  }
+  CHECK(0 == iBSP430spiTxRxAsyncRelease_ni(&xfer));
+
+  printf("%lu requests, %lu reconfigurations, %lu served out of order, %lu octets\n",
+         bus.requests, bus.reconfigurations, bypasses, ulTimerhostSPIOctets);
+  return iTimerhostCheckResult();
+}
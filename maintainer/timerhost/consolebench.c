@@ -0,0 +1,192 @@
+/* Benchmark of queueing console output for interrupt-driven
+ * transmission on the simulated eUSCI_A0.
+ *
+ * Runs of text of each requested length are queued into an empty
+ * transmit buffer three ways: one octet at a time through cputchar(),
+ * whose fast path stores directly into the ring; one octet at a time
+ * through iBSP430consoleTransmitOctets(), which takes the block path
+ * with a length of one, as every octet did before the block path
+ * existed; and as a single block through cputchars().  The buffer is
+ * drained between runs, outside the measurement, so no run blocks or
+ * drops.
+ *
+ * Reported per run length and method: the mean host time per octet
+ * and, where single-stepping is supported (x86-64), the number of
+ * host instructions executed per octet for one run.  The output is
+ * checked against what was queued.
+ *
+ * Usage: consolebench [length ...]   (default 1 8 32 128) */
+
+#include <bsp430/platform.h>
+#include <bsp430/utility/console.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "timerhost.h"
+
+#define OCTETS_PER_LENGTH 200000UL
+
+typedef enum eMethod {
+  eMethod_CPUTCHAR,
+  eMethod_OCTET,
+  eMethod_BLOCK,
+  eMethod_COUNT
+} eMethod;
+
+static const char * const method_name[] = {
+  "cputchar",
+  "1-octet blocks",
+  "cputchars",
+};
+
+static char text[BSP430_CONSOLE_TX_BUFFER_SIZE];
+static size_t text_len;
+static size_t noutput;
+static unsigned long mismatches;
+
+static unsigned long
+idleLine (uint8_t * octetp)
+{
+  return 0;
+}
+
+/* Compare each transmitted octet with the text of the run */
+static void
+sink (uint8_t octet)
+{
+  if ((noutput >= text_len) || (octet != (uint8_t)text[noutput])) {
+    ++mismatches;
+  }
+  ++noutput;
+}
+
+static double
+now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (1e9 * ts.tv_sec) + ts.tv_nsec;
+}
+
+static void
+emit (eMethod method)
+{
+  size_t i;
+
+  switch (method) {
+    case eMethod_CPUTCHAR:
+      for (i = 0; i < text_len; ++i) {
+        (void)cputchar(text[i]);
+      }
+      break;
+    case eMethod_OCTET:
+      for (i = 0; i < text_len; ++i) {
+        (void)iBSP430consoleTransmitOctets((const uint8_t *)text + i, 1);
+      }
+      break;
+    case eMethod_BLOCK:
+    default:
+      (void)cputchars(text, text_len);
+      break;
+  }
+}
+
+/* Let the UART send everything queued, and check it did */
+static void
+drain (void)
+{
+  while ((UCTXIE & BSP430_HPL_EUSCI_A0->ie)
+         || (UCBUSY & BSP430_HPL_EUSCI_A0->statw)) {
+    vTimerhostAdvance(text_len * uiTimerhostUARTTxTicks);
+  }
+  if (noutput != text_len) {
+    ++mismatches;
+  }
+  noutput = 0;
+}
+
+static void
+run (size_t len,
+     int can_step)
+{
+  unsigned long runs = (OCTETS_PER_LENGTH + len - 1) / len;
+  int m;
+
+  text_len = len;
+  for (m = 0; m < eMethod_COUNT; ++m) {
+    double sum_ns = 0;
+    unsigned long r;
+
+    for (r = 0; r < runs; ++r) {
+      double t0 = now_ns();
+
+      emit(m);
+      sum_ns += now_ns() - t0;
+      drain();
+    }
+    printf("%4u octets, %-14s %7.1f ns/octet", (unsigned int)len, method_name[m], sum_ns / (runs * len));
+    if (can_step) {
+      unsigned long steps = ulTimerhostSteps;
+
+      (void)iTimerhostStepBegin();
+      emit(m);
+      vTimerhostStepEnd();
+      steps = ulTimerhostSteps - steps;
+      drain();
+      printf("  %7.1f instructions/octet", (double)steps / len);
+    }
+    printf("\n");
+  }
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  static const size_t default_lengths[] = { 1, 8, 32, 128 };
+  int can_step;
+  size_t i;
+  int rc;
+
+  for (i = 0; i < sizeof(text); ++i) {
+    text[i] = 'a' + (i % 26);
+  }
+  vTimerhostInitialize();
+  can_step = (0 == iTimerhostStepBegin());
+  vTimerhostStepEnd();
+  /* No time passes while instructions are counted, so the transmitter
+   * does not run concurrently with the code being measured. */
+  uiTimerhostStepsPerTick = ~0U;
+  vTimerhostUARTInitialize(idleLine);
+  vTimerhostUARTSetSink(sink);
+  rc = iBSP430consoleInitialize();
+  if (0 != rc) {
+    fprintf(stderr, "console initialization failed\n");
+    return 1;
+  }
+  BSP430_CORE_ENABLE_INTERRUPT();
+  if (1 < argc) {
+    int a;
+
+    for (a = 1; a < argc; ++a) {
+      size_t len = strtoul(argv[a], NULL, 0);
+
+      if ((0 == len) || (sizeof(text) < len)) {
+        fprintf(stderr, "length %s not in 1..%u\n", argv[a], (unsigned int)sizeof(text));
+        return 1;
+      }
+      run(len, can_step);
+    }
+  } else {
+    for (i = 0; i < sizeof(default_lengths) / sizeof(*default_lengths); ++i) {
+      run(default_lengths[i], can_step);
+    }
+  }
+  if (0 != mismatches) {
+    fprintf(stderr, "FAILED: %lu mismatches in output\n", mismatches);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,272 @@
+/* Test of cooked console input (configBSP430_CONSOLE_RX_COOKED) on
+ * the simulated eUSCI_A0.
+ *
+ * A line is typed and edited with backspace, control-W, and
+ * control-U once for each position of the receive ring relative to
+ * the wrap of its 16-bit index, from a buffer's length before it to
+ * the wrap itself, so that the characters and word boundaries being
+ * erased straddle both the end of the storage and the index wrap.
+ * Then, under each transmit policy, input is typed while the
+ * transmitter is stalled and the transmit buffer is full or nearly
+ * so.  The test checks that:
+ *
+ * @li each edit removes the right characters and echoes the right
+ * erase sequence, and the application reads exactly the edited line;
+ * @li escape sequences, including control sequences with parameters
+ * such as Delete and F5, are buffered through their final character
+ * without echo, and editing resumes after them;
+ * @li echo is queued only if all of it fits, so an erase sequence
+ * is never split, and echo that does not fit is discarded without
+ * counting as a transmit drop or queueing the overflow marker;
+ * @li input whose echo was discarded is still buffered and edited,
+ * and queued output is transmitted intact. */
+
+#include <bsp430/platform.h>
+#include <bsp430/utility/console.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timerhost.h"
+
+#define RX_SIZE BSP430_CONSOLE_RX_BUFFER_SIZE
+#define TX_SIZE BSP430_CONSOLE_TX_BUFFER_SIZE
+#define INDEX_SPAN 0x10000UL
+#define OCTET_TCK 87
+/* Long enough that the transmitter takes nothing from the buffer
+ * while input is typed */
+#define STALL_TCK 1000000UL
+#define OUTPUT_MAX 256
+
+/* Octets the line has yet to send */
+static const char * rx_pending;
+static size_t rx_pending_len;
+static unsigned long rx_sent;
+/* Octets the application has read, which with nothing left unread is
+ * the counter value at which the next octet will be stored */
+static unsigned long rx_read;
+
+static unsigned long
+source (uint8_t * octetp)
+{
+  if (0 == rx_pending_len) {
+    return 0;
+  }
+  --rx_pending_len;
+  *octetp = *rx_pending++;
+  ++rx_sent;
+  return OCTET_TCK;
+}
+
+/* Type text over the line, and let it arrive */
+static void
+type (const char * text,
+      size_t len)
+{
+  rx_pending = text;
+  rx_pending_len = len;
+  vTimerhostUARTResume();
+  vTimerhostAdvance((len + 1) * OCTET_TCK);
+  CHECK(0 == rx_pending_len);
+}
+
+#define TYPE(s_) type(s_, sizeof(s_) - 1)
+
+/* Read what the application would, checking it against a string */
+static void
+readExpect (const char * text)
+{
+  int c;
+
+  while (*text) {
+    c = cgetchar();
+    CHECK((uint8_t)*text == c);
+    ++text;
+    ++rx_read;
+  }
+  CHECK(0 > cgetchar());
+}
+
+/* Transmitted octets since the last checkOutput() */
+static char output[OUTPUT_MAX];
+static size_t noutput;
+
+static void
+sink (uint8_t octet)
+{
+  CHECK(noutput < sizeof(output));
+  if (noutput < sizeof(output)) {
+    output[noutput++] = octet;
+  }
+}
+
+/* Let the UART send everything queued */
+static void
+txDrain (void)
+{
+  while ((UCTXIE & BSP430_HPL_EUSCI_A0->ie)
+         || (UCBUSY & BSP430_HPL_EUSCI_A0->statw)) {
+    vTimerhostAdvance(TX_SIZE * OCTET_TCK);
+  }
+}
+
+/* Check that exactly the expected text was transmitted */
+static void
+checkOutput (const char * expected,
+             size_t len)
+{
+  txDrain();
+  CHECK(len == noutput);
+  CHECK((len == noutput) && (0 == memcmp(output, expected, len)));
+  noutput = 0;
+}
+
+#define CHECK_OUTPUT(s_) checkOutput(s_, sizeof(s_) - 1)
+
+/* Pass octets through the ring uncooked, so the next one typed is
+ * stored at counter value next */
+static void
+rxAdvanceTo (unsigned long next)
+{
+  static const char filler[RX_SIZE / 2] = { 0 };
+
+  BSP430_CORE_DISABLE_INTERRUPT();
+  (void)iBSP430consoleSetRxCooked_ni(0);
+  BSP430_CORE_ENABLE_INTERRUPT();
+  while (rx_read < next) {
+    unsigned long n = next - rx_read;
+
+    if (sizeof(filler) < n) {
+      n = sizeof(filler);
+    }
+    type(filler, n);
+    while (0 <= cgetchar()) {
+      ++rx_read;
+    }
+  }
+  BSP430_CORE_DISABLE_INTERRUPT();
+  (void)iBSP430consoleSetRxCooked_ni(1);
+  BSP430_CORE_ENABLE_INTERRUPT();
+  CHECK(0 == noutput);
+}
+
+/* Type input with the transmit buffer holding all but room octets,
+ * while the transmitter is stalled. */
+static void
+checkEchoTxFull (eBSP430consoleTxPolicy policy,
+                 unsigned int room)
+{
+  char fill[TX_SIZE];
+  char expected[2 + TX_SIZE + 8];
+  size_t nexpected;
+  unsigned int i;
+
+  for (i = 0; i < sizeof(fill); ++i) {
+    fill[i] = 'A' + ((i + room) % 26);
+  }
+  /* Occupy the shift register and TXBUF for the duration, so the
+   * buffer cannot drain */
+  uiTimerhostUARTTxTicks = STALL_TCK;
+  CHECK(2 == cputchars("<>", 2));
+  vTimerhostAdvance(1);
+  BSP430_CORE_DISABLE_INTERRUPT();
+  CHECK(0 == iBSP430consoleWaitForTxSpace_ni(-1));
+  BSP430_CORE_ENABLE_INTERRUPT();
+  CHECK((int)(TX_SIZE - room) == cputchars(fill, TX_SIZE - room));
+  memcpy(expected, "<>", 2);
+  memcpy(expected + 2, fill, TX_SIZE - room);
+  nexpected = 2 + TX_SIZE - room;
+  /* Filled under BLOCK, since DROP_OLDEST keeps room for the marker */
+  (void)iBSP430consoleSetTxPolicy_ni(policy);
+  (void)ulBSP430consoleTxDrops_ni(1);
+
+  /* Three characters, of which as many echo as fit; the seven-octet
+   * erase of the word, which does not fit; and backspace at the start
+   * of the line, whose one-octet bell fits if anything does. */
+  TYPE("abc\027\b\r");
+  for (i = 0; (i < room) && (i < 3); ++i) {
+    expected[nexpected++] = "abc"[i];
+  }
+  if (3 < room) {
+    expected[nexpected++] = '\a';
+  }
+  CHECK(0 == ulBSP430consoleTxDrops_ni(0));
+  readExpect("\r");
+
+  uiTimerhostUARTTxTicks = OCTET_TCK;
+  checkOutput(expected, nexpected);
+  CHECK(0 == ulBSP430consoleTxDrops_ni(0));
+
+  /* Echo resumes, with no overflow marker, once there is room */
+  TYPE("d\r");
+  CHECK_OUTPUT("d");
+  readExpect("d\r");
+  (void)iBSP430consoleSetTxPolicy_ni(eBSP430consoleTxPolicy_BLOCK);
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  static const eBSP430consoleTxPolicy policies[] = {
+    eBSP430consoleTxPolicy_BLOCK,
+    eBSP430consoleTxPolicy_DROP_NEWEST,
+    eBSP430consoleTxPolicy_DROP_OLDEST,
+    eBSP430consoleTxPolicy_TRUNCATE,
+  };
+  unsigned long wrap;
+  unsigned int k;
+  unsigned int p;
+  int rc;
+
+  vTimerhostInitialize();
+  uiTimerhostUARTTxTicks = OCTET_TCK;
+  vTimerhostUARTInitialize(source);
+  vTimerhostUARTSetSink(sink);
+  rc = iBSP430consoleInitialize();
+  CHECK(0 == rc);
+  if (0 != rc) {
+    return 1;
+  }
+  BSP430_CORE_ENABLE_INTERRUPT();
+
+  /* k is how far short of the wrap the line starts */
+  for (k = 0; k <= RX_SIZE; ++k) {
+    wrap = (1 + ((rx_read + RX_SIZE) / INDEX_SPAN)) * INDEX_SPAN;
+    rxAdvanceTo(wrap - k);
+    CHECK((wrap - k) == rx_read);
+
+    /* Word erase takes the trailing word, then any spaces before the
+     * previous word along with it; backspace takes one character. */
+    TYPE("ab cd  efg\027\027\bX\r");
+    CHECK_OUTPUT("ab cd  efg" "\033[3D\033[K" "\033[4D\033[K" "\b \b" "X");
+    readExpect("abX\r");
+
+    /* Line erase, after which backspace has nothing to erase */
+    TYPE("zz yy\025\bq\n");
+    CHECK_OUTPUT("zz yy" "\033[5D\033[K" "\a" "q");
+    readExpect("q\n");
+
+    /* Escape sequences for F5, Delete, and up arrow pass through
+     * without echo; the character between them can still be erased. */
+    TYPE("\033[15~x\by\033[3~\033[A\r");
+    CHECK_OUTPUT("x" "\b \b" "y");
+    readExpect("\033[15~y\033[3~\033[A\r");
+
+    /* Word erase of a line that is all spaces, then of one word */
+    TYPE("   \027w\027\r");
+    CHECK_OUTPUT("   " "\033[3D\033[K" "w" "\b \b");
+    readExpect("\r");
+  }
+
+  for (p = 0; p < sizeof(policies) / sizeof(*policies); ++p) {
+    unsigned int room;
+
+    for (room = 0; room <= 4; ++room) {
+      checkEchoTxFull(policies[p], room);
+    }
+  }
+
+  printf("%lu octets typed, %lu read with the receive index crossing the wrap %lu times\n",
+         rx_sent, rx_read, rx_read / INDEX_SPAN);
+  return iTimerhostCheckResult();
+}
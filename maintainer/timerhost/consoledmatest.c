@@ -0,0 +1,266 @@
+/* Test of console output drained through DMA
+ * (configBSP430_CONSOLE_TX_DMA) on the simulated eUSCI_A0 and DMA
+ * controller.
+ *
+ * Blocks of output of random length, some longer than the transmit
+ * buffer, are queued with pauses of random length between them, so
+ * that queued data wraps around the end of the buffer and the channel
+ * is restarted both when the UART is idle and when the ring has
+ * emptied with an octet still being shifted out.  Console calls and
+ * service routines are single-stepped so the model sees the edge the
+ * console produces on UCTXIFG to start a transfer.  The console is
+ * then stopped while a transfer is in flight, first by switching to
+ * direct transmission and then by deconfiguring it.  The test checks that:
+ *
+ * @li the UART emits exactly the queued data, in order, with every
+ * octet moved by the DMA channel and none through the transmit
+ * interrupt;
+ * @li a transfer never runs past the end of the buffer;
+ * @li switching to direct transmission completes the chunk in flight
+ * and keeps the rest of the buffer, which follows the direct output
+ * once the DMA channel is reattached;
+ * @li deconfiguring the console stops the channel at once, after
+ * which nothing more is transmitted, and a reinitialized console
+ * transmits normally.
+ *
+ * Usage: consoledmatest [blocks]   (default 1000) */
+
+#include <bsp430/platform.h>
+#include <bsp430/utility/console.h>
+#include <bsp430/periph/dma.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timerhost.h"
+
+#define BUFFER_SIZE BSP430_CONSOLE_TX_BUFFER_SIZE
+#define MAX_BLOCK (2 * BUFFER_SIZE)
+#define FIRST_CHUNK 16
+#define OUTPUT_MAX (1UL << 21)
+
+static uint8_t sent[OUTPUT_MAX];
+static unsigned long nsent;
+static uint8_t output[OUTPUT_MAX];
+static unsigned long noutput;
+
+static unsigned long rng_state = 1;
+
+static unsigned long
+rng (void)
+{
+  rng_state = rng_state * 1103515245UL + 12345UL;
+  return (rng_state >> 16) & 0x7FFF;
+}
+
+static unsigned long
+idleLine (uint8_t * octetp)
+{
+  return 0;
+}
+
+static void
+sink (uint8_t octet)
+{
+  if (noutput < OUTPUT_MAX) {
+    output[noutput] = octet;
+  }
+  ++noutput;
+}
+
+static volatile sBSP430hplDMAchannel *
+channel (void)
+{
+  return BSP430_HPL_DMA->ch + BSP430_CONSOLE_TX_DMA_CHANNEL;
+}
+
+static int
+channelBusy (void)
+{
+  return !! (DMAEN & channel()->ctl);
+}
+
+static int
+uartBusy (void)
+{
+  return !! (UCBUSY & BSP430_HPL_EUSCI_A0->statw);
+}
+
+/* Address of the console transmit buffer, learned from the first
+ * transfer, which starts at its beginning. */
+static uintptr_t buffer_base;
+
+/* Verify the channel addresses lie within the buffer */
+static void
+checkChannel (void)
+{
+  volatile sBSP430hplDMAchannel * chp = channel();
+
+  if (! channelBusy()) {
+    return;
+  }
+  CHECK(chp->sa >= buffer_base);
+  CHECK((chp->sa + chp->sz) <= (buffer_base + BUFFER_SIZE));
+}
+
+/* Append len octets of a recognizable sequence to what is expected,
+ * and queue them through the console with the calling code
+ * single-stepped. */
+static void
+queue (size_t len)
+{
+  uint8_t * dp = sent + nsent;
+  size_t i;
+  int rc;
+
+  for (i = 0; i < len; ++i) {
+    dp[i] = 0xFF & ((nsent + i) * 13 + ((nsent + i) >> 8));
+  }
+  nsent += len;
+  (void)iTimerhostStepBegin();
+  rc = iBSP430consoleTransmitOctets(dp, len);
+  vTimerhostStepEnd();
+  CHECK((int)len == rc);
+  CHECK(! (UCTXIE & BSP430_HPL_EUSCI_A0->ie));
+}
+
+/* Let the console drain completely */
+static void
+drain (void)
+{
+  while (channelBusy() || uartBusy()) {
+    vTimerhostAdvance(BUFFER_SIZE * uiTimerhostUARTTxTicks);
+  }
+}
+
+static void
+checkOutput (void)
+{
+  CHECK(noutput == nsent);
+  CHECK(0 == memcmp(output, sent, (noutput < nsent) ? noutput : nsent));
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  unsigned long blocks = (1 < argc) ? strtoul(argv[1], NULL, 0) : 1000;
+  unsigned long idle_restarts = 0;
+  unsigned long busy_restarts = 0;
+  unsigned long b;
+  unsigned long before;
+  unsigned long transfers;
+  unsigned long octets;
+  const char direct[] = "direct";
+  int rc;
+
+  vTimerhostInitialize();
+  if (0 != iTimerhostStepBegin()) {
+    printf("single-stepping unsupported, test skipped\n");
+    return 0;
+  }
+  vTimerhostStepEnd();
+  /* The completion interrupt restarts the channel with an edge on
+   * UCTXIFG */
+  iTimerhostStepISRs = 1;
+  /* An 8 MHz CPU */
+  uiTimerhostStepsPerTick = 8;
+  vTimerhostUARTInitialize(idleLine);
+  vTimerhostUARTSetSink(sink);
+  rc = iBSP430consoleInitialize();
+  CHECK(0 == rc);
+  if (0 != rc) {
+    return 1;
+  }
+  BSP430_CORE_ENABLE_INTERRUPT();
+
+  /* Wrap and restart */
+  queue(1);
+  buffer_base = channel()->sa;
+  for (b = 0; (b < blocks) && ((nsent + MAX_BLOCK) <= OUTPUT_MAX); ++b) {
+    size_t len = 1 + (rng() % MAX_BLOCK);
+
+    if (! channelBusy()) {
+      if (uartBusy()) {
+        ++busy_restarts;
+      } else {
+        ++idle_restarts;
+      }
+    }
+    queue(len);
+    checkChannel();
+    vTimerhostAdvance(rng() % (2 * len * uiTimerhostUARTTxTicks));
+    checkChannel();
+  }
+  drain();
+  checkOutput();
+  CHECK(0 != idle_restarts);
+  CHECK(0 != busy_restarts);
+  CHECK(ulTimerhostDMATransfers == nsent);
+
+  /* Switch to direct transmission during the first of two chunks.
+   * The chunk completes, the direct output follows it, and the rest
+   * of the buffer is sent once the channel is reattached. */
+  queue((2 * BUFFER_SIZE - FIRST_CHUNK - (nsent % BUFFER_SIZE)) % BUFFER_SIZE);
+  drain();
+  CHECK((BUFFER_SIZE - FIRST_CHUNK) == (nsent % BUFFER_SIZE));
+  before = nsent;
+  transfers = ulTimerhostDMATransfers;
+  queue(BUFFER_SIZE - 4);
+  CHECK(channelBusy());
+  CHECK(FIRST_CHUNK == channel()->sz + (ulTimerhostDMATransfers - transfers));
+  BSP430_CORE_DISABLE_INTERRUPT();
+  (void)iTimerhostStepBegin();
+  rc = iBSP430consoleTransmitUseInterrupts_ni(0);
+  vTimerhostStepEnd();
+  CHECK(0 == rc);
+  CHECK(! channelBusy());
+  CHECK(! (DMAIFG & channel()->ctl));
+  CHECK((before + FIRST_CHUNK) == noutput);
+  octets = noutput;
+  (void)iTimerhostStepBegin();
+  rc = cputchars(direct, sizeof(direct) - 1);
+  vTimerhostStepEnd();
+  CHECK((sizeof(direct) - 1) == rc);
+  memmove(sent + octets + sizeof(direct) - 1, sent + octets, nsent - octets);
+  memcpy(sent + octets, direct, sizeof(direct) - 1);
+  nsent += sizeof(direct) - 1;
+  transfers = ulTimerhostDMATransfers;
+  (void)iTimerhostStepBegin();
+  rc = iBSP430consoleTransmitUseInterrupts_ni(1);
+  vTimerhostStepEnd();
+  CHECK(0 == rc);
+  BSP430_CORE_ENABLE_INTERRUPT();
+  drain();
+  checkOutput();
+  CHECK((ulTimerhostDMATransfers - transfers) == (BUFFER_SIZE - 4 - FIRST_CHUNK));
+
+  /* Deconfigure part way through a transfer.  The channel stops
+   * immediately; what was in TXBUF and the shift register is lost
+   * with the reset. */
+  before = nsent;
+  transfers = ulTimerhostDMATransfers;
+  queue(BUFFER_SIZE / 2);
+  vTimerhostAdvance(5 * uiTimerhostUARTTxTicks);
+  CHECK(channelBusy());
+  BSP430_CORE_DISABLE_INTERRUPT();
+  rc = iBSP430consoleDeconfigure();
+  CHECK(0 == rc);
+  CHECK(! channelBusy());
+  BSP430_CORE_ENABLE_INTERRUPT();
+  octets = noutput;
+  CHECK((before < octets) && (octets < nsent));
+  vTimerhostAdvance(BUFFER_SIZE * uiTimerhostUARTTxTicks);
+  CHECK(octets == noutput);
+  CHECK(0 == memcmp(output, sent, octets));
+  CHECK((ulTimerhostDMATransfers - transfers) <= (octets - before + 2));
+  nsent = noutput;
+  rc = iBSP430consoleInitialize();
+  CHECK(0 == rc);
+  queue(3 * BUFFER_SIZE / 2);
+  drain();
+  checkOutput();
+
+  printf("%lu octets in %lu blocks, %lu DMA transfers\n", noutput, b, ulTimerhostDMATransfers);
+  printf("restarts: %lu with the UART idle, %lu with an octet still shifting\n", idle_restarts, busy_restarts);
+  return iTimerhostCheckResult();
+}
@@ -0,0 +1,371 @@
+/* Test of the console transmit policies
+ * (iBSP430consoleSetTxPolicy_ni()) with output drained through DMA
+ * on the simulated eUSCI_A0 and DMA controller.
+ *
+ * Under each policy, blocks of output of random length, up to twice
+ * the transmit buffer, are queued with pauses of random length
+ * between them.  Some blocks are queued with a transfer in flight and
+ * some with the channel idle and the buffer empty.  The output is
+ * divided into epochs, each ending with the console drained and a
+ * one-octet block that collects any overflow marker still owed.
+ * Within an epoch every octet queued has a distinct value that
+ * differs from the characters of the marker, so the transmitted
+ * stream shows exactly what was kept and where each marker went.
+ * Console calls and service routines are single-stepped so the model
+ * sees the edge the console produces on UCTXIFG to start a transfer.
+ * The test checks that:
+ *
+ * @li the octets transmitted are those queued, in order, with
+ * nothing repeated or altered;
+ * @li a marker appears exactly where output was lost, never twice in
+ * a row, and nowhere else;
+ * @li ulBSP430consoleTxDrops_ni() counts exactly the octets lost;
+ * @li the octets of a transfer in flight are not modified while it
+ * is in flight, and are all transmitted;
+ * @li BLOCK loses nothing; DROP_NEWEST keeps each block whole or
+ * not at all; TRUNCATE keeps the part of each block it reports
+ * accepting; and DROP_OLDEST cuts a block, discarding its oldest
+ * octets, only as far as needed to fit it beside the transfer in
+ * flight.
+ *
+ * Usage: consolepolicytest [epochs]   (default 100) */
+
+#include <bsp430/platform.h>
+#include <bsp430/utility/console.h>
+#include <bsp430/periph/dma.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timerhost.h"
+
+#define BUFFER_SIZE BSP430_CONSOLE_TX_BUFFER_SIZE
+#define MAX_BLOCK (2 * BUFFER_SIZE)
+#define MARKER BSP430_CONSOLE_TX_OVERFLOW_MARKER
+#define MARKER_LEN (sizeof(MARKER) - 1)
+/* Distinct octet values available to an epoch: all but the
+ * characters of the marker */
+#define EPOCH_MAX (256 - MARKER_LEN)
+#define OUTPUT_MAX 1024
+
+static unsigned long rng_state = 1;
+
+static unsigned long
+rng (void)
+{
+  rng_state = rng_state * 1103515245UL + 12345UL;
+  return (rng_state >> 16) & 0x7FFF;
+}
+
+static const char * const policy_name[] = {
+  "BLOCK",
+  "DROP_NEWEST",
+  "DROP_OLDEST",
+  "TRUNCATE",
+};
+
+/* Octet value for each position within an epoch, and the reverse */
+static uint8_t value_of[EPOCH_MAX];
+static int position_of[256];
+
+/* Per position within the epoch: whether it was seen in flight and
+ * whether it was transmitted */
+static uint8_t in_flight[EPOCH_MAX];
+static uint8_t delivered[EPOCH_MAX];
+static unsigned int nqueued;
+
+/* Per block within the epoch: first position, length, and the
+ * number of octets the call reported accepting */
+static unsigned int block_start[EPOCH_MAX];
+static unsigned int block_len[EPOCH_MAX];
+static unsigned int block_accepted[EPOCH_MAX];
+static unsigned int nblocks;
+
+static uint8_t output[OUTPUT_MAX];
+static unsigned int noutput;
+
+static eBSP430consoleTxPolicy policy_;
+static unsigned long idle_calls;
+static unsigned long active_calls;
+static unsigned long lost_octets;
+static unsigned long markers;
+
+static unsigned long
+idleLine (uint8_t * octetp)
+{
+  return 0;
+}
+
+static void
+sink (uint8_t octet)
+{
+  CHECK(noutput < OUTPUT_MAX);
+  if (noutput < OUTPUT_MAX) {
+    output[noutput++] = octet;
+  }
+}
+
+static volatile sBSP430hplDMAchannel *
+channel (void)
+{
+  return BSP430_HPL_DMA->ch + BSP430_CONSOLE_TX_DMA_CHANNEL;
+}
+
+static int
+channelBusy (void)
+{
+  return !! (DMAEN & channel()->ctl);
+}
+
+/* Let the console drain completely */
+static void
+drain (void)
+{
+  while (channelBusy() || (UCBUSY & BSP430_HPL_EUSCI_A0->statw)) {
+    vTimerhostAdvance(BUFFER_SIZE * uiTimerhostUARTTxTicks);
+  }
+}
+
+/* Queue the next len positions of the epoch as one block, with the
+ * call single-stepped.  The octets of any transfer in flight are
+ * recorded, and must not change unless a service routine ran and
+ * could have completed the transfer. */
+static void
+queue (unsigned int len)
+{
+  uint8_t block[MAX_BLOCK];
+  uint8_t flight[BUFFER_SIZE];
+  const uint8_t * fp = NULL;
+  unsigned int flen = 0;
+  unsigned int dma_len = 0;
+  unsigned long isrs = ulTimerhostISRCount;
+  unsigned int i;
+  int rc;
+
+  for (i = 0; i < len; ++i) {
+    block[i] = value_of[nqueued + i];
+  }
+  if (channelBusy()) {
+    const uint8_t * start = (const uint8_t *)(uintptr_t)channel()->sa;
+
+    fp = (const uint8_t *)xTimerhostDMASource(BSP430_CONSOLE_TX_DMA_CHANNEL);
+    flen = channel()->sz;
+    dma_len = (fp - start) + flen;
+    CHECK(flen <= sizeof(flight));
+    if (flen > sizeof(flight)) {
+      flen = sizeof(flight);
+    }
+    memcpy(flight, fp, flen);
+    for (i = 0; i < flen; ++i) {
+      /* Octets of a marker have no position */
+      if (0 <= position_of[fp[i]]) {
+        in_flight[position_of[fp[i]]] = 1;
+      }
+    }
+    ++active_calls;
+  } else {
+    ++idle_calls;
+  }
+  (void)iTimerhostStepBegin();
+  rc = iBSP430consoleTransmitOctets(block, len);
+  vTimerhostStepEnd();
+  CHECK((0 <= rc) && (rc <= (int)len));
+  if (isrs == ulTimerhostISRCount) {
+    CHECK((0 == flen) || (0 == memcmp(flight, fp, flen)));
+    /* Older data goes first: the block is cut only to what fits
+     * beside the transfer in flight and a marker. */
+    if (eBSP430consoleTxPolicy_DROP_OLDEST == policy_) {
+      int room = BUFFER_SIZE - MARKER_LEN - dma_len;
+
+      if (0 > room) {
+        room = 0;
+      }
+      CHECK(rc == (((int)len < room) ? (int)len : room));
+    }
+  }
+  block_start[nblocks] = nqueued;
+  block_len[nblocks] = len;
+  block_accepted[nblocks] = rc;
+  ++nblocks;
+  nqueued += len;
+}
+
+/* Verify what the epoch transmitted against what it queued */
+static void
+checkEpoch (eBSP430consoleTxPolicy policy)
+{
+  unsigned int next = 0;
+  int marker_pending = 0;
+  unsigned int lost = 0;
+  unsigned int i;
+  unsigned int b;
+
+  memset(delivered, 0, sizeof(delivered));
+  i = 0;
+  while (i < noutput) {
+    int pos;
+
+    if ((noutput - i) >= MARKER_LEN && (0 == memcmp(output + i, MARKER, MARKER_LEN))) {
+      CHECK(! marker_pending);
+      marker_pending = 1;
+      ++markers;
+      i += MARKER_LEN;
+      continue;
+    }
+    pos = position_of[output[i++]];
+    CHECK(0 <= pos);
+    if (0 > pos) {
+      continue;
+    }
+    CHECK(pos >= (int)next);
+    if (pos < (int)next) {
+      continue;
+    }
+    /* A marker stands exactly where output was lost */
+    CHECK(marker_pending == (pos > (int)next));
+    lost += pos - next;
+    marker_pending = 0;
+    delivered[pos] = 1;
+    next = pos + 1;
+  }
+  /* The epoch ends with a block the console always accepts */
+  CHECK(next == nqueued);
+  CHECK(! marker_pending);
+  CHECK(lost == ulBSP430consoleTxDrops_ni(1));
+  lost_octets += lost;
+
+  for (i = 0; i < nqueued; ++i) {
+    if (in_flight[i]) {
+      CHECK(delivered[i]);
+    }
+  }
+  for (b = 0; b < nblocks; ++b) {
+    unsigned int kept = 0;
+    unsigned int prefix = 0;
+
+    for (i = block_start[b]; i < block_start[b] + block_len[b]; ++i) {
+      kept += delivered[i];
+      if ((prefix == (i - block_start[b])) && delivered[i]) {
+        ++prefix;
+      }
+    }
+    switch (policy) {
+      case eBSP430consoleTxPolicy_BLOCK:
+        CHECK(block_len[b] == block_accepted[b]);
+        CHECK(kept == block_len[b]);
+        break;
+      case eBSP430consoleTxPolicy_DROP_NEWEST:
+        CHECK((0 == block_accepted[b]) || (block_len[b] == block_accepted[b]));
+        CHECK(kept == block_accepted[b]);
+        break;
+      case eBSP430consoleTxPolicy_TRUNCATE:
+        CHECK(kept == block_accepted[b]);
+        CHECK(prefix == kept);
+        break;
+      case eBSP430consoleTxPolicy_DROP_OLDEST:
+      default:
+        /* Octets the call did not accept are the oldest of its
+         * block; later calls may discard more. */
+        CHECK(kept <= block_accepted[b]);
+        for (i = block_start[b]; i < block_start[b] + block_len[b] - block_accepted[b]; ++i) {
+          CHECK(! delivered[i]);
+        }
+        break;
+    }
+  }
+}
+
+static void
+runPolicy (eBSP430consoleTxPolicy policy,
+           unsigned long epochs)
+{
+  unsigned long e;
+
+  policy_ = policy;
+  BSP430_CORE_DISABLE_INTERRUPT();
+  CHECK(0 <= iBSP430consoleSetTxPolicy_ni(policy));
+  (void)ulBSP430consoleTxDrops_ni(1);
+  BSP430_CORE_ENABLE_INTERRUPT();
+  idle_calls = active_calls = lost_octets = markers = 0;
+  for (e = 0; e < epochs; ++e) {
+    noutput = 0;
+    nqueued = 0;
+    nblocks = 0;
+    memset(in_flight, 0, sizeof(in_flight));
+    while (1) {
+      unsigned int len = 1 + (rng() % MAX_BLOCK);
+
+      if ((nqueued + len + 1) > EPOCH_MAX) {
+        break;
+      }
+      if (0 == (rng() % 4)) {
+        drain();
+      }
+      queue(len);
+      vTimerhostAdvance(rng() % (len * uiTimerhostUARTTxTicks));
+    }
+    drain();
+    queue(1);
+    drain();
+    checkEpoch(policy);
+  }
+  printf("%-11s %5lu calls with DMA active, %5lu idle; %6lu octets lost, %5lu markers\n",
+         policy_name[policy], active_calls, idle_calls, lost_octets, markers);
+  CHECK(0 < active_calls);
+  CHECK(0 < idle_calls);
+  if (eBSP430consoleTxPolicy_BLOCK == policy) {
+    CHECK(0 == lost_octets);
+  } else {
+    CHECK(0 < lost_octets);
+  }
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  unsigned long epochs = (1 < argc) ? strtoul(argv[1], NULL, 0) : 100;
+  const char * mp;
+  unsigned int i;
+  unsigned int v;
+  int rc;
+
+  for (v = 0; v < 256; ++v) {
+    position_of[v] = -1;
+  }
+  for (v = 0, i = 0; v < 256; ++v) {
+    for (mp = MARKER; *mp && (v != (uint8_t)*mp); ++mp) {
+    }
+    if (! *mp) {
+      value_of[i] = v;
+      position_of[v] = i;
+      ++i;
+    }
+  }
+
+  vTimerhostInitialize();
+  if (0 != iTimerhostStepBegin()) {
+    printf("single-stepping unsupported, test skipped\n");
+    return 0;
+  }
+  vTimerhostStepEnd();
+  /* The completion interrupt restarts the channel with an edge on
+   * UCTXIFG */
+  iTimerhostStepISRs = 1;
+  /* An 8 MHz CPU */
+  uiTimerhostStepsPerTick = 8;
+  vTimerhostUARTInitialize(idleLine);
+  vTimerhostUARTSetSink(sink);
+  rc = iBSP430consoleInitialize();
+  CHECK(0 == rc);
+  if (0 != rc) {
+    return 1;
+  }
+  BSP430_CORE_ENABLE_INTERRUPT();
+
+  runPolicy(eBSP430consoleTxPolicy_BLOCK, epochs);
+  runPolicy(eBSP430consoleTxPolicy_DROP_NEWEST, epochs);
+  runPolicy(eBSP430consoleTxPolicy_DROP_OLDEST, epochs);
+  runPolicy(eBSP430consoleTxPolicy_TRUNCATE, epochs);
+
+  return iTimerhostCheckResult();
+}
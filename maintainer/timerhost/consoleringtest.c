@@ -0,0 +1,303 @@
+/* Test of the console receive and transmit rings across the wrap of
+ * their 16-bit free-running indices, on the simulated eUSCI_A0.
+ *
+ * Each ring is driven through 65536 octets once for each position of
+ * its index relative to the wrap, from a buffer's length before it to
+ * the wrap itself.  At that position the ring is empty; it is then
+ * filled so that the stored data straddles the wrap, overfilled, and
+ * emptied again.  The receive ring is fed through the simulated line
+ * and read with cgetchar(); the transmit ring is filled with
+ * cputchar() and iBSP430consoleTransmitOctets() under the DROP_NEWEST
+ * policy, and drained by the transmit interrupt.  The test checks
+ * that:
+ *
+ * @li an empty ring reads as empty, and reports the whole buffer
+ * available, on either side of the wrap;
+ * @li a full receive ring keeps the newest octets, discarding exactly
+ * as many of the oldest as overfilled it, and returns them in order;
+ * @li a full transmit ring refuses further octets and counts them as
+ * drops, transmits what it holds in order, and follows it with the
+ * overflow marker ahead of the next data;
+ * @li every other octet passes through both rings unchanged;
+ * @li under the TRUNCATE policy, cputtext() and cprintf() return only
+ * the number of characters accepted;
+ * @li under the BLOCK policy, output several times the length of the
+ * transmit ring reaches the line without a gap, though the writer
+ * takes several octet times to resume after it is woken. */
+
+#include <bsp430/platform.h>
+#include <bsp430/utility/console.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timerhost.h"
+
+#define RX_SIZE BSP430_CONSOLE_RX_BUFFER_SIZE
+#define TX_SIZE BSP430_CONSOLE_TX_BUFFER_SIZE
+#define INDEX_SPAN 0x10000UL
+#define OCTET_TCK 87
+#define EXPECT_SIZE 256
+
+/* The octet at position n of either stream */
+static uint8_t
+pattern (unsigned long n)
+{
+  return 0xFF & ((n * 7) + (n >> 8));
+}
+
+/* Octets the line has been asked for and has sent */
+static unsigned long rx_pending;
+static unsigned long rx_sent;
+/* Position of the next octet the test expects to read */
+static unsigned long rx_read;
+
+static unsigned long
+source (uint8_t * octetp)
+{
+  if (0 == rx_pending) {
+    return 0;
+  }
+  --rx_pending;
+  *octetp = pattern(rx_sent++);
+  return OCTET_TCK;
+}
+
+/* Send n octets over the line, and let them arrive */
+static void
+rxFeed (unsigned long n)
+{
+  rx_pending = n;
+  vTimerhostUARTResume();
+  vTimerhostAdvance((n + 1) * OCTET_TCK);
+  CHECK(0 == rx_pending);
+}
+
+/* Read from the console until it is empty, checking each octet */
+static void
+rxDrain (void)
+{
+  int c;
+
+  while (0 <= (c = cgetchar())) {
+    CHECK(pattern(rx_read) == c);
+    ++rx_read;
+  }
+  CHECK(rx_read == rx_sent);
+}
+
+/* Pass octets through the receive ring, which stays well short of
+ * full, until next octets have been received. */
+static void
+rxAdvanceTo (unsigned long next)
+{
+  while (rx_sent < next) {
+    unsigned long n = next - rx_sent;
+
+    if ((RX_SIZE / 2) < n) {
+      n = RX_SIZE / 2;
+    }
+    rxFeed(n);
+    rxDrain();
+  }
+}
+
+/* Octets queued for transmission and not yet seen on the line, as a
+ * FIFO of what the UART must send */
+static uint8_t expect[EXPECT_SIZE];
+static unsigned int expect_head;
+static unsigned int expect_tail;
+static unsigned long tx_queued;
+static unsigned long noutput;
+/* While watch_starved is set, the octets transmitted and those that
+ * finished with no successor waiting in TXBUF */
+static int watch_starved;
+static unsigned long watched;
+static unsigned long starved;
+
+static void
+expectOctets (const uint8_t * dp,
+              size_t len)
+{
+  while (0 < len--) {
+    CHECK((expect_head - expect_tail) < EXPECT_SIZE);
+    expect[expect_head++ % EXPECT_SIZE] = *dp++;
+  }
+}
+
+static void
+sink (uint8_t octet)
+{
+  CHECK(expect_head != expect_tail);
+  if (expect_head != expect_tail) {
+    CHECK(expect[expect_tail++ % EXPECT_SIZE] == octet);
+  }
+  if (watch_starved) {
+    ++watched;
+    if (UCTXIFG & BSP430_HPL_EUSCI_A0->ifg) {
+      ++starved;
+    }
+  }
+  ++noutput;
+}
+
+/* Queue n octets of the pattern, one block at a time, each of which
+ * must be accepted */
+static void
+txQueue (unsigned long n)
+{
+  while (0 < n--) {
+    uint8_t octet = pattern(tx_queued++);
+
+    CHECK(1 == iBSP430consoleTransmitOctets(&octet, 1));
+    expectOctets(&octet, 1);
+  }
+}
+
+/* Let the UART send everything queued */
+static void
+txDrain (void)
+{
+  while ((UCTXIE & BSP430_HPL_EUSCI_A0->ie)
+         || (UCBUSY & BSP430_HPL_EUSCI_A0->statw)) {
+    vTimerhostAdvance(TX_SIZE * OCTET_TCK);
+  }
+  CHECK(expect_head == expect_tail);
+}
+
+/* Verify the transmit ring is empty */
+static void
+txCheckEmpty (void)
+{
+  BSP430_CORE_DISABLE_INTERRUPT();
+  CHECK(0 == iBSP430consoleWaitForTxSpace_ni(-1));
+  CHECK(0 == iBSP430consoleWaitForTxSpace_ni(TX_SIZE));
+  BSP430_CORE_ENABLE_INTERRUPT();
+}
+
+static void
+txAdvanceTo (unsigned long next)
+{
+  while (tx_queued < next) {
+    unsigned long n = next - tx_queued;
+
+    if (TX_SIZE < n) {
+      n = TX_SIZE;
+    }
+    txQueue(n);
+    txDrain();
+  }
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  const uint8_t marker[] = BSP430_CONSOLE_TX_OVERFLOW_MARKER;
+  unsigned long wrap;
+  unsigned int k;
+  int rc;
+
+  vTimerhostInitialize();
+  vTimerhostUARTInitialize(source);
+  vTimerhostUARTSetSink(sink);
+  rc = iBSP430consoleInitialize();
+  CHECK(0 == rc);
+  if (0 != rc) {
+    return 1;
+  }
+  (void)iBSP430consoleSetTxPolicy_ni(eBSP430consoleTxPolicy_DROP_NEWEST);
+  BSP430_CORE_ENABLE_INTERRUPT();
+
+  /* Receive ring: k is how far short of the wrap the empty ring
+   * stands before it is filled. */
+  for (k = 0; k <= RX_SIZE; ++k) {
+    unsigned int extra;
+
+    wrap = (1 + (rx_sent / INDEX_SPAN)) * INDEX_SPAN;
+    rxAdvanceTo(wrap - k);
+    CHECK(0 > cpeekchar());
+    CHECK(0 > cgetchar());
+    /* Fill exactly, then overfill by up to three octets */
+    extra = k % 4;
+    rxFeed(RX_SIZE + extra);
+    CHECK(pattern(rx_read + extra) == cpeekchar());
+    rx_read += extra;
+    rxDrain();
+    CHECK(0 > cgetchar());
+    /* Empty on the far side of the wrap */
+    rxFeed(1);
+    rxDrain();
+  }
+
+  /* Transmit ring, likewise */
+  for (k = 0; k <= TX_SIZE; ++k) {
+    uint8_t octet;
+    unsigned int i;
+
+    wrap = (1 + (tx_queued / INDEX_SPAN)) * INDEX_SPAN;
+    txAdvanceTo(wrap - k);
+    txCheckEmpty();
+    /* Nothing leaves the ring until time passes.  Fill half through
+     * the per-octet fast path and half as blocks. */
+    (void)ulBSP430consoleTxDrops_ni(1);
+    for (i = 0; i < TX_SIZE / 2; ++i) {
+      octet = pattern(tx_queued++);
+      CHECK(octet == cputchar(octet));
+      expectOctets(&octet, 1);
+    }
+    txQueue(TX_SIZE - (TX_SIZE / 2));
+    octet = pattern(tx_queued);
+    CHECK(0 > cputchar(octet));
+    CHECK(0 == iBSP430consoleTransmitOctets(&octet, 1));
+    CHECK(2 == ulBSP430consoleTxDrops_ni(0));
+    txDrain();
+    txCheckEmpty();
+    /* The marker goes out ahead of the next octet */
+    expectOctets(marker, sizeof(marker) - 1);
+    txQueue(1);
+    txDrain();
+    txCheckEmpty();
+  }
+
+  /* Text that does not fit is counted only as far as it was accepted */
+  {
+    const char text[] = "0123456789";
+
+    (void)iBSP430consoleSetTxPolicy_ni(eBSP430consoleTxPolicy_TRUNCATE);
+    (void)ulBSP430consoleTxDrops_ni(1);
+    txQueue(TX_SIZE - 4);
+    CHECK(4 == cputtext(text));
+    expectOctets((const uint8_t *)text, 4);
+    CHECK(0 == cprintf("%s", text));
+    CHECK((6 + 10) == ulBSP430consoleTxDrops_ni(0));
+    txDrain();
+    expectOctets(marker, sizeof(marker) - 1);
+    txQueue(1);
+    txDrain();
+  }
+
+  /* A long block, with the writer slow to resume once woken */
+  {
+    uint8_t block[4 * TX_SIZE];
+    unsigned int i;
+
+    (void)iBSP430consoleSetTxPolicy_ni(eBSP430consoleTxPolicy_BLOCK);
+    uiTimerhostWakeTicks = 4 * OCTET_TCK;
+    for (i = 0; i < sizeof(block); ++i) {
+      block[i] = pattern(tx_queued++);
+    }
+    expectOctets(block, sizeof(block));
+    watch_starved = 1;
+    CHECK((int)sizeof(block) == iBSP430consoleTransmitOctets(block, sizeof(block)));
+    txDrain();
+    watch_starved = 0;
+    uiTimerhostWakeTicks = 0;
+    CHECK(sizeof(block) == watched);
+    /* Only the last octet has nothing after it */
+    CHECK(1 == starved);
+  }
+
+  printf("%lu octets received and %lu transmitted through %u-octet and %u-octet rings\n",
+         rx_sent, noutput, RX_SIZE, TX_SIZE);
+  return iTimerhostCheckResult();
+}
@@ -0,0 +1,213 @@
+/* Test of ullBSP430timerCounter(), the counter read that does not
+ * disable interrupts, against overflows at every instruction
+ * boundary.
+ *
+ * The read is single-stepped using the x86 trap flag.  Each step
+ * advances the TA0 counter by one tick; when it wraps TAIFG is set,
+ * and if interrupts are modelled as enabled the overflow ISR runs a
+ * configurable number of steps later, at an instruction boundary
+ * inside the read.  Starting the counter at each offset below the
+ * wrap places the overflow at every boundary in turn, in either of
+ * two successive reads.  Each result must lie between the true
+ * counter values on entry and exit, and the second read must not be
+ * less than the first.
+ *
+ * For comparison the same injections are applied to
+ * ulBSP430timerCounter_ni(), which is only valid with interrupts
+ * disabled; the number of wrong values it returns is reported.
+ *
+ * Usage: countertest */
+
+#define _GNU_SOURCE
+
+#include <bsp430/platform.h>
+#include <bsp430/periph/timer.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+#include "timerhost.h"
+
+#define ISR_TCK 7
+#define NO_INTERRUPT -1
+
+void isr_TA0 (void);
+
+static hBSP430halTIMER timer;
+static volatile sBSP430hplTIMER * hpl;
+static volatile int tracing;
+static unsigned long steps;
+static unsigned long isr_step;
+static unsigned long isrs;
+static int latency;
+static unsigned long long true_tck;
+
+#if defined(__x86_64__)
+
+/* One instruction has executed.  Let a tick pass, and take the
+ * overflow interrupt when it is due. */
+static void
+trap_handler (int sig,
+              siginfo_t * info,
+              void * context)
+{
+  ucontext_t * ucp = (ucontext_t *)context;
+
+  if (! tracing) {
+    ucp->uc_mcontext.gregs[REG_EFL] &= ~0x100;
+    return;
+  }
+  ++steps;
+  ++true_tck;
+  hpl->r = (hpl->r + 1) & 0xFFFF;
+  if (0 == hpl->r) {
+    hpl->ctl |= TAIFG;
+    if (NO_INTERRUPT != latency) {
+      isr_step = steps + latency;
+    }
+  }
+  if (isr_step == steps) {
+    isr_TA0();
+    ++isrs;
+    hpl->r += ISR_TCK;
+    true_tck += ISR_TCK;
+    isr_step = 0;
+  }
+}
+
+static void
+traceStart (void)
+{
+  tracing = 1;
+  __asm__ __volatile__ ("pushfq\n\torq $0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+}
+
+static void
+traceStop (void)
+{
+  tracing = 0;
+}
+
+/* Position the counter @p before_wrap ticks below an overflow and
+ * read it under single-stepping: twice in succession for the
+ * lock-free read.  Returns nonzero if a result was outside the true
+ * values at entry and exit, or the second read was less than the
+ * first. */
+static int
+tracedRead (int lock_free,
+            unsigned long overflow_count,
+            unsigned int before_wrap,
+            int isr_latency,
+            unsigned long long * resultp)
+{
+  unsigned long long entry_tck;
+  unsigned long long exit_tck;
+  unsigned long long rv;
+  unsigned long long rv2 = 0;
+
+  hpl->ctl &= ~TAIFG;
+  hpl->r = (0x10000UL - before_wrap) & 0xFFFF;
+  timer->overflow_count = overflow_count;
+  steps = 0;
+  isr_step = 0;
+  latency = isr_latency;
+  entry_tck = ((unsigned long long)overflow_count << 16) + hpl->r;
+  true_tck = entry_tck;
+  traceStart();
+  if (lock_free) {
+    rv = ullBSP430timerCounter(timer);
+    rv2 = ullBSP430timerCounter(timer);
+  } else {
+    rv = ulBSP430timerCounter_ni(timer, NULL);
+  }
+  traceStop();
+  exit_tck = true_tck;
+  /* Drain anything pending so the next case starts clean */
+  if (hpl->ctl & TAIFG) {
+    if (NO_INTERRUPT != isr_latency) {
+      isr_TA0();
+    } else {
+      hpl->ctl &= ~TAIFG;
+    }
+  }
+  *resultp = rv;
+  if (lock_free) {
+    return (rv < entry_tck) || (rv2 < rv) || (rv2 > exit_tck);
+  }
+  return (unsigned long)(rv - entry_tck) > (unsigned long)(exit_tck - entry_tck);
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  static const unsigned long overflow_counts[] = { 0, 0x1234, 0xFFFF, 0xFFFFFFFFUL };
+  static const int latencies[] = { 0, 1, 2, 5, NO_INTERRUPT };
+  struct sigaction sa;
+  unsigned long reads = 0;
+  unsigned long unsafe_reads = 0;
+  unsigned long unsafe_wrong = 0;
+  unsigned long max_steps = 0;
+  unsigned long long result;
+  unsigned int oi;
+  unsigned int li;
+  unsigned int before_wrap;
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = trap_handler;
+  sa.sa_flags = SA_SIGINFO;
+  sigaction(SIGTRAP, &sa, NULL);
+
+  vTimerhostInitialize();
+  timer = hBSP430timerLookup(BSP430_PERIPH_TA0);
+  hpl = timer->hpl;
+  hpl->ctl = TASSEL_2 | MC_2 | TAIE;
+
+  /* Learn how many steps a read takes when nothing happens */
+  (void)tracedRead(1, 0, 0x8000, NO_INTERRUPT, &result);
+  max_steps = steps;
+
+  for (oi = 0; oi < sizeof(overflow_counts) / sizeof(*overflow_counts); ++oi) {
+    for (li = 0; li < sizeof(latencies) / sizeof(*latencies); ++li) {
+      for (before_wrap = 1; before_wrap <= max_steps + 2; ++before_wrap) {
+        unsigned long isrs_before = isrs;
+        int wrong = tracedRead(1, overflow_counts[oi], before_wrap, latencies[li], &result);
+
+        ++reads;
+        if (wrong) {
+          if (iTimerhostCheckFailed()) {
+            fprintf(stderr, "overflow %#lx latency %d wrap after %u: read %#llx\n",
+                    overflow_counts[oi], latencies[li], before_wrap, result);
+          }
+        }
+        if (isrs != isrs_before) {
+          CHECK(timer->overflow_count == overflow_counts[oi] + 1);
+        }
+
+        if (NO_INTERRUPT != latencies[li]) {
+          ++unsafe_reads;
+          unsafe_wrong += tracedRead(0, overflow_counts[oi], before_wrap, latencies[li], &result);
+        }
+      }
+    }
+  }
+
+  printf("%lu lock-free reads of up to %lu steps with an overflow at each boundary, %lu wrong\n",
+         reads, max_steps, ulTimerhostFailures);
+  printf("interrupt-unsafe read with interrupts enabled: %lu of %lu wrong\n",
+         unsafe_wrong, unsafe_reads);
+  return iTimerhostCheckResult();
+}
+
+#else /* __x86_64__ */
+
+int
+main (int argc,
+      char * argv[])
+{
+  printf("countertest: single-stepping requires an x86-64 host; skipped\n");
+  return 0;
+}
+
+#endif /* __x86_64__ */
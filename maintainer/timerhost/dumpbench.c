@@ -0,0 +1,449 @@
+/* Check and benchmark of the console memory dump on the simulated
+ * eUSCI_A0.
+ *
+ * The implementation of vBSP430consoleDisplayMemory() and
+ * vBSP430consoleDisplayOctets() that formatted each octet through
+ * cprintf() is reproduced here for comparison.  The output captured
+ * from the UART is checked byte for byte:
+ *
+ * @li for a base address on a 16-octet boundary
+ * vBSP430consoleDisplayMemory() produces exactly what the old
+ * implementation did, for every length up to several lines;
+ * @li for any other base it produces the old output preceded by
+ * what the old one left out: the newline, the address of the first
+ * line's block, and blanks for the positions before the region;
+ * @li vBSP430consoleDisplayOctets() produces exactly the old output;
+ * @li vBSP430consoleDump() with #BSP430_CONSOLE_DUMP_RAW transmits
+ * the octets unaltered;
+ * @li vBSP430consoleDump() with every address width, grouping, and
+ * gutter setting, for bases at each offset within a line, matches a
+ * reference built with snprintf().
+ *
+ * Then a region is dumped one KiB at a time, into an empty transmit
+ * buffer that holds a KiB's worth of output, with the old
+ * implementation and with several layouts of the new.  Reported per
+ * layout: the mean host time per KiB dumped and, where
+ * single-stepping is supported (x86-64), the number of host
+ * instructions executed to dump one KiB.  The buffer is drained
+ * between KiB, outside the measurement.
+ *
+ * Usage: dumpbench [kib]   (default 64; 0 only checks) */
+
+#include <bsp430/platform.h>
+#include <bsp430/utility/console.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "timerhost.h"
+
+#define KIB 1024
+#define REGION_MAX 128
+#define OUTPUT_MAX (8 * KIB)
+
+#if (configBSP430_CONSOLE_USE_ONLCR - 0)
+#define EOL "\r\n"
+#else /* configBSP430_CONSOLE_USE_ONLCR */
+#define EOL "\n"
+#endif /* configBSP430_CONSOLE_USE_ONLCR */
+
+static unsigned long rng_state = 1;
+
+static unsigned long
+rng (void)
+{
+  rng_state = rng_state * 1103515245UL + 12345UL;
+  return (rng_state >> 16) & 0x7FFF;
+}
+
+/* The implementation formatting through cprintf() */
+static void
+oldDisplayOctets (const uint8_t * dp,
+                  size_t len)
+{
+  const uint8_t * const edp = dp + len;
+  while (dp < edp) {
+    cprintf("%02x", *dp++);
+    if (dp < edp) {
+      cputchar(' ');
+    }
+  }
+}
+
+static void
+oldDisplayMemory (const uint8_t * dp,
+                  size_t len,
+                  unsigned long base)
+{
+  const uint8_t * const edp = dp + len;
+  const uint8_t * adp = dp;
+
+  while (dp < edp) {
+    if (0 == (base & 0x0F)) {
+      if (adp < dp) {
+        cputtext("  ");
+        while (adp < dp) {
+          cputchar(isprint(*adp) ? *adp : '.');
+          ++adp;
+        }
+      }
+      adp = dp;
+      cprintf("\n%08lx ", base);
+    } else if (0 == (base & 0x07)) {
+      cputchar(' ');
+    }
+    cprintf(" %02x", *dp++);
+    ++base;
+  }
+  if (adp < dp) {
+    while (base & 0x0F) {
+      if (0 == (base & 0x07)) {
+        cputchar(' ');
+      }
+      cprintf("   ");
+      ++base;
+    }
+    cputtext("  ");
+    while (adp < dp) {
+      cputchar(isprint(*adp) ? *adp : '.');
+      ++adp;
+    }
+  }
+  cputchar('\n');
+}
+
+/* Octets transmitted since the last capture began; only the first
+ * OUTPUT_MAX are kept */
+static char output[OUTPUT_MAX];
+static size_t noutput;
+
+static unsigned long
+idleLine (uint8_t * octetp)
+{
+  return 0;
+}
+
+static void
+sink (uint8_t octet)
+{
+  if (noutput < sizeof(output)) {
+    output[noutput] = octet;
+  }
+  ++noutput;
+}
+
+/* Let the UART send everything queued */
+static void
+drain (void)
+{
+  while ((UCTXIE & BSP430_HPL_EUSCI_A0->ie)
+         || (UCBUSY & BSP430_HPL_EUSCI_A0->statw)) {
+    vTimerhostAdvance(BSP430_CONSOLE_TX_BUFFER_SIZE * uiTimerhostUARTTxTicks);
+  }
+}
+
+/* Copy out what was transmitted, and start a new capture */
+static size_t
+capture (char * dp,
+         size_t len)
+{
+  size_t n;
+
+  drain();
+  n = noutput;
+  CHECK(n <= len);
+  if (n > len) {
+    n = len;
+  }
+  memcpy(dp, output, n);
+  noutput = 0;
+  return n;
+}
+
+/* The dump described by the documentation of vBSP430consoleDump() */
+static size_t
+referenceDump (char * out,
+               const uint8_t * dp,
+               size_t len,
+               unsigned long base,
+               unsigned int flags)
+{
+  unsigned int digits = flags & 0x0F;
+  unsigned int group = (flags >> 4) & 0x1F;
+  char * op = out;
+
+  if (flags & BSP430_CONSOLE_DUMP_RAW) {
+    memcpy(out, dp, len);
+    return len;
+  }
+  if (8 < digits) {
+    digits = 8;
+  }
+  if (16 <= group) {
+    group = 0;
+  }
+  while (0 < len) {
+    unsigned int first = base % 16;
+    unsigned int end = (len < (16 - first)) ? (first + len) : 16;
+    unsigned int i;
+
+    memcpy(op, EOL, sizeof(EOL) - 1);
+    op += sizeof(EOL) - 1;
+    if (0 < digits) {
+      op += sprintf(op, "%0*lx ", (int)digits, (base - first) & (0xFFFFFFFFUL >> (32 - 4 * digits)));
+    }
+    for (i = 0; i < ((flags & BSP430_CONSOLE_DUMP_ASCII) ? 16 : end); ++i) {
+      if ((0 < group) && (0 < i) && (0 == (i % group))) {
+        *op++ = ' ';
+      }
+      if ((first <= i) && (i < end)) {
+        op += sprintf(op, " %02x", dp[i - first]);
+      } else {
+        memcpy(op, "   ", 3);
+        op += 3;
+      }
+    }
+    if (flags & BSP430_CONSOLE_DUMP_ASCII) {
+      *op++ = ' ';
+      *op++ = ' ';
+      for (i = 0; i < end; ++i) {
+        *op++ = (i < first) ? ' ' : (isprint(dp[i - first]) ? dp[i - first] : '.');
+      }
+    }
+    dp += end - first;
+    len -= end - first;
+    base += end - first;
+  }
+  memcpy(op, EOL, sizeof(EOL) - 1);
+  op += sizeof(EOL) - 1;
+  return op - out;
+}
+
+static void
+checkOutput (const char * expected,
+             size_t expected_len,
+             const char * what,
+             size_t len,
+             unsigned long base,
+             unsigned int flags)
+{
+  char got[OUTPUT_MAX];
+  size_t got_len = capture(got, sizeof(got));
+
+  if ((got_len == expected_len) && (0 == memcmp(got, expected, got_len))) {
+    return;
+  }
+  if (iTimerhostCheckFailed()) {
+    fprintf(stderr, "%s len %u base %#lx flags %#x: expected %u octets \"%.*s\", got %u \"%.*s\"\n",
+            what, (unsigned int)len, base, flags,
+            (unsigned int)expected_len, (int)expected_len, expected,
+            (unsigned int)got_len, (int)got_len, got);
+  }
+}
+
+/* Insert len octets at offset at into text */
+static void
+insert (char * text,
+        size_t * text_lenp,
+        size_t at,
+        const char * dp,
+        size_t len)
+{
+  memmove(text + at + len, text + at, *text_lenp - at);
+  memcpy(text + at, dp, len);
+  *text_lenp += len;
+}
+
+static void
+checkDumps (const uint8_t * region)
+{
+  char expected[OUTPUT_MAX];
+  size_t expected_len;
+  unsigned int flags;
+  unsigned int offset;
+  size_t len;
+
+  /* Against the old implementation */
+  for (offset = 0; offset < 16; ++offset) {
+    for (len = 0; len <= 80; ++len) {
+      unsigned long base = 0x12340 + offset;
+
+      oldDisplayMemory(region, len, base);
+      expected_len = capture(expected, sizeof(expected));
+      if ((0 != offset) && (0 < len)) {
+        /* What the old implementation left out of the first line: the
+         * blanks ahead of its characters, then the line terminator,
+         * its block's address, and the blanks ahead of its octets. */
+        char lead[64];
+        size_t nlead;
+        size_t nchars = ((16 - offset) < len) ? (16 - offset) : len;
+        size_t eol = 0;
+        unsigned int i;
+
+        while (((eol + sizeof(EOL) - 1) <= expected_len)
+               && (0 != memcmp(expected + eol, EOL, sizeof(EOL) - 1))) {
+          ++eol;
+        }
+        CHECK(nchars <= eol);
+        CHECK(eol < expected_len);
+        memset(lead, ' ', offset);
+        insert(expected, &expected_len, eol - nchars, lead, offset);
+        nlead = sprintf(lead, EOL "%08lx ", base & ~0x0FUL);
+        for (i = 0; i < offset; ++i) {
+          nlead += sprintf(lead + nlead, (8 == i) ? "    " : "   ");
+        }
+        insert(expected, &expected_len, 0, lead, nlead);
+      }
+      vBSP430consoleDisplayMemory(region, len, base);
+      checkOutput(expected, expected_len, "DisplayMemory", len, base, BSP430_CONSOLE_DUMP_DEFAULT);
+    }
+  }
+  for (len = 0; len <= 40; ++len) {
+    oldDisplayOctets(region, len);
+    expected_len = capture(expected, sizeof(expected));
+    vBSP430consoleDisplayOctets(region, len);
+    checkOutput(expected, expected_len, "DisplayOctets", len, 0, 0);
+  }
+
+  /* Raw, ignoring the other flags */
+  for (len = 0; len <= REGION_MAX; ++len) {
+    vBSP430consoleDump(region, len, rng(), BSP430_CONSOLE_DUMP_RAW | (rng() & 0x3FF));
+    checkOutput((const char *)region, len, "raw", len, 0, BSP430_CONSOLE_DUMP_RAW);
+  }
+
+  /* Every layout against the reference */
+  for (flags = 0; flags <= 0x3FF; ++flags) {
+    for (offset = 0; offset < 16; ++offset) {
+      unsigned long base = ((unsigned long)rng() << 17) ^ (rng() << 4) ^ offset;
+
+      len = rng() % 50;
+      expected_len = referenceDump(expected, region, len, base, flags);
+      vBSP430consoleDump(region, len, base, flags);
+      checkOutput(expected, expected_len, "Dump", len, base, flags);
+    }
+  }
+}
+
+typedef enum eLayout {
+  eLayout_OLD,
+  eLayout_DEFAULT,
+  eLayout_BARE,
+  eLayout_RAW,
+  eLayout_COUNT
+} eLayout;
+
+static const char * const layout_name[] = {
+  "cprintf (old)",
+  "default",
+  "octets only",
+  "raw",
+};
+
+static void
+dumpKiB (eLayout layout,
+         const uint8_t * dp,
+         unsigned long base)
+{
+  switch (layout) {
+    case eLayout_OLD:
+      oldDisplayMemory(dp, KIB, base);
+      break;
+    case eLayout_DEFAULT:
+      vBSP430consoleDisplayMemory(dp, KIB, base);
+      break;
+    case eLayout_BARE:
+      vBSP430consoleDump(dp, KIB, base, 0);
+      break;
+    case eLayout_RAW:
+    default:
+      vBSP430consoleDump(dp, KIB, base, BSP430_CONSOLE_DUMP_RAW);
+      break;
+  }
+}
+
+static double
+now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (1e9 * ts.tv_sec) + ts.tv_nsec;
+}
+
+static void
+bench (const uint8_t * region,
+       unsigned long kib,
+       int can_step)
+{
+  int l;
+
+  for (l = 0; l < eLayout_COUNT; ++l) {
+    double sum_ns = 0;
+    size_t octets = 0;
+    unsigned long k;
+
+    for (k = 0; k < kib; ++k) {
+      double t0 = now_ns();
+
+      dumpKiB(l, region, k * KIB);
+      sum_ns += now_ns() - t0;
+      drain();
+      octets += noutput;
+      noutput = 0;
+    }
+    CHECK(0 == ulBSP430consoleTxDrops_ni(1));
+    printf("%-14s %6u octets/KiB %9.0f ns/KiB", layout_name[l], (unsigned int)(octets / kib), sum_ns / kib);
+    if (can_step) {
+      unsigned long steps = ulTimerhostSteps;
+
+      (void)iTimerhostStepBegin();
+      dumpKiB(l, region, 0);
+      vTimerhostStepEnd();
+      steps = ulTimerhostSteps - steps;
+      drain();
+      noutput = 0;
+      printf("  %8lu instructions/KiB", steps);
+    }
+    printf("\n");
+  }
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  static uint8_t region[KIB];
+  unsigned long kib = (1 < argc) ? strtoul(argv[1], NULL, 0) : 64;
+  int can_step;
+  unsigned int i;
+  int rc;
+
+  for (i = 0; i < sizeof(region); ++i) {
+    region[i] = rng();
+  }
+  /* Some text, so the gutter shows more than dots */
+  memcpy(region + 5, "Printable text in the region", 28);
+  vTimerhostInitialize();
+  can_step = (0 == iTimerhostStepBegin());
+  vTimerhostStepEnd();
+  /* No time passes while instructions are counted, so the transmitter
+   * does not run concurrently with the code being measured. */
+  uiTimerhostStepsPerTick = ~0U;
+  vTimerhostUARTInitialize(idleLine);
+  vTimerhostUARTSetSink(sink);
+  rc = iBSP430consoleInitialize();
+  if (0 != rc) {
+    fprintf(stderr, "console initialization failed\n");
+    return 1;
+  }
+  (void)iBSP430consoleSetTxPolicy_ni(eBSP430consoleTxPolicy_DROP_NEWEST);
+  BSP430_CORE_ENABLE_INTERRUPT();
+
+  checkDumps(region);
+  /* Zero skips the benchmark */
+  if (0 < kib) {
+    bench(region, kib, can_step);
+  }
+  return iTimerhostCheckResult();
+}
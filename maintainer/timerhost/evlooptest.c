@@ -0,0 +1,157 @@
+/* Test of the event loop (utility/evloop) on the simulated timers.
+ *
+ * TA0 serves as the uptime timer, so timed events are posted by a
+ * multiplexed alarm on it.  A periodic alarm on TA1 CC0 plays the part
+ * of a peripheral interrupt, counting "received" items and posting a
+ * work item to consume them.  The test checks that:
+ *
+ * @li periodic timed events run once per period and are re-armed
+ * from their scheduled time;
+ * @li one-shot events run no earlier than they were due;
+ * @li everything produced in interrupt context is consumed by the
+ * main loop, with posts made while a handler is busy merged;
+ * @li handlers run with interrupts enabled;
+ * @li the loop sleeps in LPM0 while a hold is in place and in LPM3
+ * otherwise.
+ *
+ * Usage: evlooptest [periods]   (default 2000) */
+
+#include <bsp430/platform.h>
+#include <bsp430/utility/evloop.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "timerhost.h"
+
+#define PERIOD_UTT 1000UL
+#define ONESHOT_UTT 3333UL
+#define PRODUCER_TCK 77UL
+#define BUSY_TCK 300UL
+
+static sBSP430evloopTimer periodic;
+static sBSP430evloopTimer oneshot;
+static sBSP430evloopWork consumer;
+static sBSP430timerAlarm producer;
+
+static unsigned long periods;
+static unsigned long periodic_runs;
+static unsigned long oneshot_runs;
+static unsigned long oneshot_due_utt;
+static unsigned long consumer_runs;
+static volatile unsigned long produced;
+static unsigned long consumed;
+static unsigned long sleeps;
+static int holding;
+
+static void
+periodic_handler (hBSP430evloopWork work)
+{
+  hBSP430evloopTimer tp = (hBSP430evloopTimer)work;
+
+  CHECK(iTimerhostGIE);
+  ++periodic_runs;
+  /* Already re-armed for the next period, at an exact multiple */
+  CHECK(tp->alarm.setting_tck == (periodic_runs + 1) * PERIOD_UTT);
+  CHECK(0 == tp->alarm.overruns);
+  if (periodic_runs >= periods) {
+    vBSP430evloopStop();
+  }
+  /* Take long enough that the producer posts several times before
+   * the consumer can run. */
+  vTimerhostAdvance(BUSY_TCK);
+}
+
+static void
+oneshot_handler (hBSP430evloopWork work)
+{
+  hBSP430evloopTimer tp = (hBSP430evloopTimer)work;
+  unsigned long now_utt = ulBSP430uptime();
+
+  CHECK(iTimerhostGIE);
+  ++oneshot_runs;
+  CHECK(0 <= (long)(now_utt - oneshot_due_utt));
+  /* Alternate between holding and releasing LPM0, as a driver would
+   * around a transfer that needs SMCLK. */
+  BSP430_CORE_DISABLE_INTERRUPT();
+  if (holding) {
+    vBSP430evloopLPMRelease_ni(0);
+  } else {
+    vBSP430evloopLPMHold_ni(0);
+  }
+  holding = ! holding;
+  oneshot_due_utt += ONESHOT_UTT;
+  CHECK(0 <= iBSP430evloopTimerSchedule_ni(tp, oneshot_due_utt, 0));
+  BSP430_CORE_ENABLE_INTERRUPT();
+}
+
+static void
+consumer_handler (hBSP430evloopWork work)
+{
+  unsigned long avail;
+
+  CHECK(iTimerhostGIE);
+  ++consumer_runs;
+  BSP430_CORE_DISABLE_INTERRUPT();
+  avail = produced;
+  BSP430_CORE_ENABLE_INTERRUPT();
+  CHECK(avail > consumed);
+  consumed = avail;
+}
+
+static int
+producer_cb (hBSP430timerAlarm alarm)
+{
+  ++produced;
+  return iBSP430evloopPost(&consumer);
+}
+
+static unsigned int
+idle_hook (unsigned int lpm_bits)
+{
+  ++sleeps;
+  CHECK(! iTimerhostGIE);
+  CHECK(lpm_bits == (holding ? LPM0_bits : LPM3_bits));
+  return lpm_bits;
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  hBSP430timerAlarm pa;
+
+  periods = (1 < argc) ? strtoul(argv[1], NULL, 0) : 2000;
+  vTimerhostInitialize();
+  vBSP430uptimeStart_ni();
+  CHECK(0 == iBSP430evloopInitialize());
+  (void)xBSP430evloopSetIdleHook_ni(idle_hook);
+
+  (void)hBSP430evloopTimerInitialize(&periodic, periodic_handler);
+  CHECK(0 == iBSP430evloopTimerSchedule_ni(&periodic, PERIOD_UTT, PERIOD_UTT));
+  (void)hBSP430evloopTimerInitialize(&oneshot, oneshot_handler);
+  oneshot_due_utt = ONESHOT_UTT;
+  CHECK(0 == iBSP430evloopTimerSchedule_ni(&oneshot, oneshot_due_utt, 0));
+  (void)hBSP430evloopWorkInitialize(&consumer, consumer_handler);
+
+  BSP430_HPL_TA1->ctl = TASSEL_2 | MC_2 | TAIE;
+  pa = hBSP430timerAlarmInitialize(&producer, BSP430_PERIPH_TA1, 0, producer_cb);
+  CHECK(NULL != pa);
+  CHECK(0 == iBSP430timerAlarmEnable(pa));
+  BSP430_CORE_DISABLE_INTERRUPT();
+  CHECK(0 == iBSP430timerAlarmSetPeriodic_ni(pa, PRODUCER_TCK, PRODUCER_TCK));
+
+  vBSP430evloopRun();
+
+  /* Anything produced after the last consumer run is still pending */
+  BSP430_CORE_DISABLE_INTERRUPT();
+  (void)iBSP430timerAlarmCancel_ni(pa);
+  (void)iBSP430evloopRunPending();
+  CHECK(consumed == produced);
+  CHECK(consumer_runs < produced);
+  CHECK(periodic_runs == periods);
+  CHECK(oneshot_runs == (periods * PERIOD_UTT) / ONESHOT_UTT);
+
+  printf("%lu periodic, %lu one-shot, %lu produced in %lu consumer runs, %lu sleeps, %lu ISRs over %llu ticks\n",
+         periodic_runs, oneshot_runs, produced, consumer_runs, sleeps,
+         ulTimerhostISRCount, ullTimerhostNow());
+  return iTimerhostCheckResult();
+}
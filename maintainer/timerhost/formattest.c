@@ -0,0 +1,410 @@
+/* Comparison of the integer conversion and formatting in
+ * utility/format against the host C library.
+ *
+ * The values converted are every 16-bit value; the values on either
+ * side of each power of two and of ten up to 64 bits; and
+ * pseudo-random values of 16, 32, and 64 bits.  The test checks
+ * that:
+ *
+ * @li iBSP430formatUnsignedLong() and iBSP430formatUnsignedLongLong()
+ * in radixes 8, 10, and 16, lower and upper case, produce what
+ * snprintf() does;
+ * @li conversion in every other radix from 2 to 36 has no leading
+ * zeros and converts back to the original value, and radixes outside
+ * that range are rejected;
+ * @li iBSP430formatVprintf() produces the text and the length that
+ * vsnprintf() does for every integer conversion, with each
+ * combination of the flags defined for it, field widths and
+ * precisions given literally or by @c * (negative ones included),
+ * and each length modifier; for the plain conversions of every
+ * 16-bit value; and for @c %c, @c %s, @c %p, and @c %% with widths
+ * and precisions.
+ *
+ * The on-target example in examples/unittests/format compares the
+ * speed of conversion against division.
+ *
+ * Usage: formattest [random-values]   (default 20000) */
+
+#include <bsp430/utility/format.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timerhost.h"
+
+#define OUTPUT_MAX 256
+#define VALUES_MAX 512
+
+static char output[OUTPUT_MAX];
+static size_t noutput;
+static unsigned long comparisons;
+
+static unsigned long rng_state = 1;
+
+static unsigned long
+rng (void)
+{
+  rng_state = rng_state * 1103515245UL + 12345UL;
+  return (rng_state >> 16) & 0x7FFF;
+}
+
+static unsigned long long
+rng64 (void)
+{
+  unsigned long long v = 0;
+  int i;
+
+  for (i = 0; i < 5; ++i) {
+    v = (v << 15) | rng();
+  }
+  return v;
+}
+
+/* Edge values: around each power of two and of ten */
+static unsigned long long values[VALUES_MAX];
+static unsigned int nvalues;
+
+static void
+addValue (unsigned long long v)
+{
+  if (nvalues < VALUES_MAX) {
+    values[nvalues++] = v;
+  }
+}
+
+static int
+emit (void * context,
+      const char * cp,
+      size_t len)
+{
+  if ((noutput + len) < sizeof(output)) {
+    memcpy(output + noutput, cp, len);
+  }
+  noutput += len;
+  return 0;
+}
+
+/* Format with both implementations and compare */
+static void
+compare (const char * format, ...)
+{
+  char expected[OUTPUT_MAX];
+  va_list ap;
+  int erc;
+  int rc;
+
+  va_start(ap, format);
+  erc = vsnprintf(expected, sizeof(expected), format, ap);
+  va_end(ap);
+  noutput = 0;
+  va_start(ap, format);
+  rc = iBSP430formatVprintf(emit, NULL, format, ap);
+  va_end(ap);
+  ++comparisons;
+  if ((rc == erc) && (noutput == (size_t)rc) && (noutput < sizeof(output))
+      && (0 == memcmp(output, expected, noutput))) {
+    return;
+  }
+  if (iTimerhostCheckFailed()) {
+    fprintf(stderr, "\"%s\": expected %d \"%s\", got %d \"%.*s\"\n",
+            format, erc, expected, rc, (int)((noutput < sizeof(output)) ? noutput : 0), output);
+  }
+}
+
+/* Convert with iBSP430formatUnsignedLongLong() and compare against
+ * snprintf() where it supports the radix */
+static void
+compareConversion (unsigned long long v)
+{
+  static const struct {
+    int radix;
+    const char * format;
+  } radixes[] = {
+    { 8, "%llo" },
+    { 10, "%llu" },
+    { 16, "%llx" },
+    { 16 | BSP430_FORMAT_RADIX_UPPER, "%llX" },
+  };
+  char buf[BSP430_FORMAT_BUFFER_SIZE];
+  char expected[BSP430_FORMAT_BUFFER_SIZE];
+  unsigned int i;
+
+  for (i = 0; i < sizeof(radixes) / sizeof(*radixes); ++i) {
+    int len = snprintf(expected, sizeof(expected), radixes[i].format, v);
+
+    ++comparisons;
+    CHECK(len == iBSP430formatUnsignedLongLong(buf, v, radixes[i].radix));
+    CHECK(0 == strcmp(expected, buf));
+    if (v <= (unsigned long)-1) {
+      CHECK(len == iBSP430formatUnsignedLong(buf, (unsigned long)v, radixes[i].radix));
+      CHECK(0 == strcmp(expected, buf));
+    }
+  }
+}
+
+/* Convert in every radix and convert back by multiplication */
+static void
+checkRadixes (unsigned long long v)
+{
+  char buf[BSP430_FORMAT_BUFFER_SIZE];
+  int radix;
+
+  for (radix = 2; radix <= 36; ++radix) {
+    int upper;
+
+    for (upper = 0; upper < 2; ++upper) {
+      unsigned long long pv = 0;
+      int len = iBSP430formatUnsignedLongLong(buf, v, radix | (upper ? BSP430_FORMAT_RADIX_UPPER : 0));
+      int i;
+
+      CHECK((0 < len) && ((int)strlen(buf) == len));
+      CHECK((1 == len) || ('0' != buf[0]));
+      for (i = 0; i < len; ++i) {
+        int c = buf[i];
+        int d;
+
+        if (('0' <= c) && (c <= '9')) {
+          d = c - '0';
+        } else if (upper) {
+          CHECK(('A' <= c) && (c <= 'Z'));
+          d = c - 'A' + 10;
+        } else {
+          CHECK(('a' <= c) && (c <= 'z'));
+          d = c - 'a' + 10;
+        }
+        CHECK(d < radix);
+        pv = pv * radix + d;
+      }
+      CHECK(pv == v);
+    }
+  }
+}
+
+/* Compare one integer specification, passing the value at the type
+ * the length modifier calls for after any star arguments */
+static void
+compareInteger (const char * format,
+                int nstars,
+                const int * stars,
+                int lmod,
+                int is_signed,
+                unsigned long long v)
+{
+#define COMPARE_(v_) do {                                       \
+    if (0 == nstars) {                                          \
+      compare(format, v_);                                      \
+    } else if (1 == nstars) {                                   \
+      compare(format, stars[0], v_);                            \
+    } else {                                                    \
+      compare(format, stars[0], stars[1], v_);                  \
+    }                                                           \
+  } while (0)
+
+  switch (lmod) {
+    case 'l':
+      if (is_signed) {
+        COMPARE_((long)v);
+      } else {
+        COMPARE_((unsigned long)v);
+      }
+      break;
+    case 'L':
+      if (is_signed) {
+        COMPARE_((long long)v);
+      } else {
+        COMPARE_((unsigned long long)v);
+      }
+      break;
+    case 'z':
+      if (is_signed) {
+        COMPARE_((long)(size_t)v);
+      } else {
+        COMPARE_((size_t)v);
+      }
+      break;
+    default:
+      if (is_signed) {
+        COMPARE_((int)v);
+      } else {
+        COMPARE_((unsigned int)v);
+      }
+      break;
+  }
+#undef COMPARE_
+}
+
+/* Every combination of defined flags, width, precision, and length
+ * modifier for each integer conversion, over the edge values */
+static void
+compareIntegerSpecs (void)
+{
+  static const char conversions[] = "diouxX";
+  static const char * const widths[] = { "", "1", "6", "25", "*", "*" };
+  static const int width_args[] = { 0, 0, 0, 0, 6, -6 };
+  static const char * const precisions[] = { "", ".", ".0", ".1", ".5", ".*", ".*" };
+  static const int precision_args[] = { 0, 0, 0, 0, 0, 3, -1 };
+  static const char * const lmods[] = { "hh", "h", "", "l", "ll", "z" };
+  static const char lmod_class[] = { 0, 0, 0, 'l', 'L', 'z' };
+  const char * cp;
+
+  for (cp = conversions; *cp; ++cp) {
+    int is_signed = ('d' == *cp) || ('i' == *cp);
+    /* # is defined only for o, x, X; + and space only for signed */
+    const char * flag_chars = is_signed ? "-0+ " : (('u' == *cp) ? "-0" : "-0#");
+    unsigned int nflags = strlen(flag_chars);
+    unsigned int fs;
+
+    for (fs = 0; fs < (1U << nflags); ++fs) {
+      char flags[8];
+      unsigned int nf = 0;
+      unsigned int w;
+      unsigned int i;
+
+      for (i = 0; i < nflags; ++i) {
+        if (fs & (1U << i)) {
+          flags[nf++] = flag_chars[i];
+        }
+      }
+      flags[nf] = 0;
+      for (w = 0; w < sizeof(widths) / sizeof(*widths); ++w) {
+        unsigned int p;
+
+        for (p = 0; p < sizeof(precisions) / sizeof(*precisions); ++p) {
+          unsigned int l;
+
+          for (l = 0; l < sizeof(lmods) / sizeof(*lmods); ++l) {
+            char format[32];
+            int stars[2];
+            int nstars = 0;
+            unsigned int v;
+
+            if (strchr(widths[w], '*')) {
+              stars[nstars++] = width_args[w];
+            }
+            if (strchr(precisions[p], '*')) {
+              stars[nstars++] = precision_args[p];
+            }
+            snprintf(format, sizeof(format), "[%%%s%s%s%s%c]", flags, widths[w], precisions[p], lmods[l], *cp);
+            for (v = 0; v < nvalues; ++v) {
+              compareInteger(format, nstars, stars, lmod_class[l], is_signed, values[v]);
+              if (is_signed) {
+                compareInteger(format, nstars, stars, lmod_class[l], is_signed, -values[v]);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+/* Plain conversions of every 16-bit value */
+static void
+compareExhaustive16 (void)
+{
+  unsigned int v = 0;
+
+  do {
+    compare("%d %u %x %X %o", (int)(int16_t)v, v, v, v, v);
+    compare("%hd|%hhu|%#x|%+06d|%-7o|%.3u", (int)(int16_t)v, v, v, (int)(int16_t)v, v, v);
+    compare("%ld %lx %lld", (long)(int16_t)v, (unsigned long)v, (long long)(int16_t)v);
+  } while (0 != (v = 0xFFFF & (v + 1)));
+}
+
+/* Characters, strings, pointers, and literal text */
+static void
+compareOther (void)
+{
+  static const char * const strings[] = { "", "a", "hello", "a longer string than any width" };
+  static const char * const specs[] = { "%s", "%8s", "%-8s", "%.0s", "%.3s", "%8.3s", "%-8.3s", "%*s", "%-*s", "%.*s", "%*.*s" };
+  const char * volatile null_string = NULL;
+  unsigned int s;
+  unsigned int i;
+  int c;
+
+  for (s = 0; s < sizeof(strings) / sizeof(*strings); ++s) {
+    for (i = 0; i < sizeof(specs) / sizeof(*specs); ++i) {
+      char format[32];
+      const char * sp = specs[i];
+      int nstars = 0;
+
+      while (*sp) {
+        nstars += ('*' == *sp++);
+      }
+      snprintf(format, sizeof(format), "<%s>", specs[i]);
+      if (0 == nstars) {
+        compare(format, strings[s]);
+      } else if (1 == nstars) {
+        compare(format, 6, strings[s]);
+        compare(format, -6, strings[s]);
+      } else {
+        compare(format, 6, 2, strings[s]);
+        compare(format, -6, -1, strings[s]);
+      }
+    }
+  }
+  /* glibc renders a null string as (null) only when it fits */
+  compare("%s|%10s|%-8s", null_string, null_string, null_string);
+  for (c = 1; c < 256; ++c) {
+    compare("%c|%3c|%-3c|", c, c, c);
+  }
+  compare("%p", (void *)&comparisons);
+  compare("%p", (void *)(uintptr_t)0x1234);
+  compare("100%% of %d%%", 42);
+  compare("plain text");
+  compare("");
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  unsigned long nrandom = (1 < argc) ? strtoul(argv[1], NULL, 0) : 20000;
+  char buf[BSP430_FORMAT_BUFFER_SIZE];
+  unsigned long long p;
+  unsigned long i;
+  int k;
+
+  for (k = 0; k < 64; ++k) {
+    p = 1ULL << k;
+    addValue(p - 1);
+    addValue(p);
+    addValue(p + 1);
+  }
+  addValue(~0ULL);
+  for (p = 1, k = 0; k < 20; ++k, p *= 10) {
+    addValue(p - 1);
+    addValue(p);
+    addValue(p + 1);
+  }
+
+  /* Conversion */
+  for (i = 0; i <= 0xFFFF; ++i) {
+    compareConversion(i);
+  }
+  for (i = 0; i < nvalues; ++i) {
+    compareConversion(values[i]);
+    checkRadixes(values[i]);
+  }
+  for (i = 0; i < nrandom; ++i) {
+    unsigned long long v = rng64();
+
+    compareConversion(v);
+    compareConversion(0xFFFFFFFFULL & v);
+    compareConversion(0xFFFF & v);
+    if (0 == (i % 16)) {
+      checkRadixes(v);
+    }
+  }
+  CHECK(-1 == iBSP430formatUnsignedLong(buf, 1, 0));
+  CHECK(-1 == iBSP430formatUnsignedLong(buf, 1, 1));
+  CHECK(-1 == iBSP430formatUnsignedLong(buf, 1, 37));
+  CHECK(-1 == iBSP430formatUnsignedLongLong(buf, 1, 1 | BSP430_FORMAT_RADIX_UPPER));
+
+  /* Formatting */
+  compareIntegerSpecs();
+  compareExhaustive16();
+  compareOther();
+
+  printf("%lu comparisons against the C library, %lu failed\n", comparisons, ulTimerhostFailures);
+  return iTimerhostCheckResult();
+}
@@ -0,0 +1,470 @@
+/* Test of queued interrupt-driven I2C transactions (sBSP430i2cQueue)
+ * on the simulated eUSCI_B0.
+ *
+ * The simulated bus carries three register-file slaves, each with an
+ * address pointer set by the first octet written to it and advanced
+ * by every octet transferred; nothing answers a fourth address.  The
+ * slaves occasionally NACK their address or a written octet, and
+ * sometimes another master wins arbitration for a start.  Several
+ * drivers each fill a few transactions (writes, register reads with a
+ * repeated start, and bare reads, many of a single octet), submit
+ * them to one queue, and resubmit some from their completion
+ * callbacks, retrying any that lost arbitration.  The CPU sleeps in
+ * LPM0 until all are done.  Service routines are single-stepped, so
+ * the queue's waits for start and stop conditions see the bus move.
+ * The test checks that:
+ *
+ * @li transactions complete in submission order, each exactly once
+ * per submission, and the last completion wakes the CPU;
+ * @li each transaction appears on the bus as one start, a repeated
+ * start between its write and read segments, and one stop (none
+ * after lost arbitration), and nothing starts before the other
+ * master's traffic ends;
+ * @li the slave received exactly the octets written, and read
+ * exactly the octets read, which were all stored in order;
+ * @li the result is zero, or the NACK or arbitration error matching
+ * what happened on the bus, and nothing follows a NACK (but the
+ * repeated start already requested for a read, and one octet, when
+ * the last octet written is rejected);
+ * @li submitting a pending or empty transaction, attaching a second
+ * queue, and releasing a busy queue are rejected.
+ *
+ * Usage: i2ctest [rounds]   (default 30) */
+
+#include <bsp430/platform.h>
+#include <bsp430/serial.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timerhost.h"
+
+#define NSLAVES 3
+#define ABSENT_ADDRESS 0x21
+#define NDRIVERS 3
+#define JOBS_PER_DRIVER 3
+#define NJOBS (NDRIVERS * JOBS_PER_DRIVER)
+#define MAX_LEN 8
+#define MAX_RECORDS 64
+
+/* One in this many starts loses arbitration, and one in this many
+ * addresses or written octets is NACKed */
+#define LOST_ODDS 40
+#define NACK_ODDS 50
+
+/* Stepped instructions per tick.  A bit takes at least 8 ticks, so
+ * service routines run at least 64 instructions per bit time
+ * (about 600 per octet, as an 8 MHz CPU does on a 100 kHz bus); a
+ * sanitized build executes several times as many.  A quarter of
+ * either suffices. */
+#if defined(__SANITIZE_ADDRESS__)
+#define STEPS_PER_TICK 16
+#else /* __SANITIZE_ADDRESS__ */
+#define STEPS_PER_TICK 8
+#endif /* __SANITIZE_ADDRESS__ */
+
+#define NACK_RESULT (-(BSP430_I2C_ERRFLAG_PROTOCOL | UCNACKIFG))
+#define LOST_RESULT (-(BSP430_I2C_ERRFLAG_PROTOCOL | UCALIFG))
+
+/* What one transaction looked like on the bus */
+typedef struct sBusRecord {
+  unsigned int address;
+  int starts;
+  int read[2];
+  uint8_t tx[MAX_LEN];
+  size_t ntx;
+  uint8_t rx[MAX_LEN];
+  size_t nrx;
+  int nack;                     /* segment (1 or 2) NACKed, or zero */
+  int lost;
+  int stopped;
+} sBusRecord;
+
+typedef struct sJob {
+  sBSP430i2cTransaction xfer;
+  unsigned int driver;
+  uint8_t tx[MAX_LEN];
+  uint8_t rx[MAX_LEN];
+  unsigned int resubmits;
+  unsigned long submissions;
+  unsigned long completions;
+} sJob;
+
+static const unsigned int slave_address[NSLAVES] = { 0x1D, 0x48, 0x68 };
+static uint8_t slave_regs[NSLAVES][256];
+static uint8_t slave_ptr[NSLAVES];
+static int addressed;           /* slave index, or -1 */
+static int pointer_set;
+
+static sBusRecord records[MAX_RECORDS];
+static unsigned long records_opened;
+static unsigned long records_checked;
+static sBusRecord * open_record;
+static unsigned long long bus_free_tck;
+
+static hBSP430halSERIAL i2c;
+static sBSP430i2cQueue queue;
+static sJob jobs[NJOBS];
+static sJob * fifo[MAX_RECORDS];
+static unsigned long fifo_in;
+static unsigned long fifo_out;
+static unsigned int outstanding;
+static unsigned int bit_tck;
+
+static unsigned long n_ok;
+static unsigned long n_nack;
+static unsigned long n_lost;
+
+static unsigned long rng_state = 1;
+
+static unsigned long
+rng (void)
+{
+  rng_state = rng_state * 1103515245UL + 12345UL;
+  return (rng_state >> 16) & 0x7FFF;
+}
+
+/* Whether the current segment of a record is a read */
+static int
+readingSegment (const sBusRecord * rp)
+{
+  return rp->read[(1 < rp->starts) ? 1 : 0];
+}
+
+static int
+bus_start (unsigned int address,
+           int read)
+{
+  sBusRecord * rp = open_record;
+  unsigned int i;
+
+  if (NULL != rp) {
+    /* Repeated start: only from a write segment to a read of the
+     * same slave */
+    CHECK(1 == rp->starts);
+    CHECK(address == rp->address);
+    CHECK(read && (! rp->read[0]));
+    if (2 > rp->starts) {
+      rp->read[rp->starts] = read;
+    }
+    ++rp->starts;
+  } else {
+    CHECK(ullTimerhostNow() >= bus_free_tck);
+    CHECK(MAX_RECORDS > (records_opened - records_checked));
+    rp = records + (records_opened++ % MAX_RECORDS);
+    memset(rp, 0, sizeof(*rp));
+    rp->address = address;
+    rp->starts = 1;
+    rp->read[0] = read;
+    if (0 == (rng() % LOST_ODDS)) {
+      rp->lost = 1;
+      bus_free_tck = ullTimerhostNow() + 18UL * bit_tck;
+      return TIMERHOST_I2C_LOST;
+    }
+    open_record = rp;
+  }
+  addressed = -1;
+  pointer_set = read;
+  for (i = 0; i < NSLAVES; ++i) {
+    if (address == slave_address[i]) {
+      addressed = i;
+    }
+  }
+  if ((0 > addressed) || (0 == (rng() % NACK_ODDS))) {
+    if (! rp->nack) {
+      rp->nack = rp->starts;
+    }
+    addressed = -1;
+    return TIMERHOST_I2C_NACK;
+  }
+  return TIMERHOST_I2C_ACK;
+}
+
+static int
+bus_write (uint8_t octet)
+{
+  sBusRecord * rp = open_record;
+
+  CHECK(NULL != rp);
+  if (NULL == rp) {
+    return TIMERHOST_I2C_NACK;
+  }
+  CHECK(! rp->nack);
+  CHECK(! readingSegment(rp));
+  CHECK(0 <= addressed);
+  if (0 == (rng() % NACK_ODDS)) {
+    rp->nack = rp->starts;
+    return TIMERHOST_I2C_NACK;
+  }
+  if (MAX_LEN > rp->ntx) {
+    rp->tx[rp->ntx] = octet;
+  }
+  ++rp->ntx;
+  if (0 <= addressed) {
+    if (! pointer_set) {
+      slave_ptr[addressed] = octet;
+      pointer_set = 1;
+    } else {
+      slave_regs[addressed][slave_ptr[addressed]++] = octet;
+    }
+  }
+  return TIMERHOST_I2C_ACK;
+}
+
+static int
+bus_read (void)
+{
+  sBusRecord * rp = open_record;
+  uint8_t octet = 0xFF;
+
+  CHECK(NULL != rp);
+  if (NULL == rp) {
+    return octet;
+  }
+  /* See checkAgainstBus() */
+  CHECK((! rp->nack) || ((1 == rp->nack) && (2 == rp->starts)));
+  CHECK(readingSegment(rp));
+  CHECK(0 <= addressed);
+  if (0 <= addressed) {
+    octet = slave_regs[addressed][slave_ptr[addressed]++];
+  }
+  if (MAX_LEN > rp->nrx) {
+    rp->rx[rp->nrx] = octet;
+  }
+  ++rp->nrx;
+  return octet;
+}
+
+static void
+bus_stop (void)
+{
+  CHECK(NULL != open_record);
+  if (NULL != open_record) {
+    open_record->stopped = 1;
+  }
+  open_record = NULL;
+  addressed = -1;
+}
+
+static const sTimerhostI2CSlave bus = {
+  .start = bus_start,
+  .write = bus_write,
+  .read = bus_read,
+  .stop = bus_stop,
+};
+
+/* Give a job a new random transaction for its driver's slave */
+static void
+fillJob (sJob * jp)
+{
+  hBSP430i2cTransaction xp = &jp->xfer;
+  unsigned int kind = rng() % 4;
+  size_t i;
+
+  xp->address = (0 == (rng() % 16)) ? ABSENT_ADDRESS : slave_address[jp->driver % NSLAVES];
+  xp->tx_data = jp->tx;
+  xp->rx_data = jp->rx;
+  xp->tx_len = 0;
+  xp->rx_len = 0;
+  if (1 != kind) {
+    /* Register number, then any data */
+    xp->tx_len = 1 + ((0 == kind) ? (rng() % MAX_LEN) : 0);
+  }
+  if (0 != kind) {
+    xp->rx_len = (0 == (rng() % 3)) ? 1 : (1 + (rng() % MAX_LEN));
+  }
+  for (i = 0; i < xp->tx_len; ++i) {
+    jp->tx[i] = rng();
+  }
+  memset(jp->rx, 0, sizeof(jp->rx));
+}
+
+static int completed_cb (hBSP430i2cTransaction xp);
+
+static int
+submitJob (sJob * jp)
+{
+  int rc;
+
+  jp->xfer.callback_ni = completed_cb;
+  rc = iBSP430i2cQueueSubmit_ni(&queue, &jp->xfer);
+  CHECK(0 == rc);
+  if (0 == rc) {
+    fifo[fifo_in++ % MAX_RECORDS] = jp;
+    ++jp->submissions;
+    ++outstanding;
+  }
+  return rc;
+}
+
+/* Submit from main, which is stepped so that a single-octet read
+ * started at once sees its address go out. */
+static void
+submitFromMain (sJob * jp)
+{
+  (void)iTimerhostStepBegin();
+  (void)submitJob(jp);
+  vTimerhostStepEnd();
+}
+
+static void
+checkAgainstBus (hBSP430i2cTransaction xp,
+                 const sBusRecord * rp)
+{
+  size_t i;
+
+  CHECK(xp->address == rp->address);
+  CHECK(rp->read[0] == (0 == xp->tx_len));
+  if (rp->lost) {
+    ++n_lost;
+    CHECK(LOST_RESULT == xp->result_ni);
+    CHECK(0 == rp->ntx);
+    CHECK(0 == rp->nrx);
+    return;
+  }
+  CHECK(rp->stopped);
+  CHECK(rp->ntx <= xp->tx_len);
+  for (i = 0; (i < rp->ntx) && (i < xp->tx_len); ++i) {
+    CHECK(rp->tx[i] == xp->tx_data[i]);
+  }
+  if (rp->nack) {
+    ++n_nack;
+    CHECK(NACK_RESULT == xp->result_ni);
+    /* Nothing follows a NACK, except that the repeated start for a
+     * read is requested as the last octet written starts to go out.
+     * If that octet is rejected, the stop follows the first octet
+     * read. */
+    if (0 != rp->nrx) {
+      CHECK(1 == rp->nack);
+      CHECK((rp->ntx + 1) == xp->tx_len);
+      CHECK(1 == rp->nrx);
+    }
+    return;
+  }
+  ++n_ok;
+  CHECK(0 == xp->result_ni);
+  CHECK(rp->ntx == xp->tx_len);
+  CHECK(rp->nrx == xp->rx_len);
+  CHECK(rp->starts == (((0 < xp->tx_len) && (0 < xp->rx_len)) ? 2 : 1));
+  if (2 == rp->starts) {
+    CHECK(rp->read[1]);
+  }
+  for (i = 0; (i < rp->nrx) && (i < xp->rx_len); ++i) {
+    CHECK(rp->rx[i] == xp->rx_data[i]);
+  }
+}
+
+static int
+completed_cb (hBSP430i2cTransaction xp)
+{
+  sJob * jp = (sJob *)xp;
+
+  CHECK(fifo_out < fifo_in);
+  CHECK(jp == fifo[fifo_out % MAX_RECORDS]);
+  ++fifo_out;
+  ++jp->completions;
+  CHECK(jp->completions == jp->submissions);
+  CHECK(BSP430_I2C_TRANSACTION_PENDING != xp->result_ni);
+  CHECK(records_checked < records_opened);
+  if (records_checked < records_opened) {
+    checkAgainstBus(xp, records + (records_checked++ % MAX_RECORDS));
+  }
+  /* A completed transaction may be submitted again at once */
+  if (LOST_RESULT == xp->result_ni) {
+    (void)submitJob(jp);
+  } else if (0 < jp->resubmits) {
+    --jp->resubmits;
+    fillJob(jp);
+    (void)submitJob(jp);
+  }
+  if (0 == --outstanding) {
+    return BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
+  }
+  return 0;
+}
+
+static void
+runRound (void)
+{
+  unsigned long wakes = 0;
+  unsigned int i;
+
+  for (i = 0; i < NJOBS; ++i) {
+    sJob * jp = jobs + i;
+
+    jp->driver = i % NDRIVERS;
+    jp->resubmits = rng() % 3;
+    fillJob(jp);
+  }
+  BSP430_CORE_DISABLE_INTERRUPT();
+  for (i = 0; i < NJOBS; ++i) {
+    submitFromMain(jobs + i);
+  }
+  CHECK(-1 == iBSP430i2cQueueSubmit_ni(&queue, &jobs[NJOBS - 1].xfer));
+  CHECK(-1 == iBSP430i2cQueueRelease_ni(&queue));
+  while (0 < outstanding) {
+    BSP430_CORE_LPM_ENTER_NI(LPM0_bits);
+    BSP430_CORE_DISABLE_INTERRUPT();
+    ++wakes;
+  }
+  CHECK(1 == wakes);
+  CHECK(fifo_in == fifo_out);
+  CHECK(records_opened == records_checked);
+  CHECK(NULL == queue.head_ni);
+  CHECK(! (UCBBUSY & BSP430_HPL_EUSCI_B0->statw) || (ullTimerhostNow() < bus_free_tck));
+  for (i = 0; i < NJOBS; ++i) {
+    CHECK(jobs[i].submissions == jobs[i].completions);
+  }
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  unsigned long rounds = (1 < argc) ? strtoul(argv[1], NULL, 0) : 30;
+  static sBSP430i2cQueue other;
+  static sBSP430i2cTransaction empty;
+  unsigned long n;
+
+  vTimerhostInitialize();
+  if (0 != iTimerhostStepBegin()) {
+    printf("single-stepping unsupported, I2C test skipped\n");
+    return 0;
+  }
+  vTimerhostStepEnd();
+  vTimerhostI2CInitialize(&bus);
+  iTimerhostStepISRs = 1;
+  uiTimerhostStepsPerTick = STEPS_PER_TICK;
+  i2c = hBSP430serialLookup(BSP430_PERIPH_EUSCI_B0);
+  CHECK(NULL != i2c);
+  for (n = 0; n < NSLAVES; ++n) {
+    unsigned int r;
+
+    for (r = 0; r < 256; ++r) {
+      slave_regs[n][r] = rng();
+    }
+  }
+
+  for (n = 0; n < rounds; ++n) {
+    unsigned int prescaler = 8 + (rng() % 8);
+
+    CHECK(i2c == hBSP430serialOpenI2C(i2c, BSP430_SERIAL_ADJUST_CTL0_INITIALIZER(UCMST), UCSSEL__SMCLK, prescaler));
+    bit_tck = prescaler;
+    uiTimerhostISRTicks = 1 + (rng() % 4);
+    if (NULL == queue.hal) {
+      CHECK(&queue == hBSP430i2cQueueInitialize_ni(&queue, i2c));
+      CHECK(NULL == hBSP430i2cQueueInitialize_ni(&other, i2c));
+    }
+    runRound();
+    if (0 == (n % 4)) {
+      CHECK(0 == iBSP430i2cQueueRelease_ni(&queue));
+      CHECK(NULL == i2c->i2c_cbchain_ni);
+      CHECK(0 == iBSP430i2cQueueRelease_ni(&queue));
+      CHECK(-1 == iBSP430i2cQueueSubmit_ni(&queue, &jobs[0].xfer));
+    }
+  }
+  CHECK(-1 == iBSP430i2cQueueSubmit_ni(&queue, &empty));
+
+  printf("%lu transactions (%lu completed, %lu NACKed, %lu lost arbitration), %lu octets, %lu ISRs over %llu ticks\n",
+         fifo_out, n_ok, n_nack, n_lost, ulTimerhostI2COctets, ulTimerhostISRCount, ullTimerhostNow());
+  return iTimerhostCheckResult();
+}
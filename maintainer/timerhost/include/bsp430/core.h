@@ -0,0 +1,62 @@
+/* Host stand-in for <bsp430/core.h> used by maintainer/timerhost.
+ *
+ * Only what src/periph/timer.c and the headers it includes require
+ * is provided.  Interrupts are modelled by a single global enable
+ * flag maintained by sim.c; entering a low power mode lets the
+ * simulated timers advance to their next event. */
+
+#ifndef BSP430_CORE_H
+#define BSP430_CORE_H
+
+#include <msp430.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define BSP430_VERSION 20140602
+
+#define BSP430_CORE_TOOLCHAIN_GCC (1 < __GNUC__)
+
+#define BSP430_CORE_INLINE inline
+#define BSP430_CORE_INLINE_FORCED BSP430_CORE_INLINE __attribute__((__always_inline__))
+#define BSP430_CORE_PACKED_STRUCT(nm_) struct __attribute__((__packed__)) nm_
+
+#ifndef BSP430_CORE_NDEBUG
+#define BSP430_CORE_NDEBUG 0
+#endif /* BSP430_CORE_NDEBUG */
+
+#define BSP430_CORE_FAMILY_IS_5XX 1
+
+/* Identifiers of the simulated timers, for configuration tests */
+#define BSP430_PERIPH_CPPID_NONE 0
+#define BSP430_PERIPH_CPPID_TA0 12
+#define BSP430_PERIPH_CPPID_TA1 13
+#define BSP430_PERIPH_CPPID_TB0 16
+
+#define BSP430_CORE_LPM_SR_MASK (LPM4_bits | GIE)
+#define BSP430_CORE_LPM_EXIT_MASK (LPM4_bits)
+
+/* Interrupt enable state lives in sim.c. */
+extern int iTimerhostGIE;
+
+#define BSP430_CORE_SAVED_INTERRUPT_STATE(var_) int var_ = iTimerhostGIE
+#define BSP430_CORE_RESTORE_INTERRUPT_STATE(var_) do { iTimerhostGIE = (var_); } while (0)
+#define BSP430_CORE_DISABLE_INTERRUPT() do { iTimerhostGIE = 0; } while (0)
+#define BSP430_CORE_ENABLE_INTERRUPT() do { iTimerhostGIE = 1; } while (0)
+
+void vTimerhostLPMEnter (unsigned int lpm_bits);
+void vTimerhostLPMExitFromISR (unsigned int sr_bits);
+
+#define BSP430_CORE_LPM_ENTER(lpm_bits_) vTimerhostLPMEnter(lpm_bits_)
+#define BSP430_CORE_LPM_ENTER_NI(lpm_bits_) BSP430_CORE_LPM_ENTER(GIE | (lpm_bits_))
+#define BSP430_CORE_LPM_EXIT_FROM_ISR(lpm_bits_) vTimerhostLPMExitFromISR(BSP430_CORE_LPM_SR_MASK & (lpm_bits_))
+
+#define BSP430_CORE_WATCHDOG_CLEAR() do { } while (0)
+#define BSP430_CORE_DELAY_CYCLES(cycles_) do { (void)(cycles_); } while (0)
+
+/* Interrupt service routines are ordinary functions that sim.c
+ * invokes when the corresponding event is pending. */
+#define BSP430_CORE_DECLARE_INTERRUPT(iv_) void
+
+#define BSP430_RTOS_YIELD_FROM_ISR() do { } while (0)
+
+#endif /* BSP430_CORE_H */
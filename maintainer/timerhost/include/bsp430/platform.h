@@ -0,0 +1,66 @@
+/* Host stand-in for <bsp430/platform.h> used by maintainer/timerhost.
+ *
+ * This plays the role of an application's bsp430_config.h: the
+ * simulated MCU has three timers, TA0, TA1, and TB0, each with HAL
+ * and ISR support.  Counter reads go directly to the counter since the
+ * simulated timers are synchronous with the CPU. */
+
+#ifndef BSP430_PLATFORM_H
+#define BSP430_PLATFORM_H
+
+#ifndef configBSP430_HAL_TA0
+#define configBSP430_HAL_TA0 1
+#endif /* configBSP430_HAL_TA0 */
+
+#ifndef configBSP430_HAL_TA1
+#define configBSP430_HAL_TA1 1
+#endif /* configBSP430_HAL_TA1 */
+
+#ifndef configBSP430_HAL_TB0
+#define configBSP430_HAL_TB0 1
+#endif /* configBSP430_HAL_TB0 */
+
+#ifndef configBSP430_HAL_TA0_CC0_ISR
+#define configBSP430_HAL_TA0_CC0_ISR 1
+#endif /* configBSP430_HAL_TA0_CC0_ISR */
+
+#ifndef configBSP430_HAL_TA1_CC0_ISR
+#define configBSP430_HAL_TA1_CC0_ISR 1
+#endif /* configBSP430_HAL_TA1_CC0_ISR */
+
+#ifndef configBSP430_HAL_TB0_CC0_ISR
+#define configBSP430_HAL_TB0_CC0_ISR 1
+#endif /* configBSP430_HAL_TB0_CC0_ISR */
+
+/* TA0 is the uptime timer, as used by utility/evloop. */
+#ifndef BSP430_UPTIME_TIMER_PERIPH_CPPID
+#define BSP430_UPTIME_TIMER_PERIPH_CPPID BSP430_PERIPH_CPPID_TA0
+#endif /* BSP430_UPTIME_TIMER_PERIPH_CPPID */
+
+#ifndef BSP430_UPTIME
+#define BSP430_UPTIME 1
+#endif /* BSP430_UPTIME */
+
+#ifndef configBSP430_TIMER_VALID_COUNTER_READ
+#define configBSP430_TIMER_VALID_COUNTER_READ 0
+#endif /* configBSP430_TIMER_VALID_COUNTER_READ */
+
+/* With configBSP430_CONSOLE the console is on eUSCI_A0, clocked from
+ * SMCLK. */
+#if (configBSP430_CONSOLE - 0)
+#define BSP430_CONSOLE 1
+#ifndef BSP430_CONSOLE_SERIAL_PERIPH_HANDLE
+#define BSP430_CONSOLE_SERIAL_PERIPH_HANDLE BSP430_PERIPH_EUSCI_A0
+#endif /* BSP430_CONSOLE_SERIAL_PERIPH_HANDLE */
+#ifndef BSP430_CONSOLE_BAUD_RATE
+#define BSP430_CONSOLE_BAUD_RATE 115200
+#endif /* BSP430_CONSOLE_BAUD_RATE */
+#endif /* configBSP430_CONSOLE */
+
+#include <bsp430/core.h>
+#include <bsp430/periph.h>
+
+/* Provided by sim.c; the simulated peripherals have no pins. */
+int iBSP430platformConfigurePeripheralPins_ni (tBSP430periphHandle periph, int periph_config, int enablep);
+
+#endif /* BSP430_PLATFORM_H */
@@ -0,0 +1,234 @@
+/* Host stand-in for <msp430.h> used by maintainer/timerhost.
+ *
+ * Describes a 5xx-family MCU with two Timer_A instances, TA0 with
+ * five capture/compare registers and TA1 with three, one Timer_B
+ * instance, TB0, with seven, one eUSCI_A and one eUSCI_B instance,
+ * and a three-channel DMA controller.  The register
+ * blocks live in a page that sim.c maps at TIMERHOST_PERIPH_BASE, so
+ * peripheral handles remain plain integers as they are on the
+ * target.  Reading an interrupt vector register is a call into the
+ * simulator, which reproduces the hardware's clear-on-read
+ * behaviour. */
+
+#ifndef TIMERHOST_MSP430_H
+#define TIMERHOST_MSP430_H
+
+#include <stdint.h>
+
+/* DMA address registers hold host pointers */
+typedef uintptr_t uint20_t;
+
+#define __MSP430_HAS_MSP430XV2_CPU__
+#define __MSP430X__ 1
+
+#define TIMERHOST_PERIPH_BASE 0x40000000
+
+#define __MSP430_HAS_T0A5__
+#define __MSP430_BASEADDRESS_T0A5__ (TIMERHOST_PERIPH_BASE + 0x0340)
+#define __MSP430_HAS_T1A3__
+#define __MSP430_BASEADDRESS_T1A3__ (TIMERHOST_PERIPH_BASE + 0x0380)
+#define __MSP430_HAS_T0B7__
+#define __MSP430_BASEADDRESS_T0B7__ (TIMERHOST_PERIPH_BASE + 0x03C0)
+#define __MSP430_HAS_DMAX_3__
+#define __MSP430_BASEADDRESS_DMAX_3__ (TIMERHOST_PERIPH_BASE + 0x0500)
+#define __MSP430_HAS_EUSCI_A0__
+#define __MSP430_BASEADDRESS_EUSCI_A0__ (TIMERHOST_PERIPH_BASE + 0x05C0)
+#define __MSP430_HAS_EUSCI_B0__
+#define __MSP430_BASEADDRESS_EUSCI_B0__ (TIMERHOST_PERIPH_BASE + 0x0640)
+
+#define GIE 0x0008
+#define CPUOFF 0x0010
+#define OSCOFF 0x0020
+#define SCG0 0x0040
+#define SCG1 0x0080
+#define LPM0_bits (CPUOFF)
+#define LPM1_bits (SCG0 | CPUOFF)
+#define LPM2_bits (SCG1 | CPUOFF)
+#define LPM3_bits (SCG1 | SCG0 | CPUOFF)
+#define LPM4_bits (SCG1 | SCG0 | OSCOFF | CPUOFF)
+
+#define TASSEL1 0x0200
+#define TASSEL0 0x0100
+#define TASSEL_0 (0 * 0x100u)
+#define TASSEL_1 (1 * 0x100u)
+#define TASSEL_2 (2 * 0x100u)
+#define TASSEL_3 (3 * 0x100u)
+#define ID1 0x0080
+#define ID0 0x0040
+#define ID_0 (0 * 0x40u)
+#define ID_1 (1 * 0x40u)
+#define ID_2 (2 * 0x40u)
+#define ID_3 (3 * 0x40u)
+#define MC1 0x0020
+#define MC0 0x0010
+#define MC_0 (0 * 0x10u)
+#define MC_1 (1 * 0x10u)
+#define MC_2 (2 * 0x10u)
+#define MC_3 (3 * 0x10u)
+#define TACLR 0x0004
+#define TAIE 0x0002
+#define TAIFG 0x0001
+
+/* Timer_B counter length and compare latch grouping.  Only the
+ * defaults (16-bit, individual latches) are modelled. */
+#define TBCLGRP1 0x4000
+#define TBCLGRP0 0x2000
+#define CNTL1 0x1000
+#define CNTL0 0x0800
+
+#define CM1 0x8000
+#define CM0 0x4000
+#define CM_0 (0 * 0x4000u)
+#define CM_1 (1 * 0x4000u)
+#define CM_2 (2 * 0x4000u)
+#define CM_3 (3 * 0x4000u)
+#define CCIS1 0x2000
+#define CCIS0 0x1000
+#define CCIS_0 (0 * 0x1000u)
+#define CCIS_1 (1 * 0x1000u)
+#define CCIS_2 (2 * 0x1000u)
+#define CCIS_3 (3 * 0x1000u)
+#define SCS 0x0800
+#define CLLD1 0x0400
+#define CLLD0 0x0200
+#define SCCI 0x0400
+#define CAP 0x0100
+#define OUTMOD2 0x0080
+#define OUTMOD1 0x0040
+#define OUTMOD0 0x0020
+#define OUTMOD_0 (0 * 0x20u)
+#define OUTMOD_1 (1 * 0x20u)
+#define OUTMOD_4 (4 * 0x20u)
+#define OUTMOD_7 (7 * 0x20u)
+#define CCIE 0x0010
+#define CCI 0x0008
+#define OUT 0x0004
+#define COV 0x0002
+#define CCIFG 0x0001
+
+/* eUSCI UCxCTLW0 */
+#define UCCKPH 0x8000
+#define UCCKPL 0x4000
+#define UCMSB 0x2000
+#define UC7BIT 0x1000
+#define UCMST 0x0800
+#define UCMODE1 0x0400
+#define UCMODE0 0x0200
+#define UCMODE_0 (0 * 0x200u)
+#define UCMODE_1 (1 * 0x200u)
+#define UCMODE_2 (2 * 0x200u)
+#define UCMODE_3 (3 * 0x200u)
+#define UCSYNC 0x0100
+#define UCSSEL1 0x0080
+#define UCSSEL0 0x0040
+#define UCSSEL__UCLK (0 * 0x40u)
+#define UCSSEL__ACLK (1 * 0x40u)
+#define UCSSEL__SMCLK (2 * 0x40u)
+#define UCTXACK 0x0020
+#define UCTR 0x0010
+#define UCTXNACK 0x0008
+#define UCTXSTP 0x0004
+#define UCTXSTT 0x0002
+#define UCSWRST 0x0001
+
+/* eUSCI UCxCTLW1 */
+#define UCASTP_0 (0 * 0x04u)
+#define UCASTP_2 (2 * 0x04u)
+#define UCASTP_3 (3 * 0x04u)
+
+/* eUSCI_A UCAxMCTLW */
+#define UCBRS0 0x0100
+#define UCBRF0 0x0010
+#define UCOS16 0x0001
+
+/* eUSCI UCxSTATW */
+#define UCLISTEN 0x0080
+#define UCFE 0x0040
+#define UCOE 0x0020
+#define UCBBUSY 0x0010
+#define UCBUSY 0x0001
+
+/* eUSCI UCxIE and UCxIFG */
+#define UCNACKIE 0x0020
+#define UCALIE 0x0010
+#define UCNACKIFG 0x0020
+#define UCALIFG 0x0010
+#define UCSTPIFG 0x0008
+#define UCSTTIFG 0x0004
+#define UCTXIE 0x0002
+#define UCRXIE 0x0001
+#define UCTXIFG 0x0002
+#define UCRXIFG 0x0001
+
+/* eUSCI UCxIV */
+#define USCI_NONE 0x00
+#define USCI_UART_UCRXIFG 0x02
+#define USCI_UART_UCTXIFG 0x04
+#define USCI_SPI_UCRXIFG 0x02
+#define USCI_SPI_UCTXIFG 0x04
+#define USCI_I2C_UCALIFG 0x02
+#define USCI_I2C_UCNACKIFG 0x04
+#define USCI_I2C_UCSTTIFG 0x06
+#define USCI_I2C_UCSTPIFG 0x08
+#define USCI_I2C_UCRXIFG3 0x0A
+#define USCI_I2C_UCTXIFG3 0x0C
+#define USCI_I2C_UCRXIFG2 0x0E
+#define USCI_I2C_UCTXIFG2 0x10
+#define USCI_I2C_UCRXIFG1 0x12
+#define USCI_I2C_UCTXIFG1 0x14
+#define USCI_I2C_UCRXIFG0 0x16
+#define USCI_I2C_UCTXIFG0 0x18
+#define USCI_I2C_UCBCNTIFG 0x1A
+#define USCI_I2C_UCCLTOIFG 0x1C
+#define USCI_I2C_UCBIT9IFG 0x1E
+
+/* DMA channel control DMAxCTL */
+#define DMADT2 0x4000
+#define DMADT1 0x2000
+#define DMADT0 0x1000
+#define DMADT_0 (0 * 0x1000u)
+#define DMADT_1 (1 * 0x1000u)
+#define DMADT_4 (4 * 0x1000u)
+#define DMADT_5 (5 * 0x1000u)
+#define DMADSTINCR1 0x0800
+#define DMADSTINCR0 0x0400
+#define DMADSTINCR_0 (0 * 0x400u)
+#define DMADSTINCR_2 (2 * 0x400u)
+#define DMADSTINCR_3 (3 * 0x400u)
+#define DMASRCINCR1 0x0200
+#define DMASRCINCR0 0x0100
+#define DMASRCINCR_0 (0 * 0x100u)
+#define DMASRCINCR_2 (2 * 0x100u)
+#define DMASRCINCR_3 (3 * 0x100u)
+#define DMADSTBYTE 0x0080
+#define DMASRCBYTE 0x0040
+#define DMALEVEL 0x0020
+#define DMAEN 0x0010
+#define DMAIFG 0x0008
+#define DMAIE 0x0004
+#define DMAABORT 0x0002
+#define DMAREQ 0x0001
+
+/* DMA trigger selects for eUSCI_A0 receive and transmit */
+#define DMA0TSEL__UCA0RXIFG 16
+#define DMA0TSEL__UCA0TXIFG 17
+
+#define TIMER1_A1_VECTOR 48
+#define TIMER1_A0_VECTOR 49
+#define TIMER0_A1_VECTOR 52
+#define TIMER0_A0_VECTOR 53
+#define TIMER0_B1_VECTOR 58
+#define TIMER0_B0_VECTOR 59
+#define USCI_B0_VECTOR 55
+#define USCI_A0_VECTOR 56
+#define DMA_VECTOR 50
+
+unsigned int uiTimerhostReadIV (unsigned int base);
+#define TA0IV uiTimerhostReadIV(__MSP430_BASEADDRESS_T0A5__)
+#define TA1IV uiTimerhostReadIV(__MSP430_BASEADDRESS_T1A3__)
+#define TB0IV uiTimerhostReadIV(__MSP430_BASEADDRESS_T0B7__)
+
+unsigned int uiTimerhostReadDMAIV (void);
+#define DMAIV uiTimerhostReadDMAIV()
+
+#endif /* TIMERHOST_MSP430_H */
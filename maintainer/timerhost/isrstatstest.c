@@ -0,0 +1,207 @@
+/* Test of the HAL interrupt duration histograms (utility/isrstats) on
+ * the simulated timers.
+ *
+ * TA1 runs free as the timestamp counter.  Alarms on TA0 CC0 and CC1
+ * exercise the two timer interrupt handlers; each alarm callback
+ * consumes a random amount of virtual time, as a long callback chain
+ * would, before re-arming itself.  Overflow interrupts on TA0 take no
+ * time.  The test checks that:
+ *
+ * @li nothing is recorded until a counter is supplied;
+ * @li exactly the two handlers that ran are linked, with their names;
+ * @li the count, maximum, and every histogram bucket match the
+ * durations the callbacks consumed;
+ * @li reset clears the statistics but keeps the vectors;
+ * @li the binary encoding holds the same values.
+ *
+ * Usage: isrstatstest [alarms]   (default 20000) */
+
+#include <bsp430/platform.h>
+#include <bsp430/periph/timer.h>
+#include <bsp430/utility/isrstats.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timerhost.h"
+
+#define GAP_TCK 100UL
+
+typedef struct sExpected {
+  unsigned long count;
+  unsigned int max_tt;
+  unsigned int buckets[BSP430_ISRSTATS_NBUCKETS];
+} sExpected;
+
+typedef struct sWorker {
+  sBSP430timerAlarm alarm;
+  sExpected * expected;
+  unsigned long fired;
+} sWorker;
+
+static sWorker workers[2];
+static sExpected cc0_expected;
+static sExpected shared_expected;
+static int recording;
+
+static unsigned long rng_state = 1;
+
+static unsigned long
+rng (void)
+{
+  rng_state = rng_state * 1103515245UL + 12345UL;
+  return (rng_state >> 16) & 0x7FFF;
+}
+
+static void
+expect (sExpected * ep,
+        unsigned int dur_tt)
+{
+  unsigned int b = 0;
+
+  ++ep->count;
+  if (dur_tt > ep->max_tt) {
+    ep->max_tt = dur_tt;
+  }
+  while (dur_tt >> b) {
+    ++b;
+  }
+  ++ep->buckets[b];
+}
+
+/* Mostly short handlers, with an occasional one long enough to land
+ * in the top bucket. */
+static unsigned int
+workDuration (void)
+{
+  unsigned long r = rng();
+
+  if (0 == (r % 1000)) {
+    return 32768 + rng();
+  }
+  if (0 == (r % 7)) {
+    return 0;
+  }
+  return rng() >> (r % 15);
+}
+
+static int
+alarm_cb (hBSP430timerAlarm alarm)
+{
+  sWorker * wp = (sWorker *)alarm;
+  unsigned int dur_tt = workDuration();
+
+  ++wp->fired;
+  if (recording) {
+    expect(wp->expected, dur_tt);
+  }
+  vTimerhostAdvance(dur_tt);
+  CHECK(0 == iBSP430timerAlarmSet_ni(alarm, ulBSP430timerCounter_ni(alarm->timer, NULL) + GAP_TCK + rng()));
+  return 0;
+}
+
+static void
+checkVector (hBSP430isrstatsVector vp,
+             const sExpected * ep)
+{
+  uint8_t buf[BSP430_ISRSTATS_ENCODED_FIXED_LENGTH + 16];
+  size_t name_len = strlen(vp->name);
+  unsigned int b;
+  int len;
+
+  CHECK(vp->count_ni == ep->count);
+  CHECK(vp->max_tt == ep->max_tt);
+  for (b = 0; b < BSP430_ISRSTATS_NBUCKETS; ++b) {
+    CHECK(vp->buckets_ni[b] == ep->buckets[b]);
+  }
+
+  CHECK(-1 == iBSP430isrstatsEncode_ni(vp, buf, BSP430_ISRSTATS_ENCODED_FIXED_LENGTH + name_len - 1));
+  len = iBSP430isrstatsEncode_ni(vp, buf, sizeof(buf));
+  CHECK(len == BSP430_ISRSTATS_ENCODED_FIXED_LENGTH + name_len);
+  CHECK(ep->count == (buf[0] | (buf[1] << 8) | ((unsigned long)buf[2] << 16) | ((unsigned long)buf[3] << 24)));
+  CHECK(ep->max_tt == (buf[4] | (buf[5] << 8)));
+  for (b = 0; b < BSP430_ISRSTATS_NBUCKETS; ++b) {
+    CHECK(ep->buckets[b] == (buf[6 + 2 * b] | (buf[7 + 2 * b] << 8)));
+  }
+  CHECK(0 == memcmp(buf + BSP430_ISRSTATS_ENCODED_FIXED_LENGTH, vp->name, name_len));
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  unsigned long alarms = (1 < argc) ? strtoul(argv[1], NULL, 0) : 20000;
+  hBSP430halTIMER ta0;
+  hBSP430isrstatsVector vp;
+  unsigned long overflows;
+  unsigned int i;
+  int nvectors;
+
+  vTimerhostInitialize();
+  uiTimerhostISRTicks = 3;
+  ta0 = hBSP430timerLookup(BSP430_PERIPH_TA0);
+  BSP430_HPL_TA0->ctl = TASSEL_2 | MC_2 | TAIE;
+  BSP430_HPL_TA1->ctl = TASSEL_2 | MC_2;
+  workers[0].expected = &cc0_expected;
+  workers[1].expected = &shared_expected;
+  for (i = 0; i < 2; ++i) {
+    hBSP430timerAlarm ap = hBSP430timerAlarmInitialize(&workers[i].alarm, BSP430_PERIPH_TA0, i, alarm_cb);
+
+    CHECK(&workers[i].alarm == ap);
+    CHECK(0 == iBSP430timerAlarmSetEnabled_ni(ap, 1));
+    CHECK(0 == iBSP430timerAlarmSet_ni(ap, GAP_TCK * (i + 1)));
+  }
+  BSP430_CORE_ENABLE_INTERRUPT();
+
+  /* No counter, nothing recorded */
+  while (100 > workers[0].fired) {
+    (void)ulTimerhostAdvanceToEvent();
+  }
+  CHECK(NULL == hBSP430isrstatsFirst_ni());
+
+  BSP430_CORE_DISABLE_INTERRUPT();
+  vBSP430isrstatsInitialize_ni(&BSP430_HPL_TA1->r);
+  recording = 1;
+  overflows = ta0->overflow_count;
+  BSP430_CORE_ENABLE_INTERRUPT();
+  while ((workers[0].fired + workers[1].fired) < alarms) {
+    (void)ulTimerhostAdvanceToEvent();
+  }
+  BSP430_CORE_DISABLE_INTERRUPT();
+
+  /* Overflow interrupts share the vector with CC1 and take no time */
+  overflows = ta0->overflow_count - overflows;
+  CHECK(0 < overflows);
+  while (overflows--) {
+    expect(&shared_expected, 0);
+  }
+  CHECK(0 < cc0_expected.buckets[BSP430_ISRSTATS_NBUCKETS - 1]);
+
+  nvectors = 0;
+  for (vp = hBSP430isrstatsFirst_ni(); vp; vp = vp->next_ni) {
+    ++nvectors;
+    if (0 == strcmp(vp->name, "cc0_TA0")) {
+      checkVector(vp, &cc0_expected);
+    } else if (0 == strcmp(vp->name, "TA0")) {
+      checkVector(vp, &shared_expected);
+    } else {
+      CHECK(! "unexpected vector");
+    }
+  }
+  CHECK(2 == nvectors);
+
+  vBSP430isrstatsReset_ni();
+  memset(&cc0_expected, 0, sizeof(cc0_expected));
+  memset(&shared_expected, 0, sizeof(shared_expected));
+  nvectors = 0;
+  for (vp = hBSP430isrstatsFirst_ni(); vp; vp = vp->next_ni) {
+    ++nvectors;
+    checkVector(vp, &cc0_expected);
+  }
+  CHECK(2 == nvectors);
+
+  vp = hBSP430isrstatsFirst_ni();
+  printf("%lu alarms, %lu ISRs over %llu ticks; %s and %s recorded\n",
+         workers[0].fired + workers[1].fired, ulTimerhostISRCount, ullTimerhostNow(),
+         vp->name, vp->next_ni->name);
+  return iTimerhostCheckResult();
+}
@@ -0,0 +1,257 @@
+/* Round trip test of binary console logging
+ * (configBSP430_CONSOLE_LOG_BINARY) through maintainer/logdecode.py.
+ *
+ * Messages covering each supported conversion are logged with
+ * BSP430_CONSOLE_LOG(), interleaved with ordinary console text, and
+ * the output of the simulated eUSCI_A0 is captured.  The stream is
+ * written to PREFIX.bin and the text it should decode to, formatted
+ * by the host snprintf(), to PREFIX.txt.  The same stream cut short
+ * in the middle of its final record is written to PREFIX-cut.bin,
+ * with the text the decoder should produce from it (everything before
+ * that record) in PREFIX-cut.txt.  make check decodes both against
+ * this program's image and compares the results.  Among the messages
+ * are one whose inline string does not fit in the record, which the
+ * decoder shows truncated with the following arguments marked
+ * missing, and several long formats, so later records need both
+ * octets of their offset.  The program itself checks that:
+ *
+ * @li every record starts where expected, and some record has an
+ * offset beyond 255;
+ * @li with a full transmit buffer, under both the TRUNCATE and
+ * DROP_NEWEST policies, a record that does not fit is discarded
+ * whole, counted in full as dropped, and the overflow marker precedes
+ * the next output.
+ *
+ * Usage: logtest PREFIX */
+
+#include <bsp430/platform.h>
+#include <bsp430/utility/console.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timerhost.h"
+
+#define STREAM_MAX 4096
+#define RECORD_PAYLOAD_MAX (BSP430_CONSOLE_LOG_RECORD_MAX - 4)
+
+static uint8_t stream[STREAM_MAX];
+static size_t nstream;
+static char expected[STREAM_MAX];
+static size_t nexpected;
+static unsigned int max_offset;
+
+extern const char __start_bsp430_logfmt[];
+extern const char __stop_bsp430_logfmt[];
+
+static unsigned long
+idleLine (uint8_t * octetp)
+{
+  return 0;
+}
+
+static void
+sink (uint8_t octet)
+{
+  CHECK(nstream < sizeof(stream));
+  if (nstream < sizeof(stream)) {
+    stream[nstream++] = octet;
+  }
+}
+
+/* Let the UART send everything queued */
+static void
+drain (void)
+{
+  while ((UCTXIE & BSP430_HPL_EUSCI_A0->ie)
+         || (UCBUSY & BSP430_HPL_EUSCI_A0->statw)) {
+    vTimerhostAdvance(BSP430_CONSOLE_TX_BUFFER_SIZE * uiTimerhostUARTTxTicks);
+  }
+}
+
+/* Append to the text the decoder should produce */
+static void
+expectf (const char * fmt, ...)
+{
+  va_list ap;
+  int rc;
+
+  va_start(ap, fmt);
+  rc = vsnprintf(expected + nexpected, sizeof(expected) - nexpected, fmt, ap);
+  va_end(ap);
+  CHECK((0 <= rc) && ((size_t)rc < (sizeof(expected) - nexpected)));
+  if (0 <= rc) {
+    nexpected += rc;
+  }
+}
+
+/* Emit text as console output, which the decoder passes through
+ * with newlines translated */
+static void
+text (const char * s)
+{
+  (void)cputtext(s);
+  drain();
+  while (*s) {
+    if ('\n' == *s) {
+      expectf("\r");
+    }
+    expectf("%c", *s++);
+  }
+}
+
+/* The record just transmitted starting at at */
+static void
+checkRecord (size_t at)
+{
+  unsigned int offset;
+
+  CHECK((at + 4) <= nstream);
+  CHECK(BSP430_CONSOLE_LOG_RECORD_START == stream[at]);
+  CHECK((at + 4 + stream[at + 3]) == nstream);
+  offset = stream[at + 1] | (stream[at + 2] << 8);
+  CHECK(offset < (unsigned int)(__stop_bsp430_logfmt - __start_bsp430_logfmt));
+  if (offset > max_offset) {
+    max_offset = offset;
+  }
+}
+
+/* Log a message with its expected rendering formatted by the host */
+#define LOG(fmt_, ...) do {                     \
+    size_t at_ = nstream;                       \
+    BSP430_CONSOLE_LOG(fmt_, ## __VA_ARGS__);   \
+    drain();                                    \
+    checkRecord(at_);                           \
+    expectf(fmt_, ## __VA_ARGS__);              \
+  } while (0)
+
+static int
+writeFile (const char * prefix,
+           const char * suffix,
+           const void * data,
+           size_t len)
+{
+  char path[FILENAME_MAX];
+  FILE * fp;
+  int rc = -1;
+
+  snprintf(path, sizeof(path), "%s%s", prefix, suffix);
+  fp = fopen(path, "wb");
+  if (fp) {
+    if (len == fwrite(data, 1, len, fp)) {
+      rc = 0;
+    }
+    if (0 != fclose(fp)) {
+      rc = -1;
+    }
+  }
+  if (0 != rc) {
+    perror(path);
+  }
+  return rc;
+}
+
+/* Fill the transmit buffer until fewer octets than a three-integer
+ * record needs remain, and verify that record is discarded whole. */
+static void
+checkDropped (eBSP430consoleTxPolicy policy)
+{
+  const char fill[] = "filling the transmit buffer with text until the record will not fit";
+  const size_t record_len = 4 + 3 * sizeof(int);
+  size_t at = nstream;
+  size_t len = BSP430_CONSOLE_TX_BUFFER_SIZE - record_len + 1;
+
+  (void)iBSP430consoleSetTxPolicy_ni(policy);
+  (void)ulBSP430consoleTxDrops_ni(1);
+  CHECK(len < sizeof(fill));
+  CHECK((int)len == cputchars(fill, len));
+  expectf("%.*s", (int)len, fill);
+  BSP430_CONSOLE_LOG("never %d %d %d\n", 1, 2, 3);
+  CHECK(record_len == ulBSP430consoleTxDrops_ni(1));
+  drain();
+  CHECK((at + len) == nstream);
+  CHECK(0 == memcmp(stream + at, fill, len));
+  expectf("%s", BSP430_CONSOLE_TX_OVERFLOW_MARKER);
+  text(" after a dropped record\n");
+  CHECK(0 == ulBSP430consoleTxDrops_ni(0));
+  (void)iBSP430consoleSetTxPolicy_ni(eBSP430consoleTxPolicy_BLOCK);
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  const char * const long_string = "a string far longer than the space left in its record";
+  const char * volatile null_string = NULL;
+  size_t cut_stream;
+  size_t cut_expected;
+  size_t at;
+  int rc;
+
+  if (2 != argc) {
+    fprintf(stderr, "Usage: %s PREFIX\n", argv[0]);
+    return 1;
+  }
+  vTimerhostInitialize();
+  vTimerhostUARTInitialize(idleLine);
+  vTimerhostUARTSetSink(sink);
+  rc = iBSP430consoleInitialize();
+  CHECK(0 == rc);
+  if (0 != rc) {
+    return 1;
+  }
+  BSP430_CORE_ENABLE_INTERRUPT();
+
+  text("Text before the first record\n");
+  LOG("A record without arguments\n");
+  LOG("int %d unsigned %u hex %x/%X octal %o char %c\n", -5, 7U, 0xbeef, 0xcafe, 8, 'q');
+  LOG("short %hd %hu char %hhd %hhx\n", (short)-2, (unsigned short)65535, (signed char)-3, (unsigned char)0xab);
+  text("Text between records\n");
+  LOG("long %ld %lx\n", -100000L, 0xdeadbeefL);
+  LOG("long long %lld %llx\n", -(1LL << 40), 0x123456789abcULL);
+  LOG("width %*d|%-6s|%.3s|%5s|\n", 5, 42, "ab", "abcdef", "xy");
+  LOG("percent %%%s%% pointer %p\n", "s", (void *)stream);
+  /* A long format moves the records that follow beyond the first 256
+   * octets of the section */
+  LOG("This format is long enough that, together with the others, the"
+      " section holding the formats passes 256 octets and some records"
+      " carry a format offset that needs its upper octet: %d\n", 256);
+  LOG("This is another long format, so that the test does not depend on"
+      " the order in which the compiler places formats in the section,"
+      " which it is not required to follow: %u\n", 0xFFFFU);
+
+  /* A null string is logged as glibc renders it */
+  at = nstream;
+  BSP430_CONSOLE_LOG("null %s\n", null_string);
+  drain();
+  checkRecord(at);
+  expectf("null (null)\n");
+
+  /* The string fills the record after the first integer; the second
+   * integer is lost. */
+  at = nstream;
+  BSP430_CONSOLE_LOG("%d %s %d\n", 1, long_string, 2);
+  drain();
+  checkRecord(at);
+  CHECK(BSP430_CONSOLE_LOG_RECORD_MAX == (nstream - at));
+  expectf("1 %.*s <?>\n", (int)(RECORD_PAYLOAD_MAX - sizeof(int) - 1), long_string);
+
+  checkDropped(eBSP430consoleTxPolicy_TRUNCATE);
+  checkDropped(eBSP430consoleTxPolicy_DROP_NEWEST);
+  CHECK(255 < max_offset);
+
+  cut_stream = nstream;
+  cut_expected = nexpected;
+  LOG("final record %d\n", 9);
+  cut_stream += (nstream - cut_stream) / 2;
+
+  if ((0 != writeFile(argv[1], ".bin", stream, nstream))
+      || (0 != writeFile(argv[1], ".txt", expected, nexpected))
+      || (0 != writeFile(argv[1], "-cut.bin", stream, cut_stream))
+      || (0 != writeFile(argv[1], "-cut.txt", expected, cut_expected))) {
+    return 1;
+  }
+  printf("%lu octets of console output, format offsets up to %u\n",
+         (unsigned long)nstream, max_offset);
+  return iTimerhostCheckResult();
+}
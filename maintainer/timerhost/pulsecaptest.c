@@ -0,0 +1,242 @@
+/* Test of batched pulse capture (configBSP430_TIMER_PULSECAP_RING) on
+ * the simulated timers.
+ *
+ * A pulse train with randomized periods and widths drives the input
+ * of TA1 CC1 for long enough that the 32-bit capture times wrap.  The
+ * application side examines batches at irregular intervals.  Now and
+ * then edges arrive while interrupts are disabled, so the hardware
+ * overwrites a capture, and now and then the application falls far
+ * enough behind that the ring fills.  The test checks that:
+ *
+ * @li every batch is an unbroken run of generated edges, beginning
+ * with the start of a pulse, with the exact capture times;
+ * @li the statistics match those computed from the generated edges;
+ * @li each loss is counted and affects no later batch;
+ * @li the callback runs exactly once per completed batch.
+ *
+ * Both edges are captured in the first pass and rising edges only in
+ * the second.
+ *
+ * Usage: pulsecaptest [pulses]   (default 200000) */
+
+#include <bsp430/platform.h>
+#include <bsp430/periph/timer.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "timerhost.h"
+
+#define CCIDX 1
+#define RING_SIZE 64
+#define BATCH 16
+#define MIN_PERIOD_TCK 1000UL
+#define MAX_PERIOD_TCK 50000UL
+
+typedef struct sEdge {
+  unsigned long long at_tck;
+  int rising;
+} sEdge;
+
+static sBSP430timerPulseCapture pulsecap;
+static sBSP430timerPulseCaptureRing ring;
+static unsigned long captures_tt[RING_SIZE];
+static sEdge * edges;
+static unsigned long nedges;
+static unsigned long next_edge;
+static unsigned long callbacks;
+static unsigned long batches;
+static int record_falling;
+
+static unsigned long rng_state = 1;
+
+static unsigned long
+rng (void)
+{
+  rng_state = rng_state * 1103515245UL + 12345UL;
+  return (rng_state >> 16) & 0x7FFF;
+}
+
+static unsigned long
+rngRange (unsigned long lo,
+          unsigned long hi)
+{
+  return lo + (((rng() << 15) | rng()) % (hi - lo + 1));
+}
+
+static int
+batch_cb (hBSP430timerPulseCapture pcap)
+{
+  CHECK(pcap == &pulsecap);
+  CHECK(BSP430_TIMER_PULSECAP_CALLBACK_ACTIVE & pcap->flags_ni);
+  ++callbacks;
+  return 0;
+}
+
+/* Examine and release every complete batch, checking it against the
+ * generated edges. */
+static void
+consume (int both_edges)
+{
+  sBSP430timerPulseCaptureStats stats;
+
+  BSP430_CORE_DISABLE_INTERRUPT();
+  while (0 < uiBSP430timerPulseCaptureRingBatches_ni(&ring)) {
+    unsigned long first_tt = ulBSP430timerPulseCaptureRingCapture_ni(&ring, 0);
+    unsigned int step = both_edges ? 2 : 1;
+    unsigned long period_sum = 0;
+    unsigned long width_sum = 0;
+    unsigned long min_period = ULONG_MAX;
+    unsigned long max_period = 0;
+    unsigned long e;
+    unsigned int i;
+
+    /* Batches arrive in order; skip edges lost since the last one */
+    while ((next_edge < nedges) && ((unsigned long)edges[next_edge].at_tck != first_tt)) {
+      ++next_edge;
+    }
+    CHECK(next_edge + BATCH <= nedges);
+    if (next_edge + BATCH > nedges) {
+      break;
+    }
+    e = next_edge;
+    CHECK(edges[e].rising);
+    for (i = 0; i < BATCH; ++i) {
+      CHECK(ulBSP430timerPulseCaptureRingCapture_ni(&ring, i) == (unsigned long)edges[e + i].at_tck);
+    }
+    for (i = 0; i < BATCH; i += step) {
+      if (0 < i) {
+        unsigned long p = (unsigned long)(edges[e + i].at_tck - edges[e + i - step].at_tck);
+
+        period_sum += p;
+        min_period = (p < min_period) ? p : min_period;
+        max_period = (p > max_period) ? p : max_period;
+      }
+      if (both_edges) {
+        width_sum += (unsigned long)(edges[e + i + 1].at_tck - edges[e + i].at_tck);
+      }
+    }
+    CHECK(0 == iBSP430timerPulseCaptureRingStats_ni(&ring, &stats));
+    CHECK(stats.periods == (BATCH / step) - 1);
+    CHECK(stats.mean_period_tt == period_sum / stats.periods);
+    CHECK(stats.min_period_tt == min_period);
+    CHECK(stats.max_period_tt == max_period);
+    if (both_edges) {
+      CHECK(stats.mean_width_tt == width_sum / (BATCH / 2));
+      CHECK(stats.duty_ppt == (1000 * stats.mean_width_tt) / stats.mean_period_tt);
+    } else {
+      CHECK(0 == stats.mean_width_tt);
+      CHECK(0 == stats.duty_ppt);
+    }
+    next_edge += BATCH;
+    ++batches;
+  }
+  CHECK(0 > iBSP430timerPulseCaptureRingStats_ni(&ring, NULL));
+  BSP430_CORE_ENABLE_INTERRUPT();
+}
+
+/* Drive one input transition, recording it if it will be captured. */
+static void
+edge (volatile sBSP430hplTIMER * hpl,
+      int level)
+{
+  if (level || record_falling) {
+    edges[nedges].at_tck = ullTimerhostNow();
+    edges[nedges].rising = level;
+    ++nedges;
+  }
+  vTimerhostCapture(hpl, CCIDX, level);
+}
+
+static int
+runPass (unsigned long pulses,
+         unsigned int cm)
+{
+  volatile sBSP430hplTIMER * hpl = BSP430_HPL_TA1;
+  int both_edges = (CM_3 == cm);
+  unsigned long lag = 0;
+  unsigned long bursts = 0;
+  unsigned long stalls = 0;
+  unsigned long n;
+
+  vTimerhostInitialize();
+  nedges = 0;
+  next_edge = 0;
+  callbacks = 0;
+  batches = 0;
+  record_falling = both_edges;
+  hpl->ctl = TASSEL_2 | MC_2 | TAIE;
+  CHECK(&pulsecap == hBSP430timerPulseCaptureInitialize(&pulsecap, BSP430_PERIPH_TA1, CCIDX, CCIS_0, 0, batch_cb));
+  hpl->cctl[CCIDX] = (hpl->cctl[CCIDX] & ~CM_3) | cm;
+  CHECK(&ring == hBSP430timerPulseCaptureRingInitialize(&ring, captures_tt, RING_SIZE, BATCH));
+  vBSP430timerResetCounter_ni(pulsecap.hal);
+  CHECK(0 == iBSP430timerPulseCaptureSetEnabled_ni(&pulsecap, 1));
+  CHECK(0 == iBSP430timerPulseCaptureSetRing_ni(&pulsecap, &ring));
+  CHECK(both_edges == !!(BSP430_TIMER_PULSECAP_RING_BOTH_EDGES & ring.flags_ni));
+  CHECK(0 == iBSP430timerPulseCaptureSetActive_ni(&pulsecap, 1));
+  BSP430_CORE_ENABLE_INTERRUPT();
+
+  /* Start mid-pulse so the first capture is an end, which must not
+   * begin a batch when both edges are captured. */
+  vTimerhostAdvance(rngRange(1, MIN_PERIOD_TCK));
+  hpl->cctl[CCIDX] |= CCI;
+  vTimerhostAdvance(rngRange(1, MIN_PERIOD_TCK));
+  edge(hpl, 0);
+  for (n = 0; n < pulses; ++n) {
+    unsigned long period = rngRange(MIN_PERIOD_TCK, MAX_PERIOD_TCK);
+    unsigned long width = rngRange(1, period - 1);
+
+    vTimerhostAdvance(period - width);
+    if (0 == (rng() % 1000)) {
+      /* A pulse that ends before its start has been serviced, which
+       * overwrites the capture when both edges are captured */
+      ++bursts;
+      BSP430_CORE_DISABLE_INTERRUPT();
+      edge(hpl, 1);
+      vTimerhostAdvance(width);
+      edge(hpl, 0);
+      BSP430_CORE_ENABLE_INTERRUPT();
+      vTimerhostAdvance(0);
+      continue;
+    }
+    edge(hpl, 1);
+    vTimerhostAdvance(width);
+    edge(hpl, 0);
+    if (0 == lag) {
+      consume(both_edges);
+      lag = rngRange(1, (0 == (rng() % 500)) ? (4 * RING_SIZE) : (BATCH / 2));
+      if ((BATCH / 2) < lag) {
+        ++stalls;
+      }
+    } else {
+      --lag;
+    }
+  }
+  consume(both_edges);
+  BSP430_CORE_DISABLE_INTERRUPT();
+  CHECK(0 == iBSP430timerPulseCaptureSetEnabled_ni(&pulsecap, 0));
+
+  /* Every batch completed was delivered, and every loss is
+   * accounted for by a lost partial batch. */
+  CHECK(callbacks == batches);
+  CHECK(bursts <= ring.lost_ni);
+  CHECK(0 < ring.lost_ni);
+  CHECK(ullTimerhostNow() > 0x100000000ULL);
+  printf("%s: %lu edges, %lu batches, %lu lost (%lu bursts, %lu stalls), %lu ISRs over %llu ticks\n",
+         both_edges ? "both edges" : "rising edges",
+         nedges, batches, (unsigned long)ring.lost_ni, bursts, stalls,
+         ulTimerhostISRCount, ullTimerhostNow());
+  return 0;
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  unsigned long pulses = (1 < argc) ? strtoul(argv[1], NULL, 0) : 200000;
+
+  edges = malloc(2 * (pulses + 1) * sizeof(*edges));
+  runPass(pulses, CM_3);
+  runPass(pulses, CM_1);
+  free(edges);
+  return iTimerhostCheckResult();
+}
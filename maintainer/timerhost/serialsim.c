@@ -0,0 +1,404 @@
+/* Host model of the eUSCI_B0 peripheral in SPI and I2C master modes, used by
+ * maintainer/timerhost.
+ *
+ * Each octet takes eight bit times of UCB0BRW ticks (a zero
+ * prescaler counts as one) on the virtual clock.  The octet received
+ * in exchange for each one transmitted is supplied by a slave
+ * function the harness provides.  TXBUF is double-buffered as on the
+ * target: a write is moved to the shift register as soon as it is
+ * idle, and UCTXIFG is set whenever TXBUF is empty.  A completed
+ * octet sets UCRXIFG, and UCOE too if UCRXIFG was still set.
+ *
+ * In I2C mode (UCMODE_3) the peripheral is modelled as a single
+ * master on a bus whose slaves the harness provides.  A bit takes
+ * UCB0BRW ticks.  A start waits for the bus to be free, then takes
+ * ten bit times for the start, address, and acknowledgement; data
+ * octets take nine.  The master holds the clock while it has nothing
+ * to send, and before acknowledging a received octet while UCRXIFG
+ * is still set; if UCTXSTP is set when it acknowledges, it sends a
+ * NACK and a stop instead.  A stop takes two bit times and clears
+ * UCTXSTP.  A slave NACK sets UCNACKIFG and the master waits for a
+ * stop or repeated start.  A slave may instead report that another
+ * master won arbitration for the address: UCMST is cleared, UCALIFG
+ * set, and the bus stays busy for another eighteen bit times.
+ * Automatic stop generation (UCASTP) is not modelled.
+ *
+ * The model notices register writes only when the simulator runs, so
+ * it supports interrupt-driven use: the service routine in
+ * src/periph/eusci.c reads UCB0IV, which clears the flag it reports.
+ * Reading RXBUF does not clear UCRXIFG, so polled transfers are not
+ * modelled, and neither is the side effect of a reset that begins and
+ * ends between two calls into the simulator. */
+
+#include <bsp430/platform.h>
+#include <bsp430/serial.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "timerhost.h"
+
+void isr_EUSCI_B0 (void);
+
+/* TXBUF contents meaning nothing has been written since the last
+ * octet was moved out; outside the range of any register value. */
+#define TXBUF_EMPTY 0xFFFF0000U
+
+static iTimerhostSPISlave slave_;
+static int shifting_;
+static unsigned long shift_remaining_;
+static uint8_t shift_out_;
+unsigned long ulTimerhostSPIOctets;
+
+/* What the I2C master is doing.  The phases with a duration are
+ * ADDRESS, TX, RX, and STOP; the others wait for the code under
+ * test. */
+typedef enum eI2CPhase {
+  I2C_IDLE,
+  I2C_ADDRESS,
+  I2C_TX,
+  I2C_TX_HOLD,
+  I2C_RX,
+  I2C_RX_HOLD,
+  I2C_NACKED,
+  I2C_STOP,
+} eI2CPhase;
+
+static const sTimerhostI2CSlave * i2c_slave_;
+static eI2CPhase i2c_phase_;
+static unsigned long i2c_remaining_;
+static unsigned long i2c_foreign_remaining_;
+static uint8_t i2c_octet_;
+unsigned long ulTimerhostI2COctets;
+
+static volatile sBSP430hplEUSCIB *
+hpl (void)
+{
+  return BSP430_HPL_EUSCI_B0;
+}
+
+static int
+isI2C (void)
+{
+  return UCMODE_3 == (hpl()->ctlw0 & UCMODE_3);
+}
+
+static unsigned long
+i2cBitTicks (void)
+{
+  unsigned int brw = hpl()->brw & 0xFFFF;
+
+  return brw ? brw : 1;
+}
+
+static void
+i2cBeginAddress (void)
+{
+  volatile sBSP430hplEUSCIB * h = hpl();
+
+  i2c_phase_ = I2C_ADDRESS;
+  i2c_remaining_ = 10 * i2cBitTicks();
+  /* A transmitter may load the first octet as soon as the start has
+   * been generated */
+  if (h->ctlw0 & UCTR) {
+    h->ifg |= UCTXIFG;
+  }
+}
+
+static void
+i2cBeginStop (void)
+{
+  i2c_phase_ = I2C_STOP;
+  i2c_remaining_ = 2 * i2cBitTicks();
+}
+
+/* Move on from a phase that waits for the code under test, if it has
+ * done what is needed. */
+static void
+i2cProceed (void)
+{
+  volatile sBSP430hplEUSCIB * h = hpl();
+
+  switch (i2c_phase_) {
+    case I2C_IDLE:
+      if ((h->ctlw0 & UCMST) && (h->ctlw0 & UCTXSTT) && (0 == i2c_foreign_remaining_)) {
+        i2cBeginAddress();
+      }
+      break;
+    case I2C_TX_HOLD:
+      if (h->ctlw0 & UCTXSTT) {
+        i2cBeginAddress();
+      } else if (h->ctlw0 & UCTXSTP) {
+        i2cBeginStop();
+      } else if (TXBUF_EMPTY != h->txbuf) {
+        i2c_octet_ = h->txbuf & 0xFF;
+        h->txbuf = TXBUF_EMPTY;
+        h->ifg |= UCTXIFG;
+        i2c_phase_ = I2C_TX;
+        i2c_remaining_ = 9 * i2cBitTicks();
+      }
+      break;
+    case I2C_RX_HOLD:
+      if (! (h->ifg & UCRXIFG)) {
+        ++ulTimerhostI2COctets;
+        h->rxbuf = i2c_octet_;
+        h->ifg |= UCRXIFG;
+        if (h->ctlw0 & UCTXSTP) {
+          i2cBeginStop();
+        } else {
+          i2c_phase_ = I2C_RX;
+          i2c_remaining_ = 9 * i2cBitTicks();
+        }
+      }
+      break;
+    case I2C_NACKED:
+      if (h->ctlw0 & UCTXSTP) {
+        i2cBeginStop();
+      } else if (h->ctlw0 & UCTXSTT) {
+        i2cBeginAddress();
+      }
+      break;
+    default:
+      break;
+  }
+  if ((I2C_IDLE != i2c_phase_) || (0 != i2c_foreign_remaining_)) {
+    h->statw |= UCBBUSY | UCBUSY;
+  } else {
+    h->statw &= ~(UCBBUSY | UCBUSY);
+  }
+}
+
+/* The timed phase has ended */
+static void
+i2cComplete (void)
+{
+  volatile sBSP430hplEUSCIB * h = hpl();
+  int rc;
+
+  switch (i2c_phase_) {
+    case I2C_ADDRESS:
+      rc = i2c_slave_->start(h->i2csa & 0x3FF, ! (h->ctlw0 & UCTR));
+      if (TIMERHOST_I2C_LOST == rc) {
+        h->ctlw0 &= ~(UCMST | UCTXSTT | UCTXSTP);
+        h->ifg = (h->ifg & ~UCTXIFG) | UCALIFG;
+        h->txbuf = TXBUF_EMPTY;
+        i2c_phase_ = I2C_IDLE;
+        i2c_foreign_remaining_ = 18 * i2cBitTicks();
+        break;
+      }
+      h->ctlw0 &= ~UCTXSTT;
+      if (TIMERHOST_I2C_ACK != rc) {
+        h->ifg |= UCNACKIFG;
+        i2c_phase_ = I2C_NACKED;
+      } else if (h->ctlw0 & UCTR) {
+        i2c_phase_ = I2C_TX_HOLD;
+      } else {
+        i2c_phase_ = I2C_RX;
+        i2c_remaining_ = 8 * i2cBitTicks();
+      }
+      break;
+    case I2C_TX:
+      ++ulTimerhostI2COctets;
+      if (TIMERHOST_I2C_ACK != i2c_slave_->write(i2c_octet_)) {
+        h->ifg |= UCNACKIFG;
+        h->txbuf = TXBUF_EMPTY;
+        i2c_phase_ = I2C_NACKED;
+      } else {
+        i2c_phase_ = I2C_TX_HOLD;
+      }
+      break;
+    case I2C_RX:
+      i2c_octet_ = 0xFF & i2c_slave_->read();
+      i2c_phase_ = I2C_RX_HOLD;
+      break;
+    case I2C_STOP:
+      h->ctlw0 &= ~UCTXSTP;
+      i2c_slave_->stop();
+      i2c_phase_ = I2C_IDLE;
+      break;
+    default:
+      break;
+  }
+}
+
+static int
+i2cTimed (void)
+{
+  return (I2C_ADDRESS == i2c_phase_) || (I2C_TX == i2c_phase_)
+         || (I2C_RX == i2c_phase_) || (I2C_STOP == i2c_phase_);
+}
+
+/* Take account of register writes: reset, and a transmit buffer
+ * loaded while the shift register is idle. */
+static void
+sync (void)
+{
+  volatile sBSP430hplEUSCIB * h = hpl();
+
+  if (h->ctlw0 & UCSWRST) {
+    shifting_ = 0;
+    h->ie &= ~(UCTXIE | UCRXIE);
+    h->txbuf = TXBUF_EMPTY;
+    if (isI2C()) {
+      i2c_phase_ = I2C_IDLE;
+      h->ifg = 0;
+      i2cProceed();
+    } else {
+      h->statw = 0;
+      h->ifg = UCTXIFG;
+    }
+    return;
+  }
+  if (isI2C()) {
+    if (NULL == i2c_slave_) {
+      fprintf(stderr, "timerhost: eUSCI_B0 I2C mode without vTimerhostI2CInitialize()\n");
+      abort();
+    }
+    i2cProceed();
+    return;
+  }
+  if ((! shifting_) && (TXBUF_EMPTY != h->txbuf)) {
+    unsigned int brw = h->brw & 0xFFFF;
+
+    shift_out_ = h->txbuf & 0xFF;
+    h->txbuf = TXBUF_EMPTY;
+    shift_remaining_ = 8UL * (brw ? brw : 1);
+    shifting_ = 1;
+    h->statw |= UCBUSY;
+  }
+  if (TXBUF_EMPTY == h->txbuf) {
+    h->ifg |= UCTXIFG;
+  } else {
+    h->ifg &= ~UCTXIFG;
+  }
+}
+
+static unsigned long
+spiTicksToEvent (void)
+{
+  sync();
+  if (isI2C()) {
+    unsigned long rv = i2cTimed() ? i2c_remaining_ : 0;
+
+    if ((0 != i2c_foreign_remaining_) && ((0 == rv) || (i2c_foreign_remaining_ < rv))) {
+      rv = i2c_foreign_remaining_;
+    }
+    return rv;
+  }
+  return shifting_ ? shift_remaining_ : 0;
+}
+
+static void
+i2cElapse (unsigned long ticks)
+{
+  if (0 != i2c_foreign_remaining_) {
+    i2c_foreign_remaining_ -= ticks;
+  }
+  if (i2cTimed()) {
+    i2c_remaining_ -= ticks;
+    if (0 == i2c_remaining_) {
+      i2cComplete();
+    }
+  }
+  i2cProceed();
+}
+
+static void
+spiElapse (unsigned long ticks)
+{
+  volatile sBSP430hplEUSCIB * h = hpl();
+
+  sync();
+  if (isI2C()) {
+    i2cElapse(ticks);
+    return;
+  }
+  if (! shifting_) {
+    return;
+  }
+  shift_remaining_ -= ticks;
+  if (0 != shift_remaining_) {
+    return;
+  }
+  ++ulTimerhostSPIOctets;
+  shifting_ = 0;
+  h->statw &= ~UCBUSY;
+  if (h->ifg & UCRXIFG) {
+    h->statw |= UCOE;
+  }
+  h->rxbuf = 0xFF & slave_(shift_out_);
+  h->ifg |= UCRXIFG;
+  /* The next octet follows immediately if one is waiting */
+  sync();
+}
+
+static void
+(* spiPendingISR (void)) (void)
+{
+  volatile sBSP430hplEUSCIB * h = hpl();
+  unsigned int pending;
+
+  sync();
+  pending = h->ie & h->ifg;
+  if (isI2C()) {
+    if (pending & UCALIFG) {
+      h->iv = USCI_I2C_UCALIFG;
+      h->ifg &= ~UCALIFG;
+    } else if (pending & UCNACKIFG) {
+      h->iv = USCI_I2C_UCNACKIFG;
+      h->ifg &= ~UCNACKIFG;
+    } else if (pending & UCRXIFG) {
+      h->iv = USCI_I2C_UCRXIFG0;
+      h->ifg &= ~UCRXIFG;
+    } else if (pending & UCTXIFG) {
+      h->iv = USCI_I2C_UCTXIFG0;
+      h->ifg &= ~UCTXIFG;
+    } else {
+      h->iv = USCI_NONE;
+      return NULL;
+    }
+    return isr_EUSCI_B0;
+  }
+  if (pending & UCRXIFG) {
+    h->iv = USCI_SPI_UCRXIFG;
+    h->ifg &= ~UCRXIFG;
+  } else if (pending & UCTXIFG) {
+    h->iv = USCI_SPI_UCTXIFG;
+    h->ifg &= ~UCTXIFG;
+  } else {
+    h->iv = USCI_NONE;
+    return NULL;
+  }
+  return isr_EUSCI_B0;
+}
+
+static sTimerhostDevice spi_device_ = {
+  .ticksToEvent = spiTicksToEvent,
+  .elapse = spiElapse,
+  .pendingISR = spiPendingISR,
+};
+
+void
+vTimerhostSPIInitialize (iTimerhostSPISlave slave)
+{
+  slave_ = slave;
+  i2c_slave_ = NULL;
+  shifting_ = 0;
+  ulTimerhostSPIOctets = 0;
+  hpl()->ctlw0 = UCSWRST;
+  hpl()->ifg = UCTXIFG;
+  hpl()->txbuf = TXBUF_EMPTY;
+  vTimerhostAddDevice(&spi_device_);
+}
+
+void
+vTimerhostI2CInitialize (const sTimerhostI2CSlave * slave)
+{
+  i2c_slave_ = slave;
+  i2c_phase_ = I2C_IDLE;
+  i2c_foreign_remaining_ = 0;
+  ulTimerhostI2COctets = 0;
+  shifting_ = 0;
+  hpl()->ctlw0 = UCSWRST;
+  hpl()->ifg = 0;
+  hpl()->txbuf = TXBUF_EMPTY;
+  vTimerhostAddDevice(&spi_device_);
+}
@@ -0,0 +1,669 @@
+/* Host model of the Timer_A and Timer_B peripherals used by
+ * maintainer/timerhost.
+ *
+ * Counters run in continuous (MC_2) or up (MC_1) mode; up/down mode
+ * is not modelled.  Capture/compare registers in compare mode set
+ * CCIFG when the counter reaches them, and counters set TAIFG when
+ * they wrap.  Captures happen only when the harness writes the
+ * capture register itself or invokes vTimerhostCapture().
+ * Interrupts are delivered in hardware priority order: CC0 through
+ * its dedicated vector, then the remaining CCs and overflow through
+ * the shared vector, whose IV register is cleared on read as on the
+ * target.  Timer_B is modelled only with a 16-bit counter and compare
+ * latches that load immediately, in which configuration it behaves
+ * as Timer_A.
+ *
+ * On x86-64 Linux hosts the harness may single-step the code under
+ * test so that the clock advances with every instruction; see
+ * iTimerhostStepBegin(). */
+
+#define _GNU_SOURCE
+
+#include <sys/mman.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) && defined(__linux__)
+#include <ucontext.h>
+#define TIMERHOST_CAN_STEP 1
+#endif /* x86-64 Linux */
+#include "timerhost.h"
+
+int iTimerhostGIE;
+unsigned long ulTimerhostISRCount;
+unsigned long ulTimerhostFailures;
+unsigned int uiTimerhostISRTicks = 1;
+unsigned int uiTimerhostWakeTicks;
+unsigned long ulTimerhostSteps;
+unsigned int uiTimerhostStepsPerTick = 1;
+int iTimerhostStepISRs;
+
+static unsigned long long now_tck;
+/* Depth of nesting of the step trap handler.  Nonzero while it
+ * runs, so the code it interrupted is being stepped. */
+static volatile int in_trap;
+static int lpm_exit;
+static const sTimerhostDevice * devices;
+
+static int stepSuspend (void);
+static void stepResume (int suspended);
+static void stepContinue (void);
+
+void isr_cc0_TA0 (void);
+void isr_TA0 (void);
+void isr_cc0_TA1 (void);
+void isr_TA1 (void);
+void isr_cc0_TB0 (void);
+void isr_TB0 (void);
+
+typedef struct sTimerInstance {
+  unsigned int base;
+  unsigned int nccr;
+  void (* isr_cc0) (void);
+  void (* isr) (void);
+} sTimerInstance;
+
+static const sTimerInstance timers[] = {
+  { __MSP430_BASEADDRESS_T0A5__, 5, isr_cc0_TA0, isr_TA0 },
+  { __MSP430_BASEADDRESS_T1A3__, 3, isr_cc0_TA1, isr_TA1 },
+  { __MSP430_BASEADDRESS_T0B7__, 7, isr_cc0_TB0, isr_TB0 },
+};
+#define NTIMERS (sizeof(timers) / sizeof(*timers))
+
+static volatile sBSP430hplTIMER *
+hplFor (const sTimerInstance * tp)
+{
+  return (volatile sBSP430hplTIMER *)(uintptr_t)tp->base;
+}
+
+/* Registers are 16 bits on the target but unsigned int is wider on
+ * the host.  Truncate anything the code under test stored, as the
+ * hardware would have on the write. */
+static void
+truncateRegisters (const sTimerInstance * tp)
+{
+  volatile sBSP430hplTIMER * hpl = hplFor(tp);
+  unsigned int i;
+
+  hpl->ctl &= 0xFFFF;
+  hpl->r &= 0xFFFF;
+  for (i = 0; i < tp->nccr; ++i) {
+    hpl->cctl[i] &= 0xFFFF;
+    hpl->ccr[i] &= 0xFFFF;
+  }
+}
+
+/* Number of counts in one counter cycle, or zero if the counter is
+ * stopped. */
+static unsigned long
+counterPeriod (volatile sBSP430hplTIMER * hpl)
+{
+  if (hpl->ctl & (TBCLGRP1 | TBCLGRP0 | CNTL1 | CNTL0)) {
+    fprintf(stderr, "timerhost: Timer_B counter length and latch groups not modelled\n");
+    abort();
+  }
+  switch (hpl->ctl & (MC0 | MC1)) {
+    case MC_1:
+      return hpl->ccr[0] ? (1UL + hpl->ccr[0]) : 0;
+    case MC_2:
+      return 0x10000UL;
+    case MC_3:
+      fprintf(stderr, "timerhost: up/down mode not modelled\n");
+      abort();
+  }
+  return 0;
+}
+
+/* Ticks until the counter next reaches a compare register or wraps,
+ * or zero if the counter is stopped. */
+static unsigned long
+ticksToEvent (const sTimerInstance * tp)
+{
+  volatile sBSP430hplTIMER * hpl = hplFor(tp);
+  unsigned long period;
+  unsigned long r;
+  unsigned long rv;
+  unsigned int i;
+
+  truncateRegisters(tp);
+  period = counterPeriod(hpl);
+  r = hpl->r;
+  if (0 == period) {
+    return 0;
+  }
+  if (r >= period) {
+    /* Up mode with the counter beyond CCR0: it runs to 0xFFFF first. */
+    period = 0x10000UL;
+  }
+  rv = period - r;
+  for (i = 0; i < tp->nccr; ++i) {
+    unsigned long c = hpl->ccr[i];
+    unsigned long d;
+
+    if (hpl->cctl[i] & (CLLD1 | CLLD0)) {
+      fprintf(stderr, "timerhost: Timer_B compare latch load conditions not modelled\n");
+      abort();
+    }
+    if ((hpl->cctl[i] & CAP) || (c >= period)) {
+      continue;
+    }
+    d = (c > r) ? (c - r) : (period - r + c);
+    if (d < rv) {
+      rv = d;
+    }
+  }
+  return rv;
+}
+
+/* Advance a running counter by ticks, which must not exceed
+ * ticksToEvent(), and raise any flag for an event reached. */
+static void
+stepCounter (const sTimerInstance * tp,
+             unsigned long ticks)
+{
+  volatile sBSP430hplTIMER * hpl = hplFor(tp);
+  unsigned long period = counterPeriod(hpl);
+  unsigned long r = hpl->r;
+  unsigned int i;
+
+  if (0 == period) {
+    return;
+  }
+  if (r >= period) {
+    period = 0x10000UL;
+  }
+  r += ticks;
+  if (r >= period) {
+    r -= period;
+    hpl->ctl |= TAIFG;
+  }
+  hpl->r = r;
+  for (i = 0; i < tp->nccr; ++i) {
+    if ((! (hpl->cctl[i] & CAP)) && (hpl->ccr[i] == r)) {
+      hpl->cctl[i] |= CCIFG;
+    }
+  }
+}
+
+static const sTimerInstance *
+instanceFor (unsigned int base)
+{
+  unsigned int i;
+
+  for (i = 0; i < NTIMERS; ++i) {
+    if (timers[i].base == base) {
+      return timers + i;
+    }
+  }
+  fprintf(stderr, "timerhost: no timer at %#x\n", base);
+  abort();
+}
+
+/* Highest priority pending interrupt on the shared vector as a TAxIV
+ * value, optionally clearing the corresponding flag. */
+static unsigned int
+pendingIV (const sTimerInstance * tp,
+           int clear)
+{
+  volatile sBSP430hplTIMER * hpl = hplFor(tp);
+  unsigned int i;
+
+  truncateRegisters(tp);
+  for (i = 1; i < tp->nccr; ++i) {
+    if ((CCIE | CCIFG) == (hpl->cctl[i] & (CCIE | CCIFG))) {
+      if (clear) {
+        hpl->cctl[i] &= ~CCIFG;
+      }
+      return 2 * i;
+    }
+  }
+  if ((TAIE | TAIFG) == (hpl->ctl & (TAIE | TAIFG))) {
+    if (clear) {
+      hpl->ctl &= ~TAIFG;
+    }
+    return 0x0E;
+  }
+  return 0;
+}
+
+unsigned int
+uiTimerhostReadIV (unsigned int base)
+{
+  return pendingIV(instanceFor(base), 1);
+}
+
+/* Ticks until the nearest event on any running timer or busy
+ * device, or zero if nothing is running. */
+static unsigned long
+nearestEvent (void)
+{
+  unsigned long rv = 0;
+  const sTimerhostDevice * dp;
+  unsigned int i;
+
+  for (i = 0; i < NTIMERS; ++i) {
+    unsigned long d = ticksToEvent(timers + i);
+    if ((0 != d) && ((0 == rv) || (d < rv))) {
+      rv = d;
+    }
+  }
+  for (dp = devices; NULL != dp; dp = dp->next) {
+    unsigned long d = dp->ticksToEvent();
+    if ((0 != d) && ((0 == rv) || (d < rv))) {
+      rv = d;
+    }
+  }
+  return rv;
+}
+
+/* Let ticks pass without delivering interrupts.  Each step stops at
+ * the nearest timer or device event so no event is skipped.  Returns
+ * the ticks that elapsed, which is less than requested only if
+ * nothing is running. */
+static unsigned long
+elapse (unsigned long ticks)
+{
+  unsigned long rv = 0;
+
+  while (rv < ticks) {
+    unsigned long step = ticks - rv;
+    unsigned long d = nearestEvent();
+    const sTimerhostDevice * dp;
+    unsigned int i;
+
+    if (0 == d) {
+      break;
+    }
+    if (d < step) {
+      step = d;
+    }
+    for (i = 0; i < NTIMERS; ++i) {
+      stepCounter(timers + i, step);
+    }
+    for (dp = devices; NULL != dp; dp = dp->next) {
+      dp->elapse(step);
+    }
+    now_tck += step;
+    rv += step;
+  }
+  return rv;
+}
+
+/* Invoke an ISR the way the hardware does: interrupts are disabled
+ * on entry and re-enabled on exit.  The ISR is charged
+ * uiTimerhostISRTicks of virtual time, so code that keeps re-arming
+ * an interrupt until some time has passed makes progress as it would
+ * on the target.  If iTimerhostStepISRs is set it is also stepped;
+ * if it is being delivered to stepped code, stepping of that code
+ * continues when it returns. */
+static void
+invokeISR (void (* isr) (void))
+{
+  unsigned long done;
+
+  ++ulTimerhostISRCount;
+  iTimerhostGIE = 0;
+  if (iTimerhostStepISRs && (0 == iTimerhostStepBegin())) {
+    isr();
+    vTimerhostStepEnd();
+    if (in_trap) {
+      stepContinue();
+    }
+  } else {
+    isr();
+  }
+  done = elapse(uiTimerhostISRTicks);
+  /* The service time passes even if everything went idle */
+  now_tck += uiTimerhostISRTicks - done;
+  iTimerhostGIE = 1;
+}
+
+/* Deliver pending interrupts for as long as interrupts are enabled. */
+static void
+deliverInterrupts (void)
+{
+  while (iTimerhostGIE) {
+    unsigned int i;
+    int delivered = 0;
+
+    const sTimerhostDevice * dp;
+
+    for (i = 0; (! delivered) && (i < NTIMERS); ++i) {
+      const sTimerInstance * tp = timers + i;
+      volatile sBSP430hplTIMER * hpl = hplFor(tp);
+
+      if ((CCIE | CCIFG) == (hpl->cctl[0] & (CCIE | CCIFG))) {
+        hpl->cctl[0] &= ~CCIFG;
+        invokeISR(tp->isr_cc0);
+        delivered = 1;
+      } else if (0 != pendingIV(tp, 0)) {
+        invokeISR(tp->isr);
+        delivered = 1;
+      }
+    }
+    for (dp = devices; (! delivered) && (NULL != dp); dp = dp->next) {
+      void (* isr) (void) = dp->pendingISR();
+
+      if (NULL != isr) {
+        invokeISR(isr);
+        delivered = 1;
+      }
+    }
+    if (! delivered) {
+      break;
+    }
+  }
+}
+
+void
+vTimerhostLPMExitFromISR (unsigned int sr_bits)
+{
+  if (sr_bits & LPM4_bits) {
+    lpm_exit = 1;
+  }
+}
+
+
+/* Stepped code that sleeps is not stepped while it sleeps; the clock
+ * moves from event to event as it would for unstepped code, and on
+ * for uiTimerhostWakeTicks once a handler has asked it to wake. */
+void
+vTimerhostLPMEnter (unsigned int lpm_bits)
+{
+  int suspended = stepSuspend();
+
+  if (lpm_bits & GIE) {
+    iTimerhostGIE = 1;
+  }
+  lpm_exit = 0;
+  deliverInterrupts();
+  while (! lpm_exit) {
+    if (0 == ulTimerhostAdvanceToEvent()) {
+      fprintf(stderr, "timerhost: low power mode entered with no timer running\n");
+      abort();
+    }
+  }
+  vTimerhostAdvance(uiTimerhostWakeTicks);
+  stepResume(suspended);
+}
+
+void
+vTimerhostAdvance (unsigned long ticks)
+{
+  deliverInterrupts();
+  while (0 < ticks) {
+    unsigned long step = nearestEvent();
+
+    if ((0 == step) || (ticks < step)) {
+      step = ticks;
+    }
+    if (step != elapse(step)) {
+      /* Nothing running: time passes with no effect */
+      now_tck += step;
+    }
+    ticks -= step;
+    deliverInterrupts();
+  }
+}
+
+unsigned long
+ulTimerhostAdvanceToEvent (void)
+{
+  unsigned long step;
+
+  deliverInterrupts();
+  step = nearestEvent();
+  if (0 != step) {
+    (void)elapse(step);
+    deliverInterrupts();
+  }
+  return step;
+}
+
+void
+vTimerhostCapture (volatile sBSP430hplTIMER * hpl,
+                   unsigned int ccidx,
+                   int level)
+{
+  unsigned int cctl = hpl->cctl[ccidx] & 0xFFFF;
+  int was_high = !! (cctl & CCI);
+  int capture;
+
+  level = !! level;
+  if (level == was_high) {
+    return;
+  }
+  cctl = level ? (cctl | CCI) : (cctl & ~CCI);
+  capture = (cctl & CAP) && (level ? (cctl & CM_1) : (cctl & CM_2));
+  if (capture) {
+    if (cctl & CCIFG) {
+      cctl |= COV;
+    }
+    hpl->ccr[ccidx] = hpl->r & 0xFFFF;
+    cctl |= CCIFG;
+  }
+  hpl->cctl[ccidx] = cctl;
+  deliverInterrupts();
+}
+
+unsigned long long
+ullTimerhostNow (void)
+{
+  return now_tck;
+}
+
+#if (TIMERHOST_CAN_STEP - 0)
+
+static volatile int stepping;
+
+/* The instruction following the one that set the trap flag, or the
+ * previous trap, has executed.  Devices see what it wrote to their
+ * registers, so a flag cleared and set again between two ticks is
+ * still an edge.  Every uiTimerhostStepsPerTick instructions one tick
+ * passes, and any interrupt that is due and enabled is taken.  The handler is not itself stepped, but service
+ * routines it runs are when iTimerhostStepISRs is set; their traps
+ * nest, which the handler permits with SA_NODEFER. */
+static void
+stepTrap (int sig,
+          siginfo_t * info,
+          void * context)
+{
+  ucontext_t * ucp = (ucontext_t *)context;
+
+  if (! stepping) {
+    ucp->uc_mcontext.gregs[REG_EFL] &= ~0x100;
+    return;
+  }
+  ++ulTimerhostSteps;
+  if (0 == (ulTimerhostSteps % uiTimerhostStepsPerTick)) {
+    ++in_trap;
+    vTimerhostAdvance(1);
+    --in_trap;
+  } else {
+    (void)nearestEvent();
+  }
+}
+
+int
+iTimerhostStepBegin (void)
+{
+  static int installed;
+
+  if (! installed) {
+    struct sigaction sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = stepTrap;
+    sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+    if (0 != sigaction(SIGTRAP, &sa, NULL)) {
+      return -1;
+    }
+    installed = 1;
+  }
+  stepping = 1;
+  __asm__ __volatile__ ("pushfq\n\torq $0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+  return 0;
+}
+
+void
+vTimerhostStepEnd (void)
+{
+  stepping = 0;
+}
+
+/* Stop stepping if the caller is being stepped.  Returns nonzero if
+ * it was. */
+static int
+stepSuspend (void)
+{
+  int rv = stepping && (! in_trap);
+
+  if (rv) {
+    stepping = 0;
+  }
+  return rv;
+}
+
+static void
+stepResume (int suspended)
+{
+  if (suspended) {
+    (void)iTimerhostStepBegin();
+  }
+}
+
+/* A stepped service routine delivered by the trap handler has
+ * returned, and vTimerhostStepEnd() has cleared the trap flag in the
+ * handler.  The interrupted code, whose saved flags still hold it,
+ * is stepped again once the handler returns. */
+static void
+stepContinue (void)
+{
+  stepping = 1;
+}
+
+#else /* TIMERHOST_CAN_STEP */
+
+int
+iTimerhostStepBegin (void)
+{
+  return -1;
+}
+
+void
+vTimerhostStepEnd (void)
+{
+}
+
+static int
+stepSuspend (void)
+{
+  return 0;
+}
+
+static void
+stepResume (int suspended)
+{
+}
+
+static void
+stepContinue (void)
+{
+}
+
+#endif /* TIMERHOST_CAN_STEP */
+
+void
+vTimerhostInitialize (void)
+{
+  void * page = (void *)(uintptr_t)TIMERHOST_PERIPH_BASE;
+  static int mapped;
+
+  if (! mapped) {
+    /* The address is only a hint, so an existing mapping is never
+     * clobbered; failure to get it is fatal. */
+    if (page != mmap(page, 4096, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) {
+      perror("timerhost: mmap");
+      abort();
+    }
+    mapped = 1;
+  }
+  memset(page, 0, 4096);
+  now_tck = 0;
+  ulTimerhostISRCount = 0;
+  ulTimerhostSteps = 0;
+  iTimerhostGIE = 0;
+  devices = NULL;
+}
+
+int
+iTimerhostCheckFailed (void)
+{
+  return 20 > ++ulTimerhostFailures;
+}
+
+int
+iTimerhostCheckResult (void)
+{
+  if (0 != ulTimerhostFailures) {
+    printf("FAILED: %lu checks\n", ulTimerhostFailures);
+    return 1;
+  }
+  return 0;
+}
+
+void
+vTimerhostAddDevice (sTimerhostDevice * dp)
+{
+  dp->next = devices;
+  devices = dp;
+}
+
+/* Clock configuration reported to the timer module: MCLK and SMCLK
+ * from the DCO, ACLK from a watch crystal. */
+eBSP430clockSource
+xBSP430clockMCLKSource (void)
+{
+  return eBSP430clockSRC_DCOCLK;
+}
+
+eBSP430clockSource
+xBSP430clockSMCLKSource (void)
+{
+  return eBSP430clockSRC_DCOCLK;
+}
+
+eBSP430clockSource
+xBSP430clockACLKSource (void)
+{
+  return eBSP430clockSRC_XT1CLK;
+}
+
+unsigned long
+ulBSP430clockMCLK_Hz_ni (void)
+{
+  return 8000000UL;
+}
+
+unsigned long
+ulBSP430clockSMCLK_Hz_ni (void)
+{
+  return 1000000UL;
+}
+
+unsigned long
+ulBSP430clockACLK_Hz_ni (void)
+{
+  return 32768UL;
+}
+
+/* Simulated peripherals have no pins to configure. */
+int
+iBSP430platformConfigurePeripheralPins_ni (tBSP430periphHandle periph,
+                                           int periph_config,
+                                           int enablep)
+{
+  return 0;
+}
@@ -0,0 +1,311 @@
+/* Test of interrupt-driven SPI transactions (iBSP430spiTxRxAsync_ni)
+ * and polled write-only transfers on the simulated eUSCI_B0.
+ *
+ * The simulated slave returns a pseudo-random octet for each one it
+ * receives and logs both.  Each round opens the device with a random
+ * prescaler and runs a batch of transactions of random command and
+ * response lengths; all but the first are started from the completion
+ * callback of the one before, and only the last wakes the CPU, which
+ * sleeps in LPM0 throughout.  Interrupt service time changes with
+ * every octet: mostly a fraction of an octet time, sometimes several,
+ * so a driver that keeps more than one octet outstanding eventually
+ * loses one.  The test checks that:
+ *
+ * @li the slave received each command followed by the dummy octets
+ * of #BSP430_SERIAL_SPI_READ_TX_BYTE, in order;
+ * @li every response octet was stored in order, and none was lost to
+ * an overrun however late the interrupts;
+ * @li each completion callback ran exactly once, after every octet,
+ * with the transaction no longer active, and the CPU woke once per
+ * batch;
+ * @li starting an active transaction, starting on a device whose
+ * callbacks are in use, and polled transfers while the transaction
+ * is linked are all rejected, and releasing it unlinks its
+ * callbacks.
+ *
+ * Write-only transfers (iBSP430spiTxRx_rh() with no receive buffer)
+ * are then single-stepped, so the model runs while the driver spins
+ * on the device flags.  The test checks that the slave receives every
+ * octet in order with no idle time between them, and that the call
+ * returns only once the last one has been shifted out.  (The model
+ * does not clear UCRXIFG when RXBUF is read, so the receive side of
+ * polled transfers is not checked.)
+ *
+ * Usage: spitest [rounds]   (default 2000) */
+
+#include <bsp430/platform.h>
+#include <bsp430/serial.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timerhost.h"
+
+#define MAX_BATCH 8
+#define MAX_LEN 48
+
+/* Stepped instructions per tick for write-only transfers; a
+ * sanitized build executes several times as many. */
+#if defined(__SANITIZE_ADDRESS__)
+#define STEPS_PER_TICK 8
+#else /* __SANITIZE_ADDRESS__ */
+#define STEPS_PER_TICK 1
+#endif /* __SANITIZE_ADDRESS__ */
+
+/* Bound on ticks from entry to the first octet and from the last
+ * octet to return. */
+#define WRITE_SLACK_TCK 100
+
+typedef struct sRequest {
+  uint8_t tx[MAX_LEN];
+  size_t tx_len;
+  size_t rx_len;
+  uint8_t rx[2 * MAX_LEN];
+  int store;
+  unsigned long completions;
+} sRequest;
+
+static hBSP430halSERIAL spi;
+static sBSP430spiTransaction xfer;
+static sRequest requests[MAX_BATCH];
+static unsigned int nrequests;
+static unsigned int current;
+static uint8_t mosi_log[MAX_BATCH * 2 * MAX_LEN];
+static uint8_t miso_log[MAX_BATCH * 2 * MAX_LEN];
+static unsigned int nlog;
+static unsigned int octet_tck;
+static unsigned long long max_write_slack;
+
+static unsigned long rng_state = 1;
+static unsigned long slave_state = 7;
+
+static unsigned long
+rng (void)
+{
+  rng_state = rng_state * 1103515245UL + 12345UL;
+  return (rng_state >> 16) & 0x7FFF;
+}
+
+static int
+slave (uint8_t mosi)
+{
+  unsigned int isr_range = octet_tck / 2;
+  uint8_t miso;
+
+  slave_state = slave_state * 1103515245UL + 12345UL;
+  miso = (slave_state >> 16) & 0xFF;
+  /* Service time for the interrupts this octet raises */
+  if (0 == (rng() % 8)) {
+    isr_range = 4 * octet_tck;
+  }
+  uiTimerhostISRTicks = 1 + (rng() % isr_range);
+  CHECK(nlog < sizeof(mosi_log));
+  if (nlog < sizeof(mosi_log)) {
+    mosi_log[nlog] = mosi;
+    miso_log[nlog] = miso;
+    ++nlog;
+  }
+  return miso;
+}
+
+static int completed_cb (hBSP430spiTransaction xp);
+
+static int
+startRequest (sRequest * rp)
+{
+  return iBSP430spiTxRxAsync_ni(spi, &xfer, rp->tx, rp->tx_len, rp->rx_len,
+                                rp->store ? rp->rx : NULL, completed_cb);
+}
+
+static int
+completed_cb (hBSP430spiTransaction xp)
+{
+  sRequest * rp = requests + current;
+
+  CHECK(&xfer == xp);
+  CHECK(! (BSP430_SPI_TRANSACTION_FLAG_ACTIVE & xp->flags_ni));
+  CHECK(xp->tx_count_ni == rp->tx_len + rp->rx_len);
+  CHECK(xp->rx_count_ni == rp->tx_len + rp->rx_len);
+  ++rp->completions;
+  if (++current < nrequests) {
+    CHECK(0 == startRequest(requests + current));
+    return 0;
+  }
+  return BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
+}
+
+/* Compare what the slave saw and returned with each request. */
+static void
+checkBatch (void)
+{
+  unsigned int li = 0;
+  unsigned int i;
+
+  for (i = 0; i < nrequests; ++i) {
+    sRequest * rp = requests + i;
+    size_t total = rp->tx_len + rp->rx_len;
+    size_t j;
+
+    CHECK(1 == rp->completions);
+    CHECK(li + total <= nlog);
+    if (li + total > nlog) {
+      return;
+    }
+    for (j = 0; j < total; ++j) {
+      uint8_t expected = (j < rp->tx_len) ? rp->tx[j] : (0xFF & BSP430_SERIAL_SPI_READ_TX_BYTE(j - rp->tx_len));
+
+      CHECK(mosi_log[li + j] == expected);
+      if (rp->store) {
+        CHECK(rp->rx[j] == miso_log[li + j]);
+      }
+    }
+    li += total;
+  }
+  CHECK(li == nlog);
+}
+
+static void
+runBatch (unsigned int prescaler)
+{
+  unsigned long long start_tck;
+  unsigned long octets = 0;
+  unsigned long wakes = 0;
+  unsigned int i;
+
+  nrequests = 1 + (rng() % MAX_BATCH);
+  for (i = 0; i < nrequests; ++i) {
+    sRequest * rp = requests + i;
+    size_t j;
+
+    rp->tx_len = rng() % MAX_LEN;
+    rp->rx_len = rng() % MAX_LEN;
+    if (0 == (rp->tx_len + rp->rx_len)) {
+      rp->rx_len = 1;
+    }
+    for (j = 0; j < rp->tx_len; ++j) {
+      rp->tx[j] = rng();
+    }
+    memset(rp->rx, 0, sizeof(rp->rx));
+    rp->store = (0 != (rng() % 4));
+    rp->completions = 0;
+    octets += rp->tx_len + rp->rx_len;
+  }
+  octet_tck = 8 * prescaler;
+  uiTimerhostISRTicks = 1 + (rng() % octet_tck);
+  nlog = 0;
+  current = 0;
+
+  BSP430_CORE_DISABLE_INTERRUPT();
+  start_tck = ullTimerhostNow();
+  CHECK(0 == startRequest(requests));
+  CHECK(-1 == startRequest(requests));
+  while (current < nrequests) {
+    BSP430_CORE_LPM_ENTER_NI(LPM0_bits);
+    BSP430_CORE_DISABLE_INTERRUPT();
+    ++wakes;
+  }
+  CHECK(1 == wakes);
+  CHECK(! (UCOE & BSP430_HPL_EUSCI_B0->statw));
+  CHECK((ullTimerhostNow() - start_tck) >= 8UL * prescaler * octets);
+  checkBatch();
+}
+
+/* One polled write-only transfer, single-stepped with the CPU well
+ * ahead of the SPI clock. */
+static void
+runWrite (unsigned int prescaler)
+{
+  sRequest * rp = requests;
+  unsigned long octets0 = ulTimerhostSPIOctets;
+  unsigned long long start_tck;
+  unsigned long long dt;
+  size_t total;
+  size_t j;
+  int rc;
+
+  rp->tx_len = 1 + (rng() % MAX_LEN);
+  rp->rx_len = rng() % 4;
+  for (j = 0; j < rp->tx_len; ++j) {
+    rp->tx[j] = rng();
+  }
+  total = rp->tx_len + rp->rx_len;
+  nlog = 0;
+  start_tck = ullTimerhostNow();
+  (void)iTimerhostStepBegin();
+  rc = iBSP430spiTxRx_rh(spi, rp->tx, rp->tx_len, rp->rx_len, NULL);
+  vTimerhostStepEnd();
+  dt = ullTimerhostNow() - start_tck;
+  if (dt > max_write_slack + 8UL * prescaler * total) {
+    max_write_slack = dt - 8UL * prescaler * total;
+  }
+
+  CHECK(total == rc);
+  /* Nothing left in TXBUF or the shift register */
+  CHECK(total == (ulTimerhostSPIOctets - octets0));
+  CHECK(! (UCBUSY & BSP430_HPL_EUSCI_B0->statw));
+  CHECK(dt >= 8UL * prescaler * total);
+  CHECK(dt <= (8UL * prescaler * total + WRITE_SLACK_TCK));
+  CHECK(total == nlog);
+  for (j = 0; (j < total) && (j < nlog); ++j) {
+    uint8_t expected = (j < rp->tx_len) ? rp->tx[j] : (0xFF & BSP430_SERIAL_SPI_READ_TX_BYTE(j - rp->tx_len));
+
+    CHECK(mosi_log[j] == expected);
+  }
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  unsigned long rounds = (1 < argc) ? strtoul(argv[1], NULL, 0) : 2000;
+  static sBSP430spiTransaction other;
+  unsigned long batches = 0;
+  unsigned long n;
+  uint8_t cmd[2] = { 0x9F, 0 };
+  uint8_t resp[4];
+
+  vTimerhostInitialize();
+  vTimerhostSPIInitialize(slave);
+  spi = hBSP430serialLookup(BSP430_PERIPH_EUSCI_B0);
+  CHECK(NULL != spi);
+
+  for (n = 0; n < rounds; ++n) {
+    unsigned int prescaler = 1 + (rng() % 8);
+
+    CHECK(spi == hBSP430serialOpenSPI(spi, BSP430_SERIAL_ADJUST_CTL0_INITIALIZER(UCCKPL | UCMSB | UCMST), UCSSEL__SMCLK, prescaler));
+    runBatch(prescaler);
+    ++batches;
+
+    /* The device is claimed until the transaction is released */
+    CHECK(-1 == iBSP430spiTxRx_rh(spi, cmd, sizeof(cmd), 2, resp));
+    CHECK(-1 == iBSP430spiTxRxAsync_ni(spi, &other, cmd, sizeof(cmd), 2, resp, NULL));
+    if (0 == (n % 3)) {
+      CHECK(0 == iBSP430spiTxRxAsyncRelease_ni(&xfer));
+      CHECK(NULL == spi->tx_cbchain_ni);
+      CHECK(NULL == spi->rx_cbchain_ni);
+      CHECK(0 == iBSP430spiTxRxAsyncRelease_ni(&xfer));
+    }
+  }
+  CHECK(-1 == iBSP430spiTxRxAsync_ni(spi, &other, cmd, 0, 0, resp, NULL));
+
+  printf("%lu batches, %lu octets, %lu ISRs over %llu ticks\n",
+         batches, ulTimerhostSPIOctets, ulTimerhostISRCount, ullTimerhostNow());
+
+  CHECK(0 == iBSP430spiTxRxAsyncRelease_ni(&xfer));
+  if (0 == iTimerhostStepBegin()) {
+    unsigned long writes = rounds / 4;
+
+    vTimerhostStepEnd();
+    uiTimerhostStepsPerTick = STEPS_PER_TICK;
+    for (n = 0; n < writes; ++n) {
+      /* At least four instructions per SPI clock */
+      unsigned int prescaler = 4 + (rng() % 8);
+
+      CHECK(spi == hBSP430serialOpenSPI(spi, BSP430_SERIAL_ADJUST_CTL0_INITIALIZER(UCCKPL | UCMSB | UCMST), UCSSEL__SMCLK, prescaler));
+      runWrite(prescaler);
+    }
+    printf("%lu write-only transfers, at most %llu ticks of overhead\n", writes, max_write_slack);
+  } else {
+    printf("single-stepping unsupported, write-only transfers skipped\n");
+  }
+  return iTimerhostCheckResult();
+}
@@ -0,0 +1,248 @@
+/* Interface to the host model of the Timer_A and Timer_B peripherals
+ * used by maintainer/timerhost.
+ *
+ * The model keeps a virtual clock measured in timer ticks.  All
+ * modelled timers are clocked from it at the same rate regardless of
+ * their TASSEL and ID settings.  Time passes only when the harness
+ * asks: vTimerhostAdvance() moves the clock forward event by event,
+ * setting TAIFG when a counter wraps and CCIFG when a counter reaches
+ * a compare register, and delivers enabled interrupts through the
+ * ISRs in src/periph/timer.c whenever interrupts are enabled. */
+
+#ifndef TIMERHOST_H
+#define TIMERHOST_H
+
+#include <bsp430/periph/timer.h>
+#include <stdio.h>
+
+/** Map the simulated register blocks and reset them.  Must be
+ * invoked before anything touches a timer. */
+void vTimerhostInitialize (void);
+
+/** Advance the virtual clock by @p ticks, delivering interrupts as
+ * they become due.  Interrupts already pending are delivered first,
+ * so an advance of zero ticks acts as a window in which interrupts
+ * are briefly enabled. */
+void vTimerhostAdvance (unsigned long ticks);
+
+/** Advance the virtual clock to the next counter event (compare
+ * match or wrap) on any running timer and deliver interrupts.
+ * Returns the number of ticks that elapsed, or zero if no timer is
+ * running. */
+unsigned long ulTimerhostAdvanceToEvent (void);
+
+/** Drive the input of capture/compare register @p ccidx of the timer
+ * at @p hpl to @p level.  CCI follows the input; if the register is
+ * in capture mode and its CM bits select the edge, the counter is
+ * captured and CCIFG set, along with COV if CCIFG was already set.
+ * Pending interrupts are then delivered if interrupts are enabled. */
+void vTimerhostCapture (volatile sBSP430hplTIMER * hpl,
+                        unsigned int ccidx,
+                        int level);
+
+/** A simulated peripheral other than a timer, clocked from the same
+ * virtual clock. */
+typedef struct sTimerhostDevice {
+  /** Ticks until the device next changes state by itself, or zero if
+   * it is idle.  The device should first take account of anything
+   * the code under test has written to its registers. */
+  unsigned long (* ticksToEvent) (void);
+
+  /** Let @p ticks pass; never more than ticksToEvent() returned. */
+  void (* elapse) (unsigned long ticks);
+
+  /** The service routine for the highest priority enabled and
+   * pending interrupt, or a null pointer if there is none.  The
+   * device clears the flag as the hardware would when the routine
+   * reads the interrupt vector register. */
+  void (* (* pendingISR) (void)) (void);
+
+  /** @cond DOXYGEN_EXCLUDE */
+  const struct sTimerhostDevice * next;
+  /** @endcond */
+} sTimerhostDevice;
+
+/** Attach a device to the simulation until the next
+ * vTimerhostInitialize().  Devices are serviced after the timers, in
+ * reverse order of attachment. */
+void vTimerhostAddDevice (sTimerhostDevice * dp);
+
+/** A simulated SPI slave: given the octet the master shifted out,
+ * return the octet it shifted in. */
+typedef int (* iTimerhostSPISlave) (uint8_t mosi);
+
+/** Attach the eUSCI_B0 SPI master model in serialsim.c, exchanging
+ * octets with @p slave, and place the device in reset.  Invoke after
+ * vTimerhostInitialize(). */
+void vTimerhostSPIInitialize (iTimerhostSPISlave slave);
+
+/** Number of octets exchanged by the eUSCI_B0 model. */
+extern unsigned long ulTimerhostSPIOctets;
+
+/** Value returned by sTimerhostI2CSlave callbacks to acknowledge */
+#define TIMERHOST_I2C_ACK 0
+
+/** Value returned by sTimerhostI2CSlave callbacks to reject an
+ * address or octet */
+#define TIMERHOST_I2C_NACK 1
+
+/** Value returned by sTimerhostI2CSlave::start to make the master
+ * lose arbitration to another master */
+#define TIMERHOST_I2C_LOST 2
+
+/** The slaves on a simulated I2C bus, as seen by the master.  Each
+ * callback is invoked when the bus reaches the corresponding point
+ * on the virtual clock. */
+typedef struct sTimerhostI2CSlave {
+  /** A start or repeated start addressed @p address for reading (@p
+   * read nonzero) or writing.  Return #TIMERHOST_I2C_ACK,
+   * #TIMERHOST_I2C_NACK, or #TIMERHOST_I2C_LOST. */
+  int (* start) (unsigned int address, int read);
+
+  /** The master wrote @p octet.  Return #TIMERHOST_I2C_ACK or
+   * #TIMERHOST_I2C_NACK. */
+  int (* write) (uint8_t octet);
+
+  /** Return the octet the addressed slave sends the master */
+  int (* read) (void);
+
+  /** The master generated a stop */
+  void (* stop) (void);
+} sTimerhostI2CSlave;
+
+/** Attach the eUSCI_B0 I2C master model in serialsim.c, with @p
+ * slave on the bus, and place the device in reset.  Invoke after
+ * vTimerhostInitialize(). */
+void vTimerhostI2CInitialize (const sTimerhostI2CSlave * slave);
+
+/** Number of octets transferred by the eUSCI_B0 I2C model, not
+ * counting addresses. */
+extern unsigned long ulTimerhostI2COctets;
+
+/** The line driving a simulated UART receiver.  Store in @p octetp
+ * the next octet to be received, and return the number of ticks from
+ * now until its stop bit ends, or zero if nothing more will be
+ * received. */
+typedef unsigned long (* ulTimerhostUARTSource) (uint8_t * octetp);
+
+/** Attach the eUSCI_A0 UART and DMA controller models in uartsim.c,
+ * with @p source driving the receive line, and place the UART in
+ * reset.  @p source is first invoked here.  Invoke after
+ * vTimerhostInitialize(). */
+void vTimerhostUARTInitialize (ulTimerhostUARTSource source);
+
+/** Ask the source for another octet if it last returned zero.  Use
+ * when the harness has more for the receive line. */
+void vTimerhostUARTResume (void);
+
+/** The far end of a simulated UART transmitter: accept @p octet,
+ * which has just finished shifting out. */
+typedef void (* vTimerhostUARTSink) (uint8_t octet);
+
+/** Pass each octet the eUSCI_A0 model transmits to @p sink, or
+ * discard them if it is a null pointer (the default). */
+void vTimerhostUARTSetSink (vTimerhostUARTSink sink);
+
+/** Ticks the eUSCI_A0 model takes to shift out one octet.  Defaults
+ * to 87, one character time at 115200 baud on a 1 MHz clock. */
+extern unsigned int uiTimerhostUARTTxTicks;
+
+/** Number of octets received by the eUSCI_A0 model, including any
+ * lost to overruns. */
+extern unsigned long ulTimerhostUARTOctets;
+
+/** Number of octets transmitted by the eUSCI_A0 model */
+extern unsigned long ulTimerhostUARTTxOctets;
+
+/** Number of octets the eUSCI_A0 model received while UCRXIFG was
+ * still set, overwriting the previous one. */
+extern unsigned long ulTimerhostUARTOverruns;
+
+/** Number of octets moved by the DMA controller model */
+extern unsigned long ulTimerhostDMATransfers;
+
+/** The address from which DMA channel @p channel will read its next
+ * octet, or a null pointer if the channel is not enabled.  DMAxSA
+ * holds the start of the block throughout; the remaining DMAxSZ
+ * octets of a transfer in flight begin here. */
+const volatile uint8_t * xTimerhostDMASource (unsigned int channel);
+
+/** Ticks elapsed on the virtual clock since vTimerhostInitialize(). */
+unsigned long long ullTimerhostNow (void);
+
+/** Begin single-stepping the caller.  From here until
+ * vTimerhostStepEnd() every #uiTimerhostStepsPerTick instructions
+ * executed advance the virtual clock by one tick, and enabled interrupts that become due are taken
+ * at the next instruction boundary, so races between the code and
+ * the timer (such as a counter wrapping between two reads) occur at
+ * every point where the hardware could produce them.  Service
+ * routines taken while stepping are stepped too only if
+ * #iTimerhostStepISRs is set, and stepping pauses while the code
+ * under test is in a low power mode.
+ * The harness must not call into the simulator while stepping.
+ *
+ * Returns zero, or -1 if the host does not support stepping (only
+ * x86-64 Linux does). */
+int iTimerhostStepBegin (void);
+
+/** Stop single-stepping.  The instructions up to the one following
+ * this call are still stepped. */
+void vTimerhostStepEnd (void);
+
+/** Number of instructions single-stepped so far. */
+extern unsigned long ulTimerhostSteps;
+
+/** Number of stepped instructions per tick of the virtual clock.
+ * Defaults to one.  Timers are usually clocked well below the CPU;
+ * code that must finish within a few ticks, such as the window
+ * allowed by #BSP430_TIMER_ALARM_FUTURE_LIMIT, is only exercised
+ * faithfully with a realistic ratio. */
+extern unsigned int uiTimerhostStepsPerTick;
+
+/** Nonzero to single-step interrupt service routines, at
+ * #uiTimerhostStepsPerTick instructions per tick.  Defaults to zero.
+ * Needed by service routines that wait for the hardware, as the I2C
+ * queue does for stop conditions, where others would spin forever on
+ * a clock that does not move, and by those that produce a trigger
+ * edge by clearing and setting a flag, as the console does to start a
+ * DMA transfer. */
+extern int iTimerhostStepISRs;
+
+/** Number of interrupt service routine invocations so far. */
+extern unsigned long ulTimerhostISRCount;
+
+/** Virtual time charged for each interrupt service routine
+ * invocation, in ticks.  Defaults to one.  Must be nonzero: code that
+ * re-arms an interrupt until the counter moves on would otherwise
+ * never finish. */
+extern unsigned int uiTimerhostISRTicks;
+
+/** Virtual time that passes, with interrupts enabled, between a
+ * service routine asking to leave low power mode and the code that
+ * slept resuming, in ticks.  Defaults to zero.  Models the wakeup
+ * latency and the work the woken code does before it acts, during
+ * which a peripheral it was to feed may run dry. */
+extern unsigned int uiTimerhostWakeTicks;
+
+/** Number of checks that have failed, counted by CHECK() and
+ * iTimerhostCheckFailed(). */
+extern unsigned long ulTimerhostFailures;
+
+/** Count a failed check.  Returns nonzero if the failure should be
+ * described: only the first few are, so one fault repeated through a
+ * long run does not bury the rest of the output. */
+int iTimerhostCheckFailed (void);
+
+/** Count a failure, and describe it with its location, if @p expr_
+ * is false. */
+#define CHECK(expr_) do {                                               \
+    if ((! (expr_)) && iTimerhostCheckFailed()) {                       \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr_); \
+    }                                                                   \
+  } while (0)
+
+/** Report the number of failed checks, if any.  Returns the exit
+ * status for the test: 1 if a check failed, otherwise 0. */
+int iTimerhostCheckResult (void);
+
+#endif /* TIMERHOST_H */
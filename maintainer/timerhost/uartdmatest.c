@@ -0,0 +1,359 @@
+/* Test of UART reception through double-buffered DMA
+ * (utility/uartrxdma) on the simulated eUSCI_A0 and DMA controller.
+ *
+ * The simulated line carries a known sequence of octets at 115200
+ * baud in bursts of random length, resembling the output of a GPS
+ * receiver: within a burst octets mostly follow each other directly,
+ * sometimes with a pause shorter than the idle period; between bursts
+ * the line is silent, sometimes briefly and sometimes for longer than
+ * the idle delivery bound.  The UART first receives one octet per
+ * interrupt through its receive callback chain, then through DMA
+ * with iBSP430uartRxDMAReplay_ni() feeding the same chain, then
+ * through DMA with a consumer that takes the data in bulk while the
+ * service time of each interrupt varies up to several character
+ * times.  The line pauses between modes, leaving an octet waiting in
+ * RXBUF or in the DMA buffer, and the receiver is started
+ * single-stepped so the model sees each register write.  The test
+ * checks that:
+ *
+ * @li every octet is delivered exactly once, in order, across all
+ * three modes, and none is lost to an overrun;
+ * @li bulk deliveries start where the previous one ended and never
+ * span the two halves of the buffer, and half and full events end at
+ * the end of their half;
+ * @li idle deliveries come at least one and at most two idle periods
+ * (plus interrupt service time) after the last octet, and include
+ * every octet received;
+ * @li every octet received before a silence longer than that bound
+ * has been delivered by the time the next one arrives;
+ * @li stopping the receiver flushes what remains and restores the
+ * receive interrupt only when a receive callback chain is installed;
+ * @li DMA reception takes well under half the interrupts of
+ * per-octet reception for the same traffic.
+ *
+ * Usage: uartdmatest [octets]   (default 100000) */
+
+#include <bsp430/platform.h>
+#include <bsp430/serial.h>
+#include <bsp430/utility/uartrxdma.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "timerhost.h"
+
+/* One character time at 115200 baud on the simulated 1 MHz SMCLK */
+#define OCTET_TCK 87
+#define IDLE_TCK (10 * OCTET_TCK)
+#define HALF_LEN 64
+#define MAX_ISR_TCK (4 * OCTET_TCK)
+
+/* Bound on ticks from the last octet of a burst to its idle
+ * delivery */
+#define DELIVERY_TCK (2 * IDLE_TCK + 4 * MAX_ISR_TCK)
+
+/* Silence while the receiver changes modes; longer than any stepped
+ * start takes. */
+#define PAUSE_TCK 100000UL
+
+/* Octets received in each of the first two modes */
+#define PHASE_OCTETS 4000
+
+/* Length of the unbroken run of octets that ends the line */
+#define FINAL_RUN 32
+
+static hBSP430halSERIAL uart;
+static sBSP430uartRxDMA rxd;
+static uint8_t buffer[2 * HALF_LEN];
+static sBSP430halISRVoidChainNode rx_node;
+static unsigned long received;
+static unsigned long delivered;
+static unsigned long stream_base;
+static unsigned long target;
+static unsigned long burst_left;
+static unsigned long long last_arrival_tck;
+static int line_started;
+static int pause_requested;
+static int paused;
+static unsigned long events[1 + BSP430_UARTRXDMA_EVENT_FLUSH];
+
+static unsigned long rng_state = 1;
+
+static unsigned long
+rng (void)
+{
+  rng_state = rng_state * 1103515245UL + 12345UL;
+  return (rng_state >> 16) & 0x7FFF;
+}
+
+/* The octet at position k of the line */
+static uint8_t
+expected (unsigned long k)
+{
+  return 0xFF & (k * 7 + (k >> 7));
+}
+
+static unsigned long
+line (uint8_t * octetp)
+{
+  unsigned long long now = ullTimerhostNow();
+
+  if (line_started) {
+    if ((now - last_arrival_tck) > DELIVERY_TCK) {
+      CHECK(delivered == received);
+    }
+    ++received;
+    last_arrival_tck = now;
+  } else {
+    line_started = 1;
+  }
+  if (received >= target) {
+    return 0;
+  }
+  *octetp = expected(received);
+  if ((received + FINAL_RUN) >= target) {
+    return OCTET_TCK;
+  }
+  if (pause_requested && (! paused)) {
+    paused = 1;
+    return PAUSE_TCK;
+  }
+  if (0 < burst_left) {
+    --burst_left;
+    if (0 == (rng() % 8)) {
+      return OCTET_TCK + (rng() % (2 * OCTET_TCK));
+    }
+    return OCTET_TCK;
+  }
+  burst_left = rng() % (3 * HALF_LEN);
+  if (0 == (rng() % 4)) {
+    return OCTET_TCK + (rng() % IDLE_TCK);
+  }
+  return OCTET_TCK + DELIVERY_TCK + (rng() % (4 * DELIVERY_TCK));
+}
+
+static void
+consumeOctets (const uint8_t * data,
+               unsigned int len)
+{
+  while (0 < len--) {
+    CHECK(expected(delivered) == *data++);
+    ++delivered;
+  }
+  CHECK(delivered <= received);
+}
+
+static int
+rx_cb (const struct sBSP430halISRVoidChainNode * cb,
+       void * context)
+{
+  hBSP430halSERIAL hal = (hBSP430halSERIAL)context;
+
+  CHECK(uart == hal);
+  consumeOctets(&hal->rx_byte, 1);
+  return 0;
+}
+
+static int
+consume (sBSP430uartRxDMA * rp,
+         const uint8_t * data,
+         unsigned int len,
+         int event)
+{
+  unsigned long long since = ullTimerhostNow() - last_arrival_tck;
+  unsigned long offset = data - rp->buffer;
+
+  CHECK(&rxd == rp);
+  CHECK(0 < len);
+  CHECK((data >= rp->buffer) && (offset < (2 * HALF_LEN)));
+  CHECK(offset == ((delivered - stream_base) % (2 * HALF_LEN)));
+  CHECK((offset / HALF_LEN) == ((offset + len - 1) / HALF_LEN));
+  switch (event) {
+    case BSP430_UARTRXDMA_EVENT_HALF:
+      CHECK(HALF_LEN == (offset + len));
+      break;
+    case BSP430_UARTRXDMA_EVENT_FULL:
+      CHECK((2 * HALF_LEN) == (offset + len));
+      break;
+    case BSP430_UARTRXDMA_EVENT_IDLE:
+      CHECK(since >= IDLE_TCK);
+      CHECK(since <= DELIVERY_TCK);
+      CHECK(received == (delivered + len));
+      break;
+    case BSP430_UARTRXDMA_EVENT_FLUSH:
+      break;
+    default:
+      CHECK(0);
+      return 0;
+  }
+  ++events[event];
+  consumeOctets(data, len);
+  return 0;
+}
+
+static void
+runUntil (unsigned long octets)
+{
+  while ((received < octets) && (received < target)) {
+    vTimerhostAdvance(OCTET_TCK);
+  }
+}
+
+/* Hold off the line after the next octet arrives, with interrupts
+ * disabled so it is not taken from the UART. */
+static void
+pauseLine (void)
+{
+  BSP430_CORE_DISABLE_INTERRUPT();
+  pause_requested = 1;
+  paused = 0;
+  while (! paused) {
+    vTimerhostAdvance(OCTET_TCK);
+  }
+}
+
+static void
+resumeLine (void)
+{
+  pause_requested = 0;
+  BSP430_CORE_ENABLE_INTERRUPT();
+  /* Wait out the pause */
+  runUntil(received + 1);
+}
+
+static void
+startDMA (iBSP430uartRxDMACallback_ni callback)
+{
+  int rc;
+
+  rxd.uart = uart;
+  rxd.dma_channel = 1;
+  rxd.dma_trigger = DMA0TSEL__UCA0RXIFG;
+  rxd.buffer = buffer;
+  rxd.half_len = HALF_LEN;
+  rxd.callback_ni = callback;
+  rxd.idle_timer = BSP430_PERIPH_TA1;
+  rxd.idle_ccidx = 1;
+  rxd.idle_tck = IDLE_TCK;
+  stream_base = delivered;
+  (void)iTimerhostStepBegin();
+  rc = iBSP430uartRxDMAStart_ni(&rxd);
+  vTimerhostStepEnd();
+  CHECK(0 == rc);
+  CHECK(! (UCRXIE & BSP430_HPL_EUSCI_A0->ie));
+}
+
+int
+main (int argc,
+      char * argv[])
+{
+  unsigned long octets = (1 < argc) ? strtoul(argv[1], NULL, 0) : 100000;
+  unsigned long isr0;
+  unsigned long rx0;
+  unsigned long per_octet_isrs;
+  unsigned long per_octet_octets;
+  unsigned long dma_isrs;
+  unsigned long dma_octets;
+  unsigned long first_dma;
+  int rc;
+
+  vTimerhostInitialize();
+  if (0 != iTimerhostStepBegin()) {
+    printf("single-stepping unsupported, test skipped\n");
+    return 0;
+  }
+  vTimerhostStepEnd();
+  target = 2 * PHASE_OCTETS + octets;
+  vTimerhostUARTInitialize(line);
+  BSP430_HPL_TA1->ctl = TASSEL_2 | MC_2 | TAIE;
+
+  uart = hBSP430serialOpenUART(hBSP430serialLookup(BSP430_PERIPH_EUSCI_A0), 0, UCSSEL__SMCLK, 115200);
+  CHECK(NULL != uart);
+  if (NULL == uart) {
+    return 1;
+  }
+  (void)iBSP430serialSetHold_rh(uart, 1);
+  rx_node.callback_ni = rx_cb;
+  BSP430_HAL_ISR_CALLBACK_LINK_NI(sBSP430halISRVoidChainNode, uart->rx_cbchain_ni, rx_node, next_ni);
+  (void)iBSP430serialSetHold_rh(uart, 0);
+  CHECK(UCRXIE & BSP430_HPL_EUSCI_A0->ie);
+
+  /* One interrupt per octet */
+  BSP430_CORE_ENABLE_INTERRUPT();
+  runUntil(1);
+  isr0 = ulTimerhostISRCount;
+  rx0 = received;
+  runUntil(PHASE_OCTETS);
+  per_octet_isrs = ulTimerhostISRCount - isr0;
+  per_octet_octets = received - rx0;
+
+  /* DMA feeding the same chain; the octet that arrives as the line
+   * pauses is left in RXBUF for the receiver to pick up. */
+  pauseLine();
+  CHECK(UCRXIFG & BSP430_HPL_EUSCI_A0->ifg);
+  first_dma = delivered;
+  startDMA(iBSP430uartRxDMAReplay_ni);
+  resumeLine();
+  isr0 = ulTimerhostISRCount;
+  rx0 = received;
+  runUntil(2 * PHASE_OCTETS);
+  dma_isrs = ulTimerhostISRCount - isr0;
+  dma_octets = received - rx0;
+
+  /* Stopping flushes through the chain and restores the receive
+   * interrupt. */
+  pauseLine();
+  rc = iBSP430uartRxDMAStop_ni(&rxd);
+  CHECK(0 == rc);
+  CHECK(delivered == received);
+  CHECK(UCRXIE & BSP430_HPL_EUSCI_A0->ie);
+  BSP430_HAL_ISR_CALLBACK_UNLINK_NI(sBSP430halISRVoidChainNode, uart->rx_cbchain_ni, rx_node, next_ni);
+
+  /* Bulk consumer, with interrupt service times that vary up to
+   * several character times and occasional explicit flushes.  Some
+   * flushes are made after interrupts have been held off for a
+   * while, so the channel may have completed a half whose interrupt
+   * is still pending.  The line ends at the end of the second half of
+   * the buffer. */
+  startDMA(consume);
+  target = stream_base + (2 * HALF_LEN) * ((octets + (2 * HALF_LEN) - 1) / (2 * HALF_LEN));
+  resumeLine();
+  while ((received + FINAL_RUN / 2) < target) {
+    uiTimerhostISRTicks = (0 == (rng() % 4)) ? (1 + (rng() % MAX_ISR_TCK)) : 1;
+    vTimerhostAdvance(1 + (rng() % (4 * OCTET_TCK)));
+    if (0 == (rng() % 16)) {
+      BSP430_CORE_DISABLE_INTERRUPT();
+      vTimerhostAdvance(rng() % MAX_ISR_TCK);
+      CHECK(0 == iBSP430uartRxDMAFlush_ni(&rxd));
+      BSP430_CORE_ENABLE_INTERRUPT();
+    }
+  }
+  uiTimerhostISRTicks = 1;
+
+  /* Stop as the last octet arrives, with the completion of the
+   * second half not yet serviced. */
+  BSP430_CORE_DISABLE_INTERRUPT();
+  runUntil(target);
+  CHECK(DMAIFG & BSP430_HPL_DMA->ch[rxd.dma_channel].ctl);
+  rc = iBSP430uartRxDMAStop_ni(&rxd);
+  CHECK(0 == rc);
+  CHECK(target == received);
+  CHECK(delivered == received);
+  CHECK(! (UCRXIE & BSP430_HPL_EUSCI_A0->ie));
+  CHECK(rxd.octets == (delivered - first_dma));
+
+  CHECK(0 != events[BSP430_UARTRXDMA_EVENT_HALF]);
+  CHECK(0 != events[BSP430_UARTRXDMA_EVENT_FULL]);
+  CHECK(0 != events[BSP430_UARTRXDMA_EVENT_IDLE]);
+  CHECK(0 != events[BSP430_UARTRXDMA_EVENT_FLUSH]);
+  CHECK(0 == ulTimerhostUARTOverruns);
+  CHECK(! (UCOE & BSP430_HPL_EUSCI_A0->statw));
+  CHECK(target == ulTimerhostUARTOctets);
+  CHECK((2 * dma_isrs * per_octet_octets) < (per_octet_isrs * dma_octets));
+
+  printf("%lu octets, %lu DMA transfers\n", received, ulTimerhostDMATransfers);
+  printf("per-octet interrupts: %lu ISRs for %lu octets\n", per_octet_isrs, per_octet_octets);
+  printf("DMA with idle alarm: %lu ISRs for %lu octets\n", dma_isrs, dma_octets);
+  printf("bulk deliveries: %lu half, %lu full, %lu idle, %lu flush\n",
+         events[BSP430_UARTRXDMA_EVENT_HALF], events[BSP430_UARTRXDMA_EVENT_FULL],
+         events[BSP430_UARTRXDMA_EVENT_IDLE], events[BSP430_UARTRXDMA_EVENT_FLUSH]);
+  return iTimerhostCheckResult();
+}
@@ -0,0 +1,411 @@
+/* Host model of the eUSCI_A0 peripheral as a UART, and of the DMA
+ * controller, used by maintainer/timerhost.
+ *
+ * The receive line is driven by a source function the harness
+ * provides, which gives each octet and the ticks until it has been
+ * received.  A received octet is placed in RXBUF and sets UCRXIFG,
+ * and UCOE too if UCRXIFG was still set.  Octets that complete while
+ * UCSWRST is set are lost.
+ *
+ * Transmission is double-buffered as on the target.  A write to TXBUF
+ * clears UCTXIFG; the octet moves to the shift register as soon as it
+ * is idle, which sets UCTXIFG again, and takes
+ * #uiTimerhostUARTTxTicks to shift out, after which it is passed to
+ * the sink function the harness provides.  UCBUSY is set while an
+ * octet is in TXBUF or being shifted.  Setting UCSWRST discards both
+ * and sets UCTXIFG.
+ *
+ * A DMA channel loads its working source and destination addresses
+ * and its transfer count from the registers when the model first
+ * sees DMAEN set.  Each trigger moves one byte and decrements DMAxSZ;
+ * when it reaches zero DMAIFG is set and the channel either stops
+ * (single transfer) or reloads its working addresses from the
+ * registers and DMAxSZ from its initial value (repeated single
+ * transfer).  Only byte-to-byte single transfers are modelled, and
+ * the only triggers are rising edges of the eUSCI_A0 UCRXIFG and
+ * UCTXIFG.  A transfer whose source is RXBUF clears UCRXIFG, and one
+ * whose destination is TXBUF is a write to TXBUF.  DMAIV reports and
+ * clears the lowest-numbered channel with DMAIE and DMAIFG set.
+ *
+ * As with serialsim.c the models notice register writes only when
+ * the simulator runs.  Code that enables a channel and then changes
+ * its address registers, or that clears and sets UCRXIFG or UCTXIFG
+ * to produce a trigger edge, must be single-stepped for the model to
+ * see each write as the hardware would, as must code that polls
+ * UCTXIFG or UCBUSY.  The UART receive and transmit interrupts are
+ * supported; reading UCA0IV clears the flag it reports, but reading
+ * RXBUF does not. */
+
+#include <bsp430/platform.h>
+#include <bsp430/serial.h>
+#include <bsp430/periph/dma.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "timerhost.h"
+
+void isr_EUSCI_A0 (void);
+void isr_DMA (void);
+
+/* TXBUF contents meaning nothing has been written since the last
+ * octet was moved out; outside the range of any register value. */
+#define TXBUF_EMPTY 0xFFFF0000U
+
+/* Working registers of a DMA channel */
+typedef struct sChannel {
+  int enabled;
+  uintptr_t sa;
+  uintptr_t da;
+  unsigned int sz;
+} sChannel;
+
+static sChannel channels_[BSP430_DMA_NUM_CHANNELS];
+static ulTimerhostUARTSource source_;
+static unsigned long remaining_;
+static uint8_t octet_;
+static int rxifg_seen_;
+static vTimerhostUARTSink sink_;
+static int tx_shifting_;
+static unsigned long tx_remaining_;
+static uint8_t tx_octet_;
+static int txifg_seen_;
+unsigned int uiTimerhostUARTTxTicks = 87;
+unsigned long ulTimerhostUARTOctets;
+unsigned long ulTimerhostUARTTxOctets;
+unsigned long ulTimerhostUARTOverruns;
+unsigned long ulTimerhostDMATransfers;
+
+static volatile sBSP430hplEUSCIA *
+uart (void)
+{
+  return BSP430_HPL_EUSCI_A0;
+}
+
+static volatile sBSP430hplDMA *
+dma (void)
+{
+  return BSP430_HPL_DMA;
+}
+
+static unsigned int
+triggerSelect (unsigned int c)
+{
+  return 0x1F & ((&dma()->ctl0)[c / 2] >> (8 * (c & 1)));
+}
+
+/* Notice channels that the code under test has enabled or
+ * disabled. */
+static void
+dmaSync (void)
+{
+  unsigned int c;
+
+  for (c = 0; c < BSP430_DMA_NUM_CHANNELS; ++c) {
+    volatile sBSP430hplDMAchannel * chp = dma()->ch + c;
+    sChannel * sp = channels_ + c;
+    unsigned int ctl = chp->ctl;
+    unsigned int dt = ctl & (DMADT2 | DMADT1 | DMADT0);
+
+    if (! (ctl & DMAEN)) {
+      sp->enabled = 0;
+      continue;
+    }
+    if (sp->enabled) {
+      continue;
+    }
+    if ((ctl & (DMAREQ | DMALEVEL))
+        || ((DMADT_0 != dt) && (DMADT_4 != dt))
+        || ((DMADSTBYTE | DMASRCBYTE) != (ctl & (DMADSTBYTE | DMASRCBYTE)))) {
+      fprintf(stderr, "timerhost: DMA channel %u configuration %#x not modelled\n", c, ctl);
+      abort();
+    }
+    sp->enabled = 1;
+    sp->sa = chp->sa;
+    sp->da = chp->da;
+    sp->sz = chp->sz;
+  }
+}
+
+static uintptr_t
+stepAddress (uintptr_t addr,
+             unsigned int incr)
+{
+  if (3 == incr) {
+    return addr + 1;
+  }
+  if (2 == incr) {
+    return addr - 1;
+  }
+  return addr;
+}
+
+/* Move one byte on every enabled channel selecting @p tsel.  Returns
+ * nonzero if any of them read RXBUF. */
+static int
+dmaTrigger (unsigned int tsel)
+{
+  unsigned int c;
+  int read_rxbuf = 0;
+
+  for (c = 0; c < BSP430_DMA_NUM_CHANNELS; ++c) {
+    volatile sBSP430hplDMAchannel * chp = dma()->ch + c;
+    sChannel * sp = channels_ + c;
+    unsigned int ctl = chp->ctl;
+
+    if ((! sp->enabled) || (tsel != triggerSelect(c))) {
+      continue;
+    }
+    if (sp->sa == (uintptr_t)&uart()->rxbuf) {
+      read_rxbuf = 1;
+    }
+    if (sp->da == (uintptr_t)&uart()->txbuf) {
+      /* A byte store would leave the rest of TXBUF_EMPTY behind */
+      uart()->txbuf = *(volatile uint8_t *)sp->sa;
+    } else {
+      *(volatile uint8_t *)sp->da = *(volatile uint8_t *)sp->sa;
+    }
+    ++ulTimerhostDMATransfers;
+    sp->sa = stepAddress(sp->sa, (ctl >> 8) & 3);
+    sp->da = stepAddress(sp->da, (ctl >> 10) & 3);
+    if (0 != --chp->sz) {
+      continue;
+    }
+    chp->ctl |= DMAIFG;
+    chp->sz = sp->sz;
+    if (ctl & DMADT2) {
+      sp->sa = chp->sa;
+      sp->da = chp->da;
+    } else {
+      chp->ctl &= ~DMAEN;
+      sp->enabled = 0;
+    }
+  }
+  return read_rxbuf;
+}
+
+/* Trigger the channels on a rising edge of UCRXIFG. */
+static void
+rxifgEdge (void)
+{
+  volatile sBSP430hplEUSCIA * h = uart();
+  int rxifg = !! (h->ifg & UCRXIFG);
+
+  if (rxifg && (! rxifg_seen_) && dmaTrigger(DMA0TSEL__UCA0RXIFG)) {
+    h->ifg &= ~UCRXIFG;
+    rxifg = 0;
+  }
+  rxifg_seen_ = rxifg;
+}
+
+/* Move a written octet into the shift register if it is idle,
+ * following UCTXIFG and triggering the channels on its rising edge.
+ * A transfer may write TXBUF again, so repeat until nothing
+ * changes. */
+static void
+txSync (void)
+{
+  volatile sBSP430hplEUSCIA * h = uart();
+
+  if (h->ctlw0 & UCSWRST) {
+    tx_shifting_ = 0;
+    h->txbuf = TXBUF_EMPTY;
+    h->ifg |= UCTXIFG;
+    h->statw &= ~UCBUSY;
+    txifg_seen_ = 1;
+    return;
+  }
+  while (1) {
+    int txifg;
+
+    if (TXBUF_EMPTY != h->txbuf) {
+      h->ifg &= ~UCTXIFG;
+      txifg_seen_ = 0;
+      if (! tx_shifting_) {
+        tx_octet_ = h->txbuf & 0xFF;
+        h->txbuf = TXBUF_EMPTY;
+        tx_remaining_ = uiTimerhostUARTTxTicks;
+        tx_shifting_ = 1;
+        h->ifg |= UCTXIFG;
+      }
+    }
+    if (tx_shifting_ || (TXBUF_EMPTY != h->txbuf)) {
+      h->statw |= UCBUSY;
+    } else {
+      h->statw &= ~UCBUSY;
+    }
+    txifg = !! (h->ifg & UCTXIFG);
+    if ((! txifg) || txifg_seen_) {
+      txifg_seen_ = txifg;
+      return;
+    }
+    txifg_seen_ = 1;
+    (void)dmaTrigger(DMA0TSEL__UCA0TXIFG);
+  }
+}
+
+static void
+sync (void)
+{
+  dmaSync();
+  rxifgEdge();
+  txSync();
+}
+
+static unsigned long
+uartTicksToEvent (void)
+{
+  sync();
+  if (tx_shifting_ && ((0 == remaining_) || (tx_remaining_ < remaining_))) {
+    return tx_remaining_;
+  }
+  return remaining_;
+}
+
+/* Let ticks pass on the transmitter */
+static void
+txElapse (unsigned long ticks)
+{
+  if (! tx_shifting_) {
+    return;
+  }
+  tx_remaining_ -= ticks;
+  if (0 != tx_remaining_) {
+    return;
+  }
+  tx_shifting_ = 0;
+  ++ulTimerhostUARTTxOctets;
+  if (NULL != sink_) {
+    sink_(tx_octet_);
+  }
+  /* The next octet follows immediately if one is waiting */
+  txSync();
+}
+
+static void
+uartElapse (unsigned long ticks)
+{
+  volatile sBSP430hplEUSCIA * h = uart();
+
+  sync();
+  txElapse(ticks);
+  if (0 == remaining_) {
+    return;
+  }
+  remaining_ -= ticks;
+  if (0 != remaining_) {
+    return;
+  }
+  if (! (h->ctlw0 & UCSWRST)) {
+    ++ulTimerhostUARTOctets;
+    if (h->ifg & UCRXIFG) {
+      ++ulTimerhostUARTOverruns;
+      h->statw |= UCOE;
+    }
+    h->rxbuf = octet_;
+    h->ifg |= UCRXIFG;
+    rxifgEdge();
+  }
+  remaining_ = source_(&octet_);
+}
+
+static void
+(* uartPendingISR (void)) (void)
+{
+  volatile sBSP430hplEUSCIA * h = uart();
+  unsigned int c;
+
+  sync();
+  for (c = 0; c < BSP430_DMA_NUM_CHANNELS; ++c) {
+    if ((DMAIE | DMAIFG) == (dma()->ch[c].ctl & (DMAIE | DMAIFG))) {
+      return isr_DMA;
+    }
+  }
+  if (h->ie & h->ifg & UCRXIE) {
+    h->iv = USCI_UART_UCRXIFG;
+    h->ifg &= ~UCRXIFG;
+    rxifg_seen_ = 0;
+    return isr_EUSCI_A0;
+  }
+  if (h->ie & h->ifg & UCTXIE) {
+    h->iv = USCI_UART_UCTXIFG;
+    h->ifg &= ~UCTXIFG;
+    txifg_seen_ = 0;
+    return isr_EUSCI_A0;
+  }
+  h->iv = USCI_NONE;
+  return NULL;
+}
+
+unsigned int
+uiTimerhostReadDMAIV (void)
+{
+  unsigned int c;
+
+  for (c = 0; c < BSP430_DMA_NUM_CHANNELS; ++c) {
+    volatile sBSP430hplDMAchannel * chp = dma()->ch + c;
+
+    if ((DMAIE | DMAIFG) == (chp->ctl & (DMAIE | DMAIFG))) {
+      chp->ctl &= ~DMAIFG;
+      return 2 * (c + 1);
+    }
+  }
+  return 0;
+}
+
+static sTimerhostDevice uart_device_ = {
+  .ticksToEvent = uartTicksToEvent,
+  .elapse = uartElapse,
+  .pendingISR = uartPendingISR,
+};
+
+void
+vTimerhostUARTInitialize (ulTimerhostUARTSource source)
+{
+  unsigned int c;
+
+  if ((__MSP430_BASEADDRESS_EUSCI_A0__ < (uintptr_t)(dma()->ch + BSP430_DMA_NUM_CHANNELS))
+      || (__MSP430_BASEADDRESS_EUSCI_B0__ < (uintptr_t)(uart() + 1))) {
+    fprintf(stderr, "timerhost: eUSCI_A0 and DMA register blocks overlap\n");
+    abort();
+  }
+  for (c = 0; c < BSP430_DMA_NUM_CHANNELS; ++c) {
+    channels_[c].enabled = 0;
+  }
+  source_ = source;
+  sink_ = NULL;
+  rxifg_seen_ = 0;
+  tx_shifting_ = 0;
+  txifg_seen_ = 1;
+  ulTimerhostUARTOctets = 0;
+  ulTimerhostUARTTxOctets = 0;
+  ulTimerhostUARTOverruns = 0;
+  ulTimerhostDMATransfers = 0;
+  uart()->ctlw0 = UCSWRST;
+  uart()->ifg = UCTXIFG;
+  uart()->txbuf = TXBUF_EMPTY;
+  remaining_ = source_(&octet_);
+  vTimerhostAddDevice(&uart_device_);
+}
+
+void
+vTimerhostUARTSetSink (vTimerhostUARTSink sink)
+{
+  sink_ = sink;
+}
+
+void
+vTimerhostUARTResume (void)
+{
+  if (0 == remaining_) {
+    remaining_ = source_(&octet_);
+  }
+}
+
+const volatile uint8_t *
+xTimerhostDMASource (unsigned int channel)
+{
+  dmaSync();
+  if ((BSP430_DMA_NUM_CHANNELS <= channel) || (! channels_[channel].enabled)) {
+    return NULL;
+  }
+  return (const volatile uint8_t *)channels_[channel].sa;
+}
@@ -52,6 +52,7 @@ sBSP430halDMA xBSP430hal_DMA_ = {
 };
 
 #if (configBSP430_HAL_DMA_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(DMA)
 BSP430_CORE_DECLARE_INTERRUPT(DMA_VECTOR)
 isr_DMA (void)
 {
@@ -59,6 +60,7 @@ isr_DMA (void)
   unsigned int iv = DMAIV;
   int rv = 0;
 
+  BSP430_ISRSTATS_ENTER_NI(DMA);
   if (0 != iv) {
     int ch = (iv - 2) / 2;
     rv = iBSP430callbackInvokeISRIndexed_ni(ch + dma->ch_cbchain_ni, dma, ch, rv);
@@ -67,6 +69,7 @@ isr_DMA (void)
       dma->hpl->ch[ch].ctl &= ~DMAIE;
     }
   }
+  BSP430_ISRSTATS_EXIT_NI(DMA);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_DMA_ISR */
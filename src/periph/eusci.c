@@ -412,6 +412,27 @@ iBSP430eusciSPITxRx_rh (hBSP430halSERIAL hal,
   if (hal->tx_cbchain_ni) {
     return -1;
   }
+  if (NULL == rx_data) {
+    /* Nothing to keep: load TXBUF as soon as it empties, and discard
+     * the received data once the last octet has been shifted out. */
+    while (i < transaction_length) {
+      while (! (UCTXIFG & *ifgp)) {
+        ;
+      }
+      *txbp = (i < tx_len) ? tx_data[i] : BSP430_SERIAL_SPI_READ_TX_BYTE(i-tx_len);
+      ++i;
+    }
+    /* UCBUSY may not yet be set for an octet still in TXBUF */
+    while (! (UCTXIFG & *ifgp)) {
+      ;
+    }
+    SERIAL_HAL_FLUSH_NI(hal);
+    /* Clears UCRXIFG and UCOE */
+    (void)*rxbp;
+    hal->num_tx += i;
+    hal->num_rx += i;
+    return i;
+  }
   while (i < transaction_length) {
     uint8_t rx_dummy;
 
@@ -592,6 +613,184 @@ iBSP430eusciI2CtxData_rh (hBSP430halSERIAL hal,
   return i;
 }
 
+#if (configBSP430_SERIAL_ENABLE_I2C - 0)
+
+/* Events that drive a queued transaction */
+#define I2C_QUEUE_IE (UCNACKIE | UCALIE | UCRXIE | UCTXIE)
+#define I2C_QUEUE_IFG (UCNACKIFG | UCALIFG | UCRXIFG | UCTXIFG)
+
+/* sBSP430i2cQueue::state_ni bits: the head is in its read segment;
+ * a stop has been requested for it. */
+#define I2C_QUEUE_STATE_RX 0x01
+#define I2C_QUEUE_STATE_STOP 0x02
+
+static int
+i2cQueueAwaitStart_ni (volatile struct sBSP430hplEUSCIB * hpl)
+{
+  I2C_ERRCHECK_SPIN_WHILE_COND(hpl->ctlw0 & UCTXSTT);
+  return 0;
+}
+
+/* Unlike i2cQueueAwaitStart_ni() this keeps waiting after a NACK,
+ * since the stop that follows one must still be generated. */
+static int
+i2cQueueAwaitStop_ni (volatile struct sBSP430hplEUSCIB * hpl)
+{
+  unsigned int limit = (unsigned int)BSP430_I2C_SPIN_LIMIT;
+
+  while (hpl->ctlw0 & UCTXSTP) {
+    if ((0 < BSP430_I2C_SPIN_LIMIT) && (0 == --limit)) {
+      return -BSP430_I2C_ERRFLAG_SPINLIMIT;
+    }
+  }
+  return 0;
+}
+
+/* Issue a start (or repeated start) for the read segment of the
+ * head transaction.  The stop for a single-octet read must be
+ * requested while that octet is being received, which begins when the
+ * slave acknowledges its address: wait for that here.  A NACK or
+ * arbitration loss during the wait is left for the interrupt
+ * handler. */
+static void
+i2cQueueBeginRead_ni (hBSP430i2cQueue queue,
+                      volatile struct sBSP430hplEUSCIB * hpl)
+{
+  queue->state_ni = I2C_QUEUE_STATE_RX;
+  queue->index_ni = 0;
+  hpl->ctlw0 = (hpl->ctlw0 & ~UCTR) | UCTXSTT;
+  if (1 == queue->head_ni->rx_len) {
+    int rc = i2cQueueAwaitStart_ni(hpl);
+
+    /* The flags are read before UCTXSTT, so look again: a rejected
+     * address clears UCTXSTT too. */
+    if ((0 == rc) && (hpl->ifg & (UCNACKIFG | UCALIFG))) {
+      rc = -BSP430_I2C_ERRFLAG_PROTOCOL;
+    }
+    if ((0 == rc) || (-BSP430_I2C_ERRFLAG_SPINLIMIT == rc)) {
+      hpl->ctlw0 |= UCTXSTP;
+      queue->state_ni |= I2C_QUEUE_STATE_STOP;
+    }
+  }
+}
+
+static void
+eusciI2CQueueStart_ni (hBSP430i2cQueue queue)
+{
+  hBSP430halSERIAL hal = queue->hal;
+  volatile struct sBSP430hplEUSCIB * hpl = SERIAL_HAL_HPL_B(hal);
+  hBSP430i2cTransaction xfer = queue->head_ni;
+
+  /* The queue generates its own stop conditions */
+  i2cSetAutoStop_ni(hal, 0);
+  hpl->i2csa = xfer->address;
+  hpl->ifg &= ~I2C_QUEUE_IFG;
+  hpl->ie |= I2C_QUEUE_IE;
+  if (0 < xfer->tx_len) {
+    queue->state_ni = 0;
+    queue->index_ni = 0;
+    hpl->ctlw0 |= UCTR | UCTXSTT;
+  } else {
+    i2cQueueBeginRead_ni(queue, hpl);
+  }
+}
+
+/* Generate the stop if one has not been requested, wait for it to
+ * finish so the next start cannot overlap it, and pass the outcome to
+ * the queue.  A failed transaction leaves the peripheral in an
+ * unknown state, possibly as a slave following arbitration loss; a
+ * reset cycle discards anything left in the buffers and restores
+ * master mode. */
+static int
+i2cQueueFinish_ni (hBSP430i2cQueue queue,
+                   volatile struct sBSP430hplEUSCIB * hpl,
+                   int rc)
+{
+  if (! (I2C_QUEUE_STATE_STOP & queue->state_ni)) {
+    hpl->ctlw0 |= UCTXSTP;
+  }
+  /* Only a master generates a stop */
+  if ((hpl->ctlw0 & UCMST) && (0 != i2cQueueAwaitStop_ni(hpl))) {
+    rc = -BSP430_I2C_ERRFLAG_SPINLIMIT;
+  } else if ((0 == rc) && (hpl->ifg & UCNACKIFG)) {
+    /* Slave rejected the last octet written */
+    rc = -(BSP430_I2C_ERRFLAG_PROTOCOL | UCNACKIFG);
+  }
+  if (0 > rc) {
+    hpl->ctlw0 |= UCSWRST;
+    hpl->ctlw0 = (hpl->ctlw0 & ~(UCTXSTT | UCTXSTP)) | UCMST;
+    hpl->ctlw0 &= ~UCSWRST;
+  }
+  hpl->ie &= ~I2C_QUEUE_IE;
+  hpl->ifg &= ~I2C_QUEUE_IFG;
+  return iBSP430i2cQueueComplete_ni(queue, rc);
+}
+
+/* Installed as the sBSP430i2cQueue callback.  The queue node is the
+ * first member of the queue, so its address is that of the queue. */
+static int
+eusciI2CQueueISR_ni (const struct sBSP430halISRIndexedChainNode * cb,
+                     void * context,
+                     int iv)
+{
+  hBSP430i2cQueue queue = (hBSP430i2cQueue)cb;
+  hBSP430halSERIAL hal = (hBSP430halSERIAL)context;
+  volatile struct sBSP430hplEUSCIB * hpl = SERIAL_HAL_HPL_B(hal);
+  hBSP430i2cTransaction xfer = queue->head_ni;
+  int rc = 0;
+
+  if (NULL == xfer) {
+    hpl->ie &= ~I2C_QUEUE_IE;
+    return 0;
+  }
+  switch (iv) {
+    case USCI_I2C_UCALIFG:
+      /* The peripheral is now a slave and cannot generate a stop */
+      queue->state_ni |= I2C_QUEUE_STATE_STOP;
+      rc = -(BSP430_I2C_ERRFLAG_PROTOCOL | UCALIFG);
+      break;
+    case USCI_I2C_UCNACKIFG:
+      rc = -(BSP430_I2C_ERRFLAG_PROTOCOL | UCNACKIFG);
+      break;
+    case USCI_I2C_UCTXIFG0:
+      if (I2C_QUEUE_STATE_RX & queue->state_ni) {
+        return 0;
+      }
+      if (queue->index_ni < xfer->tx_len) {
+        ++hal->num_tx;
+        hpl->txbuf = xfer->tx_data[queue->index_ni++];
+        return 0;
+      }
+      /* The last octet is in the shift register */
+      if (0 < xfer->rx_len) {
+        i2cQueueBeginRead_ni(queue, hpl);
+        return 0;
+      }
+      break;
+    case USCI_I2C_UCRXIFG0:
+      if (! (I2C_QUEUE_STATE_RX & queue->state_ni)) {
+        return 0;
+      }
+      ++hal->num_rx;
+      xfer->rx_data[queue->index_ni++] = hpl->rxbuf;
+      if (queue->index_ni < xfer->rx_len) {
+        /* The next octet is being received; if it is the last, the
+         * stop must be requested now so the slave gets a NACK. */
+        if ((queue->index_ni + 1) == xfer->rx_len) {
+          hpl->ctlw0 |= UCTXSTP;
+          queue->state_ni |= I2C_QUEUE_STATE_STOP;
+        }
+        return 0;
+      }
+      break;
+    default:
+      return 0;
+  }
+  return i2cQueueFinish_ni(queue, hpl, rc);
+}
+
+#endif /* configBSP430_SERIAL_ENABLE_I2C */
+
 /* Since the interrupt code is the same for all peripherals, on MCUs
  * with multiple USCI devices it is more space efficient to share it.
  * This does add an extra call/return for some minor cost in stack
@@ -668,8 +867,15 @@ euscib_isr (hBSP430halSERIAL hal)
 {
   int did_tx;
   int rv = 0;
+  int iv = SERIAL_HAL_HPL_B(hal)->iv;
 
-  switch (SERIAL_HAL_HPL_B(hal)->iv) {
+#if (configBSP430_SERIAL_ENABLE_I2C - 0)
+  /* A queue handles every event itself */
+  if (hal->i2c_cbchain_ni) {
+    return iBSP430callbackInvokeISRIndexed_ni(&hal->i2c_cbchain_ni, hal, iv, 0);
+  }
+#endif /* configBSP430_SERIAL_ENABLE_I2C */
+  switch (iv) {
     default:
     case USCI_NONE:
       break;
@@ -738,6 +944,8 @@ static struct sBSP430serialDispatch dispatch_ = {
   .i2cSetAddresses_rh = iBSP430eusciI2CsetAddresses_rh,
   .i2cRxData_rh = iBSP430eusciI2CrxData_rh,
   .i2cTxData_rh = iBSP430eusciI2CtxData_rh,
+  .i2cQueueStart_ni = eusciI2CQueueStart_ni,
+  .i2cQueueISR_ni = eusciI2CQueueISR_ni,
 #endif /* configBSP430_SERIAL_ENABLE_I2C */
   .setReset_rh = iBSP430eusciSetReset_rh,
   .setHold_rh = iBSP430eusciSetHold_rh,
@@ -814,37 +1022,57 @@ struct sBSP430halSERIAL xBSP430hal_EUSCI_A3_ = {
 /* !BSP430! uscifrom=eusci insert=hal_isr_defn */
 /* BEGIN AUTOMATICALLY GENERATED CODE---DO NOT MODIFY [hal_isr_defn] */
 #if (configBSP430_HAL_EUSCI_A0_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(EUSCI_A0)
 BSP430_CORE_DECLARE_INTERRUPT(USCI_A0_VECTOR)
 isr_EUSCI_A0 (void)
 {
-  int rv = euscia_isr(BSP430_HAL_EUSCI_A0);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(EUSCI_A0);
+  rv = euscia_isr(BSP430_HAL_EUSCI_A0);
+  BSP430_ISRSTATS_EXIT_NI(EUSCI_A0);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_EUSCI_A0_ISR */
 
 #if (configBSP430_HAL_EUSCI_A1_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(EUSCI_A1)
 BSP430_CORE_DECLARE_INTERRUPT(USCI_A1_VECTOR)
 isr_EUSCI_A1 (void)
 {
-  int rv = euscia_isr(BSP430_HAL_EUSCI_A1);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(EUSCI_A1);
+  rv = euscia_isr(BSP430_HAL_EUSCI_A1);
+  BSP430_ISRSTATS_EXIT_NI(EUSCI_A1);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_EUSCI_A1_ISR */
 
 #if (configBSP430_HAL_EUSCI_A2_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(EUSCI_A2)
 BSP430_CORE_DECLARE_INTERRUPT(USCI_A2_VECTOR)
 isr_EUSCI_A2 (void)
 {
-  int rv = euscia_isr(BSP430_HAL_EUSCI_A2);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(EUSCI_A2);
+  rv = euscia_isr(BSP430_HAL_EUSCI_A2);
+  BSP430_ISRSTATS_EXIT_NI(EUSCI_A2);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_EUSCI_A2_ISR */
 
 #if (configBSP430_HAL_EUSCI_A3_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(EUSCI_A3)
 BSP430_CORE_DECLARE_INTERRUPT(USCI_A3_VECTOR)
 isr_EUSCI_A3 (void)
 {
-  int rv = euscia_isr(BSP430_HAL_EUSCI_A3);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(EUSCI_A3);
+  rv = euscia_isr(BSP430_HAL_EUSCI_A3);
+  BSP430_ISRSTATS_EXIT_NI(EUSCI_A3);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_EUSCI_A3_ISR */
@@ -889,19 +1117,29 @@ struct sBSP430halSERIAL xBSP430hal_EUSCI_B1_ = {
 /* !BSP430! uscifrom=eusci insert=hal_isr_defn */
 /* BEGIN AUTOMATICALLY GENERATED CODE---DO NOT MODIFY [hal_isr_defn] */
 #if (configBSP430_HAL_EUSCI_B0_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(EUSCI_B0)
 BSP430_CORE_DECLARE_INTERRUPT(USCI_B0_VECTOR)
 isr_EUSCI_B0 (void)
 {
-  int rv = euscib_isr(BSP430_HAL_EUSCI_B0);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(EUSCI_B0);
+  rv = euscib_isr(BSP430_HAL_EUSCI_B0);
+  BSP430_ISRSTATS_EXIT_NI(EUSCI_B0);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_EUSCI_B0_ISR */
 
 #if (configBSP430_HAL_EUSCI_B1_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(EUSCI_B1)
 BSP430_CORE_DECLARE_INTERRUPT(USCI_B1_VECTOR)
 isr_EUSCI_B1 (void)
 {
-  int rv = euscib_isr(BSP430_HAL_EUSCI_B1);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(EUSCI_B1);
+  rv = euscib_isr(BSP430_HAL_EUSCI_B1);
+  BSP430_ISRSTATS_EXIT_NI(EUSCI_B1);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_EUSCI_B1_ISR */
@@ -397,16 +397,20 @@ port_isr (hBSP430halPORT device,
 /* !BSP430! insert=hal_port_isr_defn */
 /* BEGIN AUTOMATICALLY GENERATED CODE---DO NOT MODIFY [hal_port_isr_defn] */
 #if (configBSP430_HAL_PORT1_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(PORT1)
 BSP430_CORE_DECLARE_INTERRUPT(PORT1_VECTOR)
 isr_PORT1 (void)
 {
   int idx = 0;
   int rv;
   unsigned char bit = 1;
-
 #if (BSP430_CORE_FAMILY_IS_5XX - 0)
-  unsigned int iv = P1IV;
+  unsigned int iv;
+#endif /* CPUX */
 
+  BSP430_ISRSTATS_ENTER_NI(PORT1);
+#if (BSP430_CORE_FAMILY_IS_5XX - 0)
+  iv = P1IV;
   if (0 == iv) {
     return;
   }
@@ -428,21 +432,26 @@ isr_PORT1 (void)
 #endif /* CPUX */
     P1IE &= ~bit;
   }
+  BSP430_ISRSTATS_EXIT_NI(PORT1);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_PORT1_ISR */
 
 #if (configBSP430_HAL_PORT2_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(PORT2)
 BSP430_CORE_DECLARE_INTERRUPT(PORT2_VECTOR)
 isr_PORT2 (void)
 {
   int idx = 0;
   int rv;
   unsigned char bit = 1;
-
 #if (BSP430_CORE_FAMILY_IS_5XX - 0)
-  unsigned int iv = P2IV;
+  unsigned int iv;
+#endif /* CPUX */
 
+  BSP430_ISRSTATS_ENTER_NI(PORT2);
+#if (BSP430_CORE_FAMILY_IS_5XX - 0)
+  iv = P2IV;
   if (0 == iv) {
     return;
   }
@@ -464,21 +473,26 @@ isr_PORT2 (void)
 #endif /* CPUX */
     P2IE &= ~bit;
   }
+  BSP430_ISRSTATS_EXIT_NI(PORT2);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_PORT2_ISR */
 
 #if (configBSP430_HAL_PORT3_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(PORT3)
 BSP430_CORE_DECLARE_INTERRUPT(PORT3_VECTOR)
 isr_PORT3 (void)
 {
   int idx = 0;
   int rv;
   unsigned char bit = 1;
-
 #if (BSP430_CORE_FAMILY_IS_5XX - 0)
-  unsigned int iv = P3IV;
+  unsigned int iv;
+#endif /* CPUX */
 
+  BSP430_ISRSTATS_ENTER_NI(PORT3);
+#if (BSP430_CORE_FAMILY_IS_5XX - 0)
+  iv = P3IV;
   if (0 == iv) {
     return;
   }
@@ -500,21 +514,26 @@ isr_PORT3 (void)
 #endif /* CPUX */
     P3IE &= ~bit;
   }
+  BSP430_ISRSTATS_EXIT_NI(PORT3);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_PORT3_ISR */
 
 #if (configBSP430_HAL_PORT4_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(PORT4)
 BSP430_CORE_DECLARE_INTERRUPT(PORT4_VECTOR)
 isr_PORT4 (void)
 {
   int idx = 0;
   int rv;
   unsigned char bit = 1;
-
 #if (BSP430_CORE_FAMILY_IS_5XX - 0)
-  unsigned int iv = P4IV;
+  unsigned int iv;
+#endif /* CPUX */
 
+  BSP430_ISRSTATS_ENTER_NI(PORT4);
+#if (BSP430_CORE_FAMILY_IS_5XX - 0)
+  iv = P4IV;
   if (0 == iv) {
     return;
   }
@@ -536,21 +555,26 @@ isr_PORT4 (void)
 #endif /* CPUX */
     P4IE &= ~bit;
   }
+  BSP430_ISRSTATS_EXIT_NI(PORT4);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_PORT4_ISR */
 
 #if (configBSP430_HAL_PORT5_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(PORT5)
 BSP430_CORE_DECLARE_INTERRUPT(PORT5_VECTOR)
 isr_PORT5 (void)
 {
   int idx = 0;
   int rv;
   unsigned char bit = 1;
-
 #if (BSP430_CORE_FAMILY_IS_5XX - 0)
-  unsigned int iv = P5IV;
+  unsigned int iv;
+#endif /* CPUX */
 
+  BSP430_ISRSTATS_ENTER_NI(PORT5);
+#if (BSP430_CORE_FAMILY_IS_5XX - 0)
+  iv = P5IV;
   if (0 == iv) {
     return;
   }
@@ -572,21 +596,26 @@ isr_PORT5 (void)
 #endif /* CPUX */
     P5IE &= ~bit;
   }
+  BSP430_ISRSTATS_EXIT_NI(PORT5);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_PORT5_ISR */
 
 #if (configBSP430_HAL_PORT6_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(PORT6)
 BSP430_CORE_DECLARE_INTERRUPT(PORT6_VECTOR)
 isr_PORT6 (void)
 {
   int idx = 0;
   int rv;
   unsigned char bit = 1;
-
 #if (BSP430_CORE_FAMILY_IS_5XX - 0)
-  unsigned int iv = P6IV;
+  unsigned int iv;
+#endif /* CPUX */
 
+  BSP430_ISRSTATS_ENTER_NI(PORT6);
+#if (BSP430_CORE_FAMILY_IS_5XX - 0)
+  iv = P6IV;
   if (0 == iv) {
     return;
   }
@@ -608,21 +637,26 @@ isr_PORT6 (void)
 #endif /* CPUX */
     P6IE &= ~bit;
   }
+  BSP430_ISRSTATS_EXIT_NI(PORT6);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_PORT6_ISR */
 
 #if (configBSP430_HAL_PORT7_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(PORT7)
 BSP430_CORE_DECLARE_INTERRUPT(PORT7_VECTOR)
 isr_PORT7 (void)
 {
   int idx = 0;
   int rv;
   unsigned char bit = 1;
-
 #if (BSP430_CORE_FAMILY_IS_5XX - 0)
-  unsigned int iv = P7IV;
+  unsigned int iv;
+#endif /* CPUX */
 
+  BSP430_ISRSTATS_ENTER_NI(PORT7);
+#if (BSP430_CORE_FAMILY_IS_5XX - 0)
+  iv = P7IV;
   if (0 == iv) {
     return;
   }
@@ -644,21 +678,26 @@ isr_PORT7 (void)
 #endif /* CPUX */
     P7IE &= ~bit;
   }
+  BSP430_ISRSTATS_EXIT_NI(PORT7);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_PORT7_ISR */
 
 #if (configBSP430_HAL_PORT8_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(PORT8)
 BSP430_CORE_DECLARE_INTERRUPT(PORT8_VECTOR)
 isr_PORT8 (void)
 {
   int idx = 0;
   int rv;
   unsigned char bit = 1;
-
 #if (BSP430_CORE_FAMILY_IS_5XX - 0)
-  unsigned int iv = P8IV;
+  unsigned int iv;
+#endif /* CPUX */
 
+  BSP430_ISRSTATS_ENTER_NI(PORT8);
+#if (BSP430_CORE_FAMILY_IS_5XX - 0)
+  iv = P8IV;
   if (0 == iv) {
     return;
   }
@@ -680,21 +719,26 @@ isr_PORT8 (void)
 #endif /* CPUX */
     P8IE &= ~bit;
   }
+  BSP430_ISRSTATS_EXIT_NI(PORT8);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_PORT8_ISR */
 
 #if (configBSP430_HAL_PORT9_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(PORT9)
 BSP430_CORE_DECLARE_INTERRUPT(PORT9_VECTOR)
 isr_PORT9 (void)
 {
   int idx = 0;
   int rv;
   unsigned char bit = 1;
-
 #if (BSP430_CORE_FAMILY_IS_5XX - 0)
-  unsigned int iv = P9IV;
+  unsigned int iv;
+#endif /* CPUX */
 
+  BSP430_ISRSTATS_ENTER_NI(PORT9);
+#if (BSP430_CORE_FAMILY_IS_5XX - 0)
+  iv = P9IV;
   if (0 == iv) {
     return;
   }
@@ -716,21 +760,26 @@ isr_PORT9 (void)
 #endif /* CPUX */
     P9IE &= ~bit;
   }
+  BSP430_ISRSTATS_EXIT_NI(PORT9);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_PORT9_ISR */
 
 #if (configBSP430_HAL_PORT10_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(PORT10)
 BSP430_CORE_DECLARE_INTERRUPT(PORT10_VECTOR)
 isr_PORT10 (void)
 {
   int idx = 0;
   int rv;
   unsigned char bit = 1;
-
 #if (BSP430_CORE_FAMILY_IS_5XX - 0)
-  unsigned int iv = P10IV;
+  unsigned int iv;
+#endif /* CPUX */
 
+  BSP430_ISRSTATS_ENTER_NI(PORT10);
+#if (BSP430_CORE_FAMILY_IS_5XX - 0)
+  iv = P10IV;
   if (0 == iv) {
     return;
   }
@@ -752,21 +801,26 @@ isr_PORT10 (void)
 #endif /* CPUX */
     P10IE &= ~bit;
   }
+  BSP430_ISRSTATS_EXIT_NI(PORT10);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_PORT10_ISR */
 
 #if (configBSP430_HAL_PORT11_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(PORT11)
 BSP430_CORE_DECLARE_INTERRUPT(PORT11_VECTOR)
 isr_PORT11 (void)
 {
   int idx = 0;
   int rv;
   unsigned char bit = 1;
-
 #if (BSP430_CORE_FAMILY_IS_5XX - 0)
-  unsigned int iv = P11IV;
+  unsigned int iv;
+#endif /* CPUX */
 
+  BSP430_ISRSTATS_ENTER_NI(PORT11);
+#if (BSP430_CORE_FAMILY_IS_5XX - 0)
+  iv = P11IV;
   if (0 == iv) {
     return;
   }
@@ -788,6 +842,7 @@ isr_PORT11 (void)
 #endif /* CPUX */
     P11IE &= ~bit;
   }
+  BSP430_ISRSTATS_EXIT_NI(PORT11);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_PORT11_ISR */
@@ -31,6 +31,7 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <bsp430/platform.h>    /* BSP430_PLATFORM_TIMER_CCACLK defined by this */
 #include <bsp430/periph/timer.h>
 #include <bsp430/clock.h>
@@ -364,7 +365,7 @@ timerOverflowAdjusted_ni (hBSP430halTIMER timer,
    *
    * Note that TAIFG, TBIFG, and TDIFG all have value 0x0001 so it
    * doesn't matter which type of timer this is. */
-  if ((0 <= (int)ctr) && (timer->hpl->ctl & TAIFG)) {
+  if ((! (0x8000 & ctr)) && (timer->hpl->ctl & TAIFG)) {
     ++overflow_count;
   }
   return overflow_count;
@@ -392,6 +393,33 @@ ulBSP430timerCounter_ni (hBSP430halTIMER timer,
   return (overflow_count << 16) + r;
 }
 
+unsigned long long
+ullBSP430timerCounter (hBSP430halTIMER timer)
+{
+  const volatile unsigned long * ocp = (const volatile unsigned long *)&timer->overflow_count;
+  unsigned long overflow_count;
+  unsigned int r;
+  unsigned int ifg;
+
+  /* The overflow count changes only in the overflow interrupt, which
+   * clears TAIFG before incrementing it.  If the count is the same
+   * before and after reading the counter and flag, no overflow was
+   * handled in between and the values are consistent.  A read of the
+   * count that was torn by the interrupt (on a 16-bit CPU) never
+   * matches the value read afterwards, since the low word always
+   * changes.  An overflow that is pending but not yet handled is
+   * accounted for as in timerOverflowAdjusted_ni(). */
+  do {
+    overflow_count = *ocp;
+    r = uiBSP430timerBestCounterRead_ni(timer->hpl, timer->hal_state.flags);
+    ifg = timer->hpl->ctl & TAIFG;
+  } while (overflow_count != *ocp);
+  if (ifg && (! (0x8000 & r))) {
+    ++overflow_count;
+  }
+  return ((unsigned long long)overflow_count << 16) + r;
+}
+
 unsigned long
 ulBSP430timerCaptureCounter_ni (hBSP430halTIMER timer,
                                 unsigned int ccidx)
@@ -435,7 +463,7 @@ void alarmConfigureInterrupts_ni (sBSP430timerAlarm * map)
 {
   unsigned int chi = map->timer->overflow_count;
   unsigned int shi = map->setting_tck >> 16;
-  unsigned int slo = map->setting_tck;
+  unsigned int slo = 0xFFFF & map->setting_tck;
 
   /* NB: When invoked from the overflow handler we can expect there
    * are no unhandled overflow events; that's not true when invoked
@@ -474,6 +502,31 @@ alarmOFcb_ni (const struct sBSP430halISRVoidChainNode * cb,
   return 0;
 }
 
+static int timerAlarmSet_ni (hBSP430timerAlarm alarm,
+                             unsigned long setting_tck,
+                             int force,
+                             unsigned long period_tck);
+
+/* Advance *setting_tckp by one period, then by as many more as are
+ * needed to reach the first event that is not already past at
+ * now_tck.  Returns the number of events skipped, saturated at
+ * UINT_MAX. */
+static unsigned int
+alarmAdvancePeriod_ (unsigned long * setting_tckp,
+                     unsigned long period_tck,
+                     unsigned long now_tck)
+{
+  unsigned long setting_tck = *setting_tckp + period_tck;
+  unsigned long missed = 0;
+
+  if (0 > (long)(setting_tck - now_tck)) {
+    missed = 1 + (now_tck - setting_tck - 1) / period_tck;
+    setting_tck += missed * period_tck;
+  }
+  *setting_tckp = setting_tck;
+  return (UINT_MAX < missed) ? UINT_MAX : (unsigned int)missed;
+}
+
 /* The capture/compare callback registered for enabled alarms.  It is
  * responsible for clearing the alarm and invoking the user-provided
  * callback. */
@@ -495,6 +548,16 @@ alarmCCcb_ni (const struct sBSP430halISRIndexedChainNode * cb,
   } else {
     rv = BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
   }
+  /* Re-arm a periodic alarm from its scheduled time, unless the
+   * callback cancelled or set the alarm itself. */
+  if ((0 != malarmp->period_tck)
+      && (! (malarmp->flags & BSP430_TIMER_ALARM_FLAG_SET))) {
+    unsigned long setting_tck = malarmp->setting_tck;
+    unsigned long now_tck = ulBSP430timerCounter_ni(malarmp->timer, NULL);
+
+    malarmp->overruns = alarmAdvancePeriod_(&setting_tck, malarmp->period_tck, now_tck);
+    (void)timerAlarmSet_ni(malarmp, setting_tck, 1, malarmp->period_tck);
+  }
   return rv;
 }
 
@@ -577,7 +640,8 @@ iBSP430timerAlarmSetEnabled_ni (hBSP430timerAlarm alarm,
 static int
 timerAlarmSet_ni (hBSP430timerAlarm alarm,
                   unsigned long setting_tck,
-                  int force)
+                  int force,
+                  unsigned long period_tck)
 {
   sBSP430timerAlarm * malarmp = (sBSP430timerAlarm *)alarm;
   int rv = 0;
@@ -619,6 +683,7 @@ timerAlarmSet_ni (hBSP430timerAlarm alarm,
      * raised and hand off control to the routine that checks that
      * we're in the right overflow cycle. */
     malarmp->setting_tck = setting_tck;
+    malarmp->period_tck = period_tck;
     malarmp->flags |= BSP430_TIMER_ALARM_FLAG_SET;
     hpl->ccr[alarm->ccidx] = (unsigned int)setting_tck;
     if (0 < rv) {
@@ -634,14 +699,27 @@ int
 iBSP430timerAlarmSet_ni (hBSP430timerAlarm alarm,
                          unsigned long setting_tck)
 {
-  return timerAlarmSet_ni(alarm, setting_tck, 0);
+  return timerAlarmSet_ni(alarm, setting_tck, 0, 0);
 }
 
 int
 iBSP430timerAlarmSetForced_ni (hBSP430timerAlarm alarm,
                                unsigned long setting_tck)
 {
-  return timerAlarmSet_ni(alarm, setting_tck, 1);
+  return timerAlarmSet_ni(alarm, setting_tck, 1, 0);
+}
+
+int
+iBSP430timerAlarmSetPeriodic_ni (hBSP430timerAlarm alarm,
+                                 unsigned long setting_tck,
+                                 unsigned long period_tck)
+{
+  int rv = timerAlarmSet_ni(alarm, setting_tck, 1, period_tck);
+
+  if (0 <= rv) {
+    ((sBSP430timerAlarm *)alarm)->overruns = 0;
+  }
+  return rv;
 }
 
 int
@@ -654,6 +732,9 @@ iBSP430timerAlarmCancel_ni (hBSP430timerAlarm alarm)
   if (! (BSP430_TIMER_ALARM_FLAG_ENABLED & alarm->flags)) {
     return -1;
   }
+  /* Stop a periodic alarm even when it is not set, as when cancelled
+   * from its own callback. */
+  malarm->period_tck = 0;
   if (! (BSP430_TIMER_ALARM_FLAG_SET & alarm->flags)) {
     return 0;
   }
@@ -664,37 +745,179 @@ iBSP430timerAlarmCancel_ni (hBSP430timerAlarm alarm)
   return 1;
 }
 
-/* The capture/compare callback registered for enabled alarms.  It is
- * responsible for clearing the alarm and invoking the user-provided
- * callback. */
+#if (configBSP430_TIMER_MUX_ALARM_HEAP - 0)
+/* Multiplexed alarms are held in a pairing heap.  Each node's child
+ * field heads a list of siblings (linked through next) that are due
+ * no earlier than the node; prev refers to the parent for the first
+ * child and to the preceding sibling otherwise.  Due times are
+ * compared as signed differences so the ordering survives counter
+ * wrap, provided all pending alarms lie within half the counter range
+ * of each other. */
+
+/* Combine two non-empty heaps, returning the root of the result. */
+static hBSP430timerMuxAlarm
+muxHeapMeld_ (hBSP430timerMuxAlarm a,
+              hBSP430timerMuxAlarm b)
+{
+  if (0 > (long)(b->setting_tck - a->setting_tck)) {
+    hBSP430timerMuxAlarm t = a;
+    a = b;
+    b = t;
+  }
+  b->next = a->child;
+  if (NULL != b->next) {
+    b->next->prev = b;
+  }
+  b->prev = a;
+  a->child = b;
+  return a;
+}
+
+/* Combine a non-empty sibling list into a single heap using the
+ * standard two-pass pairing.  The first pass melds adjacent pairs
+ * left to right, accumulating the results in reverse order; the
+ * second melds the accumulated heaps into one. */
+static hBSP430timerMuxAlarm
+muxHeapMergePairs_ (hBSP430timerMuxAlarm list)
+{
+  hBSP430timerMuxAlarm acc = NULL;
+  hBSP430timerMuxAlarm root;
+
+  while (NULL != list) {
+    hBSP430timerMuxAlarm a = list;
+    hBSP430timerMuxAlarm b = a->next;
+
+    if (NULL == b) {
+      list = NULL;
+    } else {
+      list = b->next;
+      a = muxHeapMeld_(a, b);
+    }
+    a->next = acc;
+    acc = a;
+  }
+  root = acc;
+  acc = acc->next;
+  while (NULL != acc) {
+    hBSP430timerMuxAlarm next = acc->next;
+    root = muxHeapMeld_(root, acc);
+    acc = next;
+  }
+  root->next = NULL;
+  root->prev = NULL;
+  return root;
+}
+
+/* Remove the root of a non-empty heap, returning the new root. */
+static hBSP430timerMuxAlarm
+muxHeapPop_ (hBSP430timerMuxAlarm root)
+{
+  hBSP430timerMuxAlarm child = root->child;
+
+  root->child = NULL;
+  return (NULL == child) ? NULL : muxHeapMergePairs_(child);
+}
+#endif /* configBSP430_TIMER_MUX_ALARM_HEAP */
+
+/* Link alarm into the structure held by shared.  The dedicated alarm
+ * is not updated. */
+static void
+muxAlarmInsert_ni (hBSP430timerMuxSharedAlarm shared,
+                   hBSP430timerMuxAlarm alarm)
+{
+#if (configBSP430_TIMER_MUX_ALARM_HEAP - 0)
+  alarm->next = NULL;
+  alarm->child = NULL;
+  alarm->prev = NULL;
+  if (NULL == shared->alarms) {
+    shared->alarms = alarm;
+  } else {
+    shared->alarms = muxHeapMeld_(shared->alarms, alarm);
+  }
+#else /* configBSP430_TIMER_MUX_ALARM_HEAP */
+  hBSP430timerMuxAlarm * np = &shared->alarms;
+  hBSP430halTIMER timer = shared->dedicated.timer;
+  unsigned long now_tck = ulBSP430timerCounter_ni(timer, NULL);
+  long delay_tck = alarm->setting_tck - now_tck;
+
+  /* Insert the alarm into the sequence after any alarm that should
+   * fire at or before the time of the new alarm. */
+  while (NULL != *np) {
+    long next_delay_tck = (*np)->setting_tck - now_tck;
+    if (next_delay_tck > delay_tck) {
+      break;
+    }
+    np = &(*np)->next;
+  }
+  alarm->next = *np;
+  *np = alarm;
+#endif /* configBSP430_TIMER_MUX_ALARM_HEAP */
+}
+
+/* The callback for the dedicated alarm.  It is responsible for
+ * invoking the callbacks of all multiplexed alarms that are due,
+ * re-adding the periodic ones, and re-arming the dedicated alarm for
+ * whatever remains. */
 static int
 muxAlarm_cb_ni (hBSP430timerAlarm alarm)
 {
   hBSP430timerMuxSharedAlarm sap = (sBSP430timerMuxSharedAlarm *)(-offsetof(sBSP430timerMuxSharedAlarm, dedicated) + (char *)alarm);
-  unsigned long now_tck = ulBSP430timerCounter_ni(sap->dedicated.timer, NULL);
-  hBSP430timerMuxAlarm fired = sap->alarms;
-  hBSP430timerMuxAlarm * ap = &sap->alarms;
   int rv = 0;
-
-  while (NULL != *ap) {
-    if (0 < ((long)((*ap)->setting_tck) - (long)now_tck)) {
-      break;
+  int pass;
+
+  /* Alarms that come due while the callbacks run, including periodic
+   * alarms re-added by the first pass, are handled by a second pass
+   * rather than through another interrupt.  Anything due after that
+   * is left to the dedicated alarm, which fires again at once, so
+   * callbacks that take longer than their period cannot keep the
+   * handler from returning. */
+  for (pass = 0; pass < 2; ++pass) {
+    unsigned long now_tck = ulBSP430timerCounter_ni(sap->dedicated.timer, NULL);
+    hBSP430timerMuxAlarm fired = NULL;
+    hBSP430timerMuxAlarm * ap = &fired;
+
+    /* Move the alarms that are due onto the fired list, in order. */
+#if (configBSP430_TIMER_MUX_ALARM_HEAP - 0)
+    while (NULL != sap->alarms) {
+      hBSP430timerMuxAlarm due = sap->alarms;
+      if (0 < ((long)(due->setting_tck) - (long)now_tck)) {
+        break;
+      }
+      sap->alarms = muxHeapPop_(due);
+      *ap = due;
+      ap = &due->next;
     }
-    ap = &(*ap)->next;
-  }
-  sap->alarms = *ap;
-  if (sap->alarms) {
-    (void)timerAlarmSet_ni(&sap->dedicated, sap->alarms->setting_tck, 1);
-  }
-  if (fired != sap->alarms) {
+#else /* configBSP430_TIMER_MUX_ALARM_HEAP */
+    fired = sap->alarms;
+    while (NULL != *ap) {
+      if (0 < ((long)((*ap)->setting_tck) - (long)now_tck)) {
+        break;
+      }
+      ap = &(*ap)->next;
+    }
+    sap->alarms = *ap;
+#endif /* configBSP430_TIMER_MUX_ALARM_HEAP */
     *ap = NULL;
+    if (NULL == fired) {
+      break;
+    }
     while (NULL != fired) {
       hBSP430timerMuxAlarm notify = fired;
       fired = notify->next;
       notify->next = NULL;
       rv |= notify->callback_ni(sap, notify);
+      if (0 != notify->period_tck) {
+        notify->overruns = alarmAdvancePeriod_(&notify->setting_tck, notify->period_tck, now_tck);
+        muxAlarmInsert_ni(sap, notify);
+      }
     }
   }
+  /* Callbacks that added or removed alarms may have set the dedicated
+   * alarm already. */
+  (void)iBSP430timerAlarmCancel_ni(&sap->dedicated);
+  if (NULL != sap->alarms) {
+    (void)timerAlarmSet_ni(&sap->dedicated, sap->alarms->setting_tck, 1, 0);
+  }
   return rv;
 }
 
@@ -746,28 +969,23 @@ iBSP430timerMuxAlarmShutdown (hBSP430timerMuxSharedAlarm shared)
 int
 iBSP430timerMuxAlarmAdd_ni (hBSP430timerMuxSharedAlarm shared,
                             hBSP430timerMuxAlarm alarm)
+{
+  return iBSP430timerMuxAlarmAddPeriodic_ni(shared, alarm, 0);
+}
+
+int
+iBSP430timerMuxAlarmAddPeriodic_ni (hBSP430timerMuxSharedAlarm shared,
+                                    hBSP430timerMuxAlarm alarm,
+                                    unsigned long period_tck)
 {
   int rc;
 
   rc = iBSP430timerAlarmCancel_ni(&shared->dedicated);
   if (0 <= rc) {
-    hBSP430timerMuxAlarm * np = &shared->alarms;
-    hBSP430halTIMER timer = shared->dedicated.timer;
-    unsigned long now_tck = ulBSP430timerCounter_ni(timer, NULL);
-    long delay_tck = alarm->setting_tck - now_tck;
-
-    /* Insert the alarm into the sequence after any alarm that should
-     * fire at or before the time of the new alarm. */
-    while (NULL != *np) {
-      long next_delay_tck = (*np)->setting_tck - now_tck;
-      if (next_delay_tck > delay_tck) {
-        break;
-      }
-      np = &(*np)->next;
-    }
-    alarm->next = *np;
-    *np = alarm;
-    rc = timerAlarmSet_ni(&shared->dedicated, shared->alarms->setting_tck, 1);
+    alarm->period_tck = period_tck;
+    alarm->overruns = 0;
+    muxAlarmInsert_ni(shared, alarm);
+    rc = timerAlarmSet_ni(&shared->dedicated, shared->alarms->setting_tck, 1, 0);
   }
   return rc;
 }
@@ -780,6 +998,36 @@ iBSP430timerMuxAlarmRemove_ni (hBSP430timerMuxSharedAlarm shared,
 
   rc = iBSP430timerAlarmCancel_ni(&shared->dedicated);
   if (0 <= rc) {
+    /* Stop a periodic alarm even if it is not linked, as when removed
+     * from its own callback. */
+    alarm->period_tck = 0;
+#if (configBSP430_TIMER_MUX_ALARM_HEAP - 0)
+    /* An alarm that is not in the heap (including one that is due
+     * and waiting for its callback) is left untouched. */
+    if (alarm == shared->alarms) {
+      shared->alarms = muxHeapPop_(alarm);
+      alarm->next = NULL;
+    } else if (NULL != alarm->prev) {
+      hBSP430timerMuxAlarm prev = alarm->prev;
+
+      /* Cut the subtree rooted at alarm out of its sibling list, then
+       * meld what remains of it back into the heap. */
+      if (alarm == prev->child) {
+        prev->child = alarm->next;
+      } else {
+        prev->next = alarm->next;
+      }
+      if (NULL != alarm->next) {
+        alarm->next->prev = prev;
+      }
+      prev = muxHeapPop_(alarm);
+      if (NULL != prev) {
+        shared->alarms = muxHeapMeld_(shared->alarms, prev);
+      }
+      alarm->next = NULL;
+      alarm->prev = NULL;
+    }
+#else /* configBSP430_TIMER_MUX_ALARM_HEAP */
     hBSP430timerMuxAlarm * np = &shared->alarms;
     while (NULL != *np) {
       if (alarm == *np) {
@@ -788,14 +1036,61 @@ iBSP430timerMuxAlarmRemove_ni (hBSP430timerMuxSharedAlarm shared,
       }
       np = &(*np)->next;
     }
+#endif /* configBSP430_TIMER_MUX_ALARM_HEAP */
     rc = 0;
     if (NULL != shared->alarms) {
-      rc = timerAlarmSet_ni(&shared->dedicated, shared->alarms->setting_tck, 1);
+      rc = timerAlarmSet_ni(&shared->dedicated, shared->alarms->setting_tck, 1, 0);
     }
   }
   return rc;
 }
 
+#if (configBSP430_TIMER_PULSECAP_RING - 0)
+/* Capture handling while a ring is attached: store the time and, when
+ * a batch completes, notify the application. */
+static int
+pulsecapRing_ni (hBSP430timerPulseCapture pulsecap,
+                 hBSP430halTIMER timer,
+                 int idx,
+                 unsigned int ccr,
+                 unsigned int cctl)
+{
+  hBSP430timerPulseCaptureRing ring = pulsecap->ring;
+  unsigned int head = ring->head_ni;
+  unsigned int flags = ring->flags_ni;
+  int rv = 0;
+
+  /* A capture lost in hardware or for lack of space breaks the
+   * sequence.  Discard the partial batch and start again with the
+   * next pulse. */
+  if ((cctl & (COV | CCIFG)) || (ring->size == (head - ring->tail_ni))) {
+    timer->hpl->cctl[idx] &= ~(COV | CCIFG);
+    ring->head_ni = head - ring->fill_ni;
+    ring->fill_ni = 0;
+    ++ring->lost_ni;
+    ring->flags_ni = flags | BSP430_TIMER_PULSECAP_RING_RESYNC;
+    return 0;
+  }
+  if (BSP430_TIMER_PULSECAP_RING_RESYNC & flags) {
+    if ((BSP430_TIMER_PULSECAP_RING_BOTH_EDGES & flags) && (! (cctl & CCI))) {
+      return 0;
+    }
+    ring->flags_ni = flags & ~BSP430_TIMER_PULSECAP_RING_RESYNC;
+  }
+  ring->captures_tt[head & (ring->size - 1)] = (timerOverflowAdjusted_ni(timer, ccr) << 16) | ccr;
+  ring->head_ni = head + 1;
+  if (ring->batch == ++ring->fill_ni) {
+    ring->fill_ni = 0;
+    if (NULL != pulsecap->callback_ni) {
+      pulsecap->flags_ni |= BSP430_TIMER_PULSECAP_CALLBACK_ACTIVE;
+      rv = pulsecap->callback_ni(pulsecap);
+      pulsecap->flags_ni &= ~BSP430_TIMER_PULSECAP_CALLBACK_ACTIVE;
+    }
+  }
+  return rv;
+}
+#endif /* configBSP430_TIMER_PULSECAP_RING */
+
 static int
 pulsecap_isr (const struct sBSP430halISRIndexedChainNode * cb,
               void * context,
@@ -814,6 +1109,12 @@ pulsecap_isr (const struct sBSP430halISRIndexedChainNode * cb,
   ccr  = timer->hpl->ccr[idx];
   cctl = timer->hpl->cctl[idx];
 
+#if (configBSP430_TIMER_PULSECAP_RING - 0)
+  if (NULL != pulsecap->ring) {
+    return pulsecapRing_ni(pulsecap, timer, idx, ccr, cctl);
+  }
+#endif /* configBSP430_TIMER_PULSECAP_RING */
+
   /* COV means a second capture occured before the interrupt handler
    * was entered.  CCIFG means a second capture occured after the
    * interrupt handler was entered but before this callback was
@@ -844,9 +1145,6 @@ pulsecap_isr (const struct sBSP430halISRIndexedChainNode * cb,
   if (BSP430_TIMER_PULSECAP_OVERFLOW & flags) {
     do_callback = 1;
   }
-  while (! (flags & (BSP430_TIMER_PULSECAP_START_CALLBACK | BSP430_TIMER_PULSECAP_END_CALLBACK))) {
-    ;
-  }
   pulsecap->flags_ni = flags;
   if ((NULL != pulsecap->callback_ni) && do_callback) {
     pulsecap->flags_ni |= BSP430_TIMER_PULSECAP_CALLBACK_ACTIVE;
@@ -940,28 +1238,143 @@ hBSP430timerPulseCaptureInitialize (hBSP430timerPulseCapture pulsecap,
   return pulsecap;
 }
 
+#if (configBSP430_TIMER_PULSECAP_RING - 0)
+hBSP430timerPulseCaptureRing
+hBSP430timerPulseCaptureRingInitialize (hBSP430timerPulseCaptureRing ring,
+                                        unsigned long * captures_tt,
+                                        unsigned int size,
+                                        unsigned int batch)
+{
+  if ((NULL == captures_tt)
+      || (0 == size)
+      || (0 != (size & (size - 1)))
+      || (2 > batch)
+      || (batch > size)) {
+    return NULL;
+  }
+  memset(ring, 0, sizeof(*ring));
+  ring->captures_tt = captures_tt;
+  ring->size = size;
+  ring->batch = batch;
+  return ring;
+}
+
+int
+iBSP430timerPulseCaptureSetRing_ni (hBSP430timerPulseCapture pulsecap,
+                                    hBSP430timerPulseCaptureRing ring)
+{
+  if ((NULL == pulsecap)
+      || (NULL == pulsecap->hal)) {
+    return -1;
+  }
+  if (NULL != ring) {
+    unsigned int flags = BSP430_TIMER_PULSECAP_RING_RESYNC;
+
+    if (CM_3 == (CM_3 & pulsecap->hal->hpl->cctl[pulsecap->ccidx])) {
+      if ((4 > ring->batch) || (ring->batch & 1)) {
+        return -1;
+      }
+      flags |= BSP430_TIMER_PULSECAP_RING_BOTH_EDGES;
+    }
+    ring->head_ni = 0;
+    ring->tail_ni = 0;
+    ring->fill_ni = 0;
+    ring->lost_ni = 0;
+    ring->flags_ni = flags;
+  }
+  pulsecap->ring = ring;
+  return 0;
+}
+
+int
+iBSP430timerPulseCaptureRingStats_ni (hBSP430timerPulseCaptureRing ring,
+                                      sBSP430timerPulseCaptureStats * stats)
+{
+  unsigned int tail = ring->tail_ni;
+
+  if (ring->batch > ((ring->head_ni - ring->fill_ni) - tail)) {
+    return -1;
+  }
+  if (NULL != stats) {
+    const unsigned long * cp = ring->captures_tt;
+    unsigned int mask = ring->size - 1;
+    unsigned int step = (BSP430_TIMER_PULSECAP_RING_BOTH_EDGES & ring->flags_ni) ? 2 : 1;
+    unsigned long first_tt = cp[tail & mask];
+    unsigned long prev_tt = first_tt;
+    unsigned long width_sum_tt = 0;
+    unsigned int i;
+
+    stats->periods = 0;
+    stats->min_period_tt = ULONG_MAX;
+    stats->max_period_tt = 0;
+    for (i = 0; i < ring->batch; i += step) {
+      unsigned long start_tt = cp[(tail + i) & mask];
+
+      if (0 < i) {
+        unsigned long period_tt = start_tt - prev_tt;
+
+        if (period_tt < stats->min_period_tt) {
+          stats->min_period_tt = period_tt;
+        }
+        if (period_tt > stats->max_period_tt) {
+          stats->max_period_tt = period_tt;
+        }
+        ++stats->periods;
+      }
+      if (1 < step) {
+        width_sum_tt += cp[(tail + i + 1) & mask] - start_tt;
+      }
+      prev_tt = start_tt;
+    }
+    stats->mean_period_tt = (prev_tt - first_tt) / stats->periods;
+    stats->mean_width_tt = 0;
+    stats->duty_ppt = 0;
+    if (1 < step) {
+      stats->mean_width_tt = width_sum_tt / (ring->batch / 2);
+      /* Avoid the overflow in scaling a long width, and the precision
+       * lost in scaling down a short period. */
+      if ((ULONG_MAX / 1000) > stats->mean_width_tt) {
+        stats->duty_ppt = (1000 * stats->mean_width_tt) / stats->mean_period_tt;
+      } else {
+        stats->duty_ppt = stats->mean_width_tt / (stats->mean_period_tt / 1000);
+      }
+    }
+  }
+  ring->tail_ni = tail + ring->batch;
+  return 0;
+}
+#endif /* configBSP430_TIMER_PULSECAP_RING */
+
 /* !BSP430! TYPE=A subst=TYPE instance=0,1,2,3 insert=hal_timer_isr_defn */
 /* BEGIN AUTOMATICALLY GENERATED CODE---DO NOT MODIFY [hal_timer_isr_defn] */
 #if (configBSP430_HAL_TA0_CC0_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(cc0_TA0)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER0_A0_VECTOR)
 isr_cc0_TA0 (void)
 {
   hBSP430halTIMER timer = BSP430_HAL_TA0;
-  int rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(cc0_TA0);
+  rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
   if (rv & BSP430_HAL_ISR_CALLBACK_DISABLE_INTERRUPT) {
     timer->hpl->cctl[0] &= ~CCIE;
   }
+  BSP430_ISRSTATS_EXIT_NI(cc0_TA0);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_TA0_CC0_ISR */
 
 #if (configBSP430_HAL_TA0_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(TA0)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER0_A1_VECTOR)
 isr_TA0 (void)
 {
   hBSP430halTIMER timer = BSP430_HAL_TA0;
   unsigned int iv = TA0IV;
   int rv = 0;
+
+  BSP430_ISRSTATS_ENTER_NI(TA0);
   if (0 != iv) {
     if (TA_OVERFLOW == iv) {
       ++timer->overflow_count;
@@ -977,30 +1390,39 @@ isr_TA0 (void)
       }
     }
   }
+  BSP430_ISRSTATS_EXIT_NI(TA0);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_TA0_ISR */
 
 #if (configBSP430_HAL_TA1_CC0_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(cc0_TA1)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER1_A0_VECTOR)
 isr_cc0_TA1 (void)
 {
   hBSP430halTIMER timer = BSP430_HAL_TA1;
-  int rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(cc0_TA1);
+  rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
   if (rv & BSP430_HAL_ISR_CALLBACK_DISABLE_INTERRUPT) {
     timer->hpl->cctl[0] &= ~CCIE;
   }
+  BSP430_ISRSTATS_EXIT_NI(cc0_TA1);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_TA1_CC0_ISR */
 
 #if (configBSP430_HAL_TA1_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(TA1)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER1_A1_VECTOR)
 isr_TA1 (void)
 {
   hBSP430halTIMER timer = BSP430_HAL_TA1;
   unsigned int iv = TA1IV;
   int rv = 0;
+
+  BSP430_ISRSTATS_ENTER_NI(TA1);
   if (0 != iv) {
     if (TA_OVERFLOW == iv) {
       ++timer->overflow_count;
@@ -1016,30 +1438,39 @@ isr_TA1 (void)
       }
     }
   }
+  BSP430_ISRSTATS_EXIT_NI(TA1);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_TA1_ISR */
 
 #if (configBSP430_HAL_TA2_CC0_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(cc0_TA2)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER2_A0_VECTOR)
 isr_cc0_TA2 (void)
 {
   hBSP430halTIMER timer = BSP430_HAL_TA2;
-  int rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(cc0_TA2);
+  rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
   if (rv & BSP430_HAL_ISR_CALLBACK_DISABLE_INTERRUPT) {
     timer->hpl->cctl[0] &= ~CCIE;
   }
+  BSP430_ISRSTATS_EXIT_NI(cc0_TA2);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_TA2_CC0_ISR */
 
 #if (configBSP430_HAL_TA2_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(TA2)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER2_A1_VECTOR)
 isr_TA2 (void)
 {
   hBSP430halTIMER timer = BSP430_HAL_TA2;
   unsigned int iv = TA2IV;
   int rv = 0;
+
+  BSP430_ISRSTATS_ENTER_NI(TA2);
   if (0 != iv) {
     if (TA_OVERFLOW == iv) {
       ++timer->overflow_count;
@@ -1055,30 +1486,39 @@ isr_TA2 (void)
       }
     }
   }
+  BSP430_ISRSTATS_EXIT_NI(TA2);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_TA2_ISR */
 
 #if (configBSP430_HAL_TA3_CC0_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(cc0_TA3)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER3_A0_VECTOR)
 isr_cc0_TA3 (void)
 {
   hBSP430halTIMER timer = BSP430_HAL_TA3;
-  int rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(cc0_TA3);
+  rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
   if (rv & BSP430_HAL_ISR_CALLBACK_DISABLE_INTERRUPT) {
     timer->hpl->cctl[0] &= ~CCIE;
   }
+  BSP430_ISRSTATS_EXIT_NI(cc0_TA3);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_TA3_CC0_ISR */
 
 #if (configBSP430_HAL_TA3_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(TA3)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER3_A1_VECTOR)
 isr_TA3 (void)
 {
   hBSP430halTIMER timer = BSP430_HAL_TA3;
   unsigned int iv = TA3IV;
   int rv = 0;
+
+  BSP430_ISRSTATS_ENTER_NI(TA3);
   if (0 != iv) {
     if (TA_OVERFLOW == iv) {
       ++timer->overflow_count;
@@ -1094,6 +1534,7 @@ isr_TA3 (void)
       }
     }
   }
+  BSP430_ISRSTATS_EXIT_NI(TA3);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_TA3_ISR */
@@ -1103,25 +1544,33 @@ isr_TA3 (void)
 /* !BSP430! TYPE=B subst=TYPE instance=0,1,2 insert=hal_timer_isr_defn */
 /* BEGIN AUTOMATICALLY GENERATED CODE---DO NOT MODIFY [hal_timer_isr_defn] */
 #if (configBSP430_HAL_TB0_CC0_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(cc0_TB0)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER0_B0_VECTOR)
 isr_cc0_TB0 (void)
 {
   hBSP430halTIMER timer = BSP430_HAL_TB0;
-  int rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(cc0_TB0);
+  rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
   if (rv & BSP430_HAL_ISR_CALLBACK_DISABLE_INTERRUPT) {
     timer->hpl->cctl[0] &= ~CCIE;
   }
+  BSP430_ISRSTATS_EXIT_NI(cc0_TB0);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_TB0_CC0_ISR */
 
 #if (configBSP430_HAL_TB0_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(TB0)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER0_B1_VECTOR)
 isr_TB0 (void)
 {
   hBSP430halTIMER timer = BSP430_HAL_TB0;
   unsigned int iv = TB0IV;
   int rv = 0;
+
+  BSP430_ISRSTATS_ENTER_NI(TB0);
   if (0 != iv) {
     if (TB_OVERFLOW == iv) {
       ++timer->overflow_count;
@@ -1137,30 +1586,39 @@ isr_TB0 (void)
       }
     }
   }
+  BSP430_ISRSTATS_EXIT_NI(TB0);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_TB0_ISR */
 
 #if (configBSP430_HAL_TB1_CC0_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(cc0_TB1)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER1_B0_VECTOR)
 isr_cc0_TB1 (void)
 {
   hBSP430halTIMER timer = BSP430_HAL_TB1;
-  int rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(cc0_TB1);
+  rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
   if (rv & BSP430_HAL_ISR_CALLBACK_DISABLE_INTERRUPT) {
     timer->hpl->cctl[0] &= ~CCIE;
   }
+  BSP430_ISRSTATS_EXIT_NI(cc0_TB1);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_TB1_CC0_ISR */
 
 #if (configBSP430_HAL_TB1_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(TB1)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER1_B1_VECTOR)
 isr_TB1 (void)
 {
   hBSP430halTIMER timer = BSP430_HAL_TB1;
   unsigned int iv = TB1IV;
   int rv = 0;
+
+  BSP430_ISRSTATS_ENTER_NI(TB1);
   if (0 != iv) {
     if (TB_OVERFLOW == iv) {
       ++timer->overflow_count;
@@ -1176,30 +1634,39 @@ isr_TB1 (void)
       }
     }
   }
+  BSP430_ISRSTATS_EXIT_NI(TB1);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_TB1_ISR */
 
 #if (configBSP430_HAL_TB2_CC0_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(cc0_TB2)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER2_B0_VECTOR)
 isr_cc0_TB2 (void)
 {
   hBSP430halTIMER timer = BSP430_HAL_TB2;
-  int rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
+  int rv;
+
+  BSP430_ISRSTATS_ENTER_NI(cc0_TB2);
+  rv = iBSP430callbackInvokeISRIndexed_ni(0 + timer->cc_cbchain_ni, timer, 0, 0);
   if (rv & BSP430_HAL_ISR_CALLBACK_DISABLE_INTERRUPT) {
     timer->hpl->cctl[0] &= ~CCIE;
   }
+  BSP430_ISRSTATS_EXIT_NI(cc0_TB2);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_TB2_CC0_ISR */
 
 #if (configBSP430_HAL_TB2_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(TB2)
 BSP430_CORE_DECLARE_INTERRUPT(TIMER2_B1_VECTOR)
 isr_TB2 (void)
 {
   hBSP430halTIMER timer = BSP430_HAL_TB2;
   unsigned int iv = TB2IV;
   int rv = 0;
+
+  BSP430_ISRSTATS_ENTER_NI(TB2);
   if (0 != iv) {
     if (TB_OVERFLOW == iv) {
       ++timer->overflow_count;
@@ -1215,6 +1682,7 @@ isr_TB2 (void)
       }
     }
   }
+  BSP430_ISRSTATS_EXIT_NI(TB2);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* configBSP430_HAL_TB2_ISR */
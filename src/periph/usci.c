@@ -396,17 +396,31 @@ iBSP430usciSPITxRx_rh (hBSP430halSERIAL hal,
   if (hal->tx_cbchain_ni) {
     return -1;
   }
-  rxp = rx_data;
-  if (NULL == rx_data)  {
-    rxp = &rx_dummy;
+  if (NULL == rx_data) {
+    /* Nothing to keep: load TXBUF as soon as it empties, and discard
+     * the received data once the last octet has been shifted out. */
+    while (i < transaction_length) {
+      uint8_t txd = (i < tx_len) ? tx_data[i] : BSP430_SERIAL_SPI_READ_TX_BYTE(i-tx_len);
+      RAW_TRANSMIT_HAL_RH(hal, txd);
+      ++i;
+    }
+    /* UCBUSY may not yet be set for an octet still in TXBUF */
+    while (! (SERIAL_HAL_HPLAUX(hal)->tx_bit & *SERIAL_HAL_HPLAUX(hal)->ifgp)) {
+      ;
+    }
+    FLUSH_HAL_NI(hal);
+    /* Clears UCRXIFG and UCOE */
+    rx_dummy = SERIAL_HAL_HPL(hal)->rxbuf;
+    (void)rx_dummy;
+    hal->num_rx += i;
+    return i;
   }
+  rxp = rx_data;
   while (i < transaction_length) {
     uint8_t txd = (i < tx_len) ? tx_data[i] : BSP430_SERIAL_SPI_READ_TX_BYTE(i-tx_len);
     RAW_TRANSMIT_HAL_RH(hal, txd);
     RAW_RECEIVE_HAL_RH(hal, *rxp);
-    if (rx_data) {
-      ++rxp;
-    }
+    ++rxp;
     ++i;
   }
   return i;
@@ -679,12 +693,14 @@ usciabrx_isr (hBSP430halSERIAL hal)
 }
 
 #if (configBSP430_HAL_USCI_AB0RX_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(USCI_AB0RX)
 BSP430_CORE_DECLARE_INTERRUPT(USCIAB0RX_VECTOR)
 isr_USCI_AB0RX (void)
 {
   hBSP430halSERIAL usci = NULL;
   int rv = 0;
 
+  BSP430_ISRSTATS_ENTER_NI(USCI_AB0RX);
   if (0) {
   }
 #if (configBSP430_HAL_USCI_A0 - 0)
@@ -700,17 +716,20 @@ isr_USCI_AB0RX (void)
   if (usci) {
     rv = usciabrx_isr(usci);
   }
+  BSP430_ISRSTATS_EXIT_NI(USCI_AB0RX);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* HAL USCI_AB0RX ISR */
 
 #if (configBSP430_HAL_USCI_AB1RX_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(USCI_AB1RX)
 BSP430_CORE_DECLARE_INTERRUPT(USCIAB1RX_VECTOR)
 isr_USCI_AB1RX (void)
 {
   hBSP430halSERIAL usci = NULL;
   int rv = 0;
 
+  BSP430_ISRSTATS_ENTER_NI(USCI_AB1RX);
   if (0) {
   }
 #if (configBSP430_HAL_USCI_A1 - 0)
@@ -726,6 +745,7 @@ isr_USCI_AB1RX (void)
   if (usci) {
     rv = usciabrx_isr(usci);
   }
+  BSP430_ISRSTATS_EXIT_NI(USCI_AB1RX);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* HAL USCI_AB1RX ISR */
@@ -765,12 +785,14 @@ usciabtx_isr (hBSP430halSERIAL hal)
 }
 
 #if (configBSP430_HAL_USCI_AB0TX_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(USCI_AB0TX)
 BSP430_CORE_DECLARE_INTERRUPT(USCIAB0TX_VECTOR)
 isr_USCI_AB0TX (void)
 {
   int rv = 0;
   hBSP430halSERIAL usci = NULL;
 
+  BSP430_ISRSTATS_ENTER_NI(USCI_AB0TX);
   if (0) {
   }
 #if (configBSP430_HAL_USCI_A0 - 0)
@@ -786,17 +808,20 @@ isr_USCI_AB0TX (void)
   if (usci) {
     rv = usciabtx_isr(usci);
   }
+  BSP430_ISRSTATS_EXIT_NI(USCI_AB0TX);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* HAL USCI_AB0TX ISR */
 
 #if (configBSP430_HAL_USCI_AB1TX_ISR - 0)
+BSP430_ISRSTATS_DEFINE_VECTOR(USCI_AB1TX)
 BSP430_CORE_DECLARE_INTERRUPT(USCIAB1TX_VECTOR)
 isr_USCI_AB1TX (void)
 {
   int rv = 0;
   hBSP430halSERIAL usci = NULL;
 
+  BSP430_ISRSTATS_ENTER_NI(USCI_AB1TX);
   if (0) {
   }
 #if (configBSP430_HAL_USCI_A1 - 0)
@@ -812,6 +837,7 @@ isr_USCI_AB1TX (void)
   if (usci) {
     rv = usciabtx_isr(usci);
   }
+  BSP430_ISRSTATS_EXIT_NI(USCI_AB1TX);
   BSP430_HAL_ISR_CALLBACK_TAIL_NI(rv);
 }
 #endif /* HAL USCI_AB1TX ISR */
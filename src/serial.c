@@ -77,3 +77,207 @@ uiBSP430serialSMCLKPrescaler (unsigned long freq_Hz)
   }
   return (unsigned int)prescaler;
 }
+
+#if (configBSP430_SERIAL_ENABLE_SPI - 0)
+
+/* The transmit callback node is the first member of the transaction,
+ * so its address is that of the transaction.  Provide the next octet
+ * only once the response to the previous one has been received, and
+ * disable the transmit interrupt until the receive callback re-enables
+ * it. */
+static int
+spi_tx_isr_ni (const struct sBSP430halISRVoidChainNode * cb,
+               void * context)
+{
+  hBSP430spiTransaction xfer = (hBSP430spiTransaction)cb;
+  hBSP430halSERIAL hal = (hBSP430halSERIAL)context;
+  size_t i = xfer->tx_count_ni;
+
+  if ((! (BSP430_SPI_TRANSACTION_FLAG_ACTIVE & xfer->flags_ni))
+      || (i != xfer->rx_count_ni)) {
+    return 0;
+  }
+  hal->tx_byte = (i < xfer->tx_len) ? xfer->tx_data[i] : BSP430_SERIAL_SPI_READ_TX_BYTE(i - xfer->tx_len);
+  xfer->tx_count_ni = i + 1;
+  return BSP430_HAL_ISR_CALLBACK_BREAK_CHAIN | BSP430_HAL_ISR_CALLBACK_DISABLE_INTERRUPT;
+}
+
+static int
+spi_rx_isr_ni (const struct sBSP430halISRVoidChainNode * cb,
+               void * context)
+{
+  hBSP430spiTransaction xfer = (hBSP430spiTransaction)((const char *)cb - offsetof(sBSP430spiTransaction, rx_cb_node));
+  hBSP430halSERIAL hal = (hBSP430halSERIAL)context;
+  size_t i = xfer->rx_count_ni;
+
+  /* Ignore anything not solicited by this transaction */
+  if ((! (BSP430_SPI_TRANSACTION_FLAG_ACTIVE & xfer->flags_ni))
+      || (i >= xfer->tx_count_ni)) {
+    return 0;
+  }
+  if (NULL != xfer->rx_data) {
+    xfer->rx_data[i] = hal->rx_byte;
+  }
+  xfer->rx_count_ni = ++i;
+  if (i < (xfer->tx_len + xfer->rx_len)) {
+    vBSP430serialWakeupTransmit_rh(hal);
+    return 0;
+  }
+  xfer->flags_ni &= ~BSP430_SPI_TRANSACTION_FLAG_ACTIVE;
+  if (NULL != xfer->callback_ni) {
+    return xfer->callback_ni(xfer);
+  }
+  return BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
+}
+
+int
+iBSP430spiTxRxAsync_ni (hBSP430halSERIAL hal,
+                        hBSP430spiTransaction xfer,
+                        const uint8_t * tx_data,
+                        size_t tx_len,
+                        size_t rx_len,
+                        uint8_t * rx_data,
+                        iBSP430spiTransactionCallback_ni callback_ni)
+{
+  unsigned int isr_flags = BSP430_PERIPH_HAL_STATE_CFLAGS_ISR;
+  int linked;
+
+  if ((NULL == hal) || (NULL == xfer) || (0 == (tx_len + rx_len))) {
+    return -1;
+  }
+  /* The 2xx/4xx USCI has separate transmit and receive handlers */
+  if (BSP430_SERIAL_HAL_HPL_VARIANT_IS_USCI(hal)) {
+    isr_flags |= BSP430_PERIPH_HAL_STATE_CFLAGS_ISR2;
+  }
+  if (isr_flags != (isr_flags & hal->hal_state.cflags)) {
+    return -1;
+  }
+  linked = (&xfer->tx_cb_node == hal->tx_cbchain_ni) && (&xfer->rx_cb_node == hal->rx_cbchain_ni);
+  if (linked) {
+    if (BSP430_SPI_TRANSACTION_FLAG_ACTIVE & xfer->flags_ni) {
+      return -1;
+    }
+  } else if ((NULL != hal->tx_cbchain_ni) || (NULL != hal->rx_cbchain_ni)) {
+    return -1;
+  }
+  xfer->hal = hal;
+  xfer->tx_data = tx_data;
+  xfer->tx_len = tx_len;
+  xfer->rx_len = rx_len;
+  xfer->rx_data = rx_data;
+  xfer->callback_ni = callback_ni;
+  xfer->tx_count_ni = 0;
+  xfer->rx_count_ni = 0;
+  xfer->flags_ni = BSP430_SPI_TRANSACTION_FLAG_ACTIVE;
+  if (! linked) {
+    xfer->tx_cb_node.callback_ni = spi_tx_isr_ni;
+    xfer->rx_cb_node.callback_ni = spi_rx_isr_ni;
+    BSP430_HAL_ISR_CALLBACK_LINK_NI(sBSP430halISRVoidChainNode, hal->tx_cbchain_ni, xfer->tx_cb_node, next_ni);
+    BSP430_HAL_ISR_CALLBACK_LINK_NI(sBSP430halISRVoidChainNode, hal->rx_cbchain_ni, xfer->rx_cb_node, next_ni);
+    /* Leaving reset with a receive callback enables the receive
+     * interrupt */
+    (void)iBSP430serialSetReset_rh(hal, 0);
+  }
+  vBSP430serialWakeupTransmit_rh(hal);
+  return 0;
+}
+
+int
+iBSP430spiTxRxAsyncRelease_ni (hBSP430spiTransaction xfer)
+{
+  hBSP430halSERIAL hal = xfer->hal;
+
+  if (BSP430_SPI_TRANSACTION_FLAG_ACTIVE & xfer->flags_ni) {
+    return -1;
+  }
+  if (NULL != hal) {
+    BSP430_HAL_ISR_CALLBACK_UNLINK_NI(sBSP430halISRVoidChainNode, hal->tx_cbchain_ni, xfer->tx_cb_node, next_ni);
+    BSP430_HAL_ISR_CALLBACK_UNLINK_NI(sBSP430halISRVoidChainNode, hal->rx_cbchain_ni, xfer->rx_cb_node, next_ni);
+    /* Entering reset clears the interrupt enables; leaving it without
+     * a receive callback leaves them clear for polled use. */
+    (void)iBSP430serialSetReset_rh(hal, -1);
+    (void)iBSP430serialSetReset_rh(hal, 0);
+    xfer->hal = NULL;
+  }
+  return 0;
+}
+
+#endif /* configBSP430_SERIAL_ENABLE_SPI */
+
+#if (configBSP430_SERIAL_ENABLE_I2C - 0)
+
+hBSP430i2cQueue
+hBSP430i2cQueueInitialize_ni (hBSP430i2cQueue queue,
+                              hBSP430halSERIAL hal)
+{
+  if ((NULL == queue) || (NULL == hal)
+      || (NULL == hal->dispatch->i2cQueueISR_ni)
+      || (! (BSP430_PERIPH_HAL_STATE_CFLAGS_ISR & hal->hal_state.cflags))
+      || (NULL != hal->i2c_cbchain_ni)) {
+    return NULL;
+  }
+  queue->hal = hal;
+  queue->head_ni = queue->tail_ni = NULL;
+  queue->index_ni = 0;
+  queue->state_ni = 0;
+  queue->cb_node.callback_ni = hal->dispatch->i2cQueueISR_ni;
+  BSP430_HAL_ISR_CALLBACK_LINK_NI(sBSP430halISRIndexedChainNode, hal->i2c_cbchain_ni, queue->cb_node, next_ni);
+  return queue;
+}
+
+int
+iBSP430i2cQueueSubmit_ni (hBSP430i2cQueue queue,
+                          hBSP430i2cTransaction xfer)
+{
+  if ((NULL == queue->hal)
+      || (BSP430_I2C_TRANSACTION_PENDING == xfer->result_ni)
+      || (0 == (xfer->tx_len + xfer->rx_len))) {
+    return -1;
+  }
+  xfer->next_ni = NULL;
+  xfer->result_ni = BSP430_I2C_TRANSACTION_PENDING;
+  if (NULL == queue->head_ni) {
+    queue->head_ni = queue->tail_ni = xfer;
+    queue->hal->dispatch->i2cQueueStart_ni(queue);
+  } else {
+    queue->tail_ni->next_ni = xfer;
+    queue->tail_ni = xfer;
+  }
+  return 0;
+}
+
+int
+iBSP430i2cQueueComplete_ni (hBSP430i2cQueue queue,
+                            int result)
+{
+  hBSP430i2cTransaction xfer = queue->head_ni;
+
+  queue->head_ni = xfer->next_ni;
+  xfer->next_ni = NULL;
+  xfer->result_ni = result;
+  /* Keep the bus busy while the callback runs */
+  if (NULL != queue->head_ni) {
+    queue->hal->dispatch->i2cQueueStart_ni(queue);
+  }
+  if (NULL != xfer->callback_ni) {
+    return xfer->callback_ni(xfer);
+  }
+  return BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
+}
+
+int
+iBSP430i2cQueueRelease_ni (hBSP430i2cQueue queue)
+{
+  hBSP430halSERIAL hal = queue->hal;
+
+  if (NULL != queue->head_ni) {
+    return -1;
+  }
+  if (NULL != hal) {
+    BSP430_HAL_ISR_CALLBACK_UNLINK_NI(sBSP430halISRIndexedChainNode, hal->i2c_cbchain_ni, queue->cb_node, next_ni);
+    queue->hal = NULL;
+  }
+  return 0;
+}
+
+#endif /* configBSP430_SERIAL_ENABLE_I2C */
@@ -43,6 +43,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 
 static iBSP430cliDiagnosticFunction diagnosticFunction = &iBSP430cliNullDiagnostic;
 
@@ -141,6 +142,202 @@ xBSP430cliNextQToken (const char ** commandp,
   return rv;
 }
 
+int
+iBSP430cliTokenize (const char * command,
+                    size_t command_len,
+                    sBSP430cliToken * tokens,
+                    unsigned int max_tokens)
+{
+  const char * const ep = command + command_len;
+  const char * cp = command;
+  int ntokens = 0;
+
+  while (1) {
+    const char * tp;
+
+    /* Skip leading space up to end of input */
+    while ((cp < ep) && isspace((unsigned char)*cp)) {
+      ++cp;
+    }
+    if ((cp >= ep) || (0 == *cp)) {
+      break;
+    }
+    if (max_tokens <= ntokens) {
+      return -eBSP430_CLI_ERR_Invalid;
+    }
+    tokens->quoted = 0;
+    tp = cp;
+    if (('\'' == *cp) || ('"' == *cp)) {
+      const char * qp = cp + 1;
+
+      /* Same rules as xBSP430cliNextQToken(): the end quote must be
+       * followed by the end of input, a NUL, or a space. */
+      while ((qp < ep) && (*qp != *cp)) {
+        ++qp;
+      }
+      if ((qp < ep)
+          && (((qp + 1) >= ep)
+              || (0 == qp[1])
+              || isspace((unsigned char)qp[1]))) {
+        tokens->text = cp + 1;
+        tokens->len = qp - tokens->text;
+        tokens->quoted = 1;
+        ++tokens;
+        ++ntokens;
+        cp = qp + 1;
+        continue;
+      }
+    }
+    /* Skip non-space up to end of input */
+    while ((cp < ep) && ! isspace((unsigned char)*cp)) {
+      ++cp;
+    }
+    tokens->text = tp;
+    tokens->len = cp - tp;
+    ++tokens;
+    ++ntokens;
+  }
+  return ntokens;
+}
+
+/* Extract the sign and magnitude of an integer token, accepting the
+ * same syntax as strtoul() with base zero but requiring that the
+ * entire token be consumed and that the magnitude fit in an unsigned
+ * long. */
+static int
+tokenMagnitude_ (const sBSP430cliToken * tp,
+                 int * negp,
+                 unsigned long * vp)
+{
+  const char * cp = tp->text;
+  const char * const ep = cp + tp->len;
+  unsigned int base = 10;
+  unsigned long limit;
+  unsigned int limit_digit;
+  unsigned long v = 0;
+  int neg = 0;
+
+  if (0 == tp->len) {
+    return -eBSP430_CLI_ERR_Missing;
+  }
+  if (('-' == *cp) || ('+' == *cp)) {
+    neg = ('-' == *cp);
+    ++cp;
+  }
+  if ((cp < ep) && ('0' == *cp)) {
+    base = 8;
+    if (((cp + 1) < ep) && ('x' == (0x20 | cp[1]))) {
+      base = 16;
+      cp += 2;
+    }
+  }
+  if (cp >= ep) {
+    return -eBSP430_CLI_ERR_Invalid;
+  }
+  /* Constant divisions only; no division is done per digit. */
+  if (16 == base) {
+    limit = ULONG_MAX / 16;
+  } else if (8 == base) {
+    limit = ULONG_MAX / 8;
+  } else {
+    limit = ULONG_MAX / 10;
+  }
+  limit_digit = (unsigned int)(ULONG_MAX - limit * base);
+  while (cp < ep) {
+    unsigned int d = (unsigned char)*cp++;
+
+    if (('0' <= d) && (d <= '9')) {
+      d -= '0';
+    } else {
+      d |= 0x20;
+      if (('a' <= d) && (d <= 'f')) {
+        d -= 'a' - 10;
+      } else {
+        return -eBSP430_CLI_ERR_Invalid;
+      }
+    }
+    if ((base <= d)
+        || (limit < v)
+        || ((limit == v) && (limit_digit < d))) {
+      return -eBSP430_CLI_ERR_Invalid;
+    }
+    v = (v * base) + d;
+  }
+  *negp = neg;
+  *vp = v;
+  return 0;
+}
+
+#define GEN_TOKEN_AS_UNSIGNED(tag_,type_,max_)                          \
+  int                                                                   \
+  iBSP430cliTokenAs##tag_ (const sBSP430cliToken * tp,                  \
+                           type_ * destp)                               \
+  {                                                                     \
+    unsigned long v;                                                    \
+    int neg;                                                            \
+    int rv = tokenMagnitude_(tp, &neg, &v);                             \
+                                                                        \
+    if (0 == rv) {                                                      \
+      if ((max_) < v) {                                                 \
+        return -eBSP430_CLI_ERR_Invalid;                                \
+      }                                                                 \
+      *destp = neg ? -(type_)v : (type_)v;                              \
+    }                                                                   \
+    return rv;                                                          \
+  }
+
+#define GEN_TOKEN_AS_SIGNED(tag_,type_,max_)                            \
+  int                                                                   \
+  iBSP430cliTokenAs##tag_ (const sBSP430cliToken * tp,                  \
+                           type_ * destp)                               \
+  {                                                                     \
+    unsigned long v;                                                    \
+    int neg;                                                            \
+    int rv = tokenMagnitude_(tp, &neg, &v);                             \
+                                                                        \
+    if (0 == rv) {                                                      \
+      if ((neg ? (1UL + (max_)) : (unsigned long)(max_)) < v) {         \
+        return -eBSP430_CLI_ERR_Invalid;                                \
+      }                                                                 \
+      /* Negate as v-1 so that the most negative value does not */      \
+      /* overflow type_. */                                             \
+      *destp = (neg && v) ? (-(type_)(v - 1) - 1) : (type_)v;           \
+    }                                                                   \
+    return rv;                                                          \
+  }
+
+GEN_TOKEN_AS_UNSIGNED(UI,unsigned int,UINT_MAX)
+GEN_TOKEN_AS_UNSIGNED(UL,unsigned long int,ULONG_MAX)
+GEN_TOKEN_AS_SIGNED(I,int,INT_MAX)
+GEN_TOKEN_AS_SIGNED(L,long int,LONG_MAX)
+#undef GEN_TOKEN_AS_SIGNED
+#undef GEN_TOKEN_AS_UNSIGNED
+
+#if (configBSP430_CLI_COMMAND_INDEX - 0)
+/* Return the position of the first command in the indexed set cmds
+ * whose key is not less than the len-character prefix key.  Keys with
+ * that prefix occupy a contiguous range starting here. */
+static unsigned int
+indexedLowerBound_ (const sBSP430cliCommand * cmds,
+                    const char * key,
+                    size_t len)
+{
+  unsigned int lo = 0;
+  unsigned int hi = cmds->indexed_count;
+
+  while (lo < hi) {
+    unsigned int mid = lo + ((hi - lo) >> 1);
+
+    if (0 > strncmp(cmds[mid].key, key, len)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+#endif /* configBSP430_CLI_COMMAND_INDEX */
+
 int
 iBSP430cliMatchCommand (const sBSP430cliCommand * cmds,
                         const char * command,
@@ -163,6 +360,21 @@ iBSP430cliMatchCommand (const sBSP430cliCommand * cmds,
     *argstr_lenp = command_len;
   }
   nmatches = 0;
+#if (configBSP430_CLI_COMMAND_INDEX - 0)
+  if (cmds && (0 != cmds->indexed_count)) {
+    const sBSP430cliCommand * const ecmds = cmds + cmds->indexed_count;
+
+    cmds += indexedLowerBound_(cmds, key, len);
+    while ((cmds < ecmds) && (0 == strncmp(key, cmds->key, len))) {
+      ++nmatches;
+      if (0 != match_callback) {
+        match_callback->callback(match_callback, cmds);
+      }
+      match = cmds++;
+    }
+    cmds = NULL;
+  }
+#endif /* configBSP430_CLI_COMMAND_INDEX */
   while (cmds) {
     if (0 == strncmp(key, cmds->key, len)) {
       ++nmatches;
@@ -259,6 +471,124 @@ iBSP430cliParseCommand (const sBSP430cliCommand * cmds,
   return processSubcommand_(NULL, cmds, param, command, strlen(command), chain_handler, handler);
 }
 
+/* Octet that begins a command in erased flash */
+#define SCRIPT_ERASED 0xFF
+
+/* Execute one len-character command from a script.  Commands with no
+ * tokens, and comments, succeed without being executed. */
+static int
+executeScriptCommand_ (const sBSP430cliCommand * cmds,
+                       void * param,
+                       const char * command,
+                       size_t command_len)
+{
+  const char * cp = command;
+  size_t remaining = command_len;
+  const char * key;
+  size_t key_len;
+
+  key = xBSP430cliNextToken(&cp, &remaining, &key_len);
+  if ((0 == key_len) || ('#' == *key)) {
+    return 0;
+  }
+  return processSubcommand_(NULL, cmds, param, command, command_len, NULL, NULL);
+}
+
+int
+iBSP430cliExecuteScript (const sBSP430cliCommand * cmds,
+                         void * param,
+                         const char * script,
+                         size_t script_len,
+                         unsigned int * linep)
+{
+  const char * const ep = script + script_len;
+  unsigned int line = 0;
+  int rv = 0;
+
+  while ((script < ep)
+         && (0 != *script)
+         && (SCRIPT_ERASED != (unsigned char)*script)) {
+    const char * np = memchr(script, 0, ep - script);
+
+    ++line;
+    if (NULL == np) {
+      rv = -eBSP430_CLI_ERR_Invalid;
+      break;
+    }
+    rv = executeScriptCommand_(cmds, param, script, np - script);
+    if (0 != rv) {
+      break;
+    }
+    script = np + 1;
+  }
+  if (NULL != linep) {
+    *linep = line;
+  }
+  return rv;
+}
+
+int
+iBSP430cliExecuteScriptStream (const sBSP430cliCommand * cmds,
+                               void * param,
+                               iBSP430cliScriptReadFunction read_fn,
+                               void * context,
+                               char * buffer,
+                               size_t buffer_len,
+                               unsigned int * linep)
+{
+  unsigned int line = 0;
+  size_t have = 0;
+  int at_end = 0;
+  int rv = 0;
+
+  while (1) {
+    char * np = memchr(buffer, 0, have);
+    size_t len;
+
+    /* Read until the buffer holds a complete command or the script
+     * is exhausted. */
+    while ((NULL == np) && (! at_end) && (have < buffer_len)) {
+      int nr = read_fn(context, buffer + have, buffer_len - have);
+
+      if (0 > nr) {
+        rv = nr;
+        break;
+      }
+      if (0 == nr) {
+        at_end = 1;
+      }
+      np = memchr(buffer + have, 0, nr);
+      have += nr;
+    }
+    if ((0 != rv)
+        || (0 == have)
+        || (0 == buffer[0])
+        || (SCRIPT_ERASED == (unsigned char)buffer[0])) {
+      if (0 != rv) {
+        ++line;
+      }
+      break;
+    }
+    ++line;
+    if (NULL == np) {
+      /* Unterminated at end of script, or too long for the buffer */
+      rv = -eBSP430_CLI_ERR_Invalid;
+      break;
+    }
+    len = np - buffer;
+    rv = executeScriptCommand_(cmds, param, buffer, len);
+    if (0 != rv) {
+      break;
+    }
+    have -= len + 1;
+    memmove(buffer, np + 1, have);
+  }
+  if (NULL != linep) {
+    *linep = line;
+  }
+  return rv;
+}
+
 int
 iBSP430cliHandlerSimple (sBSP430cliCommandLink * chain,
                          void * param,
@@ -271,48 +601,52 @@ iBSP430cliHandlerSimple (sBSP430cliCommandLink * chain,
   return ((iBSP430cliSimpleHandler)chain->cmd->param.simple_handler)(argstr);
 }
 
-#define GEN_STORE_EXTRACTED_VALUE(tag_,type_,strtov_,maxvalstr_)        \
+int
+iBSP430cliHandlerArgv (sBSP430cliCommandLink * chain,
+                       void * param,
+                       const char * argstr,
+                       size_t argstr_len)
+{
+  sBSP430cliToken argv[BSP430_CLI_ARGV_MAX];
+  int argc;
+
+  if (0 == chain->cmd->param.argv_handler) {
+    return diagnosticFunction(chain, eBSP430_CLI_ERR_Config, argstr, argstr_len);
+  }
+  argc = iBSP430cliTokenize(argstr, argstr_len, argv, sizeof(argv)/sizeof(*argv));
+  if (0 > argc) {
+    return diagnosticFunction(chain, eBSP430_CLI_ERR_Invalid, argstr, argstr_len);
+  }
+  return chain->cmd->param.argv_handler(chain, argc, argv);
+}
+
+#define GEN_STORE_EXTRACTED_VALUE(tag_,type_)                          \
   int                                                                   \
   iBSP430cliStoreExtracted##tag_ (const char * * argstrp,               \
                                   size_t * argstr_lenp,                 \
                                   type_ * destp)                        \
   {                                                                     \
-    char buffer[sizeof(maxvalstr_)];                                    \
-    char * ep;                                                          \
+    sBSP430cliToken token;                                              \
     const char * argstr = *argstrp;                                     \
     size_t argstr_len = *argstr_lenp;                                   \
-    const char * vstr;                                                  \
-    size_t len;                                                         \
-    type_ v;                                                            \
+    int rv;                                                             \
                                                                         \
-    vstr = xBSP430cliNextToken(&argstr, &argstr_len, &len);             \
-    if (0 == len) {                                                     \
-      return -eBSP430_CLI_ERR_Missing;                                  \
+    token.text = xBSP430cliNextToken(&argstr, &argstr_len, &token.len); \
+    rv = iBSP430cliTokenAs##tag_(&token, destp);                        \
+    if (0 == rv) {                                                      \
+      *argstrp = argstr;                                                \
+      *argstr_lenp = argstr_len;                                        \
     }                                                                   \
-    if (sizeof(buffer)-1 < len) {                                       \
-      return -eBSP430_CLI_ERR_Invalid;                                  \
-    }                                                                   \
-    memcpy(buffer, vstr, len);                                          \
-    buffer[len] = 0;                                                    \
-    v = strtov_(buffer, &ep, 0);                                        \
-    if (*ep) {                                                          \
-      return -eBSP430_CLI_ERR_Invalid;                                  \
-    }                                                                   \
-    *destp = v;                                                         \
-    *argstrp = argstr;                                                  \
-    *argstr_lenp = argstr_len;                                          \
-    return 0;                                                           \
+    return rv;                                                          \
   }
 
-/* The text representations with the greatest length are the
- * ones that use octal. */
-GEN_STORE_EXTRACTED_VALUE(UI,unsigned int,strtoul,"0177777")
-GEN_STORE_EXTRACTED_VALUE(UL,unsigned long int,strtoul,"037777777777")
-GEN_STORE_EXTRACTED_VALUE(I,int,strtol,"-0100000")
-GEN_STORE_EXTRACTED_VALUE(L,long int,strtol,"-020000000000")
+GEN_STORE_EXTRACTED_VALUE(UI,unsigned int)
+GEN_STORE_EXTRACTED_VALUE(UL,unsigned long int)
+GEN_STORE_EXTRACTED_VALUE(I,int)
+GEN_STORE_EXTRACTED_VALUE(L,long int)
 #undef GEN_STORE_EXTRACTED_VALUE
 
-#define GEN_STORE_VALUE_HANDLER(tag_,type_,strtov_,maxvalstr_)          \
+#define GEN_STORE_VALUE_HANDLER(tag_,type_)                             \
   int                                                                   \
   iBSP430cliHandlerStore##tag_ (struct sBSP430cliCommandLink * chain,   \
                                 void * param,                           \
@@ -334,10 +668,10 @@ GEN_STORE_EXTRACTED_VALUE(L,long int,strtol,"-020000000000")
 
 /* The text representations with the greatest length are the
  * ones that use octal. */
-GEN_STORE_VALUE_HANDLER(UI,unsigned int,strtoul,"0177777")
-GEN_STORE_VALUE_HANDLER(UL,unsigned long int,strtoul,"037777777777")
-GEN_STORE_VALUE_HANDLER(I,int,strtol,"-0100000")
-GEN_STORE_VALUE_HANDLER(L,long int,strtol,"-020000000000")
+GEN_STORE_VALUE_HANDLER(UI,unsigned int)
+GEN_STORE_VALUE_HANDLER(UL,unsigned long int)
+GEN_STORE_VALUE_HANDLER(I,int)
+GEN_STORE_VALUE_HANDLER(L,long int)
 
 #undef GEN_STORE_VALUE_HANDLER
 
@@ -532,11 +866,17 @@ iBSP430cliConsoleBufferProcessInput ()
 {
   int rv;
   int c;
+  int echo = 1;
 
   rv = 0;
   if (NULL == cbEnd_) {
     cbEnd_ = consoleBuffer_;
   }
+#if (0 < BSP430_CONSOLE_RX_BUFFER_SIZE) && (configBSP430_CONSOLE_RX_COOKED - 0)
+  /* The console line discipline has already echoed ordinary
+   * characters and applied any edits it could. */
+  echo = ! iBSP430consoleRxCooked();
+#endif /* configBSP430_CONSOLE_RX_COOKED */
   while (0 <= ((c = cgetchar()))) {
     if (KEY_BS == c) {
       if (cbEnd_ == consoleBuffer_) {
@@ -561,26 +901,35 @@ iBSP430cliConsoleBufferProcessInput ()
       cputchar('\n');
       rv |= eBSP430cliConsole_READY;
       break;
+    } else if (0 == c) {
+      /* A NUL would terminate the command early; discard it */
     } else if (KEY_KILL_LINE == c) {
       cprintf("\e[%uD\e[K", (unsigned int)(cbEnd_ - consoleBuffer_));
       cbEnd_ = consoleBuffer_;
       *cbEnd_ = 0;
     } else if (KEY_KILL_WORD == c) {
       char * kp = cbEnd_;
-      while (--kp > consoleBuffer_ && isspace((unsigned char)*kp)) {
+      /* Back over trailing space, then the word preceding it */
+      while ((kp > consoleBuffer_) && isspace((unsigned char)kp[-1])) {
+        --kp;
       }
-      while (--kp > consoleBuffer_ && !isspace((unsigned char)*kp)) {
+      while ((kp > consoleBuffer_) && !isspace((unsigned char)kp[-1])) {
+        --kp;
       }
-      ++kp;
       cprintf("\e[%uD\e[K", (unsigned int)(cbEnd_ - kp));
       cbEnd_ = kp;
       *cbEnd_ = 0;
     } else {
       if ((1+cbEnd_) >= (consoleBuffer_ + sizeof(consoleBuffer_))) {
+        if (! echo) {
+          cputtext("\b \b");
+        }
         cputchar(KEY_BEL);
       } else {
         *cbEnd_++ = c;
-        cputchar(c);
+        if (echo) {
+          cputchar(c);
+        }
       }
     }
   }
@@ -872,18 +1221,17 @@ iBSP430cliConsoleBufferCompletion (const sBSP430cliCommand * command_set,
   if (NULL != ccd.append) {
     size_t app_len = 0;
 
+    /* Count only what fit in the buffer */
     if (0 < ccd.append_len) {
-      app_len += ccd.append_len;
-      iBSP430cliConsoleBufferExtend(ccd.append, ccd.append_len);
+      app_len += iBSP430cliConsoleBufferExtend(ccd.append, ccd.append_len);
     }
     if (flags & eBSP430cliConsole_COMPLETE_SPACE) {
       flags &= ~eBSP430cliConsole_COMPLETE_SPACE;
-      iBSP430cliConsoleBufferExtend(" ", 1);
-      ++app_len;
+      app_len += iBSP430cliConsoleBufferExtend(" ", 1);
     }
     *commandp = xBSP430cliConsoleBuffer();
     if ((0 < app_len) && ! (flags & eBSP430cliConsole_REPAINT)) {
-      cputtext(*commandp + strlen(*commandp) - app_len);
+      cputchars(cbEnd_ - app_len, app_len);
     }
   } else {
     if (0 < ccd.ncandidates) {
@@ -39,62 +39,218 @@
 
 #include <bsp430/platform.h>
 #include <bsp430/utility/console.h>
+#include <bsp430/utility/format.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h>
-#include <ctype.h>
+#include <string.h>
 
 #if (BSP430_CONSOLE - 0)
-/* Inhibit definition if required components were not provided. */
-
-#if (BSP430_CONSOLE_USE_EMBTEXTF - 0)
-#define HAVE_EMBTEXTF 1
-#include <embtextf/uprintf.h>
-#include <embtextf/xtoa.h>
-
-#define itoa embtextf_itoa
-#define utoa embtextf_utoa
-#define ltoa embtextf_ltoa
-#define ultoa embtextf_ultoa
-#define vuprintf embtextf_vuprintf
-#elif (__MSPGCC__ - 0)
-/* Technically this should use __MSP430_LIBC__ which will be obtained
- * implicitly from <msp430libc.h> via <inttypes.h>, but since that's
- * not available in the header we'll use __MSPGCC__ as a
- * substitute. */
-#define HAVE_EMBTEXTF 1
-#endif /* BSP430_CONSOLE_USE_EMBTEXTF */
 
 static hBSP430halSERIAL console_hal_;
 
+/* The receive and transmit buffers are rings with a power-of-two
+ * size.  The head and tail are free-running 16-bit counters: the
+ * number of octets held is their difference, and the storage index
+ * for a counter is obtained by masking it.  No division is required,
+ * and the full capacity of the storage is usable. */
+
+/* Number of octets held in a ring given its head and tail. */
+#define RING_COUNT_(h_,t_) ((uint16_t)((h_) - (t_)))
+
+/* Storage index corresponding to free-running counter @p i_ in a ring
+ * of @p size_ octets. */
+#define RING_INDEX_(i_,size_) ((i_) & ((size_) - 1))
+
 #if (BSP430_CONSOLE_RX_BUFFER_SIZE - 0)
-#if 254 < (BSP430_CONSOLE_RX_BUFFER_SIZE)
-#error BSP430_CONSOLE_RX_BUFFER_SIZE is too large
+#if (16384 < (BSP430_CONSOLE_RX_BUFFER_SIZE)) || (0 != ((BSP430_CONSOLE_RX_BUFFER_SIZE) & ((BSP430_CONSOLE_RX_BUFFER_SIZE) - 1)))
+#error BSP430_CONSOLE_RX_BUFFER_SIZE must be a power of two not exceeding 16384
 #endif /* validate BSP430_CONSOLE_RX_BUFFER_SIZE */
 
 typedef struct sConsoleRxBuffer {
   sBSP430halISRVoidChainNode cb_node;
   char buffer[BSP430_CONSOLE_RX_BUFFER_SIZE];
-  volatile unsigned char head;
-  volatile unsigned char tail;
+  volatile uint16_t head;
+  volatile uint16_t tail;
   iBSP430consoleRxCallback_ni callback_ni;
+#if (configBSP430_CONSOLE_RX_COOKED - 0)
+  /* Nonzero if the line discipline is active */
+  unsigned char cooked;
+  /* Progress through an escape sequence: 1 after ESC, 2 after CSI */
+  unsigned char escape;
+  /* Counter value following the last line terminator */
+  uint16_t line_start;
+  /* Counter value following the last character passed to the
+   * application uninterpreted; the discipline edits only what
+   * follows */
+  uint16_t edit_start;
+#endif /* configBSP430_CONSOLE_RX_COOKED */
 } sConsoleRxBuffer;
 
+#if (configBSP430_CONSOLE_RX_COOKED - 0)
+
+#define KEY_BS '\b'
+#define KEY_DEL 0x7F
+#define KEY_LF '\n'
+#define KEY_CR '\r'
+#define KEY_BEL '\a'
+#define KEY_ESC '\033'
+#define KEY_CSI '['
+#define KEY_KILL_LINE 0x15
+#define KEY_KILL_WORD 0x17
+
+static void console_rx_echo_ni (const char * cp,
+                                size_t len);
+
+/* True iff counter value p_ identifies a position in the buffer that
+ * has not been consumed by the application. */
+#define RX_UNCONSUMED_(bufp_,p_) (RING_COUNT_((bufp_)->head, (p_)) <= RING_COUNT_((bufp_)->head, (bufp_)->tail))
+
+/* Remove the octets from p to the head, erasing them from the
+ * display. */
+static void
+console_rx_erase_ni (sConsoleRxBuffer * bufp,
+                     uint16_t p)
+{
+  unsigned int n = RING_COUNT_(bufp->head, p);
+
+  if (1 == n) {
+    console_rx_echo_ni("\b \b", 3);
+  } else if (1 < n) {
+    char csi[sizeof("\033[16384D\033[K")];
+    char * cp = csi;
+
+    *cp++ = KEY_ESC;
+    *cp++ = KEY_CSI;
+    cp += iBSP430formatUnsignedLong(cp, n, 10);
+    memcpy(cp, "D\033[K", 4);
+    console_rx_echo_ni(csi, cp + 4 - csi);
+  }
+  bufp->head = p;
+}
+
+/* Apply the line discipline to character c.  Returns -1 if the
+ * character was consumed, 0 if it should be stored without waking
+ * the application, and 1 if it should be stored and the application
+ * woken. */
+static int
+console_rx_cook_ni (sConsoleRxBuffer * bufp,
+                    uint8_t c)
+{
+  uint16_t head = bufp->head;
+  uint16_t base = bufp->edit_start;
+  /* Nonzero if the entire current line is held unedited in the
+   * buffer, so the discipline can edit any of it. */
+  int whole_line = (base == bufp->line_start) && RX_UNCONSUMED_(bufp, base);
+
+  if (! RX_UNCONSUMED_(bufp, base)) {
+    base = bufp->tail;
+  }
+  if (bufp->escape) {
+    /* Pass escape sequences through uninterpreted, one wakeup per
+     * character.  As in iBSP430cliConsoleBufferConsumeEscape(), a
+     * sequence ends at a final character in 0x40..0x7E, so the
+     * parameters of a control sequence (ESC [ 3 ~) are not taken as
+     * text. */
+    if ((1 == bufp->escape) && (KEY_CSI == c)) {
+      bufp->escape = 2;
+    } else if ((0x40 <= c) && (c <= 0x7E)) {
+      bufp->escape = 0;
+    }
+    return 1;
+  }
+  if ((KEY_BS == c) || (KEY_DEL == c)) {
+    if (head != base) {
+      console_rx_erase_ni(bufp, head - 1);
+      return -1;
+    }
+    if (whole_line) {
+      console_rx_echo_ni("\a", 1);
+      return -1;
+    }
+    /* Part of the line is held by the application: let it edit. */
+    return 1;
+  }
+  if (KEY_KILL_LINE == c) {
+    if (whole_line) {
+      console_rx_erase_ni(bufp, base);
+      return -1;
+    }
+    return 1;
+  }
+  if (KEY_KILL_WORD == c) {
+    uint16_t p = head;
+
+    while ((p != base) && (' ' == bufp->buffer[RING_INDEX_(p - 1, BSP430_CONSOLE_RX_BUFFER_SIZE)])) {
+      --p;
+    }
+    while ((p != base) && (' ' != bufp->buffer[RING_INDEX_(p - 1, BSP430_CONSOLE_RX_BUFFER_SIZE)])) {
+      --p;
+    }
+    if ((p != base) || whole_line) {
+      console_rx_erase_ni(bufp, p);
+      return -1;
+    }
+    return 1;
+  }
+  if ((' ' <= c) && (KEY_DEL != c)) {
+    console_rx_echo_ni((const char *)&c, 1);
+    return 0;
+  }
+  if (KEY_ESC == c) {
+    bufp->escape = 1;
+  }
+  return 1;
+}
+
+#endif /* configBSP430_CONSOLE_RX_COOKED */
+
 static int
 console_rx_isr_ni (const struct sBSP430halISRVoidChainNode * cb,
                    void * context)
 {
   sConsoleRxBuffer * bufp = (sConsoleRxBuffer *)cb;
   sBSP430halSERIAL * hal = (sBSP430halSERIAL *) context;
-  unsigned char head = bufp->head;
+  uint16_t head = bufp->head;
   int rv;
 
-  bufp->buffer[head] = hal->rx_byte;
-  head = (head + 1) % (sizeof(bufp->buffer) / sizeof(*bufp->buffer));
-  if (head == bufp->tail) {
-    bufp->tail = (bufp->tail + 1) % (sizeof(bufp->buffer) / sizeof(*bufp->buffer));
+#if (configBSP430_CONSOLE_RX_COOKED - 0)
+  if (bufp->cooked) {
+    uint8_t c = hal->rx_byte;
+    int action;
+
+    /* With a full buffer refuse new input, but make sure the
+     * application is awake to drain it. */
+    if (BSP430_CONSOLE_RX_BUFFER_SIZE == RING_COUNT_(head, bufp->tail)) {
+      console_rx_echo_ni("\a", 1);
+      action = 1;
+    } else {
+      action = console_rx_cook_ni(bufp, c);
+      if (0 <= action) {
+        head = bufp->head;
+        bufp->buffer[RING_INDEX_(head, BSP430_CONSOLE_RX_BUFFER_SIZE)] = c;
+        bufp->head = ++head;
+        if ((KEY_CR == c) || (KEY_LF == c)) {
+          bufp->line_start = head;
+        }
+        if (0 < action) {
+          bufp->edit_start = head;
+        }
+      }
+    }
+    rv = 0;
+    if (0 < action) {
+      rv = (NULL != bufp->callback_ni) ? bufp->callback_ni() : BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
+    }
+    return rv | BSP430_HAL_ISR_CALLBACK_BREAK_CHAIN;
   }
-  bufp->head = head;
+#endif /* configBSP430_CONSOLE_RX_COOKED */
+  /* If the buffer is full, discard the oldest character. */
+  if (BSP430_CONSOLE_RX_BUFFER_SIZE == RING_COUNT_(head, bufp->tail)) {
+    bufp->tail += 1;
+  }
+  bufp->buffer[RING_INDEX_(head, BSP430_CONSOLE_RX_BUFFER_SIZE)] = hal->rx_byte;
+  bufp->head = head + 1;
   if (NULL != bufp->callback_ni) {
     rv = bufp->callback_ni();
   } else {
@@ -114,26 +270,134 @@ vBSP430consoleSetRxCallback_ni (iBSP430consoleRxCallback_ni cb)
   rx_buffer_.callback_ni = cb;
 }
 
+#if (configBSP430_CONSOLE_RX_COOKED - 0)
+
+int
+iBSP430consoleSetRxCooked_ni (int enablep)
+{
+  int rv = rx_buffer_.cooked;
+
+  if (enablep && ! rx_buffer_.cooked) {
+    /* Everything already received belongs to the application */
+    rx_buffer_.line_start = rx_buffer_.edit_start = rx_buffer_.head;
+    rx_buffer_.escape = 0;
+  }
+  rx_buffer_.cooked = !!enablep;
+  return rv;
+}
+
+int
+iBSP430consoleRxCooked (void)
+{
+  return rx_buffer_.cooked;
+}
+
+#endif /* configBSP430_CONSOLE_RX_COOKED */
+
 #endif /* BSP430_CONSOLE_RX_BUFFER_SIZE */
 
 #if (BSP430_CONSOLE_TX_BUFFER_SIZE - 0)
-#if 254 < (BSP430_CONSOLE_TX_BUFFER_SIZE)
-#error BSP430_CONSOLE_TX_BUFFER_SIZE is too large
+#if (16384 < (BSP430_CONSOLE_TX_BUFFER_SIZE)) || (0 != ((BSP430_CONSOLE_TX_BUFFER_SIZE) & ((BSP430_CONSOLE_TX_BUFFER_SIZE) - 1)))
+#error BSP430_CONSOLE_TX_BUFFER_SIZE must be a power of two not exceeding 16384
 #endif /* validate BSP430_CONSOLE_TX_BUFFER_SIZE */
 
+/* Storage index for free-running transmit buffer counter @p i_ */
+#define TX_INDEX_(i_) RING_INDEX_(i_, BSP430_CONSOLE_TX_BUFFER_SIZE)
+
+#if (configBSP430_CONSOLE_TX_DMA - 0)
+#include <bsp430/periph/dma.h>
+#if ! (configBSP430_HAL_DMA - 0)
+#error configBSP430_CONSOLE_TX_DMA requires configBSP430_HAL_DMA
+#endif /* configBSP430_HAL_DMA */
+#if ! ((BSP430_MODULE_DMAX - 0) && (BSP430_CORE_FAMILY_IS_5XX - 0))
+#error configBSP430_CONSOLE_TX_DMA supported only on 5xx/FR5xx DMAX
+#endif /* DMAX */
+#ifndef BSP430_CONSOLE_TX_DMA_TRIGGER
+#error configBSP430_CONSOLE_TX_DMA requires BSP430_CONSOLE_TX_DMA_TRIGGER
+#endif /* BSP430_CONSOLE_TX_DMA_TRIGGER */
+#if BSP430_DMA_NUM_CHANNELS <= (BSP430_CONSOLE_TX_DMA_CHANNEL)
+#error BSP430_CONSOLE_TX_DMA_CHANNEL is not a valid channel
+#endif /* validate BSP430_CONSOLE_TX_DMA_CHANNEL */
+#define CONSOLE_TX_DMA 1
+
+/* The DMACTLx register holding the trigger select for the console
+ * channel, and the position of its field within that register. */
+#if 0 == ((BSP430_CONSOLE_TX_DMA_CHANNEL) / 2)
+#define CONSOLE_TX_DMA_TSEL_REG ctl0
+#elif 1 == ((BSP430_CONSOLE_TX_DMA_CHANNEL) / 2)
+#define CONSOLE_TX_DMA_TSEL_REG ctl1
+#else
+#define CONSOLE_TX_DMA_TSEL_REG ctl2
+#endif /* BSP430_CONSOLE_TX_DMA_CHANNEL */
+#define CONSOLE_TX_DMA_TSEL_SHIFT (8 * ((BSP430_CONSOLE_TX_DMA_CHANNEL) & 1))
+#endif /* configBSP430_CONSOLE_TX_DMA */
+
 typedef struct sConsoleTxBuffer {
   sBSP430halISRVoidChainNode cb_node;
   char buffer[BSP430_CONSOLE_TX_BUFFER_SIZE];
-  volatile unsigned char head;
-  volatile unsigned char tail;
+  volatile uint16_t head;
+  volatile uint16_t tail;
   volatile int wake_available;
+  /* What to do when there is not enough space to queue data */
+  eBSP430consoleTxPolicy policy;
+  /* Nonzero if data has been discarded since the overflow marker was
+   * last queued */
+  unsigned char overflowed;
+  /* Nonzero if an overflow marker was queued starting at marker_at
+   * and may still be there */
+  unsigned char marker_placed;
+  uint16_t marker_at;
+  /* Number of octets discarded under policy */
+  unsigned long drops;
+#if (CONSOLE_TX_DMA - 0)
+  /* Completion callback for the DMA channel */
+  sBSP430halISRIndexedChainNode dma_cb_node;
+  /* Number of octets starting at tail that are in flight through
+   * the DMA channel.  Zero when the channel is idle. */
+  volatile unsigned int dma_len;
+  /* Pointer to the UART interrupt flag register, used to generate
+   * the trigger edge that starts a transfer. */
+  volatile unsigned char * dma_ifgp;
+#endif /* CONSOLE_TX_DMA */
 } sConsoleTxBuffer;
 
 /* Calculate the number of bytes available in the buffer given the
- * head and tail indexes. */
-#define TX_BUFFER_AVAILABLE_(bp_,h_,t_) (((h_) >= (t_))                 \
-                                         ? (sizeof((bp_)->buffer) + (t_) - (h_) - 1) \
-                                         : ((t_) - (h_) - 1))
+ * head and tail counters. */
+#define TX_BUFFER_AVAILABLE_(h_,t_) ((BSP430_CONSOLE_TX_BUFFER_SIZE) - RING_COUNT_(h_,t_))
+
+/* Text queued ahead of the first data accepted after some was
+ * discarded. */
+static const char tx_overflow_marker_[] = BSP430_CONSOLE_TX_OVERFLOW_MARKER;
+#define TX_OVERFLOW_MARKER_LEN (sizeof(tx_overflow_marker_) - 1)
+
+/* Determine whether a task waiting for transmit buffer space should
+ * be woken, given the new head and tail indexes.  Returns
+ * BSP430_HAL_ISR_CALLBACK_EXIT_LPM if so. */
+static int
+console_tx_wake_ni (sConsoleTxBuffer * bufp,
+                    uint16_t head,
+                    uint16_t tail)
+{
+  int wake_available = bufp->wake_available;
+
+  if (head == tail) {
+    /* If somebody wants to know when there's space available, well,
+     * there's never going to be any more space than the whole
+     * buffer. */
+    if (0 != wake_available) {
+      bufp->wake_available = 0;
+      return BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
+    }
+  } else if (0 < wake_available) {
+    int available = TX_BUFFER_AVAILABLE_(head, tail);
+
+    if (available >= wake_available) {
+      bufp->wake_available = 0;
+      return BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
+    }
+  }
+  return 0;
+}
 
 static int
 console_tx_isr_ni (const struct sBSP430halISRVoidChainNode * cb,
@@ -141,85 +405,623 @@ console_tx_isr_ni (const struct sBSP430halISRVoidChainNode * cb,
 {
   sConsoleTxBuffer * bufp = (sConsoleTxBuffer *)cb;
   sBSP430halSERIAL * hal = (sBSP430halSERIAL *) context;
-  unsigned char tail = bufp->tail;
-  unsigned char head = bufp->head;
-  int wake_available;
+  uint16_t tail = bufp->tail;
+  uint16_t head = bufp->head;
   int rv = 0;
 
   /* If there's data available here, store it and mark that we have
    * done so. */
   if (head != tail) {
-    hal->tx_byte = bufp->buffer[tail];
+    hal->tx_byte = bufp->buffer[TX_INDEX_(tail)];
     rv |= BSP430_HAL_ISR_CALLBACK_BREAK_CHAIN;
-    bufp->tail = tail = (tail + 1) % (sizeof(bufp->buffer) / sizeof(*bufp->buffer));
+    bufp->tail = ++tail;
   }
-  wake_available = bufp->wake_available;
   if (head == tail) {
     /* Ran out of data.  Turn off the interrupt infrastructure. */
     rv |= BSP430_HAL_ISR_CALLBACK_DISABLE_INTERRUPT;
-    /* If somebody wants to know when there's space available, well,
-     * there's never going to be any more space than the whole
-     * buffer. */
-    if (0 != wake_available) {
-      bufp->wake_available = 0;
-      rv |= BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
-    }
-  } else if (0 < wake_available) {
-    int available = TX_BUFFER_AVAILABLE_(bufp, head, tail);
-
-    if (available >= wake_available) {
-      bufp->wake_available = 0;
-      rv |= BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
-    }
   }
-  return rv;
+  return rv | console_tx_wake_ni(bufp, head, tail);
 }
 
+#if (CONSOLE_TX_DMA - 0)
+
+static int
+console_tx_dma_isr_ni (const struct sBSP430halISRIndexedChainNode * cb,
+                       void * context,
+                       int idx);
+
+#endif /* CONSOLE_TX_DMA */
+
 static sConsoleTxBuffer tx_buffer_ = {
   .cb_node = { .callback_ni = console_tx_isr_ni },
+#if (CONSOLE_TX_DMA - 0)
+  .dma_cb_node = { .callback_ni = console_tx_dma_isr_ni },
+#endif /* CONSOLE_TX_DMA */
 };
 
+#if (CONSOLE_TX_DMA - 0)
+
+/* Start a DMA transfer of the longest contiguous run of queued data
+ * beginning at the tail of the buffer.  The channel must be idle. */
+static void
+console_tx_dma_start_ni (sConsoleTxBuffer * bufp)
+{
+  volatile sBSP430hplDMAchannel * chp = BSP430_HAL_DMA->hpl->ch + (BSP430_CONSOLE_TX_DMA_CHANNEL);
+  uint16_t tail = bufp->tail;
+  unsigned int len = RING_COUNT_(bufp->head, tail);
+  unsigned int contiguous = sizeof(bufp->buffer) - TX_INDEX_(tail);
+
+  if (0 == len) {
+    return;
+  }
+  /* Data that wraps is sent in two chunks; the completion of the
+   * first starts the second. */
+  if (len > contiguous) {
+    len = contiguous;
+  }
+  bufp->dma_len = len;
+  chp->sa = (uintptr_t)(bufp->buffer + TX_INDEX_(tail));
+  chp->sz = len;
+  chp->ctl |= DMAEN;
+  /* The UART trigger is edge-sensitive.  If the transmit buffer is
+   * already empty the flag is set and will not change, so produce an
+   * edge by clearing and resetting it.  If the flag is clear a
+   * character is still pending and its completion will trigger the
+   * first transfer. */
+  if (*bufp->dma_ifgp & UCTXIFG) {
+    *bufp->dma_ifgp &= ~UCTXIFG;
+    *bufp->dma_ifgp |= UCTXIFG;
+  }
+}
+
 static int
-console_tx_queue (hBSP430halSERIAL uart, uint8_t c)
+console_tx_dma_isr_ni (const struct sBSP430halISRIndexedChainNode * cb,
+                       void * context,
+                       int idx)
 {
-  BSP430_CORE_SAVED_INTERRUPT_STATE(istate);
   sConsoleTxBuffer * bufp = &tx_buffer_;
+  uint16_t tail;
 
-  BSP430_CORE_DISABLE_INTERRUPT();
-  while (1) {
-    unsigned char head = bufp->head;
-    unsigned char next_head = (head + 1) % (sizeof(bufp->buffer)/sizeof(*bufp->buffer));
-    if (next_head == bufp->tail) {
+  tail = bufp->tail + bufp->dma_len;
+  bufp->tail = tail;
+  bufp->dma_len = 0;
+  console_tx_dma_start_ni(bufp);
+  return console_tx_wake_ni(bufp, bufp->head, tail);
+}
+
+/* Stop the DMA channel, accounting for any part of the in-flight
+ * chunk that has been transmitted. */
+static void
+console_tx_dma_stop_ni (sConsoleTxBuffer * bufp)
+{
+  volatile sBSP430hplDMAchannel * chp = BSP430_HAL_DMA->hpl->ch + (BSP430_CONSOLE_TX_DMA_CHANNEL);
+  unsigned int remaining;
+
+  chp->ctl &= ~DMAEN;
+  remaining = chp->sz;
+  if (chp->ctl & DMAIFG) {
+    remaining = 0;
+    chp->ctl &= ~DMAIFG;
+  }
+  if (0 != bufp->dma_len) {
+    bufp->tail += bufp->dma_len - remaining;
+    bufp->dma_len = 0;
+  }
+}
+
+/* Configure the DMA channel to feed the console UART.  Returns 0 on
+ * success, or -1 if the UART does not support DMA transmission. */
+static int
+console_tx_dma_configure_ni (hBSP430halSERIAL hal)
+{
+  volatile sBSP430hplDMA * const dma = BSP430_HAL_DMA->hpl;
+  volatile sBSP430hplDMAchannel * chp = dma->ch + (BSP430_CONSOLE_TX_DMA_CHANNEL);
+  sConsoleTxBuffer * bufp = &tx_buffer_;
+  volatile void * txbufp = NULL;
+
+#if (configBSP430_SERIAL_USE_EUSCI - 0)
+  if (BSP430_SERIAL_HAL_HPL_VARIANT_IS_EUSCIA(hal)) {
+    txbufp = &hal->hpl.euscia->txbuf;
+    bufp->dma_ifgp = (volatile unsigned char *)&hal->hpl.euscia->ifg;
+  }
+#endif /* configBSP430_SERIAL_USE_EUSCI */
+#if (configBSP430_SERIAL_USE_USCI5 - 0)
+  if (BSP430_SERIAL_HAL_HPL_VARIANT_IS_USCI5(hal)) {
+    txbufp = &hal->hpl.usci5->txbuf;
+    bufp->dma_ifgp = &hal->hpl.usci5->ifg;
+  }
+#endif /* configBSP430_SERIAL_USE_USCI5 */
+  if (NULL == txbufp) {
+    return -1;
+  }
+  chp->ctl = 0;
+  dma->CONSOLE_TX_DMA_TSEL_REG = (dma->CONSOLE_TX_DMA_TSEL_REG & ~(0x1F << CONSOLE_TX_DMA_TSEL_SHIFT))
+                                 | ((BSP430_CONSOLE_TX_DMA_TRIGGER) << CONSOLE_TX_DMA_TSEL_SHIFT);
+  /* Single transfers, one per trigger, incrementing byte source and
+   * fixed byte destination. */
+  chp->da = (uintptr_t)txbufp;
+  chp->ctl = DMADT_0 | DMASRCINCR_3 | DMADSTBYTE | DMASRCBYTE | DMAIE;
+  bufp->dma_len = 0;
+  return 0;
+}
+
+#endif /* CONSOLE_TX_DMA */
+
+/* Initiate transmission of newly queued data if the transmitter is
+ * idle. */
+static BSP430_CORE_INLINE_FORCED
+void
+console_tx_kick_ni (sConsoleTxBuffer * bufp,
+                    hBSP430halSERIAL uart)
+{
+#if (CONSOLE_TX_DMA - 0)
+  if (0 == bufp->dma_len) {
+    console_tx_dma_start_ni(bufp);
+  }
+#else /* CONSOLE_TX_DMA */
+  vBSP430serialWakeupTransmit_rh(uart);
+#endif /* CONSOLE_TX_DMA */
+}
+
+/* Hook the transmit buffer into whatever infrastructure drains it. */
+static void
+console_tx_attach_ni (hBSP430halSERIAL hal)
+{
+#if (CONSOLE_TX_DMA - 0)
+  if (0 == console_tx_dma_configure_ni(hal)) {
+    BSP430_HAL_ISR_CALLBACK_LINK_NI(sBSP430halISRIndexedChainNode, BSP430_HAL_DMA->ch_cbchain_ni[BSP430_CONSOLE_TX_DMA_CHANNEL], tx_buffer_.dma_cb_node, next_ni);
+    return;
+  }
+#endif /* CONSOLE_TX_DMA */
+  BSP430_HAL_ISR_CALLBACK_LINK_NI(sBSP430halISRVoidChainNode, hal->tx_cbchain_ni, tx_buffer_.cb_node, next_ni);
+}
+
+/* Reverse the effect of console_tx_attach_ni(). */
+static void
+console_tx_detach_ni (hBSP430halSERIAL hal)
+{
+#if (CONSOLE_TX_DMA - 0)
+  if (NULL != tx_buffer_.dma_ifgp) {
+    console_tx_dma_stop_ni(&tx_buffer_);
+    BSP430_HAL_ISR_CALLBACK_UNLINK_NI(sBSP430halISRIndexedChainNode, BSP430_HAL_DMA->ch_cbchain_ni[BSP430_CONSOLE_TX_DMA_CHANNEL], tx_buffer_.dma_cb_node, next_ni);
+    tx_buffer_.dma_ifgp = NULL;
+    return;
+  }
+#endif /* CONSOLE_TX_DMA */
+  BSP430_HAL_ISR_CALLBACK_UNLINK_NI(sBSP430halISRVoidChainNode, hal->tx_cbchain_ni, tx_buffer_.cb_node, next_ni);
+}
+
+/* Copy len octets into the buffer at head.  The caller must have
+ * verified the space is available. */
+static void
+console_tx_copy_ni (sConsoleTxBuffer * bufp,
+                    const uint8_t * dp,
+                    size_t len)
+{
+  const size_t buffer_size = sizeof(bufp->buffer) / sizeof(*bufp->buffer);
+  uint16_t head = bufp->head;
+  size_t first = buffer_size - TX_INDEX_(head);
+
+  if (first > len) {
+    first = len;
+  }
+  memcpy(bufp->buffer + TX_INDEX_(head), dp, first);
+  if (first < len) {
+    memcpy(bufp->buffer, dp + first, len - first);
+  }
+  bufp->head = head + len;
+}
+
+/* Queue a block of data for transmission, suspending as necessary
+ * until space is available.  Space is reserved in contiguous runs,
+ * each of which is copied in at most two pieces (when it wraps) with
+ * a single interrupt-disabled section.  The transmitter is woken only
+ * if the buffer was empty. */
+static void
+console_tx_block_ni (sConsoleTxBuffer * bufp,
+                     hBSP430halSERIAL uart,
+                     const uint8_t * dp,
+                     size_t len)
+{
+  const size_t buffer_size = sizeof(bufp->buffer) / sizeof(*bufp->buffer);
+  const uint8_t * const edp = dp + len;
+
+  while (dp < edp) {
+    uint16_t head = bufp->head;
+    uint16_t tail = bufp->tail;
+    size_t available = TX_BUFFER_AVAILABLE_(head, tail);
+    size_t remaining = edp - dp;
+
+    if (0 == available) {
+      /* Ask to be woken when enough space has been freed to hold the
+       * rest of the block, or half the buffer if that is less, so the
+       * transmitter still has the other half to send while the space
+       * is refilled. */
       if (0 == bufp->wake_available) {
-        bufp->wake_available = 1;
+        bufp->wake_available = (remaining < (buffer_size / 2)) ? remaining : (buffer_size / 2);
       }
-      /* Sleep until the tx callback indicates space is available or
-       * something else wakes us up.  Then immediately disable the
-       * interrupts as that probably was not done during wakeup. */
       BSP430_CORE_LPM_ENTER_NI(LPM0_bits);
       BSP430_CORE_DISABLE_INTERRUPT();
       continue;
     }
-    bufp->buffer[head] = c;
-    bufp->head = next_head;
-    if (head == bufp->tail) {
-      vBSP430serialWakeupTransmit_rh(uart);
+    if (available > remaining) {
+      available = remaining;
+    }
+    console_tx_copy_ni(bufp, dp, available);
+    if (head == tail) {
+      console_tx_kick_ni(bufp, uart);
     }
-    break;
+    dp += available;
+    BSP430_CORE_WATCHDOG_CLEAR();
+  }
+}
+
+/* The distance from start to the overflow marker last queued, if it
+ * is still among the len octets queued from start; otherwise len.
+ * The contents are checked because marker_at is not cleared when the
+ * marker is transmitted, and the indexes wrap. */
+static size_t
+console_tx_marker_offset_ni (const sConsoleTxBuffer * bufp,
+                             uint16_t start,
+                             size_t len)
+{
+  size_t offset = RING_COUNT_(bufp->marker_at, start);
+  size_t i;
+
+  if ((! bufp->marker_placed) || (len < (offset + TX_OVERFLOW_MARKER_LEN))) {
+    return len;
+  }
+  for (i = 0; i < TX_OVERFLOW_MARKER_LEN; ++i) {
+    if (bufp->buffer[TX_INDEX_(bufp->marker_at + i)] != tx_overflow_marker_[i]) {
+      return len;
+    }
+  }
+  return offset;
+}
+
+/* The number of octets of the overflow marker last queued that are
+ * still queued from start, if the rest of it has already been handed
+ * to the hardware and nothing was queued after it ahead of start;
+ * otherwise -1.  Anything discarded from start then directly follows
+ * the marker, which stands for that loss too. */
+static int
+console_tx_marker_lead_ni (const sConsoleTxBuffer * bufp,
+                           uint16_t start,
+                           size_t len)
+{
+  size_t lead = RING_COUNT_(bufp->marker_at + TX_OVERFLOW_MARKER_LEN, start);
+  size_t i;
+
+  if ((! bufp->marker_placed) || (TX_OVERFLOW_MARKER_LEN <= lead) || (len < lead)) {
+    return -1;
+  }
+  for (i = 0; i < TX_OVERFLOW_MARKER_LEN; ++i) {
+    if (bufp->buffer[TX_INDEX_(bufp->marker_at + i)] != tx_overflow_marker_[i]) {
+      return -1;
+    }
+  }
+  return (int)lead;
+}
+
+#if (CONSOLE_TX_DMA - 0)
+/* As console_tx_drop_oldest_ni(), while a DMA transfer is in flight.
+ * Octets handed to the DMA channel cannot be recalled, and the tail
+ * must stay at the start of the transfer, so discarding the oldest
+ * queued octets would mean moving everything kept down to follow the
+ * transfer, with interrupts disabled for as long as that takes.
+ * Instead the newest queued octets are discarded, and the marker
+ * takes the place of the last of them. */
+static void
+console_tx_drop_queued_ni (sConsoleTxBuffer * bufp,
+                           size_t want)
+{
+  uint16_t head = bufp->head;
+  uint16_t start = bufp->tail + bufp->dma_len;
+  size_t queued = RING_COUNT_(head, start);
+  size_t dropped = want + TX_OVERFLOW_MARKER_LEN;
+  size_t old_marker = 0;
+  size_t marker;
+  int lead;
+
+  if (dropped > queued) {
+    dropped = queued;
+  }
+  /* Only one marker is kept queued: one that is already there is
+   * discarded with everything after it, and the new one takes its
+   * place.  It is not lost data. */
+  marker = console_tx_marker_offset_ni(bufp, start, queued);
+  lead = console_tx_marker_lead_ni(bufp, start, queued);
+  if (marker < queued) {
+    if ((queued - dropped) > marker) {
+      dropped = queued - marker;
+    }
+    old_marker = TX_OVERFLOW_MARKER_LEN;
+  } else if ((0 <= lead) && ((queued - dropped) <= (size_t)lead)) {
+    /* The transfer in flight ends with the marker, or with the start
+     * of it: everything queued after it goes, and it stands. */
+    dropped = queued - lead;
+    bufp->head = start + lead;
+    bufp->overflowed = 0;
+    bufp->drops += dropped;
+    return;
+  }
+  bufp->marker_placed = 0;
+  head -= dropped;
+  if (TX_OVERFLOW_MARKER_LEN <= dropped) {
+    size_t i;
+
+    for (i = 0; i < TX_OVERFLOW_MARKER_LEN; ++i) {
+      bufp->buffer[TX_INDEX_(head + i)] = tx_overflow_marker_[i];
+    }
+    bufp->marker_at = head;
+    bufp->marker_placed = 1;
+    bufp->overflowed = 0;
+    head += TX_OVERFLOW_MARKER_LEN;
+  } else if (0 < dropped) {
+    /* Everything queued goes; the marker goes in ahead of the next
+     * data accepted. */
+    bufp->overflowed = 1;
+  }
+  bufp->head = head;
+  bufp->drops += dropped - old_marker;
+}
+#endif /* CONSOLE_TX_DMA */
+
+/* Make at least want octets of space available by discarding the
+ * oldest data that has not yet been handed to the hardware, leaving
+ * the overflow marker where the data was lost.  May free less if
+ * there is not enough such data. */
+static void
+console_tx_drop_oldest_ni (sConsoleTxBuffer * bufp,
+                           size_t want)
+{
+  uint16_t head = bufp->head;
+  uint16_t start = bufp->tail;
+  size_t queued = RING_COUNT_(head, start);
+  size_t dropped;
+  size_t old_marker = 0;
+  size_t marker;
+  int lead;
+
+#if (CONSOLE_TX_DMA - 0)
+  if (0 != bufp->dma_len) {
+    console_tx_drop_queued_ni(bufp, want);
+    return;
+  }
+#endif /* CONSOLE_TX_DMA */
+  /* Discard from start, reusing the last TX_OVERFLOW_MARKER_LEN freed
+   * octets to hold the marker. */
+  dropped = want + TX_OVERFLOW_MARKER_LEN;
+  if (dropped > queued) {
+    dropped = queued;
+  }
+  /* Only one marker is kept queued: discarding runs through one that
+   * is already there, and the new one takes the place of the last
+   * octets discarded.  It is not lost data. */
+  marker = console_tx_marker_offset_ni(bufp, start, queued);
+  lead = console_tx_marker_lead_ni(bufp, start, queued);
+  if (marker < queued) {
+    if (dropped < (marker + TX_OVERFLOW_MARKER_LEN)) {
+      dropped = marker + TX_OVERFLOW_MARKER_LEN;
+    }
+    old_marker = TX_OVERFLOW_MARKER_LEN;
+  } else if (0 <= lead) {
+    /* The UART has the marker, or the start of it, and it stands for
+     * this loss too.  What is left of it moves up to follow the
+     * discarded octets, and is rewritten in full where the space
+     * allows so it is still recognized. */
+    uint16_t at;
+    size_t i;
+
+    dropped = queued - lead;
+    if (dropped > want) {
+      dropped = want;
+    }
+    for (i = lead; 0 < i; --i) {
+      bufp->buffer[TX_INDEX_(start + dropped + i - 1)] = bufp->buffer[TX_INDEX_(start + i - 1)];
+    }
+    bufp->tail = start + dropped;
+    at = start + dropped + lead - TX_OVERFLOW_MARKER_LEN;
+    for (i = 0; i < TX_OVERFLOW_MARKER_LEN; ++i) {
+      if (RING_COUNT_(at + i, start) < (dropped + lead)) {
+        bufp->buffer[TX_INDEX_(at + i)] = tx_overflow_marker_[i];
+      }
+    }
+    bufp->marker_at = at;
+    bufp->overflowed = 0;
+    bufp->drops += dropped;
+    return;
+  }
+  bufp->marker_placed = 0;
+  if (TX_OVERFLOW_MARKER_LEN <= dropped) {
+    uint16_t at = start + dropped - TX_OVERFLOW_MARKER_LEN;
+    size_t i;
+
+    bufp->tail = at;
+    for (i = 0; i < TX_OVERFLOW_MARKER_LEN; ++i) {
+      bufp->buffer[TX_INDEX_(at + i)] = tx_overflow_marker_[i];
+    }
+    bufp->marker_at = at;
+    bufp->marker_placed = 1;
+    bufp->overflowed = 0;
+  } else {
+    /* Everything goes; the marker goes in ahead of the next data
+     * accepted. */
+    bufp->tail = start + dropped;
+    if (0 < dropped) {
+      bufp->overflowed = 1;
+    }
+  }
+  bufp->drops += dropped - old_marker;
+}
+
+/* Queue a block of data for transmission without suspending, applying
+ * the configured policy when there is not enough space.  Returns the
+ * number of octets queued. */
+static size_t
+console_tx_admit_ni (sConsoleTxBuffer * bufp,
+                     hBSP430halSERIAL uart,
+                     const uint8_t * dp,
+                     size_t len)
+{
+  size_t marker_len = bufp->overflowed ? TX_OVERFLOW_MARKER_LEN : 0;
+  uint16_t was_empty = (bufp->head == bufp->tail);
+  size_t available = TX_BUFFER_AVAILABLE_(bufp->head, bufp->tail);
+  size_t admit = 0;
+
+  if (eBSP430consoleTxPolicy_DROP_OLDEST == bufp->policy) {
+    int room = sizeof(bufp->buffer) - TX_OVERFLOW_MARKER_LEN;
+
+#if (CONSOLE_TX_DMA - 0)
+    room -= bufp->dma_len;
+#endif /* CONSOLE_TX_DMA */
+    if (0 > room) {
+      room = 0;
+    }
+    if (len > (size_t)room) {
+      /* Even an empty buffer cannot hold all of it: the oldest part
+       * of the new data goes too. */
+      bufp->drops += len - room;
+      dp += len - room;
+      len = room;
+      bufp->overflowed = 1;
+      marker_len = TX_OVERFLOW_MARKER_LEN;
+    }
+    if ((len + marker_len) > available) {
+      console_tx_drop_oldest_ni(bufp, len + marker_len - available);
+      marker_len = bufp->overflowed ? TX_OVERFLOW_MARKER_LEN : 0;
+      available = TX_BUFFER_AVAILABLE_(bufp->head, bufp->tail);
+    }
+  }
+  if ((0 < marker_len) && (0 == console_tx_marker_lead_ni(bufp, bufp->head, 0))) {
+    /* Nothing was queued after the last marker: it stands for this
+     * loss too. */
+    marker_len = 0;
+    bufp->overflowed = 0;
+  }
+  if (marker_len <= available) {
+    admit = available - marker_len;
+    if (admit >= len) {
+      admit = len;
+    } else if (eBSP430consoleTxPolicy_DROP_NEWEST == bufp->policy) {
+      admit = 0;
+    }
+  }
+  if (0 < admit) {
+    if (0 < marker_len) {
+      bufp->marker_at = bufp->head;
+      bufp->marker_placed = 1;
+      console_tx_copy_ni(bufp, (const uint8_t *)tx_overflow_marker_, marker_len);
+      bufp->overflowed = 0;
+    }
+    console_tx_copy_ni(bufp, dp, admit);
+    if (was_empty) {
+      console_tx_kick_ni(bufp, uart);
+    }
+  }
+  if (admit < len) {
+    bufp->drops += len - admit;
+    bufp->overflowed = 1;
+  }
+  return admit;
+}
+
+static int
+console_tx_queue_data (hBSP430halSERIAL uart,
+                       const uint8_t * data,
+                       size_t len)
+{
+  BSP430_CORE_SAVED_INTERRUPT_STATE(istate);
+  sConsoleTxBuffer * bufp = &tx_buffer_;
+  int rv = len;
+
+  BSP430_CORE_DISABLE_INTERRUPT();
+  if (eBSP430consoleTxPolicy_BLOCK != bufp->policy) {
+    rv = console_tx_admit_ni(bufp, uart, data, len);
+  } else {
+    if (bufp->overflowed) {
+      bufp->overflowed = 0;
+      console_tx_block_ni(bufp, uart, (const uint8_t *)tx_overflow_marker_, TX_OVERFLOW_MARKER_LEN);
+    }
+    console_tx_block_ni(bufp, uart, data, len);
+  }
+  BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
+  return rv;
+}
+
+static int
+console_tx_queue (hBSP430halSERIAL uart, uint8_t c)
+{
+  BSP430_CORE_SAVED_INTERRUPT_STATE(istate);
+  sConsoleTxBuffer * bufp = &tx_buffer_;
+  uint16_t head;
+
+  BSP430_CORE_DISABLE_INTERRUPT();
+  head = bufp->head;
+  if ((0 == TX_BUFFER_AVAILABLE_(head, bufp->tail)) || bufp->overflowed) {
+    /* Let the general case deal with blocking or dropping. */
+    BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
+    return (1 == console_tx_queue_data(uart, &c, 1)) ? c : -1;
+  }
+  bufp->buffer[TX_INDEX_(head)] = c;
+  bufp->head = head + 1;
+  if (head == bufp->tail) {
+    console_tx_kick_ni(bufp, uart);
   }
   BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
   return c;
 }
 
 static int (* uartTransmit) (hBSP430halSERIAL uart, uint8_t c);
+static int (* uartTransmitData) (hBSP430halSERIAL uart, const uint8_t * data, size_t len);
 
 #define UART_TRANSMIT(uart_, c_) uartTransmit(uart_, c_)
+#define UART_TRANSMIT_DATA(uart_, d_, l_) uartTransmitData(uart_, d_, l_)
 
 #else /* BSP430_CONSOLE_TX_BUFFER_SIZE */
 
 #define UART_TRANSMIT(uart_, c_) iBSP430uartTxByte_rh(uart_, c_)
+#define UART_TRANSMIT_DATA(uart_, d_, l_) iBSP430uartTxData_rh(uart_, d_, l_)
+
+#endif /* BSP430_CONSOLE_TX_BUFFER_SIZE */
+
+#if (BSP430_CONSOLE_RX_BUFFER_SIZE - 0) && (configBSP430_CONSOLE_RX_COOKED - 0)
+
+/* Echo from the receive interrupt.  This must not suspend: with
+ * interrupt-driven transmission the text is queued only if all of it
+ * fits, and otherwise is discarded.  Writing it to the UART instead
+ * would send it out of order with queued output (or in the middle of
+ * a DMA transfer), and applying the transmit policy would count lost
+ * echo as lost output.  Without interrupt-driven transmission it is
+ * written directly to the UART. */
+static void
+console_rx_echo_ni (const char * cp,
+                    size_t len)
+{
+  hBSP430halSERIAL uart = console_hal_;
+
+  if (! uart) {
+    return;
+  }
+#if (BSP430_CONSOLE_TX_BUFFER_SIZE - 0)
+  if (uartTransmit == console_tx_queue) {
+    sConsoleTxBuffer * bufp = &tx_buffer_;
+    uint16_t head = bufp->head;
+    uint16_t tail = bufp->tail;
 
+    if (len <= (size_t)TX_BUFFER_AVAILABLE_(head, tail)) {
+      console_tx_copy_ni(bufp, (const uint8_t *)cp, len);
+      if (head == tail) {
+        console_tx_kick_ni(bufp, uart);
+      }
+    }
+    return;
+  }
 #endif /* BSP430_CONSOLE_TX_BUFFER_SIZE */
+  (void)iBSP430uartTxData_rh(uart, (const uint8_t *)cp, len);
+}
+
+#endif /* configBSP430_CONSOLE_RX_COOKED */
 
 /* Optimized version used inline.  Assumes that the uart is not
  * null. */
@@ -261,38 +1063,62 @@ cputchar (int c)
   return emit_char(c);
 }
 
-/* Emit a NUL-terminated string of text, returning the number of
- * characters emitted. */
+/* Emit a sequence of characters, returning the number of characters
+ * the transmit policy accepted.  Runs of text between newlines are
+ * passed to the UART as blocks.  The count does not include any
+ * carriage returns added for ONLCR; a newline counts only if its
+ * carriage return was accepted with it. */
 static int
-emit_text (const char * s,
-           hBSP430halSERIAL uart)
+emit_chars (const char * cp,
+            size_t len,
+            hBSP430halSERIAL uart)
 {
+#if (configBSP430_CONSOLE_USE_ONLCR - 0)
+  const char * const ecp = cp + len;
+#endif /* configBSP430_CONSOLE_USE_ONLCR */
   int rv = 0;
-  if (uart) {
-    while (s[rv]) {
-      emit_char2(s[rv++], uart);
-      BSP430_CORE_WATCHDOG_CLEAR();
+
+  if (! uart) {
+    return 0;
+  }
+#if (configBSP430_CONSOLE_USE_ONLCR - 0)
+  while (cp < ecp) {
+    const char * nlp = memchr(cp, '\n', ecp - cp);
+    const char * ep = nlp ? nlp : ecp;
+
+    if (cp < ep) {
+      int n = UART_TRANSMIT_DATA(uart, (const uint8_t *)cp, ep - cp);
+
+      if (0 < n) {
+        rv += n;
+      }
     }
+    if (nlp) {
+      if (2 == UART_TRANSMIT_DATA(uart, (const uint8_t *)"\r\n", 2)) {
+        ++rv;
+      }
+      ++ep;
+    }
+    cp = ep;
+    BSP430_CORE_WATCHDOG_CLEAR();
+  }
+#else /* configBSP430_CONSOLE_USE_ONLCR */
+  rv = UART_TRANSMIT_DATA(uart, (const uint8_t *)cp, len);
+  if (0 > rv) {
+    rv = 0;
   }
+#endif /* configBSP430_CONSOLE_USE_ONLCR */
   return rv;
 }
 
 /* Emit a NUL-terminated string of text, returning the number of
  * characters emitted. */
-static int
-emit_chars (const char * cp,
-            size_t len,
-            hBSP430halSERIAL uart)
+static BSP430_CORE_INLINE
+int
+emit_text (const char * s,
+           hBSP430halSERIAL uart)
 {
-  int rv = 0;
-
-  if (uart) {
-    while (rv < len) {
-      emit_char2(cp[rv++], uart);
-      BSP430_CORE_WATCHDOG_CLEAR();
-    }
-  }
-  return rv;
+  return emit_chars(s, strlen(s), uart);
 }
 
 int
@@ -305,8 +1131,7 @@ cputs (const char * s)
     return 0;
   }
   rv = emit_text(s, uart);
-  emit_char2('\n', uart);
-  return 1+rv;
+  return rv + emit_chars("\n", 1, uart);
 }
 
 int
@@ -332,33 +1157,69 @@ cputchars (const char * cp,
   return emit_chars(cp, len, uart);
 }
 
-#if HAVE_EMBTEXTF
+int
+iBSP430consoleTransmitOctets (const uint8_t * dp,
+                              size_t len)
+{
+  hBSP430halSERIAL uart = console_hal_;
+
+  if (! uart) {
+    return 0;
+  }
+  return UART_TRANSMIT_DATA(uart, dp, len);
+}
+
+/* Emit a converted integer, with a leading minus sign if negative.
+ * Only radix 10 values are treated as signed, as with itoa(). */
+static int
+emit_integer (unsigned long magnitude,
+              int negative,
+              int radix)
+{
+  char buffer[1 + BSP430_FORMAT_LONG_BUFFER_SIZE];
+  char * bp = buffer;
+  hBSP430halSERIAL uart = console_hal_;
+
+  if (! uart) {
+    return 0;
+  }
+  if (negative) {
+    *bp++ = '-';
+  }
+  if (0 > iBSP430formatUnsignedLong(bp, magnitude, radix)) {
+    return 0;
+  }
+  return emit_text(buffer, uart);
+}
+
 int
 cputi (int n, int radix)
 {
-  char buffer[sizeof("-32767")];
-  return emit_text(itoa(n, buffer, radix), console_hal_);
+  if ((10 == radix) && (0 > n)) {
+    return emit_integer(-(unsigned int)n, 1, radix);
+  }
+  return emit_integer((unsigned int)n, 0, radix);
 }
 
 int
 cputu (unsigned int n, int radix)
 {
-  char buffer[sizeof("65535")];
-  return emit_text(utoa(n, buffer, radix), console_hal_);
+  return emit_integer(n, 0, radix);
 }
 
 int
 cputl (long n, int radix)
 {
-  char buffer[sizeof("-2147483647")];
-  return emit_text(ltoa(n, buffer, radix), console_hal_);
+  if ((10 == radix) && (0 > n)) {
+    return emit_integer(-(unsigned long)n, 1, radix);
+  }
+  return emit_integer((unsigned long)n, 0, radix);
 }
 
 int
 cputul (unsigned long n, int radix)
 {
-  char buffer[sizeof("4294967295")];
-  return emit_text(ultoa(n, buffer, radix), console_hal_);
+  return emit_integer(n, 0, radix);
 }
 
 int
@@ -375,17 +1236,192 @@ cprintf (const char *fmt, ...)
   return rv;
 }
 
+/* The console and the number of characters it has accepted, for
+ * vcprintf_emit() */
+typedef struct sVcprintfContext {
+  hBSP430halSERIAL uart;
+  int emitted;
+} sVcprintfContext;
+
+static int
+vcprintf_emit (void * context,
+               const char * cp,
+               size_t len)
+{
+  sVcprintfContext * cxp = (sVcprintfContext *)context;
+
+  cxp->emitted += emit_chars(cp, len, cxp->uart);
+  return 0;
+}
+
 int
 vcprintf (const char * fmt, va_list ap)
 {
+  sVcprintfContext context;
+  int rv;
+
+  context.uart = console_hal_;
+  context.emitted = 0;
   /* Fail fast if printing is disabled */
-  if (! console_hal_) {
+  if (! context.uart) {
     return 0;
   }
-  return vuprintf(emit_char, fmt, ap);
+  rv = iBSP430formatVprintf(vcprintf_emit, &context, fmt, ap);
+  return (0 > rv) ? rv : context.emitted;
 }
 
-#endif /* HAVE_EMBTEXTF */
+#if (configBSP430_CONSOLE_LOG_BINARY - 0) && (BSP430_CORE_TOOLCHAIN_GCC - 0)
+
+#if (259 < (BSP430_CONSOLE_LOG_RECORD_MAX)) || ((BSP430_CONSOLE_LOG_RECORD_MAX) < 4)
+#error BSP430_CONSOLE_LOG_RECORD_MAX must be between 4 and 259
+#endif /* validate BSP430_CONSOLE_LOG_RECORD_MAX */
+
+/* Linker-provided start of the section holding BSP430_CONSOLE_LOG()
+ * format strings.  Weak so an application that never logs still
+ * links. */
+extern const char __start_bsp430_logfmt[] __attribute__((__weak__));
+
+/* Append len octets at vp to the record at *rpp, failing if this
+ * would pass erp. */
+static int
+log_append (uint8_t ** rpp,
+            const uint8_t * erp,
+            const void * vp,
+            size_t len)
+{
+  if ((size_t)(erp - *rpp) < len) {
+    return -1;
+  }
+  memcpy(*rpp, vp, len);
+  *rpp += len;
+  return 0;
+}
+
+int
+iBSP430consoleLogRecord_ (const char * fmt, ...)
+{
+  uint8_t record[BSP430_CONSOLE_LOG_RECORD_MAX];
+  uint8_t * rp = record + 4;
+  const uint8_t * const erp = record + sizeof(record);
+  hBSP430halSERIAL uart = console_hal_;
+  BSP430_CORE_SAVED_INTERRUPT_STATE(istate);
+  uintptr_t offset;
+  const char * fp = fmt;
+  va_list ap;
+  int rc = 0;
+  int rv;
+
+  if (! uart) {
+    return 0;
+  }
+  offset = (uintptr_t)fmt - (uintptr_t)__start_bsp430_logfmt;
+  va_start(ap, fmt);
+  while ((0 == rc) && *fp) {
+    int lmod = 0;
+
+    if ('%' != *fp++) {
+      continue;
+    }
+    if ('%' == *fp) {
+      ++fp;
+      continue;
+    }
+    /* Flags, width, precision.  Only the star forms consume an
+     * argument. */
+    while (*fp && (0 != strchr("-+ #0123456789.*", *fp))) {
+      if ('*' == *fp) {
+        int v = va_arg(ap, int);
+        rc = log_append(&rp, erp, &v, sizeof(v));
+      }
+      ++fp;
+    }
+    /* Length modifiers.  h and hh arguments are promoted to int. */
+    while (*fp && (0 != strchr("hl", *fp))) {
+      if ('l' == *fp) {
+        ++lmod;
+      }
+      ++fp;
+    }
+    if (0 != rc) {
+      break;
+    }
+    switch (*fp) {
+      case 'd':
+      case 'i':
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+      case 'c':
+        if (0 == lmod) {
+          int v = va_arg(ap, int);
+          rc = log_append(&rp, erp, &v, sizeof(v));
+        } else if (1 == lmod) {
+          long v = va_arg(ap, long);
+          rc = log_append(&rp, erp, &v, sizeof(v));
+        } else {
+          long long v = va_arg(ap, long long);
+          rc = log_append(&rp, erp, &v, sizeof(v));
+        }
+        break;
+      case 'p': {
+        unsigned long v = (uintptr_t)va_arg(ap, void *);
+        rc = log_append(&rp, erp, &v, sizeof(v));
+        break;
+      }
+      case 's': {
+        const char * sp = va_arg(ap, const char *);
+        size_t len;
+
+        if (rp == erp) {
+          rc = -1;
+          break;
+        }
+        if (! sp) {
+          sp = "(null)";
+        }
+        len = strlen(sp);
+        if ((size_t)(erp - rp) <= len) {
+          len = erp - rp - 1;
+          rc = -1;
+        }
+        memcpy(rp, sp, len);
+        rp += len;
+        *rp++ = 0;
+        break;
+      }
+      default:
+        /* Unsupported conversion (e.g. floating point): the type of
+         * the argument is unknown, so nothing further can be
+         * recorded. */
+        rc = -1;
+        break;
+    }
+    if (*fp) {
+      ++fp;
+    }
+  }
+  va_end(ap);
+  record[0] = BSP430_CONSOLE_LOG_RECORD_START;
+  record[1] = 0xFF & offset;
+  record[2] = 0xFF & (offset >> 8);
+  record[3] = (rp - record) - 4;
+  /* A partial record would desynchronize the decoder, so the record
+   * is queued whole or discarded whole, whatever the transmit
+   * policy. */
+  BSP430_CORE_DISABLE_INTERRUPT();
+  do {
+    rv = -1;
+    if (0 > iBSP430consoleReserveTxSpace_ni(rp - record)) {
+      break;
+    }
+    rv = UART_TRANSMIT_DATA(uart, record, rp - record);
+  } while (0);
+  BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
+  return rv;
+}
+
+#endif /* configBSP430_CONSOLE_LOG_BINARY */
 
 hBSP430halSERIAL
 hBSP430console (void)
@@ -403,10 +1439,11 @@ console_getchar_ (int do_pop)
 
   BSP430_CORE_DISABLE_INTERRUPT();
   do {
-    if (rx_buffer_.head != rx_buffer_.tail) {
-      rv = rx_buffer_.buffer[rx_buffer_.tail];
+    uint16_t tail = rx_buffer_.tail;
+    if (rx_buffer_.head != tail) {
+      rv = (unsigned char)rx_buffer_.buffer[RING_INDEX_(tail, BSP430_CONSOLE_RX_BUFFER_SIZE)];
       if (do_pop) {
-        rx_buffer_.tail = (rx_buffer_.tail + 1) & ((sizeof(rx_buffer_.buffer) / sizeof(*rx_buffer_.buffer)) - 1);
+        rx_buffer_.tail = tail + 1;
       }
     }
   } while (0);
@@ -447,22 +1484,24 @@ iBSP430consoleTransmitUseInterrupts_ni (int enablep)
   if (enablep) {
     if (uartTransmit != console_tx_queue) {
       uartTransmit = console_tx_queue;
+      uartTransmitData = console_tx_queue_data;
       vBSP430serialFlush_ni(console_hal_);
       iBSP430serialSetHold_rh(console_hal_, 1);
-      BSP430_HAL_ISR_CALLBACK_LINK_NI(sBSP430halISRVoidChainNode, console_hal_->tx_cbchain_ni, tx_buffer_.cb_node, next_ni);
+      console_tx_attach_ni(console_hal_);
       iBSP430serialSetHold_rh(console_hal_, 0);
       if (tx_buffer_.head != tx_buffer_.tail) {
-        vBSP430serialWakeupTransmit_rh(console_hal_);
+        console_tx_kick_ni(&tx_buffer_, console_hal_);
       }
     }
   } else {
     if (uartTransmit != iBSP430uartTxByte_rh) {
       uartTransmit = iBSP430uartTxByte_rh;
+      uartTransmitData = iBSP430uartTxData_rh;
       /* This flushes any character currently in the UART; it does not
        * flush anything left in the transmission buffer. */
       vBSP430serialFlush_ni(console_hal_);
       iBSP430serialSetHold_rh(console_hal_, 1);
-      BSP430_HAL_ISR_CALLBACK_UNLINK_NI(sBSP430halISRVoidChainNode, console_hal_->tx_cbchain_ni, tx_buffer_.cb_node, next_ni);
+      console_tx_detach_ni(console_hal_);
       iBSP430serialSetHold_rh(console_hal_, 0);
     }
   }
@@ -495,14 +1534,20 @@ iBSP430consoleInitialize (void)
     /* Associate the callback before opening the device, so the
      * interrupts are enabled properly. */
     rx_buffer_.head = rx_buffer_.tail = 0;
+#if (configBSP430_CONSOLE_RX_COOKED - 0)
+    rx_buffer_.line_start = rx_buffer_.edit_start = 0;
+    rx_buffer_.escape = 0;
+#endif /* configBSP430_CONSOLE_RX_COOKED */
     BSP430_HAL_ISR_CALLBACK_LINK_NI(sBSP430halISRVoidChainNode, hal->rx_cbchain_ni, rx_buffer_.cb_node, next_ni);
 #endif /* BSP430_CONSOLE_RX_BUFFER_SIZE */
 
 #if (BSP430_CONSOLE_TX_BUFFER_SIZE - 0)
     uartTransmit = console_tx_queue;
+    uartTransmitData = console_tx_queue_data;
     tx_buffer_.wake_available = 0;
+    tx_buffer_.overflowed = 0;
     tx_buffer_.head = tx_buffer_.tail = 0;
-    BSP430_HAL_ISR_CALLBACK_LINK_NI(sBSP430halISRVoidChainNode, hal->tx_cbchain_ni, tx_buffer_.cb_node, next_ni);
+    console_tx_attach_ni(hal);
 #endif /* BSP430_CONSOLE_TX_BUFFER_SIZE */
 
     /* Attempt to configure and install the console */
@@ -521,6 +1566,9 @@ iBSP430consoleInitialize (void)
 #if (BSP430_CONSOLE_RX_BUFFER_SIZE - 0)
       BSP430_HAL_ISR_CALLBACK_UNLINK_NI(sBSP430halISRVoidChainNode, hal->rx_cbchain_ni, rx_buffer_.cb_node, next_ni);
 #endif /* BSP430_CONSOLE_RX_BUFFER_SIZE */
+#if (BSP430_CONSOLE_TX_BUFFER_SIZE - 0)
+      console_tx_detach_ni(hal);
+#endif /* BSP430_CONSOLE_TX_BUFFER_SIZE */
       break;
     }
 #if (BSP430_PLATFORM_SPIN_FOR_JUMPER - 0)
@@ -549,7 +1597,7 @@ iBSP430consoleDeconfigure (void)
     BSP430_HAL_ISR_CALLBACK_UNLINK_NI(sBSP430halISRVoidChainNode, console_hal_->rx_cbchain_ni, rx_buffer_.cb_node, next_ni);
 #endif /* BSP430_CONSOLE_RX_BUFFER_SIZE */
 #if (BSP430_CONSOLE_TX_BUFFER_SIZE - 0)
-    BSP430_HAL_ISR_CALLBACK_UNLINK_NI(sBSP430halISRVoidChainNode, console_hal_->tx_cbchain_ni, tx_buffer_.cb_node, next_ni);
+    console_tx_detach_ni(console_hal_);
 #endif /* BSP430_CONSOLE_TX_BUFFER_SIZE */
 #if (BSP430_SERIAL_ENABLE_RESOURCE - 0)
     (void)iBSP430resourceRelease_ni(&console_hal_->resource, &console_hal_);
@@ -565,20 +1613,20 @@ iBSP430consoleWaitForTxSpace_ni (int want_available)
 {
   int rv = 0;
 #if (BSP430_CONSOLE_TX_BUFFER_SIZE - 0)
-  if (((int)sizeof(tx_buffer_.buffer) - 1) < want_available) {
+  if ((int)sizeof(tx_buffer_.buffer) < want_available) {
     return -1;
   }
   while (1) {
     int available;
-    unsigned char head = tx_buffer_.head;
-    unsigned char tail = tx_buffer_.tail;
+    uint16_t head = tx_buffer_.head;
+    uint16_t tail = tx_buffer_.tail;
 
     if (0 > want_available) {
       if (head == tail) {
         break;
       }
     } else {
-      available = TX_BUFFER_AVAILABLE_(&tx_buffer_, head, tail);
+      available = TX_BUFFER_AVAILABLE_(head, tail);
       if (available >= want_available) {
         break;
       }
@@ -615,59 +1663,220 @@ iBSP430consoleFlush (void)
   return rv;
 }
 
+int
+iBSP430consoleSetTxPolicy_ni (eBSP430consoleTxPolicy policy)
+{
+#if (BSP430_CONSOLE_TX_BUFFER_SIZE - 0)
+  int rv = tx_buffer_.policy;
+
+  switch (policy) {
+    case eBSP430consoleTxPolicy_BLOCK:
+    case eBSP430consoleTxPolicy_DROP_NEWEST:
+    case eBSP430consoleTxPolicy_DROP_OLDEST:
+    case eBSP430consoleTxPolicy_TRUNCATE:
+      tx_buffer_.policy = policy;
+      return rv;
+    default:
+      return -1;
+  }
+#else /* BSP430_CONSOLE_TX_BUFFER_SIZE */
+  return (eBSP430consoleTxPolicy_BLOCK == policy) ? eBSP430consoleTxPolicy_BLOCK : -1;
+#endif /* BSP430_CONSOLE_TX_BUFFER_SIZE */
+}
+
+unsigned long
+ulBSP430consoleTxDrops_ni (int reset)
+{
+#if (BSP430_CONSOLE_TX_BUFFER_SIZE - 0)
+  unsigned long rv = tx_buffer_.drops;
+
+  if (reset) {
+    tx_buffer_.drops = 0;
+  }
+  return rv;
+#else /* BSP430_CONSOLE_TX_BUFFER_SIZE */
+  return 0;
+#endif /* BSP430_CONSOLE_TX_BUFFER_SIZE */
+}
+
+int
+iBSP430consoleReserveTxSpace_ni (size_t len)
+{
+#if (BSP430_CONSOLE_TX_BUFFER_SIZE - 0)
+  sConsoleTxBuffer * bufp = &tx_buffer_;
+  size_t need;
+
+  if ((! console_hal_) || (uartTransmit != console_tx_queue)) {
+    return 0;
+  }
+  need = len + (bufp->overflowed ? TX_OVERFLOW_MARKER_LEN : 0);
+  if (eBSP430consoleTxPolicy_BLOCK == bufp->policy) {
+    /* Output that cannot fit is queued as space frees, so waiting for
+     * the buffer to empty would only leave the transmitter idle. */
+    return iBSP430consoleWaitForTxSpace_ni((need <= sizeof(bufp->buffer)) ? (int)need : (int)(sizeof(bufp->buffer) / 2));
+  }
+  if (eBSP430consoleTxPolicy_DROP_OLDEST == bufp->policy) {
+    size_t room = sizeof(bufp->buffer);
+    size_t available = TX_BUFFER_AVAILABLE_(bufp->head, bufp->tail);
+
+#if (CONSOLE_TX_DMA - 0)
+    room -= bufp->dma_len;
+#endif /* CONSOLE_TX_DMA */
+    if ((need <= room) && (need > available)) {
+      console_tx_drop_oldest_ni(bufp, need - available);
+      need = len + (bufp->overflowed ? TX_OVERFLOW_MARKER_LEN : 0);
+    }
+  }
+  if (need <= (size_t)TX_BUFFER_AVAILABLE_(bufp->head, bufp->tail)) {
+    return 0;
+  }
+  bufp->drops += len;
+  bufp->overflowed = 1;
+  return -1;
+#else /* BSP430_CONSOLE_TX_BUFFER_SIZE */
+  return 0;
+#endif /* BSP430_CONSOLE_TX_BUFFER_SIZE */
+}
+
+/* Hexadecimal digits indexed by nibble value */
+static const char dump_nibble_[] = "0123456789abcdef";
+
+/* Line terminator as it goes to the UART */
+#if (configBSP430_CONSOLE_USE_ONLCR - 0)
+#define DUMP_EOL "\r\n"
+#else /* configBSP430_CONSOLE_USE_ONLCR */
+#define DUMP_EOL "\n"
+#endif /* configBSP430_CONSOLE_USE_ONLCR */
+#define DUMP_EOL_LEN (sizeof(DUMP_EOL) - 1)
+
+/* Octets displayed per line */
+#define DUMP_LINE_OCTETS 16
+
+/* The longest line: terminator, address and separator, octets each
+ * with a leading space, at most one group space between octets, and
+ * the character gutter. */
+#define DUMP_LINE_MAX (DUMP_EOL_LEN + 9 + 3 * DUMP_LINE_OCTETS + (DUMP_LINE_OCTETS - 1) + 2 + DUMP_LINE_OCTETS)
+
+static BSP430_CORE_INLINE
+char *
+dump_octet (char * lp,
+            uint8_t v)
+{
+  *lp++ = dump_nibble_[v >> 4];
+  *lp++ = dump_nibble_[v & 0x0F];
+  return lp;
+}
+
 void
 vBSP430consoleDisplayOctets (const uint8_t * dp,
                              size_t len)
 {
+  hBSP430halSERIAL uart = console_hal_;
   const uint8_t * const edp = dp + len;
+  char text[3 * DUMP_LINE_OCTETS];
+
+  if (! uart) {
+    return;
+  }
   while (dp < edp) {
-    cprintf("%02x", *dp++);
-    if (dp < edp) {
-      cputchar(' ');
+    const uint8_t * const eldp = ((edp - dp) > DUMP_LINE_OCTETS) ? (dp + DUMP_LINE_OCTETS) : edp;
+    char * tp = text;
+
+    while (dp < eldp) {
+      tp = dump_octet(tp, *dp++);
+      if (dp < edp) {
+        *tp++ = ' ';
+      }
     }
+    UART_TRANSMIT_DATA(uart, (const uint8_t *)text, tp - text);
   }
 }
 
 void
-vBSP430consoleDisplayMemory (const uint8_t * dp,
-                             size_t len,
-                             unsigned long base)
+vBSP430consoleDump (const uint8_t * dp,
+                    size_t len,
+                    unsigned long base,
+                    unsigned int flags)
 {
+  hBSP430halSERIAL uart = console_hal_;
   const uint8_t * const edp = dp + len;
-  const uint8_t * adp = dp;
+  unsigned int address_digits = flags & 0x0F;
+  unsigned int group = (flags >> 4) & 0x1F;
+  char line[DUMP_LINE_MAX];
 
+  if (! uart) {
+    return;
+  }
+  if (flags & BSP430_CONSOLE_DUMP_RAW) {
+    UART_TRANSMIT_DATA(uart, dp, len);
+    return;
+  }
+  if (8 < address_digits) {
+    address_digits = 8;
+  }
+  if (DUMP_LINE_OCTETS <= group) {
+    group = 0;
+  }
   while (dp < edp) {
-    if (0 == (base & 0x0F)) {
-      if (adp < dp) {
-        cputtext("  ");
-        while (adp < dp) {
-          cputchar(isprint(*adp) ? *adp : '.');
-          ++adp;
-        }
+    char * lp = line;
+    unsigned int first = base & (DUMP_LINE_OCTETS - 1);
+    unsigned int end = DUMP_LINE_OCTETS;
+    unsigned int in_group = 0;
+    unsigned int i;
+
+    if ((size_t)(end - first) > (size_t)(edp - dp)) {
+      end = first + (edp - dp);
+    }
+    memcpy(lp, DUMP_EOL, DUMP_EOL_LEN);
+    lp += DUMP_EOL_LEN;
+    if (0 < address_digits) {
+      unsigned long address = base - first;
+
+      i = address_digits;
+      while (0 < i--) {
+        lp[i] = dump_nibble_[address & 0x0F];
+        address >>= 4;
+      }
+      lp += address_digits;
+      *lp++ = ' ';
+    }
+    /* Positions after the last octet are padded only if the
+     * character gutter must be aligned. */
+    for (i = 0; i < ((flags & BSP430_CONSOLE_DUMP_ASCII) ? DUMP_LINE_OCTETS : end); ++i) {
+      if (group && (in_group++ == group)) {
+        *lp++ = ' ';
+        in_group = 1;
       }
-      adp = dp;
-      cprintf("\n%08lx ", base);
-    } else if (0 == (base & 0x07)) {
-      cputchar(' ');
-    }
-    cprintf(" %02x", *dp++);
-    ++base;
-  }
-  if (adp < dp) {
-    while (base & 0x0F) {
-      if (0 == (base & 0x07)) {
-        cputchar(' ');
+      *lp++ = ' ';
+      if ((i < first) || (i >= end)) {
+        *lp++ = ' ';
+        *lp++ = ' ';
+      } else {
+        lp = dump_octet(lp, dp[i - first]);
       }
-      cprintf("   ");
-      ++base;
     }
-    cputtext("  ");
-    while (adp < dp) {
-      cputchar(isprint(*adp) ? *adp : '.');
-      ++adp;
+    if (flags & BSP430_CONSOLE_DUMP_ASCII) {
+      *lp++ = ' ';
+      *lp++ = ' ';
+      for (i = 0; i < end; ++i) {
+        uint8_t c = (i < first) ? ' ' : dp[i - first];
+
+        *lp++ = ((' ' <= c) && (c < 0x7F)) ? c : '.';
+      }
     }
+    UART_TRANSMIT_DATA(uart, (const uint8_t *)line, lp - line);
+    dp += end - first;
+    base += end - first;
   }
-  cputchar('\n');
+  UART_TRANSMIT_DATA(uart, (const uint8_t *)DUMP_EOL, DUMP_EOL_LEN);
+}
+
+void
+vBSP430consoleDisplayMemory (const uint8_t * dp,
+                             size_t len,
+                             unsigned long base)
+{
+  vBSP430consoleDump(dp, len, base, BSP430_CONSOLE_DUMP_DEFAULT);
 }
 
 #endif /* BSP430_CONSOLE */
@@ -0,0 +1,256 @@
+/* Copyright 2014, Peter A. Bigot
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the software nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <bsp430/platform.h>
+#include <bsp430/utility/evloop.h>
+#include <string.h>
+
+#if (BSP430_UPTIME - 0)
+/* Inhibit definition if required components were not provided. */
+
+/* Registered work items, in registration order.  Only modified from
+ * the main context. */
+static hBSP430evloopWork work_head;
+static hBSP430evloopWork * work_tailp = &work_head;
+
+/* Set whenever any work item is posted.  Each poster sets the item's
+ * own flag first, so a scan that begins after clearing this flag sees
+ * every item posted before the flag was set again. */
+static volatile unsigned char work_posted;
+
+/* Cleared by vBSP430evloopStop() to terminate vBSP430evloopRun(). */
+static volatile unsigned char loop_running;
+
+/* Number of holds placed on each low power mode level. */
+static unsigned int lpm_holds[5];
+
+static const unsigned int lpm_bits_[] = {
+  LPM0_bits, LPM1_bits, LPM2_bits, LPM3_bits, LPM4_bits,
+};
+
+static uiBSP430evloopIdleHook_ni idle_hook;
+
+/* The multiplexed alarm on the uptime timer that posts timed
+ * events. */
+static sBSP430timerMuxSharedAlarm timer_alarm;
+static hBSP430timerMuxSharedAlarm timer_alarm_h;
+
+int
+iBSP430evloopInitialize (void)
+{
+  BSP430_CORE_SAVED_INTERRUPT_STATE(istate);
+  int rv = 0;
+
+  BSP430_CORE_DISABLE_INTERRUPT();
+  do {
+    if (NULL == timer_alarm_h) {
+      timer_alarm_h = hBSP430timerMuxAlarmStartup(&timer_alarm, BSP430_UPTIME_TIMER_PERIPH_HANDLE, BSP430_EVLOOP_ALARM_CCIDX);
+      if (NULL == timer_alarm_h) {
+        rv = -1;
+      }
+    }
+  } while (0);
+  BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
+  return rv;
+}
+
+hBSP430evloopWork
+hBSP430evloopWorkInitialize (sBSP430evloopWork * work,
+                             vBSP430evloopHandler handler)
+{
+  hBSP430evloopWork wp;
+
+  if (NULL == work) {
+    return NULL;
+  }
+  work->handler = handler;
+  for (wp = work_head; NULL != wp; wp = wp->next) {
+    if (wp == work) {
+      return work;
+    }
+  }
+  work->pending = 0;
+  work->next = NULL;
+  *work_tailp = work;
+  work_tailp = &work->next;
+  return work;
+}
+
+int
+iBSP430evloopPost (hBSP430evloopWork work)
+{
+  work->pending = 1;
+  work_posted = 1;
+  return BSP430_HAL_ISR_CALLBACK_EXIT_LPM;
+}
+
+static int
+timerAlarmCallback_ni (hBSP430timerMuxSharedAlarm shared,
+                       hBSP430timerMuxAlarm alarm)
+{
+  hBSP430evloopTimer tp = (hBSP430evloopTimer)(-offsetof(sBSP430evloopTimer, alarm) + (unsigned char *)alarm);
+
+  return iBSP430evloopPost(&tp->work);
+}
+
+hBSP430evloopTimer
+hBSP430evloopTimerInitialize (sBSP430evloopTimer * timer,
+                              vBSP430evloopHandler handler)
+{
+  if (NULL == timer) {
+    return NULL;
+  }
+  memset(&timer->alarm, 0, sizeof(timer->alarm));
+  timer->alarm.callback_ni = timerAlarmCallback_ni;
+  (void)hBSP430evloopWorkInitialize(&timer->work, handler);
+  return timer;
+}
+
+int
+iBSP430evloopTimerSchedule_ni (hBSP430evloopTimer timer,
+                               unsigned long when_utt,
+                               unsigned long period_utt)
+{
+  if ((NULL == timer) || (NULL == timer_alarm_h)) {
+    return -1;
+  }
+  (void)iBSP430timerMuxAlarmRemove_ni(timer_alarm_h, &timer->alarm);
+  timer->alarm.setting_tck = when_utt;
+  return iBSP430timerMuxAlarmAddPeriodic_ni(timer_alarm_h, &timer->alarm, period_utt);
+}
+
+int
+iBSP430evloopTimerCancel_ni (hBSP430evloopTimer timer)
+{
+  int rv;
+
+  if ((NULL == timer) || (NULL == timer_alarm_h)) {
+    return -1;
+  }
+  rv = iBSP430timerMuxAlarmRemove_ni(timer_alarm_h, &timer->alarm);
+  timer->work.pending = 0;
+  return rv;
+}
+
+void
+vBSP430evloopLPMHold_ni (unsigned int level)
+{
+  if (level < (sizeof(lpm_holds) / sizeof(*lpm_holds))) {
+    ++lpm_holds[level];
+  }
+}
+
+void
+vBSP430evloopLPMRelease_ni (unsigned int level)
+{
+  if ((level < (sizeof(lpm_holds) / sizeof(*lpm_holds)))
+      && (0 < lpm_holds[level])) {
+    --lpm_holds[level];
+  }
+}
+
+unsigned int
+uiBSP430evloopLPMBits_ni (void)
+{
+  unsigned int level = 0;
+
+  while ((level < BSP430_EVLOOP_LPM_DEEPEST) && (0 == lpm_holds[level])) {
+    ++level;
+  }
+  return lpm_bits_[level];
+}
+
+uiBSP430evloopIdleHook_ni
+xBSP430evloopSetIdleHook_ni (uiBSP430evloopIdleHook_ni hook)
+{
+  uiBSP430evloopIdleHook_ni rv = idle_hook;
+
+  idle_hook = hook;
+  return rv;
+}
+
+int
+iBSP430evloopRunPending (void)
+{
+  BSP430_CORE_SAVED_INTERRUPT_STATE(istate);
+  int rv = 0;
+
+  BSP430_CORE_ENABLE_INTERRUPT();
+  while (work_posted) {
+    hBSP430evloopWork wp;
+
+    work_posted = 0;
+    for (wp = work_head; NULL != wp; wp = wp->next) {
+      if (wp->pending) {
+        wp->pending = 0;
+        wp->handler(wp);
+        ++rv;
+      }
+    }
+  }
+  BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
+  return rv;
+}
+
+void
+vBSP430evloopRun (void)
+{
+  BSP430_CORE_SAVED_INTERRUPT_STATE(istate);
+
+  loop_running = 1;
+  while (loop_running) {
+    (void)iBSP430evloopRunPending();
+
+    /* Sleep only if nothing was posted since the handlers ran.
+     * Interrupts stay disabled from the test until the low power
+     * mode is entered, so a post cannot be missed. */
+    BSP430_CORE_DISABLE_INTERRUPT();
+    if (loop_running && (! work_posted)) {
+      unsigned int lpm_bits = uiBSP430evloopLPMBits_ni();
+
+      if (NULL != idle_hook) {
+        lpm_bits = idle_hook(lpm_bits);
+      }
+      if (0 != lpm_bits) {
+        BSP430_CORE_LPM_ENTER_NI(lpm_bits);
+      }
+    }
+  }
+  BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
+}
+
+void
+vBSP430evloopStop (void)
+{
+  loop_running = 0;
+}
+
+#endif /* BSP430_UPTIME */
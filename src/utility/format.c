@@ -0,0 +1,613 @@
+/* Copyright 2014, Peter A. Bigot
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the software nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ *
+ * @brief Implementation of integer conversion and printf-style formatting
+ *
+ * @homepage http://github.com/pabigot/bsp430
+ * @copyright Copyright 2014, Peter A. Bigot.  Licensed under <a href="http://www.opensource.org/licenses/BSD-3-Clause">BSD-3-Clause</a>
+ */
+
+#include <bsp430/utility/format.h>
+#include <string.h>
+
+static const char digits_lower[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+static const char digits_upper[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+/* Powers of ten used for decimal conversion.  Each table ends with
+ * the smallest power that is handled at that width; the units digit
+ * is what remains after the last subtraction. */
+static const uint16_t pow10_16[] = { 10000U, 1000U, 100U, 10U };
+static const uint32_t pow10_32[] = { 1000000000UL, 100000000UL, 10000000UL,
+                                     1000000UL, 100000UL, 10000UL };
+static const unsigned long long pow10_64[] = {
+  10000000000000000000ULL, 1000000000000000000ULL, 100000000000000000ULL,
+  10000000000000000ULL, 1000000000000000ULL, 100000000000000ULL,
+  10000000000000ULL, 1000000000000ULL, 100000000000ULL,
+  10000000000ULL, 1000000000ULL
+};
+
+#define POW10_END_(t_) ((t_) + sizeof(t_) / sizeof(*(t_)))
+
+/* Emit one digit for each power from pp to the end of pow10_16, then
+ * the units digit.  Each digit costs at most nine 16-bit
+ * subtractions. */
+static char *
+dec16_ (char * dp,
+        uint16_t v,
+        const uint16_t * pp)
+{
+  while (pp < POW10_END_(pow10_16)) {
+    uint16_t p = *pp++;
+    char d = '0';
+
+    while (v >= p) {
+      v -= p;
+      ++d;
+    }
+    *dp++ = d;
+  }
+  *dp++ = '0' + v;
+  return dp;
+}
+
+/* As with dec16_ but starting from a power in pow10_32.  Once the
+ * 10000 digit is produced the remainder fits in 16 bits. */
+static char *
+dec32_ (char * dp,
+        uint32_t v,
+        const uint32_t * pp)
+{
+  while (pp < POW10_END_(pow10_32)) {
+    uint32_t p = *pp++;
+    char d = '0';
+
+    while (v >= p) {
+      v -= p;
+      ++d;
+    }
+    *dp++ = d;
+  }
+  return dec16_(dp, (uint16_t)v, pow10_16 + 1);
+}
+
+/* Emit the decimal digits of a value of at most 32 bits, returning
+ * the position after the last. */
+static char *
+dec_ (char * dp,
+      uint32_t v)
+{
+  if (v <= 0xFFFFU) {
+    const uint16_t * pp = pow10_16;
+    uint16_t v16 = v;
+
+    while ((pp < POW10_END_(pow10_16)) && (v16 < *pp)) {
+      ++pp;
+    }
+    return dec16_(dp, v16, pp);
+  } else {
+    const uint32_t * pp = pow10_32;
+
+    while (v < *pp) {
+      ++pp;
+    }
+    return dec32_(dp, v, pp);
+  }
+}
+
+/* As with dec_, for a value that needs more than 32 bits */
+static char *
+dec64_ (char * dp,
+        unsigned long long v)
+{
+  const unsigned long long * pp = pow10_64;
+
+  while (v < *pp) {
+    ++pp;
+  }
+  while (pp < POW10_END_(pow10_64)) {
+    unsigned long long p = *pp++;
+    char d = '0';
+
+    while (v >= p) {
+      v -= p;
+      ++d;
+    }
+    *dp++ = d;
+  }
+  /* Remainder is less than 10^9 */
+  return dec32_(dp, (uint32_t)v, pow10_32 + 1);
+}
+
+/* The base two logarithm of radix if it is a power of two, otherwise
+ * zero. */
+static unsigned int
+shift_ (unsigned int radix)
+{
+  unsigned int shift = 0;
+
+  while ((1U << shift) < radix) {
+    ++shift;
+  }
+  return ((1U << shift) == radix) ? shift : 0;
+}
+
+/* Store the digits of a value of at most 32 bits least significant
+ * first, returning the position after the last.  Each digit is taken
+ * with the narrowest arithmetic that holds what remains of the
+ * value. */
+static char *
+rev_ (char * dp,
+      uint32_t v,
+      unsigned int radix,
+      const char * digits)
+{
+  unsigned int shift = shift_(radix);
+  uint16_t v16;
+
+  if (shift) {
+    unsigned int mask = radix - 1;
+
+    while (v > 0xFFFFU) {
+      *dp++ = digits[v & mask];
+      v >>= shift;
+    }
+    v16 = v;
+    do {
+      *dp++ = digits[v16 & mask];
+      v16 >>= shift;
+    } while (v16);
+  } else {
+    while (v > 0xFFFFU) {
+      *dp++ = digits[v % radix];
+      v /= radix;
+    }
+    v16 = v;
+    do {
+      *dp++ = digits[v16 % radix];
+      v16 /= radix;
+    } while (v16);
+  }
+  return dp;
+}
+
+/* As with rev_, for a value that needs more than 32 bits.  Radixes
+ * that are not powers of two divide the value held as 16-bit limbs,
+ * so each step is a 32-bit division; once the value fits in 32 bits
+ * rev_ finishes it. */
+static char *
+rev64_ (char * dp,
+        unsigned long long v,
+        unsigned int radix,
+        const char * digits)
+{
+  unsigned int shift = shift_(radix);
+  uint16_t limb[4];
+  unsigned int i;
+
+  if (shift) {
+    unsigned int mask = radix - 1;
+
+    do {
+      *dp++ = digits[v & mask];
+      v >>= shift;
+    } while ((v >> 16) >> 16);
+    return rev_(dp, (uint32_t)v, radix, digits);
+  }
+  for (i = 0; i < 4; ++i) {
+    limb[3 - i] = (uint16_t)(v >> (16 * i));
+  }
+  while ((0 != limb[0]) || (0 != limb[1])) {
+    uint32_t r = 0;
+
+    for (i = 0; i < 4; ++i) {
+      uint32_t x = (r << 16) | limb[i];
+
+      limb[i] = x / radix;
+      r = x % radix;
+    }
+    *dp++ = digits[r];
+  }
+  return rev_(dp, ((uint32_t)limb[2] << 16) | limb[3], radix, digits);
+}
+
+/* Reverse the digits stored from dp to ep and terminate them,
+ * returning their number. */
+static int
+reverse_ (char * dp,
+          char * ep)
+{
+  int len = ep - dp;
+
+  *ep = 0;
+  while (dp < --ep) {
+    char c = *dp;
+
+    *dp++ = *ep;
+    *ep = c;
+  }
+  return len;
+}
+
+/* Convert a value of at most 32 bits, with radix as passed to
+ * iBSP430formatUnsignedLong(). */
+static int
+convert_ (char * dp,
+          uint32_t value,
+          int radix)
+{
+  const char * digits = (radix & BSP430_FORMAT_RADIX_UPPER) ? digits_upper : digits_lower;
+  char * ep;
+
+  radix &= ~BSP430_FORMAT_RADIX_UPPER;
+  if ((2 > radix) || (36 < radix)) {
+    return -1;
+  }
+  if (10 == radix) {
+    ep = dec_(dp, value);
+    *ep = 0;
+    return ep - dp;
+  }
+  return reverse_(dp, rev_(dp, value, radix, digits));
+}
+
+int
+iBSP430formatUnsignedLongLong (char * dp,
+                               unsigned long long value,
+                               int radix)
+{
+  const char * digits = (radix & BSP430_FORMAT_RADIX_UPPER) ? digits_upper : digits_lower;
+  char * ep;
+
+  if (0 == ((value >> 16) >> 16)) {
+    return convert_(dp, (uint32_t)value, radix);
+  }
+  radix &= ~BSP430_FORMAT_RADIX_UPPER;
+  if ((2 > radix) || (36 < radix)) {
+    return -1;
+  }
+  if (10 == radix) {
+    ep = dec64_(dp, value);
+    *ep = 0;
+    return ep - dp;
+  }
+  return reverse_(dp, rev64_(dp, value, radix, digits));
+}
+
+int
+iBSP430formatUnsignedLong (char * dp,
+                           unsigned long value,
+                           int radix)
+{
+  /* Only where unsigned long is wider than 32 bits */
+  if (0 != ((value >> 16) >> 16)) {
+    return iBSP430formatUnsignedLongLong(dp, value, radix);
+  }
+  return convert_(dp, (uint32_t)value, radix);
+}
+
+/* Emit n copies of the fill character c. */
+static int
+pad_ (iBSP430formatEmit emit,
+      void * context,
+      char c,
+      int n)
+{
+  static const char spaces[] = "                ";
+  static const char zeros[] = "0000000000000000";
+  const char * sp = ('0' == c) ? zeros : spaces;
+  int rc = 0;
+
+  while ((0 < n) && (0 <= rc)) {
+    int k = (n < (int)(sizeof(spaces) - 1)) ? n : (int)(sizeof(spaces) - 1);
+    rc = emit(context, sp, k);
+    n -= k;
+  }
+  return rc;
+}
+
+#define FLAG_LEFT 0x01
+#define FLAG_PLUS 0x02
+#define FLAG_SPACE 0x04
+#define FLAG_ALT 0x08
+#define FLAG_ZERO 0x10
+
+int
+iBSP430formatVprintf (iBSP430formatEmit emit,
+                      void * context,
+                      const char * fmt,
+                      va_list ap)
+{
+  int rv = 0;
+  int rc = 0;
+
+  /* Emit and account for text; stop on the first error */
+#define EMIT_(cp_, len_) do {                   \
+    if (0 < (len_)) {                           \
+      rc = emit(context, cp_, len_);            \
+      if (0 > rc) {                             \
+        return rc;                              \
+      }                                         \
+      rv += (len_);                             \
+    }                                           \
+  } while (0)
+#define PAD_(c_, n_) do {                       \
+    if (0 < (n_)) {                             \
+      rc = pad_(emit, context, c_, n_);         \
+      if (0 > rc) {                             \
+        return rc;                              \
+      }                                         \
+      rv += (n_);                               \
+    }                                           \
+  } while (0)
+
+  while (*fmt) {
+    /* Enough for the octal digits of an unsigned long long, the
+     * longest conversion printf(3) can request */
+    char buffer[1 + (8 * sizeof(unsigned long long) + 2) / 3];
+    const char * sp = fmt;
+    const char * body;
+    const char * prefix = "";
+    int prefix_len;
+    int body_len;
+    int flags = 0;
+    int width = 0;
+    int precision = -1;
+    int lmod = 0;
+    int zeros = 0;
+    int is_signed = 0;
+    int radix = 0;
+
+    while (*fmt && ('%' != *fmt)) {
+      ++fmt;
+    }
+    EMIT_(sp, fmt - sp);
+    if (! *fmt) {
+      break;
+    }
+    sp = fmt++;
+    while (1) {
+      if ('-' == *fmt) {
+        flags |= FLAG_LEFT;
+      } else if ('+' == *fmt) {
+        flags |= FLAG_PLUS;
+      } else if (' ' == *fmt) {
+        flags |= FLAG_SPACE;
+      } else if ('#' == *fmt) {
+        flags |= FLAG_ALT;
+      } else if ('0' == *fmt) {
+        flags |= FLAG_ZERO;
+      } else {
+        break;
+      }
+      ++fmt;
+    }
+    if ('*' == *fmt) {
+      width = va_arg(ap, int);
+      if (0 > width) {
+        flags |= FLAG_LEFT;
+        width = -width;
+      }
+      ++fmt;
+    } else {
+      while (('0' <= *fmt) && (*fmt <= '9')) {
+        width = 10 * width + *fmt++ - '0';
+      }
+    }
+    if ('.' == *fmt) {
+      ++fmt;
+      if ('*' == *fmt) {
+        precision = va_arg(ap, int);
+        ++fmt;
+      } else {
+        precision = 0;
+        while (('0' <= *fmt) && (*fmt <= '9')) {
+          precision = 10 * precision + *fmt++ - '0';
+        }
+      }
+    }
+    /* Length modifiers: -2 hh, -1 h, 1 l, 2 ll */
+    if ('h' == *fmt) {
+      lmod = -1;
+      if ('h' == *++fmt) {
+        lmod = -2;
+        ++fmt;
+      }
+    } else if ('l' == *fmt) {
+      lmod = 1;
+      if ('l' == *++fmt) {
+        lmod = 2;
+        ++fmt;
+      }
+    } else if ('z' == *fmt) {
+      lmod = (sizeof(size_t) > sizeof(unsigned int)) ? 1 : 0;
+      ++fmt;
+    }
+    switch (*fmt) {
+      case 'd':
+      case 'i':
+        is_signed = 1;
+        /*FALLTHRU*/
+      case 'u':
+        radix = 10;
+        break;
+      case 'o':
+        radix = 8;
+        break;
+      case 'p':
+        flags |= FLAG_ALT;
+        lmod = (sizeof(void *) > sizeof(unsigned int)) ? 1 : 0;
+        /*FALLTHRU*/
+      case 'x':
+        radix = 16;
+        break;
+      case 'X':
+        radix = 16 | BSP430_FORMAT_RADIX_UPPER;
+        break;
+      case 'c':
+        buffer[0] = (char)va_arg(ap, int);
+        body = buffer;
+        body_len = 1;
+        break;
+      case 's':
+        body = va_arg(ap, const char *);
+        if (! body) {
+          body = "(null)";
+        }
+        if (0 <= precision) {
+          const char * ep = memchr(body, 0, precision);
+          body_len = ep ? (ep - body) : precision;
+        } else {
+          body_len = strlen(body);
+        }
+        break;
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        (void)va_arg(ap, double);
+        body = "?";
+        body_len = 1;
+        break;
+      case '%':
+        body = fmt;
+        body_len = 1;
+        break;
+      default:
+        /* Unrecognized: emit the specification verbatim */
+        if (*fmt) {
+          ++fmt;
+        }
+        EMIT_(sp, fmt - sp);
+        continue;
+    }
+    ++fmt;
+    if (radix) {
+      /* Only ll conversions are carried at 64 bits */
+      unsigned long uv = 0;
+      unsigned long long ullv = 0;
+      int negative = 0;
+
+      if ('p' == fmt[-1]) {
+        uv = (uintptr_t)va_arg(ap, void *);
+      } else if (2 == lmod) {
+        if (is_signed) {
+          long long sv = va_arg(ap, long long);
+
+          negative = (0 > sv);
+          ullv = negative ? -(unsigned long long)sv : (unsigned long long)sv;
+        } else {
+          ullv = va_arg(ap, unsigned long long);
+        }
+      } else if (is_signed) {
+        long sv;
+
+        if (1 == lmod) {
+          sv = va_arg(ap, long);
+        } else {
+          sv = va_arg(ap, int);
+          if (-1 == lmod) {
+            sv = (short)sv;
+          } else if (-2 == lmod) {
+            sv = (signed char)sv;
+          }
+        }
+        negative = (0 > sv);
+        uv = negative ? -(unsigned long)sv : (unsigned long)sv;
+      } else {
+        if (1 == lmod) {
+          uv = va_arg(ap, unsigned long);
+        } else {
+          uv = va_arg(ap, unsigned int);
+          if (-1 == lmod) {
+            uv = (unsigned short)uv;
+          } else if (-2 == lmod) {
+            uv = (unsigned char)uv;
+          }
+        }
+      }
+      if (negative) {
+        prefix = "-";
+      } else if (is_signed) {
+        if (flags & FLAG_PLUS) {
+          prefix = "+";
+        } else if (flags & FLAG_SPACE) {
+          prefix = " ";
+        }
+      }
+      body = buffer;
+      if ((0 == precision) && (0 == uv) && (0 == ullv)) {
+        /* Explicit zero precision suppresses a zero value */
+        body_len = 0;
+      } else if (2 == lmod) {
+        body_len = iBSP430formatUnsignedLongLong(buffer, ullv, radix);
+      } else {
+        body_len = iBSP430formatUnsignedLong(buffer, uv, radix);
+      }
+      if ((flags & FLAG_ALT)
+          && (16 == (radix & ~BSP430_FORMAT_RADIX_UPPER)) && ((0 != uv) || (0 != ullv))) {
+        prefix = (radix & BSP430_FORMAT_RADIX_UPPER) ? "0X" : "0x";
+      }
+      if (precision > body_len) {
+        zeros = precision - body_len;
+      } else if ((flags & FLAG_ZERO) && ! (flags & FLAG_LEFT) && (0 > precision)) {
+        zeros = width - body_len - (int)strlen(prefix);
+      }
+      if (0 > zeros) {
+        zeros = 0;
+      }
+      if ((flags & FLAG_ALT) && (8 == radix) && (0 == zeros)
+          && ((0 == body_len) || ('0' != buffer[0]))) {
+        /* Ensure the first digit is zero, unless padding supplies it */
+        zeros = 1;
+      }
+    }
+    prefix_len = strlen(prefix);
+    width -= prefix_len + zeros + body_len;
+    if (! (flags & FLAG_LEFT)) {
+      PAD_(' ', width);
+    }
+    EMIT_(prefix, prefix_len);
+    PAD_('0', zeros);
+    EMIT_(body, body_len);
+    if (flags & FLAG_LEFT) {
+      PAD_(' ', width);
+    }
+  }
+  return rv;
+#undef PAD_
+#undef EMIT_
+}
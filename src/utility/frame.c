@@ -0,0 +1,371 @@
+/* Copyright 2014, Peter A. Bigot
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the software nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ *
+ * @brief Implementation of framed channels over the console UART
+ *
+ * @homepage http://github.com/pabigot/bsp430
+ * @copyright Copyright 2014, Peter A. Bigot.  Licensed under <a href="http://www.opensource.org/licenses/BSD-3-Clause">BSD-3-Clause</a>
+ */
+
+#include <bsp430/utility/frame.h>
+#include <bsp430/utility/console.h>
+
+#if (256 < (BSP430_FRAME_CHANNEL_COUNT)) || ((BSP430_FRAME_CHANNEL_COUNT) < 1)
+#error BSP430_FRAME_CHANNEL_COUNT must be between 1 and 256
+#endif /* validate BSP430_FRAME_CHANNEL_COUNT */
+
+/* The longest run of non-zero octets a COBS block can hold. */
+#define COBS_RUN_MAX 254
+
+/* Octets in a frame in addition to the payload: the channel and the
+ * CRC. */
+#define FRAME_OVERHEAD 3
+
+/* Value of in_frame while skipping the remainder of a frame that
+ * was too long */
+#define FRAME_RX_DISCARD 2
+
+typedef struct sFrameRx {
+  sBSP430halISRVoidChainNode cb_node;
+  /* The UART to which cb_node is linked, if any */
+  hBSP430halSERIAL hal;
+  /* Nonzero while between the delimiters of a frame;
+   * FRAME_RX_DISCARD if the frame is being discarded */
+  unsigned char in_frame;
+  /* The code octet of the current COBS block, or zero before the
+   * first */
+  uint8_t code;
+  /* The number of data octets remaining in the current block */
+  uint8_t remaining;
+  /* The number of decoded octets in buffer */
+  unsigned int len;
+  unsigned long errors;
+  uint8_t buffer[BSP430_FRAME_RX_PAYLOAD_MAX + FRAME_OVERHEAD];
+  iBSP430frameRxCallback_ni callback_ni[BSP430_FRAME_CHANNEL_COUNT];
+} sFrameRx;
+
+/* A piece of the unencoded frame. */
+typedef struct sFrameSegment {
+  const uint8_t * dp;
+  size_t len;
+} sFrameSegment;
+
+/* Update a CRC-16 with polynomial 0x1021 with one octet.  This form
+ * avoids both a table and a bit loop. */
+static BSP430_CORE_INLINE
+uint16_t
+frame_crc_update (uint16_t crc,
+                  uint8_t octet)
+{
+  uint16_t x = (uint8_t)((crc >> 8) ^ octet);
+
+  x ^= x >> 4;
+  return (crc << 8) ^ (x << 12) ^ (x << 5) ^ x;
+}
+
+static uint16_t
+frame_crc (uint16_t crc,
+           const uint8_t * dp,
+           size_t len)
+{
+  const uint8_t * const edp = dp + len;
+
+  while (dp < edp) {
+    crc = frame_crc_update(crc, *dp++);
+  }
+  return crc;
+}
+
+/* COBS-encode the concatenation of the segments from sp up to esp.
+ * If emitp is nonzero the encoded octets are transmitted, with each
+ * run of data passed directly from its segment to the console.
+ * Returns the length of the encoding. */
+static size_t
+frame_encode_ni (const sFrameSegment * sp,
+                 const sFrameSegment * esp,
+                 int emitp)
+{
+  size_t encoded = 0;
+  size_t so = 0;
+
+  while (1) {
+    const sFrameSegment * xsp = sp;
+    size_t xo = so;
+    uint8_t run = 0;
+    int zero = 0;
+
+    /* Find the end of the run of non-zero octets starting at sp/so */
+    while ((COBS_RUN_MAX > run) && (xsp < esp)) {
+      if (xo >= xsp->len) {
+        ++xsp;
+        xo = 0;
+        continue;
+      }
+      if (0 == xsp->dp[xo]) {
+        zero = 1;
+        break;
+      }
+      ++run;
+      ++xo;
+    }
+    encoded += 1 + run;
+    if (emitp) {
+      uint8_t code = 1 + run;
+
+      (void)iBSP430consoleTransmitOctets(&code, 1);
+      while (0 < run) {
+        size_t n = sp->len - so;
+
+        if (n > run) {
+          n = run;
+        }
+        if (0 < n) {
+          (void)iBSP430consoleTransmitOctets(sp->dp + so, n);
+          run -= n;
+          so += n;
+        }
+        if (so >= sp->len) {
+          ++sp;
+          so = 0;
+        }
+      }
+    }
+    sp = xsp;
+    so = xo;
+    if (zero) {
+      /* The zero is implied by the block; the next block encodes what
+       * follows it, even if nothing does. */
+      ++so;
+    } else if (sp >= esp) {
+      break;
+    }
+  }
+  return encoded;
+}
+
+int
+iBSP430frameTransmit (unsigned int channel,
+                      const uint8_t * data,
+                      size_t len)
+{
+  BSP430_CORE_SAVED_INTERRUPT_STATE(istate);
+  static const uint8_t delimiter = BSP430_FRAME_DELIMITER;
+  uint8_t header = channel;
+  uint8_t trailer[2];
+  sFrameSegment segments[3];
+  size_t encoded;
+  uint16_t crc;
+  int rv = -1;
+
+  if (BSP430_FRAME_CHANNEL_COUNT <= channel) {
+    return -1;
+  }
+  crc = frame_crc(frame_crc_update(0xFFFF, header), data, len);
+  trailer[0] = crc & 0xFF;
+  trailer[1] = crc >> 8;
+  segments[0].dp = &header;
+  segments[0].len = sizeof(header);
+  segments[1].dp = data;
+  segments[1].len = len;
+  segments[2].dp = trailer;
+  segments[2].len = sizeof(trailer);
+  encoded = 2 + frame_encode_ni(segments, segments + 3, 0);
+  BSP430_CORE_DISABLE_INTERRUPT();
+  if (0 <= iBSP430consoleReserveTxSpace_ni(encoded)) {
+    (void)iBSP430consoleTransmitOctets(&delimiter, 1);
+    (void)frame_encode_ni(segments, segments + 3, 1);
+    (void)iBSP430consoleTransmitOctets(&delimiter, 1);
+    rv = len;
+  }
+  BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
+  return rv;
+}
+
+/* Validate and deliver the frame that has just been terminated.
+ * Returns -1 if the frame is bad, otherwise the callback flags. */
+static int
+frame_rx_complete_ni (sFrameRx * rxp)
+{
+  const uint8_t * const bp = rxp->buffer;
+  unsigned int len = rxp->len;
+  iBSP430frameRxCallback_ni cb;
+  uint16_t crc;
+
+  /* The last block must be complete, and there must be room for the
+   * channel and CRC. */
+  if ((0 != rxp->remaining) || (FRAME_OVERHEAD > len)) {
+    return -1;
+  }
+  len -= 2;
+  crc = frame_crc(0xFFFF, bp, len);
+  if ((bp[len] != (crc & 0xFF)) || (bp[len + 1] != (crc >> 8))
+      || (BSP430_FRAME_CHANNEL_COUNT <= bp[0])) {
+    return -1;
+  }
+  cb = rxp->callback_ni[bp[0]];
+  if (NULL == cb) {
+    return 0;
+  }
+  return cb(bp[0], bp + 1, len - 1);
+}
+
+/* Append a decoded octet to the frame.  If it does not fit the
+ * frame is abandoned, and what follows is discarded until the next
+ * delimiter.  Returns 0 if the octet was stored. */
+static int
+frame_rx_store_ni (sFrameRx * rxp,
+                   uint8_t c)
+{
+  if (sizeof(rxp->buffer) <= rxp->len) {
+    rxp->errors += 1;
+    rxp->in_frame = FRAME_RX_DISCARD;
+    return -1;
+  }
+  rxp->buffer[rxp->len++] = c;
+  return 0;
+}
+
+static int
+frame_rx_isr_ni (const struct sBSP430halISRVoidChainNode * cb,
+                 void * context)
+{
+  sFrameRx * rxp = (sFrameRx *)cb;
+  sBSP430halSERIAL * hal = (sBSP430halSERIAL *) context;
+  uint8_t c = hal->rx_byte;
+  int rv = BSP430_HAL_ISR_CALLBACK_BREAK_CHAIN;
+
+  if (BSP430_FRAME_DELIMITER == c) {
+    if (FRAME_RX_DISCARD == rxp->in_frame) {
+      rxp->in_frame = 0;
+    } else if (rxp->in_frame && (0 != rxp->code)) {
+      int frv = frame_rx_complete_ni(rxp);
+
+      if (0 <= frv) {
+        rv |= frv;
+        rxp->in_frame = 0;
+      } else {
+        /* Perhaps the start of a frame was lost and this delimiter
+         * begins the next one. */
+        rxp->errors += 1;
+      }
+    } else {
+      rxp->in_frame = 1;
+    }
+    rxp->code = 0;
+    rxp->remaining = 0;
+    rxp->len = 0;
+    return rv;
+  }
+  if (! rxp->in_frame) {
+    /* Text for the console */
+    return 0;
+  }
+  if (FRAME_RX_DISCARD == rxp->in_frame) {
+    return rv;
+  }
+  if (0 == rxp->remaining) {
+    /* A code octet.  Unless the previous block was full it was
+     * followed by a zero. */
+    if ((0 != rxp->code) && ((1 + COBS_RUN_MAX) != rxp->code)
+        && (0 != frame_rx_store_ni(rxp, 0))) {
+      return rv;
+    }
+    rxp->code = c;
+    rxp->remaining = c - 1;
+  } else {
+    rxp->remaining -= 1;
+    (void)frame_rx_store_ni(rxp, c);
+  }
+  return rv;
+}
+
+static sFrameRx frame_rx_ = {
+  .cb_node = { .callback_ni = frame_rx_isr_ni },
+};
+
+int
+iBSP430frameInitialize (void)
+{
+  BSP430_CORE_SAVED_INTERRUPT_STATE(istate);
+  hBSP430halSERIAL hal = hBSP430console();
+  int rv = -1;
+
+  if (NULL == hal) {
+    return rv;
+  }
+  BSP430_CORE_DISABLE_INTERRUPT();
+  if (NULL == frame_rx_.hal) {
+    frame_rx_.in_frame = 0;
+    frame_rx_.hal = hal;
+    BSP430_HAL_ISR_CALLBACK_LINK_NI(sBSP430halISRVoidChainNode, hal->rx_cbchain_ni, frame_rx_.cb_node, next_ni);
+  }
+  rv = 0;
+  BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
+  return rv;
+}
+
+int
+iBSP430frameDeconfigure (void)
+{
+  BSP430_CORE_SAVED_INTERRUPT_STATE(istate);
+
+  BSP430_CORE_DISABLE_INTERRUPT();
+  if (NULL != frame_rx_.hal) {
+    BSP430_HAL_ISR_CALLBACK_UNLINK_NI(sBSP430halISRVoidChainNode, frame_rx_.hal->rx_cbchain_ni, frame_rx_.cb_node, next_ni);
+    frame_rx_.hal = NULL;
+  }
+  BSP430_CORE_RESTORE_INTERRUPT_STATE(istate);
+  return 0;
+}
+
+int
+iBSP430frameSetRxCallback_ni (unsigned int channel,
+                              iBSP430frameRxCallback_ni cb)
+{
+  if (BSP430_FRAME_CHANNEL_COUNT <= channel) {
+    return -1;
+  }
+  frame_rx_.callback_ni[channel] = cb;
+  return 0;
+}
+
+unsigned long
+ulBSP430frameRxErrors_ni (int reset)
+{
+  unsigned long rv = frame_rx_.errors;
+
+  if (reset) {
+    frame_rx_.errors = 0;
+  }
+  return rv;
+}
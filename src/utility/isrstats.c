@@ -0,0 +1,148 @@
+/* Copyright 2014, Peter A. Bigot
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the software nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ *
+ * @brief Implementation of duration histograms for HAL interrupt handlers
+ *
+ * @homepage http://github.com/pabigot/bsp430
+ * @copyright Copyright 2014, Peter A. Bigot.  Licensed under <a href="http://www.opensource.org/licenses/BSD-3-Clause">BSD-3-Clause</a>
+ */
+
+#include <bsp430/utility/isrstats.h>
+
+#if (configBSP430_ISRSTATS - 0)
+
+/* Read in place of a real counter until one is supplied, so handlers
+ * need not check for a null pointer. */
+static volatile unsigned int no_counter_;
+
+volatile unsigned int * xBSP430isrstatsCounter_ni = &no_counter_;
+
+static hBSP430isrstatsVector first_ni;
+
+void
+vBSP430isrstatsInitialize_ni (volatile unsigned int * counterp)
+{
+  xBSP430isrstatsCounter_ni = counterp ? counterp : &no_counter_;
+}
+
+void
+vBSP430isrstatsRecord_ni (hBSP430isrstatsVector vector)
+{
+  unsigned int dur_tt;
+  unsigned int bucket;
+
+  if (&no_counter_ == xBSP430isrstatsCounter_ni) {
+    return;
+  }
+  /* Durations are modulo the 16-bit counter period */
+  dur_tt = 0xFFFF & (*xBSP430isrstatsCounter_ni - vector->start_tt);
+  if (! vector->linked_ni) {
+    vector->next_ni = first_ni;
+    first_ni = vector;
+    vector->linked_ni = 1;
+  }
+  ++vector->count_ni;
+  if (dur_tt > vector->max_tt) {
+    vector->max_tt = dur_tt;
+  }
+  bucket = 0;
+  while (dur_tt) {
+    ++bucket;
+    dur_tt >>= 1;
+  }
+  if (0 != (unsigned int)~vector->buckets_ni[bucket]) {
+    ++vector->buckets_ni[bucket];
+  }
+}
+
+hBSP430isrstatsVector
+hBSP430isrstatsFirst_ni (void)
+{
+  return first_ni;
+}
+
+void
+vBSP430isrstatsReset_ni (void)
+{
+  hBSP430isrstatsVector vp;
+
+  for (vp = first_ni; vp; vp = vp->next_ni) {
+    unsigned int b;
+
+    vp->count_ni = 0;
+    vp->max_tt = 0;
+    for (b = 0; b < BSP430_ISRSTATS_NBUCKETS; ++b) {
+      vp->buckets_ni[b] = 0;
+    }
+  }
+}
+
+static uint8_t *
+encode_ (uint8_t * bp,
+         unsigned long value,
+         unsigned int octets)
+{
+  while (0 < octets--) {
+    *bp++ = value & 0xFF;
+    value >>= 8;
+  }
+  return bp;
+}
+
+int
+iBSP430isrstatsEncode_ni (hBSP430isrstatsVector vector,
+                          uint8_t * buf,
+                          size_t len)
+{
+  uint8_t * bp = buf;
+  const char * np = vector->name;
+  unsigned int b;
+
+  while (*np) {
+    ++np;
+  }
+  if (len < ((BSP430_ISRSTATS_ENCODED_FIXED_LENGTH) + (np - vector->name))) {
+    return -1;
+  }
+  bp = encode_(bp, vector->count_ni, 4);
+  bp = encode_(bp, vector->max_tt, 2);
+  for (b = 0; b < BSP430_ISRSTATS_NBUCKETS; ++b) {
+    bp = encode_(bp, vector->buckets_ni[b], 2);
+  }
+  for (np = vector->name; *np; ++np) {
+    *bp++ = *np;
+  }
+  return bp - buf;
+}
+
+#endif /* configBSP430_ISRSTATS */
@@ -0,0 +1,284 @@
+/* Copyright 2014, Peter A. Bigot
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the software nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ *
+ * @brief Implementation of the shared serial bus scheduler
+ *
+ * @homepage http://github.com/pabigot/bsp430
+ * @copyright Copyright 2014, Peter A. Bigot.  Licensed under <a href="http://www.opensource.org/licenses/BSD-3-Clause">BSD-3-Clause</a>
+ */
+
+#include <bsp430/utility/serialbus.h>
+#include <string.h>
+
+#if ! (BSP430_SERIAL_ENABLE_RESOURCE - 0)
+#error utility/serialbus requires BSP430_SERIAL_ENABLE_RESOURCE
+#endif /* BSP430_SERIAL_ENABLE_RESOURCE */
+
+#if (255 < (BSP430_SERIALBUS_MAX_BYPASS)) || ((BSP430_SERIALBUS_MAX_BYPASS) < 0)
+#error BSP430_SERIALBUS_MAX_BYPASS must be between 0 and 255
+#endif /* validate BSP430_SERIALBUS_MAX_BYPASS */
+
+/* Nonzero if a device configured for cp can be used for rp without
+ * being reset.  The I2C slave address can be changed in place. */
+static int
+compatibleConfig (const sBSP430serialBusConfig * cp,
+                  const sBSP430serialBusConfig * rp)
+{
+  return (cp->mode == rp->mode)
+    && (cp->ctl0_byte == rp->ctl0_byte)
+    && (cp->ctl1_byte == rp->ctl1_byte)
+    && (cp->prescaler == rp->prescaler);
+}
+
+/* Choose the next request to serve and remove it from the queue. */
+static hBSP430serialBusRequest
+selectRequest_ni (hBSP430serialBus bus)
+{
+  volatile hBSP430serialBusRequest * rpp = &bus->head_ni;
+  hBSP430serialBusRequest rp = *rpp;
+
+  if (bus->configured_ni && (! compatibleConfig(&bus->config_ni, rp->config))) {
+    if (BSP430_SERIALBUS_MAX_BYPASS > bus->bypass_ni) {
+      volatile hBSP430serialBusRequest * spp = &rp->next_ni;
+
+      /* Look for a request of the same priority that can use the
+       * current configuration */
+      while ((NULL != *spp) && ((*spp)->priority == rp->priority)) {
+        if (compatibleConfig(&bus->config_ni, (*spp)->config)) {
+          ++bus->bypass_ni;
+          rpp = spp;
+          break;
+        }
+        spp = &(*spp)->next_ni;
+      }
+    }
+  }
+  rp = *rpp;
+  if (rpp == &bus->head_ni) {
+    bus->bypass_ni = 0;
+  }
+  *rpp = rp->next_ni;
+  rp->next_ni = NULL;
+  return rp;
+}
+
+/* Configure the peripheral for the request, returning it or a null
+ * pointer on failure. */
+static hBSP430halSERIAL
+configure_ni (hBSP430serialBus bus,
+              const sBSP430serialBusConfig * cp)
+{
+  hBSP430halSERIAL hal = bus->hal;
+
+  if ((! bus->configured_ni) || (! compatibleConfig(&bus->config_ni, cp))) {
+    bus->configured_ni = 0;
+    ++bus->reconfigurations;
+    if (BSP430_SERIALBUS_MODE_SPI == cp->mode) {
+#if (configBSP430_SERIAL_ENABLE_SPI - 0)
+      hal = hBSP430serialOpenSPI(hal, cp->ctl0_byte, cp->ctl1_byte, cp->prescaler);
+#else /* configBSP430_SERIAL_ENABLE_SPI */
+      hal = NULL;
+#endif /* configBSP430_SERIAL_ENABLE_SPI */
+    } else if (BSP430_SERIALBUS_MODE_I2C == cp->mode) {
+#if (configBSP430_SERIAL_ENABLE_I2C - 0)
+      hal = hBSP430serialOpenI2C(hal, cp->ctl0_byte, cp->ctl1_byte, cp->prescaler);
+      /* Force the slave address to be set */
+      bus->config_ni.slave_address = -1;
+#else /* configBSP430_SERIAL_ENABLE_I2C */
+      hal = NULL;
+#endif /* configBSP430_SERIAL_ENABLE_I2C */
+    } else {
+      hal = NULL;
+    }
+    if (NULL == hal) {
+      return NULL;
+    }
+    bus->config_ni.mode = cp->mode;
+    bus->config_ni.ctl0_byte = cp->ctl0_byte;
+    bus->config_ni.ctl1_byte = cp->ctl1_byte;
+    bus->config_ni.prescaler = cp->prescaler;
+    bus->configured_ni = 1;
+  }
+#if (configBSP430_SERIAL_ENABLE_I2C - 0)
+  if ((BSP430_SERIALBUS_MODE_I2C == cp->mode)
+      && (0 <= cp->slave_address)
+      && (cp->slave_address != bus->config_ni.slave_address)) {
+    if (0 != iBSP430i2cSetAddresses_rh(hal, -1, cp->slave_address)) {
+      bus->configured_ni = 0;
+      return NULL;
+    }
+    bus->config_ni.slave_address = cp->slave_address;
+  }
+#endif /* configBSP430_SERIAL_ENABLE_I2C */
+  return hal;
+}
+
+/* Start queued requests until one holds the bus or the queue is
+ * empty, claiming and releasing the peripheral resource as
+ * required. */
+static int
+dispatch_ni (hBSP430serialBus bus)
+{
+  hBSP430resource resource = &bus->hal->resource;
+  int rv = 0;
+
+  if (bus->dispatching_ni) {
+    return 0;
+  }
+  bus->dispatching_ni = 1;
+  while (NULL == bus->active_ni) {
+    hBSP430serialBusRequest rp;
+    hBSP430halSERIAL hal;
+
+    /* Give the peripheral up if there's nothing to do or somebody
+     * else wants it.  They may reconfigure it. */
+    if (bus->held_ni
+        && ((NULL == bus->head_ni) || (NULL != resource->waiter))) {
+      bus->held_ni = 0;
+      bus->configured_ni = 0;
+      rv |= iBSP430resourceRelease_ni(resource, bus);
+    }
+    if (NULL == bus->head_ni) {
+      /* Stop waiting for the resource if the queue emptied while we
+       * were */
+      if (! bus->held_ni) {
+        rv |= iBSP430resourceCancelWait_ni(resource, &bus->waiter);
+      }
+      break;
+    }
+    if (! bus->held_ni) {
+      /* On failure we're notified through the waiter when the holder
+       * releases the resource. */
+      if (0 != iBSP430resourceClaim_ni(resource, bus, eBSP430resourceWait_FIFO, &bus->waiter)) {
+        break;
+      }
+      bus->held_ni = 1;
+    }
+    rp = selectRequest_ni(bus);
+    hal = configure_ni(bus, rp->config);
+    rp->state_ni = BSP430_SERIALBUS_STATE_ACTIVE;
+    bus->active_ni = rp;
+    ++bus->requests;
+    rv |= rp->start_ni(bus, rp, hal);
+  }
+  bus->dispatching_ni = 0;
+  return rv;
+}
+
+static int
+resourceReleased_ni (hBSP430resource resource,
+                     hBSP430resourceWaiter waiter)
+{
+  hBSP430serialBus bus = (hBSP430serialBus)(-offsetof(sBSP430serialBus, waiter) + (unsigned char *)waiter);
+
+  return dispatch_ni(bus);
+}
+
+hBSP430serialBus
+hBSP430serialBusInitialize_ni (hBSP430serialBus bus,
+                               hBSP430halSERIAL hal)
+{
+  if ((NULL == bus) || (NULL == hal)) {
+    return NULL;
+  }
+  memset(bus, 0, sizeof(*bus));
+  bus->hal = hal;
+  bus->waiter.callback_ni = resourceReleased_ni;
+  return bus;
+}
+
+int
+iBSP430serialBusSubmit_ni (hBSP430serialBus bus,
+                           hBSP430serialBusRequest request)
+{
+  volatile hBSP430serialBusRequest * rpp = &bus->head_ni;
+
+  if ((BSP430_SERIALBUS_STATE_IDLE != request->state_ni)
+      || (NULL == request->config)
+      || (NULL == request->start_ni)) {
+    return -1;
+  }
+  while ((NULL != *rpp) && ((*rpp)->priority >= request->priority)) {
+    rpp = &(*rpp)->next_ni;
+  }
+  request->next_ni = *rpp;
+  *rpp = request;
+  if (rpp == &bus->head_ni) {
+    bus->bypass_ni = 0;
+  }
+  request->state_ni = BSP430_SERIALBUS_STATE_QUEUED;
+  return dispatch_ni(bus);
+}
+
+int
+iBSP430serialBusComplete_ni (hBSP430serialBus bus,
+                             hBSP430serialBusRequest request)
+{
+  if ((NULL == request) || (request != bus->active_ni)) {
+    return -1;
+  }
+  request->state_ni = BSP430_SERIALBUS_STATE_IDLE;
+  bus->active_ni = NULL;
+  return dispatch_ni(bus);
+}
+
+int
+iBSP430serialBusCancel_ni (hBSP430serialBus bus,
+                           hBSP430serialBusRequest request)
+{
+  volatile hBSP430serialBusRequest * rpp = &bus->head_ni;
+
+  if (BSP430_SERIALBUS_STATE_ACTIVE == request->state_ni) {
+    return -1;
+  }
+  while (NULL != *rpp) {
+    if (request == *rpp) {
+      *rpp = request->next_ni;
+      request->next_ni = NULL;
+      request->state_ni = BSP430_SERIALBUS_STATE_IDLE;
+      /* Passing over the old head no longer counts against the new
+       * one */
+      if (rpp == &bus->head_ni) {
+        bus->bypass_ni = 0;
+        /* Stop waiting for the resource if there's nothing left to
+         * do */
+        if ((NULL == bus->head_ni) && (! bus->held_ni)) {
+          return iBSP430resourceCancelWait_ni(&bus->hal->resource, &bus->waiter);
+        }
+      }
+      break;
+    }
+    rpp = &(*rpp)->next_ni;
+  }
+  return 0;
+}
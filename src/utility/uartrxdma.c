@@ -0,0 +1,278 @@
+/* Copyright 2014, Peter A. Bigot
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the software nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ *
+ * @brief Implementation of UART reception through DMA
+ *
+ * @homepage http://github.com/pabigot/bsp430
+ * @copyright Copyright 2014, Peter A. Bigot.  Licensed under <a href="http://www.opensource.org/licenses/BSD-3-Clause">BSD-3-Clause</a>
+ */
+
+#include <bsp430/utility/uartrxdma.h>
+
+#if ! (configBSP430_HAL_DMA - 0)
+#error utility/uartrxdma requires configBSP430_HAL_DMA
+#endif /* configBSP430_HAL_DMA */
+#if ! ((BSP430_MODULE_DMAX - 0) && (BSP430_CORE_FAMILY_IS_5XX - 0))
+#error utility/uartrxdma supported only on 5xx/FR5xx DMAX
+#endif /* DMAX */
+
+static BSP430_CORE_INLINE
+volatile sBSP430hplDMAchannel *
+channel (const sBSP430uartRxDMA * rxd)
+{
+  return BSP430_HAL_DMA->hpl->ch + rxd->dma_channel;
+}
+
+/* Deliver the octets of the filling half from the last delivery up
+ * to offset end. */
+static int
+deliver_ni (sBSP430uartRxDMA * rxd,
+            unsigned int end,
+            int event)
+{
+  unsigned int start = rxd->delivered_ni;
+  int rv;
+
+  if (end <= start) {
+    return 0;
+  }
+  rxd->delivered_ni = end;
+  rxd->octets += end - start;
+  ++rxd->deliveries;
+  rxd->uart->num_rx += end - start;
+  rv = rxd->callback_ni(rxd, rxd->buffer + rxd->fill_ni * rxd->half_len + start, end - start, event);
+  return rv & ~BSP430_HAL_ISR_CALLBACK_DISABLE_INTERRUPT;
+}
+
+/* The channel has completed the half it was filling and begun the
+ * other.  Deliver the rest of the completed half and make the other
+ * the filling half. */
+static int
+complete_ni (sBSP430uartRxDMA * rxd)
+{
+  int rv;
+
+  rv = deliver_ni(rxd, rxd->half_len, rxd->fill_ni ? BSP430_UARTRXDMA_EVENT_FULL : BSP430_UARTRXDMA_EVENT_HALF);
+  rxd->fill_ni = ! rxd->fill_ni;
+  rxd->delivered_ni = 0;
+  rxd->idle_seen_ni = 0;
+  return rv;
+}
+
+static int
+dma_isr_ni (const struct sBSP430halISRIndexedChainNode * cb,
+            void * context,
+            int idx)
+{
+  sBSP430uartRxDMA * rxd = (sBSP430uartRxDMA *)(-offsetof(sBSP430uartRxDMA, dma_cb) + (unsigned char *)cb);
+
+  /* The channel has loaded the address of the half it is now filling
+   * from the register.  Point the register back at the half just
+   * completed, so the channel returns to it at the next
+   * completion. */
+  channel(rxd)->da = (uintptr_t)(rxd->buffer + rxd->fill_ni * rxd->half_len);
+  return complete_ni(rxd);
+}
+
+/* Octets received in the filling half, or a negative value if the
+ * channel has completed that half and its interrupt is pending. */
+static int
+received_ni (const sBSP430uartRxDMA * rxd)
+{
+  volatile sBSP430hplDMAchannel * chp = channel(rxd);
+  unsigned int sz = chp->sz;
+
+  /* Read the count before the flag: if the channel completed the half
+   * after the read the flag is set, so a reloaded count is never
+   * taken for progress through the filling half. */
+  if (chp->ctl & DMAIFG) {
+    return -1;
+  }
+  return rxd->half_len - sz;
+}
+
+static int
+idle_alarm_ni (hBSP430timerAlarm alarm)
+{
+  sBSP430uartRxDMA * rxd = (sBSP430uartRxDMA *)(-offsetof(sBSP430uartRxDMA, idle_alarm) + (unsigned char *)alarm);
+  int pos = received_ni(rxd);
+  int rv = 0;
+
+  if (0 > pos) {
+    return 0;
+  }
+  if ((unsigned int)pos == rxd->idle_seen_ni) {
+    rv = deliver_ni(rxd, pos, BSP430_UARTRXDMA_EVENT_IDLE);
+  }
+  rxd->idle_seen_ni = pos;
+  return rv;
+}
+
+int
+iBSP430uartRxDMAStart_ni (sBSP430uartRxDMA * rxd)
+{
+  volatile sBSP430hplDMA * const dma = BSP430_HAL_DMA->hpl;
+  volatile sBSP430hplDMAchannel * chp;
+  volatile unsigned int * tselp;
+  unsigned int tsel_shift;
+  hBSP430halSERIAL hal = rxd->uart;
+  volatile void * rxbufp = NULL;
+
+  if ((NULL == hal) || (BSP430_DMA_NUM_CHANNELS <= rxd->dma_channel)
+      || (NULL == rxd->buffer) || (0 == rxd->half_len)
+      || (NULL == rxd->callback_ni)) {
+    return -1;
+  }
+#if (configBSP430_SERIAL_USE_EUSCI - 0)
+  if (BSP430_SERIAL_HAL_HPL_VARIANT_IS_EUSCIA(hal)) {
+    rxbufp = &hal->hpl.euscia->rxbuf;
+    rxd->iep = (volatile unsigned char *)&hal->hpl.euscia->ie;
+    rxd->ifgp = (volatile unsigned char *)&hal->hpl.euscia->ifg;
+  }
+#endif /* configBSP430_SERIAL_USE_EUSCI */
+#if (configBSP430_SERIAL_USE_USCI5 - 0)
+  if (BSP430_SERIAL_HAL_HPL_VARIANT_IS_USCI5(hal)) {
+    rxbufp = &hal->hpl.usci5->rxbuf;
+    rxd->iep = &hal->hpl.usci5->ie;
+    rxd->ifgp = &hal->hpl.usci5->ifg;
+  }
+#endif /* configBSP430_SERIAL_USE_USCI5 */
+  if (NULL == rxbufp) {
+    return -1;
+  }
+  rxd->idle_alarmh = NULL;
+  if (BSP430_PERIPH_NONE != rxd->idle_timer) {
+    if (0 == rxd->idle_tck) {
+      return -1;
+    }
+    rxd->idle_alarmh = hBSP430timerAlarmInitialize(&rxd->idle_alarm, rxd->idle_timer, rxd->idle_ccidx, idle_alarm_ni);
+    if ((NULL == rxd->idle_alarmh)
+        || (0 != iBSP430timerAlarmSetEnabled_ni(rxd->idle_alarmh, 1))) {
+      return -1;
+    }
+  }
+
+  chp = dma->ch + rxd->dma_channel;
+  chp->ctl = 0;
+  /* Trigger selects for channels 2n and 2n+1 share DMACTLn. */
+  tselp = &dma->ctl0 + (rxd->dma_channel / 2);
+  tsel_shift = 8 * (rxd->dma_channel & 1);
+  *tselp = (*tselp & ~(0x1F << tsel_shift)) | (rxd->dma_trigger << tsel_shift);
+  chp->sa = (uintptr_t)rxbufp;
+  chp->da = (uintptr_t)rxd->buffer;
+  chp->sz = rxd->half_len;
+  rxd->fill_ni = 0;
+  rxd->delivered_ni = 0;
+  rxd->idle_seen_ni = 0;
+  rxd->dma_cb.callback_ni = dma_isr_ni;
+  BSP430_HAL_ISR_CALLBACK_LINK_NI(sBSP430halISRIndexedChainNode, BSP430_HAL_DMA->ch_cbchain_ni[rxd->dma_channel], rxd->dma_cb, next_ni);
+
+  /* The UART interrupt would compete with the channel for octets. */
+  *rxd->iep &= ~UCRXIE;
+  /* Repeated single transfers, one per trigger, from the fixed
+   * receive buffer to incrementing byte destinations.  Enabling the
+   * channel latches the first half as its destination; the register
+   * is then changed to the second half, which the channel loads when
+   * the first is complete. */
+  chp->ctl = DMADT_4 | DMASRCINCR_0 | DMADSTINCR_3 | DMADSTBYTE | DMASRCBYTE | DMAIE | DMAEN;
+  chp->da = (uintptr_t)(rxd->buffer + rxd->half_len);
+  /* The trigger is edge-sensitive.  If an octet is already waiting
+   * produce an edge so the channel takes it. */
+  if (*rxd->ifgp & UCRXIFG) {
+    *rxd->ifgp &= ~UCRXIFG;
+    *rxd->ifgp |= UCRXIFG;
+  }
+
+  if (NULL != rxd->idle_alarmh) {
+    unsigned long now = ulBSP430timerCounter_ni(rxd->idle_alarm.timer, NULL);
+
+    if (0 > iBSP430timerAlarmSetPeriodic_ni(rxd->idle_alarmh, now + rxd->idle_tck, rxd->idle_tck)) {
+      (void)iBSP430uartRxDMAStop_ni(rxd);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int
+iBSP430uartRxDMAFlush_ni (sBSP430uartRxDMA * rxd)
+{
+  int pos = received_ni(rxd);
+
+  if (0 > pos) {
+    return 0;
+  }
+  return deliver_ni(rxd, pos, BSP430_UARTRXDMA_EVENT_FLUSH);
+}
+
+int
+iBSP430uartRxDMAStop_ni (sBSP430uartRxDMA * rxd)
+{
+  volatile sBSP430hplDMAchannel * chp = channel(rxd);
+  int rv = 0;
+
+  if (NULL != rxd->idle_alarmh) {
+    (void)iBSP430timerAlarmSetEnabled_ni(rxd->idle_alarmh, 0);
+    rxd->idle_alarmh = NULL;
+  }
+  chp->ctl &= ~DMAEN;
+  BSP430_HAL_ISR_CALLBACK_UNLINK_NI(sBSP430halISRIndexedChainNode, BSP430_HAL_DMA->ch_cbchain_ni[rxd->dma_channel], rxd->dma_cb, next_ni);
+  /* A completion whose interrupt has not been taken is handled here,
+   * since the interrupt no longer reaches this receiver. */
+  if (chp->ctl & DMAIFG) {
+    chp->ctl &= ~DMAIFG;
+    rv |= complete_ni(rxd);
+  }
+  rv |= deliver_ni(rxd, rxd->half_len - chp->sz, BSP430_UARTRXDMA_EVENT_FLUSH);
+  if (NULL != rxd->uart->rx_cbchain_ni) {
+    *rxd->iep |= UCRXIE;
+  }
+  return rv;
+}
+
+int
+iBSP430uartRxDMAReplay_ni (sBSP430uartRxDMA * rxd,
+                           const uint8_t * data,
+                           unsigned int len,
+                           int event)
+{
+  hBSP430halSERIAL hal = rxd->uart;
+  int rv = 0;
+
+  (void)event;
+  while (0 < len--) {
+    hal->rx_byte = *data++;
+    rv |= iBSP430callbackInvokeISRVoid_ni(&hal->rx_cbchain_ni, hal, 0) & ~BSP430_HAL_ISR_CALLBACK_BREAK_CHAIN;
+  }
+  return rv;
+}